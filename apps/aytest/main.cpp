@@ -0,0 +1,337 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * aytest --check
+ *
+ * Runs the Mockingboard AY8910s, which skip from one output change to the
+ * next, against TickAY below, which runs every tick of both chips one at a
+ * time with the same tone, noise and envelope rules. TickAY sends each tick's
+ * change in output through the same BandLimitedSteps, so the two must produce
+ * identical samples.
+ *
+ * Both get the same random register traffic through busCycle(): short and
+ * long tone, noise and envelope periods, every envelope shape, mixer and
+ * amplitude settings, and the odd ~RESET, at random bus cycles within each
+ * frame, at 44.1kHz and 48kHz.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "NClock.hpp"
+#include "devices/mockingboard/AY8910-2.hpp"
+
+uint64_t debug_level = 0;
+
+namespace {
+
+/* Both AY chips, one tick at a time, with no skipping. */
+class TickAY {
+    public:
+        TickAY(uint64_t bus_rate, uint32_t output_rate) : bus_rate(bus_rate), output_rate(output_rate) {
+            for (int c = 0; c < 2; c++) {
+                Chip &chip = chips[c];
+                chip = Chip{};
+                for (Tone &t : chip.tone) t.counter = 1;
+                chip.noise_period = 1;
+                chip.noise_counter = 1;
+                chip.noise_rng = 1;
+                chip.registers[Mixer_Control] = 0x3F;
+                chip.mixer_control = 0x3F;
+                reg_num[c] = 0xFF;
+                mix_level[c] = mixLevel(chip);
+                steps[c].restart(mix_level[c]);
+            }
+        }
+
+        // LATCH, WRITE and ~RESET, as AY8910s::busCycle decodes them.
+        void busCycle(uint8_t c, uint8_t pa, uint8_t pb, uint64_t cycle) {
+            if ((pb & 0b100) == 0) {
+                for (uint8_t r = 0; r < AY_8913_REGISTER_COUNT; r++) pending.push_back({cycle, c, r, 0});
+                reg_num[c] = 0xFF;
+            } else if ((pb & 0b011) == 0b11) {
+                reg_num[c] = pa;
+            } else if ((pb & 0b011) == 0b10 && reg_num[c] < AY_8913_REGISTER_COUNT) {
+                pending.push_back({cycle, c, reg_num[c], pa});
+            }
+        }
+
+        void generateSamples(int num_samples, std::vector<float> &out) {
+            const uint64_t tick_span = 16 * (uint64_t)output_rate;
+            const float scale = AY_LEVEL_SCALE / (float)(1 << BandLimitedSteps::KERNEL_BITS);
+            for (int i = 0; i < num_samples; i++) {
+                const uint64_t start = position;
+                const uint64_t end = position + bus_rate;
+                while (tick * tick_span < end) {
+                    const int phase = (int)((tick * tick_span - start) * BandLimitedSteps::PHASES / bus_rate);
+                    const int32_t was[2] = { mix_level[0], mix_level[1] };
+                    runTick();
+                    for (int c = 0; c < 2; c++) {
+                        if (mix_level[c] != was[c]) steps[c].add_step(phase, mix_level[c] - was[c]);
+                    }
+                }
+                position = end;
+                out.push_back((float)steps[0].read() * scale);
+                out.push_back((float)steps[1].read() * scale);
+            }
+        }
+
+    private:
+        struct Tone {
+            uint16_t period = 0;
+            uint16_t counter = 0;
+            bool output = false;
+            uint8_t level = 0;
+            bool use_envelope = false;
+        };
+        struct Chip {
+            Tone tone[3];
+            uint16_t noise_period, noise_counter;
+            uint32_t noise_rng;
+            bool noise_output;
+            uint8_t mixer_control;
+            uint16_t envelope_period;
+            uint8_t envelope_shape;
+            uint16_t envelope_counter;
+            uint8_t envelope_output;
+            bool envelope_hold, envelope_attack;
+            uint8_t registers[AY_8913_REGISTER_COUNT];
+        };
+
+        uint64_t bus_rate;
+        uint32_t output_rate;
+        uint64_t position = 0;
+        uint64_t tick = 0;
+        Chip chips[2];
+        uint8_t reg_num[2];
+        int32_t mix_level[2];
+        BandLimitedSteps steps[2];
+        std::deque<RegisterEvent> pending;
+
+        void write(Chip &chip, uint8_t reg, uint8_t value) {
+            chip.registers[reg] = value;
+            switch (reg) {
+                case A_Tone_Low: case A_Tone_High:
+                case B_Tone_Low: case B_Tone_High:
+                case C_Tone_Low: case C_Tone_High: {
+                    const int t = reg / 2;
+                    chip.tone[t].period = ((chip.registers[t * 2 + 1] & 0x0F) << 8) | chip.registers[t * 2];
+                    break;
+                }
+                case Noise_Period:
+                    chip.noise_period = value & 0x1F;
+                    if (chip.noise_period == 0) chip.noise_period = 1;
+                    break;
+                case Mixer_Control:
+                    chip.mixer_control = value;
+                    break;
+                case Envelope_Period_Low:
+                    chip.envelope_period = (chip.envelope_period & 0xFF00) | value;
+                    break;
+                case Envelope_Period_High:
+                    chip.envelope_period = (chip.envelope_period & 0x00FF) | (value << 8);
+                    break;
+                case Envelope_Shape:
+                    chip.envelope_shape = value & 0x0F;
+                    chip.envelope_counter = 0;
+                    chip.envelope_hold = false;
+                    chip.envelope_attack = (chip.envelope_shape & 0x04) != 0;
+                    chip.envelope_output = chip.envelope_attack ? 0 : 15;
+                    break;
+                case Ampl_A: case Ampl_B: case Ampl_C:
+                    chip.tone[reg - Ampl_A].use_envelope = (value & 0x10) != 0;
+                    chip.tone[reg - Ampl_A].level = value & 0x0F;
+                    break;
+            }
+        }
+
+        void runTick() {
+            while (!pending.empty() && pending.front().cycle <= tick * 16) {
+                const RegisterEvent &e = pending.front();
+                write(chips[e.chip_index], e.register_num, e.value);
+                pending.pop_front();
+            }
+            for (int c = 0; c < 2; c++) {
+                Chip &chip = chips[c];
+                for (Tone &t : chip.tone) {
+                    if (t.period == 0) continue;
+                    if (t.counter > 0) {
+                        t.counter--;
+                        if (t.counter == t.period / 2) t.output = !t.output;
+                    } else {
+                        t.counter = t.period;
+                        t.output = !t.output;
+                    }
+                }
+                if (--chip.noise_counter == 0) {
+                    chip.noise_counter = chip.noise_period;
+                    const uint32_t bit = (chip.noise_rng ^ (chip.noise_rng >> 3)) & 1;
+                    chip.noise_rng = (chip.noise_rng >> 1) | (bit << 16);
+                    chip.noise_output = (chip.noise_rng & 1) != 0;
+                }
+                if ((tick % 16) == 0 && chip.envelope_period > 0) {
+                    if (++chip.envelope_counter >= chip.envelope_period / 16) {
+                        chip.envelope_counter = 0;
+                        stepEnvelope(chip);
+                    }
+                }
+                mix_level[c] = mixLevel(chip);
+            }
+            tick++;
+        }
+
+        static void stepEnvelope(Chip &chip) {
+            const bool hold = chip.envelope_shape & 0x01;
+            const bool alternate = chip.envelope_shape & 0x02;
+            const bool attack = chip.envelope_shape & 0x04;
+            const bool cont = chip.envelope_shape & 0x08;
+            if (chip.envelope_hold) return;
+
+            const bool at_end = chip.envelope_attack ? chip.envelope_output == 15 : chip.envelope_output == 0;
+            if (!at_end) {
+                chip.envelope_output += chip.envelope_attack ? 1 : -1;
+            } else if (cont && hold) {
+                chip.envelope_output = (attack != alternate) ? 15 : 0;
+                chip.envelope_hold = true;
+            } else if (hold) {
+                chip.envelope_hold = true;
+            } else if (!cont) {
+                chip.envelope_output = 0;
+                chip.envelope_hold = true;
+            } else if (alternate) {
+                chip.envelope_attack = !chip.envelope_attack;
+            } else {
+                chip.envelope_output = attack ? 0 : 15;
+            }
+        }
+
+        static int32_t mixLevel(const Chip &chip) {
+            int32_t output = 0;
+            for (int i = 0; i < 3; i++) {
+                const Tone &t = chip.tone[i];
+                const bool tone_on = !(chip.mixer_control & (1 << i)) && t.period > 0 && chip.registers[Ampl_A + i] > 0;
+                const bool noise_on = !(chip.mixer_control & (1 << (i + 3)));
+                const int32_t level = ay_levels[t.use_envelope ? chip.envelope_output : t.level];
+                if (tone_on && t.output) output += level;
+                if (noise_on && chip.noise_output) output += level;
+            }
+            return output;
+        }
+};
+
+/* A register value worth writing: short periods keep the generators busy. */
+uint8_t random_value(std::mt19937 &rng, uint8_t reg) {
+    switch (reg) {
+        case A_Tone_Low: case B_Tone_Low: case C_Tone_Low:
+            return (rng() % 3) ? rng() % 24 : rng();
+        case A_Tone_High: case B_Tone_High: case C_Tone_High:
+            return (rng() % 4) ? 0 : rng() % 16;
+        case Envelope_Period_Low:
+            return (rng() % 2) ? rng() % 64 : rng();
+        case Envelope_Period_High:
+            return (rng() % 3) ? 0 : rng() % 8;
+        case Mixer_Control:
+            return rng() & 0x3F;
+        default:
+            return rng();
+    }
+}
+
+bool run_once(uint32_t output_rate, uint32_t seed, int frames, long &samples) {
+    std::mt19937 rng(seed);
+    NClock clock;
+    std::vector<float> buffer;
+    AY8910s ay(&buffer, nullptr, &clock, nullptr, output_rate);
+    ay.reset();
+    const uint64_t bus_rate = clock.get_vid_cycles_per_second();
+    TickAY ref(bus_rate, output_rate);
+
+    auto bus = [&](uint8_t c, uint8_t pa, uint8_t pb, uint64_t cycle) {
+        ay.busCycle(c, pa, pb, cycle);
+        ref.busCycle(c, pa, pb, cycle);
+    };
+
+    std::vector<float> out;
+    uint64_t sample = 0;
+    for (int f = 0; f < frames; f++) {
+        const int n = (int)(output_rate / 60) + (int)(rng() % 3);
+        const uint64_t first = sample * bus_rate / output_rate;
+        const uint64_t span = (sample + n) * bus_rate / output_rate - first;
+
+        // Writes at rising bus cycles within the frame; some land together.
+        std::vector<uint64_t> at(rng() % 24);
+        for (uint64_t &a : at) a = first + rng() % span;
+        std::sort(at.begin(), at.end());
+        for (uint64_t a : at) {
+            const uint8_t c = rng() & 1;
+            if (rng() % 200 == 0) {
+                bus(c, 0, 0b000, a);
+                continue;
+            }
+            const uint8_t reg = rng() % 14;
+            bus(c, reg, 0b111, a);
+            bus(c, random_value(rng, reg), 0b110, a);
+        }
+
+        buffer.clear();
+        out.clear();
+        ay.generateSamples(n);
+        ref.generateSamples(n, out);
+        if (buffer != out) {
+            size_t i = 0;
+            while (i < out.size() && buffer[i] == out[i]) i++;
+            printf("  %u Hz seed %08x frame %d: sample %zu is %.9f, expected %.9f\n", output_rate, seed, f,
+                i / 2, (double)buffer[i], (double)out[i]);
+            return false;
+        }
+        sample += n;
+    }
+    samples += (long)sample;
+    return true;
+}
+
+bool run_check() {
+    const int RUNS = 24;
+    const int FRAMES = 300;
+    long samples = 0;
+    bool ok = true;
+    for (int r = 0; r < RUNS && ok; r++) {
+        ok = run_once((r & 1) ? 48000 : OUTPUT_SAMPLE_RATE_INT, 0xA78910 + r, FRAMES, samples);
+    }
+    printf("ay8910 skip vs tick-by-tick: %ld samples: %s\n", samples, ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            return run_check() ? 0 : 1;
+        }
+    }
+    printf("usage: aytest --check\n");
+    return 1;
+}
@@ -0,0 +1,154 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * basictest --check
+ *
+ * Checks the host-side Applesoft tokenizer. Each line is tokenized with and
+ * without lowercase folding and compared to the bytes the ROM's PARSE leaves in
+ * the input buffer (II+ ROM, and enhanced IIe ROM). Then a listing is tokenized
+ * and its line links, ordering, replacement and deletion are checked, and a
+ * 2,000-line listing is timed.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "util/Applesoft.hpp"
+
+namespace {
+
+struct parse_case {
+    const char *text;
+    const char *plus;       // hex, II+ ROM
+    const char *folded;     // hex, enhanced IIe ROM
+};
+
+const parse_case parse_cases[] = {
+    { "PRINT \"HI\"",               "ba2248492200", "ba2248492200" },
+    { "FOR I=A TO B",               "8149d041c14200", "8149d041c14200" },
+    { "FORI=ATOB",                  "8149d041c14200", "8149d041c14200" },
+    { "X=ATN(1)",                   "58d0e128312900", "58d0e128312900" },
+    { "HTAB 5:VTAB 3",              "96353aa23300", "96353aa23300" },
+    { "? \"a b\" ; X",              "ba22612062223b5800", "ba22612062223b5800" },
+    { "DATA a b, \"c:d\" ,e: PRINT", "83206120622c2022633a6422202c653aba00", "83206120622c2022633a6422202c653aba00" },
+    { "REM hello: PRINT \"x\"",     "b22068656c6c6f3a205052494e542022782200", "b22068656c6c6f3a205052494e542022782200" },
+    { "P R I N T 1",                "ba3100", "ba3100" },
+    { "HGR2",                       "9000", "9000" },
+    { "HGR",                        "9100", "9100" },
+    { "DRAW 1 AT 2,3",              "9431c5322c3300", "9431c5322c3300" },
+    { "A T N",                      "c54e00", "c54e00" },
+    { "X = AT N",                   "58d0c54e00", "58d0c54e00" },
+    { "IF X THEN 10",               "ad58c4313000", "ad58c4313000" },
+    { "print chr$(65)",             "7072696e74636872242836352900", "bae72836352900" },
+    { "~",                          "7e00", "cc00" },
+    { "GOTO10",                     "ab313000", "ab313000" },
+    { "data x:rem y",               "64617461783a72656d7900", "8320783ab2207900" },
+};
+
+std::string to_hex(const std::vector<uint8_t> &v) {
+    std::string s;
+    char buf[3];
+    for (uint8_t b : v) {
+        snprintf(buf, sizeof(buf), "%02x", b);
+        s += buf;
+    }
+    return s;
+}
+
+bool check_lines() {
+    int failures = 0;
+    for (const parse_case &pc : parse_cases) {
+        for (int fold = 0; fold < 2; fold++) {
+            std::vector<uint8_t> out;
+            applesoft_tokenize_line(pc.text, fold != 0, out);
+            std::string got = to_hex(out);
+            const char *want = fold ? pc.folded : pc.plus;
+            if (got != want) {
+                printf("FAIL: \"%s\" fold=%d: got %s, want %s\n", pc.text, fold, got.c_str(), want);
+                failures++;
+            }
+        }
+    }
+    printf("parse: %zu lines, %d failed\n", sizeof(parse_cases) / sizeof(parse_cases[0]) * 2, failures);
+    return failures == 0;
+}
+
+bool check_listing() {
+    int failures = 0;
+    auto expect = [&](bool ok, const char *what) {
+        if (!ok) {
+            printf("FAIL: %s\n", what);
+            failures++;
+        }
+    };
+
+    // Out of order, CRLF and bare CR, a replaced line, a deleted line, a blank line.
+    const std::string listing = "20 GOTO 10\r\n10 PRINT \"HI\"\r15 END\n\n30 STOP\n1 0 PRINT \"HO\"\n30\n";
+    std::vector<uint8_t> image;
+    uint32_t lines = 0;
+    std::string err;
+    expect(applesoft_tokenize_listing(listing, 0x801, false, image, lines, err), "listing accepted");
+    expect(lines == 3, "3 lines");
+    const std::vector<uint8_t> want = {
+        0x0B, 0x08, 10, 0, 0xBA, '"', 'H', 'O', '"', 0,
+        0x11, 0x08, 15, 0, 0x80, 0,
+        0x19, 0x08, 20, 0, 0xAB, '1', '0', 0,
+        0, 0,
+    };
+    expect(image == want, "linked image");
+    if (image != want) printf("  got %s\n", to_hex(image).c_str());
+
+    expect(!applesoft_tokenize_listing("10 PRINT\nPRINT\n", 0x801, false, image, lines, err) &&
+           err == "line 2: no line number", "missing line number rejected");
+    expect(!applesoft_tokenize_listing("64000 END\n", 0x801, false, image, lines, err), "line 64000 rejected");
+    expect(!applesoft_tokenize_listing("10 REM " + std::string(240, 'X') + "\n", 0x801, false, image, lines, err),
+           "long line rejected");
+    expect(applesoft_tokenize_listing("", 0x801, false, image, lines, err) && lines == 0 &&
+           image == std::vector<uint8_t>{0, 0}, "empty listing");
+
+    // Timing: a 2,000 line program.
+    std::string big;
+    for (int n = 1; n <= 2000; n++) {
+        big += std::to_string(n * 10) + " FOR I = 1 TO 10: PRINT \"LINE\"; I; TAB( 20); CHR$ (65 + I): NEXT I\n";
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = applesoft_tokenize_listing(big, 0x801, true, image, lines, err);
+    auto t1 = std::chrono::steady_clock::now();
+    expect(ok && lines == 2000, "2000-line listing");
+    printf("listing: %d failed; 2000 lines (%zu bytes) in %.2f ms\n", failures, image.size(),
+        std::chrono::duration<double, std::milli>(t1 - t0).count());
+    return failures == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            bool ok = check_lines();
+            ok = check_listing() && ok;
+            return ok ? 0 : 1;
+        }
+    }
+    printf("usage: basictest --check\n");
+    return 1;
+}
@@ -0,0 +1,525 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * breakpointtest --check-exec
+ *
+ * Drives BreakpointTable with a random mix of EXEC breakpoint adds (plain,
+ * temporary, with ignore counts, bank-masked), clears, enables / disables
+ * and check_pre calls, and compares every result and hit count with a
+ * plain linear scan of the same entries: the per-bank bitmap must never
+ * hide a hit or invent one.
+ *
+ * breakpointtest --check-watch
+ *
+ * The same for DATA breakpoints trapped in the MMU page table: random
+ * watches over RAM and an I/O page, reads and writes (armed and not),
+ * debugger peeks and remaps of watched pages. Every access must reach the
+ * memory or handler it would without the trap, exactly once, and the hits
+ * must be the ones a scan of the table would report.
+ *
+ * breakpointtest --check-dma
+ *
+ * Block device DMA (write_block / read_block, as pdblock2 and pdblock3 do
+ * it) over watched pages, on a plain MMU and on MMU_IIgs in its fast-map
+ * banks $00/$01/$E0/$E1 and a 64K-page bank: the watch must fire on the
+ * first watched byte with that byte's value, the data must land as it
+ * would unwatched, and DMA that misses the watch must not fire it.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "cpu.hpp"
+#include "NClock.hpp"
+#include "debugger/BreakpointTable.hpp"
+#include "mmus/mmu.hpp"
+#include "mmus/mmu_iie.hpp"
+#include "mmus/mmu_iigs.hpp"
+
+uint64_t debug_level = 0;
+
+namespace {
+
+/** The EXEC check as it was before the index: every entry, in order. */
+struct ReferenceTable {
+    std::vector<bp_entry_t> entries;
+
+    bp_entry_t *find(uint32_t id) {
+        for (bp_entry_t &e : entries) {
+            if (e.id == id) return &e;
+        }
+        return nullptr;
+    }
+    void clear_id(uint32_t id) {
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->id == id) {
+                entries.erase(it);
+                return;
+            }
+        }
+    }
+    uint32_t check(uint32_t pc) {
+        for (bp_entry_t &e : entries) {
+            if ((e.flags & BP_FLAG_ENABLED) == 0 || e.kind != BP_KIND_EXEC) continue;
+            uint32_t a = pc & e.addr_mask;
+            uint32_t base = e.address & e.addr_mask;
+            if (a < base || a >= base + e.length) continue;
+            e.hit_count++;
+            if (e.ignore_count > 0) {
+                e.ignore_count--;
+                continue;
+            }
+            uint32_t id = e.id;
+            if (e.flags & BP_FLAG_TEMPORARY) clear_id(id);
+            return id;
+        }
+        return 0;
+    }
+};
+
+const uint32_t BANKS[] = {0x00, 0x01, 0x02, 0xE0, 0xE1, 0xFF};
+
+bool run_check_exec() {
+    std::mt19937 rng(0x0B5E55ED);
+    auto below = [&rng](uint32_t n) { return (uint32_t)(rng() % n); };
+
+    BreakpointTable table;
+    ReferenceTable ref;
+    cpu_state cpu(PROCESSOR_65816);
+    uint64_t checks = 0, hits = 0;
+    const int OPS = 300000;
+
+    for (int op = 0; op < OPS; op++) {
+        uint32_t r = below(100);
+        if (r < 4 && ref.entries.size() < 48) {
+            bp_entry_t e;
+            e.kind = BP_KIND_EXEC;
+            e.flags = BP_FLAG_ENABLED;
+            if (below(5) == 0) e.flags |= BP_FLAG_TEMPORARY;
+            e.address = (BANKS[below(6)] << 16) | below(0x10000);
+            e.length = (below(4) == 0) ? 1 + below(300) : 1;
+            if (e.address + e.length > 0x1000000) e.length = 0x1000000 - e.address;
+            if (below(20) == 0) e.addr_mask = 0xFFFF;     // any bank: not indexable
+            e.ignore_count = (below(4) == 0) ? below(3) : 0;
+            const char *err = nullptr;
+            e.id = table.add(e, &err);
+            if (e.id == 0) {
+                printf("add failed: %s\n", err ? err : "?");
+                return false;
+            }
+            ref.entries.push_back(e);
+        } else if (r < 7 && !ref.entries.empty()) {
+            uint32_t id = ref.entries[below(ref.entries.size())].id;
+            table.clear_id(id);
+            ref.clear_id(id);
+        } else if (r < 10 && !ref.entries.empty()) {
+            bp_entry_t &e = ref.entries[below(ref.entries.size())];
+            bool enable = (e.flags & BP_FLAG_ENABLED) == 0;
+            table.set_enabled(e.id, enable);
+            e.flags = enable ? (e.flags | BP_FLAG_ENABLED) : (e.flags & ~BP_FLAG_ENABLED);
+        } else {
+            // mostly at or just around a breakpoint, sometimes anywhere
+            uint32_t pc;
+            if (!ref.entries.empty() && below(10) < 7) {
+                const bp_entry_t &e = ref.entries[below(ref.entries.size())];
+                pc = (e.address + e.length + 2 - below(e.length + 4)) & 0xFFFFFF;
+                if (below(4) == 0) pc = (BANKS[below(6)] << 16) | (pc & 0xFFFF);
+            } else {
+                pc = (BANKS[below(6)] << 16) | below(0x10000);
+            }
+            cpu.full_pc = pc;
+            std::optional<StopHit> hit = table.check_pre(&cpu);
+            uint32_t want = ref.check(pc);
+            uint32_t got = hit ? hit->bp_id : 0;
+            checks++;
+            if (got) hits++;
+            if (got != want || (hit && (hit->pc != pc || hit->reason != STOP_BP_EXEC))) {
+                printf("op %d: pc %06X hit id %u, expected %u\n", op, pc, got, want);
+                return false;
+            }
+        }
+
+        const std::vector<bp_entry_t> &entries = table.entries();
+        bool same = entries.size() == ref.entries.size();
+        for (size_t i = 0; same && i < entries.size(); i++) {
+            same = entries[i].id == ref.entries[i].id && entries[i].flags == ref.entries[i].flags
+                && entries[i].hit_count == ref.entries[i].hit_count
+                && entries[i].ignore_count == ref.entries[i].ignore_count;
+        }
+        if (!same) {
+            printf("op %d: breakpoint table differs from the reference\n", op);
+            return false;
+        }
+    }
+    printf("exec index check: %d ops, %llu check_pre calls, %llu hits: PASS\n",
+        OPS, (unsigned long long)checks, (unsigned long long)hits);
+    return true;
+}
+
+/** What the table should report for one access through a trapped page. */
+uint32_t reference_watch_hit(ReferenceTable &ref, uint32_t address, bool is_write, uint8_t value) {
+    for (bp_entry_t &e : ref.entries) {
+        if ((e.flags & BP_FLAG_ENABLED) == 0 || e.kind != BP_KIND_DATA) continue;
+        uint32_t a = address & e.addr_mask;
+        uint32_t base = e.address & e.addr_mask;
+        if (a < base || a >= base + e.length) continue;
+        if (!(e.access & (is_write ? BP_ACCESS_W : BP_ACCESS_R))) continue;
+        if ((e.flags & BP_FLAG_DATA_MATCH) && ((value ^ e.data_value) & e.data_mask & 0xFF)) continue;
+        e.hit_count++;
+        if (e.ignore_count > 0) {
+            e.ignore_count--;
+            continue;
+        }
+        uint32_t id = e.id;
+        if (e.flags & BP_FLAG_TEMPORARY) ref.clear_id(id);
+        return id;
+    }
+    return 0;
+}
+
+struct io_page_t {
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    uint32_t last_address = 0;
+    uint8_t last_value = 0;
+};
+
+uint8_t io_read(void *context, uint32_t address) {
+    io_page_t *io = (io_page_t *)context;
+    io->reads++;
+    io->last_address = address;
+    return (uint8_t)(address ^ 0x5A);
+}
+
+void io_write(void *context, uint32_t address, uint8_t value) {
+    io_page_t *io = (io_page_t *)context;
+    io->writes++;
+    io->last_address = address;
+    io->last_value = value;
+}
+
+bool run_check_watch() {
+    std::mt19937 rng(0xDA7AB17E);
+    auto below = [&rng](uint32_t n) { return (uint32_t)(rng() % n); };
+
+    // 24-bit space in 256-byte pages: RAM in banks $00-$02, an I/O page at $00C0,
+    // and a spare RAM page that watched pages get remapped onto and back.
+    const uint32_t RAM_BANKS = 3;
+    const uint32_t IO_PAGE = 0xC0;
+    MMU mmu(0x10000, 256);
+    std::vector<uint8_t> ram(RAM_BANKS * 0x10000), spare(0x100);
+    for (size_t i = 0; i < ram.size(); i++) ram[i] = (uint8_t)rng();
+    for (size_t i = 0; i < spare.size(); i++) spare[i] = (uint8_t)rng();
+    std::vector<uint8_t *> backing(RAM_BANKS * 0x100);
+    for (uint32_t page = 0; page < RAM_BANKS * 0x100; page++) {
+        backing[page] = &ram[page * 0x100];
+        mmu.map_page_both(page, backing[page], "RAM");
+    }
+    io_page_t io;
+    backing[IO_PAGE] = nullptr;
+    mmu.map_page_both(IO_PAGE, nullptr, "IO");
+    mmu.set_page_read_h(IO_PAGE, {io_read, &io}, "IO");
+    mmu.set_page_write_h(IO_PAGE, {io_write, &io}, "IO");
+    int32_t remapped = -1;
+
+    BreakpointTable table;
+    ReferenceTable ref;
+    cpu_state cpu(PROCESSOR_65816);
+    table.attach_mmu(&mmu, &cpu, nullptr);
+    uint64_t accesses = 0, hits = 0;
+    const int OPS = 300000;
+
+    for (int op = 0; op < OPS; op++) {
+        uint32_t r = below(100);
+        if (r < 3 && ref.entries.size() < 24) {
+            bp_entry_t e;
+            e.kind = BP_KIND_DATA;
+            e.flags = BP_FLAG_ENABLED;
+            if (below(5) == 0) e.flags |= BP_FLAG_TEMPORARY;
+            e.access = 1 + below(3);
+            e.address = (below(RAM_BANKS) << 16) | below(0x10000);
+            if (below(6) == 0) e.address = (IO_PAGE << 8) | below(0x100);
+            e.length = (below(3) == 0) ? 1 + below(700) : 1 + below(4);
+            if (below(4) == 0) {
+                e.flags |= BP_FLAG_DATA_MATCH;
+                e.data_value = below(256);
+                e.data_mask = (below(2) == 0) ? 0xFF : 0xF0;
+            }
+            e.ignore_count = (below(4) == 0) ? below(3) : 0;
+            const char *err = nullptr;
+            e.id = table.add(e, &err);
+            if (e.id == 0) {
+                printf("add failed: %s\n", err ? err : "?");
+                return false;
+            }
+            ref.entries.push_back(e);
+        } else if (r < 5 && !ref.entries.empty()) {
+            uint32_t id = ref.entries[below(ref.entries.size())].id;
+            table.clear_id(id);
+            ref.clear_id(id);
+        } else if (r < 7 && !ref.entries.empty()) {
+            bp_entry_t &e = ref.entries[below(ref.entries.size())];
+            bool enable = (e.flags & BP_FLAG_ENABLED) == 0;
+            table.set_enabled(e.id, enable);
+            e.flags = enable ? (e.flags | BP_FLAG_ENABLED) : (e.flags & ~BP_FLAG_ENABLED);
+        } else if (r < 8) {
+            // bank switch a page that may be watched; the trap must follow the new mapping
+            if (remapped >= 0) {
+                backing[remapped] = &ram[remapped * 0x100];
+                mmu.map_page_both(remapped, backing[remapped], "RAM");
+                remapped = -1;
+            } else {
+                remapped = (int32_t)below(RAM_BANKS * 0x100);
+                if (remapped == (int32_t)IO_PAGE) remapped++;
+                if (!ref.entries.empty() && below(2) == 0) {
+                    remapped = (int32_t)((ref.entries[below(ref.entries.size())].address >> 8) & 0xFFFF);
+                    if (remapped == (int32_t)IO_PAGE) remapped++;
+                }
+                backing[remapped] = spare.data();
+                mmu.map_page_both(remapped, backing[remapped], "ALT");
+            }
+        } else {
+            uint32_t address;
+            if (!ref.entries.empty() && below(10) < 7) {
+                const bp_entry_t &e = ref.entries[below(ref.entries.size())];
+                address = e.address + e.length + 2 - below(e.length + 4);
+            } else {
+                address = (below(RAM_BANKS) << 16) | below(0x10000);
+            }
+            address &= RAM_BANKS * 0x10000 - 1;
+            if (address >= RAM_BANKS * 0x10000) address = below(0x10000);
+            const uint32_t page = address >> 8;
+            uint8_t *mem = backing[page];
+            const bool armed = below(10) != 0;
+            const uint32_t kind = below(3);     // read, write, debugger peek
+            cpu.full_pc = below(0x1000000);
+            table.set_watch_armed(armed);
+
+            uint8_t value;
+            const io_page_t before = io;
+            if (kind == 0) {
+                value = mmu.read(address);
+                uint8_t want = mem ? mem[address & 0xFF] : (uint8_t)(address ^ 0x5A);
+                if (value != want || (!mem && io.reads != before.reads + 1)) {
+                    printf("op %d: read %06X gave %02X, expected %02X\n", op, address, value, want);
+                    return false;
+                }
+            } else if (kind == 1) {
+                value = (uint8_t)rng();
+                mmu.write(address, value);
+                bool landed = mem ? mem[address & 0xFF] == value
+                                  : (io.writes == before.writes + 1 && io.last_value == value && io.last_address == address);
+                if (!landed) {
+                    printf("op %d: write %02X to %06X didn't land exactly once\n", op, value, address);
+                    return false;
+                }
+            } else {
+                value = mmu.read_raw(address);
+                if (mem && value != mem[address & 0xFF]) {
+                    printf("op %d: peek %06X gave %02X, expected %02X\n", op, address, value, mem[address & 0xFF]);
+                    return false;
+                }
+                if (io.reads != before.reads || io.writes != before.writes) {
+                    printf("op %d: peek %06X reached the I/O handler\n", op, address);
+                    return false;
+                }
+            }
+            table.set_watch_armed(false);
+            accesses++;
+
+            uint32_t want = (armed && kind != 2) ? reference_watch_hit(ref, address, kind == 1, value) : 0;
+            std::optional<StopHit> hit = table.take_watch_hit();
+            uint32_t got = hit ? hit->bp_id : 0;
+            if (got) hits++;
+            if (got != want) {
+                printf("op %d: %s %06X = %02X%s hit id %u, expected %u\n", op, kind == 0 ? "read" : kind == 1 ? "write" : "peek",
+                       address, value, armed ? "" : " (disarmed)", got, want);
+                return false;
+            }
+            if (hit && (hit->reason != STOP_BP_DATA || hit->eaddr != address || hit->value != value
+                        || hit->pc != cpu.full_pc || hit->access != (kind == 1 ? BP_ACCESS_W : BP_ACCESS_R))) {
+                printf("op %d: hit %u at %06X has the wrong details\n", op, got, address);
+                return false;
+            }
+        }
+
+        const std::vector<bp_entry_t> &entries = table.entries();
+        bool same = entries.size() == ref.entries.size();
+        for (size_t i = 0; same && i < entries.size(); i++) {
+            same = entries[i].id == ref.entries[i].id && entries[i].flags == ref.entries[i].flags
+                && entries[i].hit_count == ref.entries[i].hit_count
+                && entries[i].ignore_count == ref.entries[i].ignore_count;
+        }
+        if (!same) {
+            printf("op %d: breakpoint table differs from the reference\n", op);
+            return false;
+        }
+        bool trapped = false;
+        for (const bp_entry_t &e : ref.entries) trapped |= (e.flags & BP_FLAG_ENABLED) != 0;
+        if (table.has_watch_traps() != trapped || table.needs_instruction_checks()) {
+            printf("op %d: table reports the wrong kind of checks\n", op);
+            return false;
+        }
+    }
+
+    // with the table empty nothing is trapped: an armed pass over every watched byte is silent
+    table.clear_all();
+    table.set_watch_armed(true);
+    for (uint32_t a = 0; a < RAM_BANKS * 0x10000; a++) {
+        mmu.write(a, mmu.read(a));
+    }
+    table.set_watch_armed(false);
+    if (table.watch_hit_pending()) {
+        printf("watch reported after clear_all\n");
+        return false;
+    }
+
+    printf("watch trap check: %d ops, %llu accesses, %llu hits: PASS\n",
+        OPS, (unsigned long long)accesses, (unsigned long long)hits);
+    return true;
+}
+
+struct dma_case_t {
+    const char *what;
+    uint32_t watch;         // watched bytes [watch, watch + watch_len)
+    uint32_t watch_len;
+    uint8_t access;
+    uint32_t start;         // DMA span
+    uint32_t len;
+    bool is_write;
+    bool expect_hit;
+};
+
+// Runs each case on mmu with one DATA breakpoint; a hit must be on the first watched byte of the span.
+bool run_dma_cases(const char *name, MMU &mmu, const dma_case_t *cases, size_t count, std::mt19937 &rng) {
+    BreakpointTable table;
+    cpu_state cpu(PROCESSOR_65816);
+    table.attach_mmu(&mmu, &cpu, nullptr);
+
+    for (size_t c = 0; c < count; c++) {
+        const dma_case_t &k = cases[c];
+        table.clear_all();
+        bp_entry_t e;
+        e.kind = BP_KIND_DATA;
+        e.flags = BP_FLAG_ENABLED;
+        e.access = k.access;
+        e.address = k.watch;
+        e.length = k.watch_len;
+        const char *err = nullptr;
+        if (table.add(e, &err) == 0) {
+            printf("%s %s: add failed: %s\n", name, k.what, err ? err : "?");
+            return false;
+        }
+
+        std::vector<uint8_t> data(k.len), got(k.len);
+        for (uint8_t &b : data) b = (uint8_t)rng();
+        if (!k.is_write) {
+            mmu.write_block(k.start, data.data(), k.len);    // disarmed: not reported
+        }
+        table.set_watch_armed(true);
+        if (k.is_write) {
+            mmu.write_block(k.start, data.data(), k.len);
+        } else {
+            mmu.read_block(k.start, got.data(), k.len);
+        }
+        table.set_watch_armed(false);
+        std::optional<StopHit> hit = table.take_watch_hit();
+
+        if (k.is_write) mmu.read_block(k.start, got.data(), k.len);
+        if (got != data) {
+            printf("%s %s: DMA data didn't land as it would unwatched\n", name, k.what);
+            return false;
+        }
+        if (hit.has_value() != k.expect_hit) {
+            printf("%s %s: watch %s\n", name, k.what, hit ? "fired on a miss" : "missed the DMA");
+            return false;
+        }
+        if (hit) {
+            const uint32_t at = std::max(k.watch, k.start);
+            if (hit->eaddr != at || hit->value != data[at - k.start]
+                    || hit->access != (k.is_write ? BP_ACCESS_W : BP_ACCESS_R)) {
+                printf("%s %s: hit at %06X = %02X, expected %06X = %02X\n", name, k.what,
+                       hit->eaddr, hit->value, at, data[at - k.start]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool run_check_dma() {
+    std::mt19937 rng(0xD3A0B10C);
+
+    // The II / IIe MMU: 256-byte pages of plain RAM.
+    MMU plain(0x100, 256);
+    std::vector<uint8_t> ram(0x10000);
+    for (uint32_t page = 0; page < 0x100; page++) plain.map_page_both(page, &ram[page * 0x100], "RAM");
+    const dma_case_t plain_cases[] = {
+        { "write over a watched byte",  0x2345, 1,     BP_ACCESS_W,  0x2200, 0x200, true,  true  },
+        { "write across a page edge",   0x20FF, 2,     BP_ACCESS_RW, 0x2080, 0x100, true,  true  },
+        { "read over a watched range",  0x0800, 0x100, BP_ACCESS_R,  0x07F0, 0x40,  false, true  },
+        { "write missing the watch",    0x2345, 1,     BP_ACCESS_W,  0x3000, 0x200, true,  false },
+        { "read of a write watch",      0x2345, 1,     BP_ACCESS_W,  0x2300, 0x100, false, false },
+    };
+    if (!run_dma_cases("plain", plain, plain_cases, sizeof(plain_cases) / sizeof(plain_cases[0]), rng)) return false;
+
+    // The IIgs, as the CPU (and so pdblock2 / pdblock3) sees it. No ROM is read.
+    const uint32_t ROM_SIZE = 128 * 1024;
+    std::vector<uint8_t> rom(ROM_SIZE);
+    NClockIIgs clock;
+    MMU_IIe megaii(256, 128 * 1024, rom.data() + ROM_SIZE - 65536 + 0xC000);
+    MMU_IIgs iigs(256, 4 * 1024 * 1024, ROM_SIZE, rom.data(), &megaii);
+    iigs.set_clock(&clock);
+    iigs.init_map();
+    const dma_case_t iigs_cases[] = {
+        { "bank $00 write",             0x002345, 1,     BP_ACCESS_W,  0x002200, 0x200, true,  true  },
+        { "bank $00 shadowed text page", 0x000480, 4,    BP_ACCESS_W,  0x000400, 0x200, true,  true  },
+        { "bank $01 read",              0x010400, 0x10,  BP_ACCESS_R,  0x010300, 0x200, false, true  },
+        { "bank $E1 write",             0xE12000, 0x10,  BP_ACCESS_W,  0xE11F00, 0x200, true,  true  },
+        { "bank $02 (64K page) write",  0x028000, 1,     BP_ACCESS_W,  0x027F00, 0x200, true,  true  },
+        { "bank $00 write missing it",  0x002345, 1,     BP_ACCESS_W,  0x003000, 0x200, true,  false },
+        { "same page, other bytes",     0x002345, 1,     BP_ACCESS_W,  0x002300, 0x40,  true,  false },
+    };
+    if (!run_dma_cases("IIgs", iigs, iigs_cases, sizeof(iigs_cases) / sizeof(iigs_cases[0]), rng)) return false;
+
+    printf("dma watch check: %zu cases: PASS\n",
+        sizeof(plain_cases) / sizeof(plain_cases[0]) + sizeof(iigs_cases) / sizeof(iigs_cases[0]));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check-exec") == 0) {
+            return run_check_exec() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--check-watch") == 0) {
+            return run_check_watch() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--check-dma") == 0) {
+            return run_check_dma() ? 0 : 1;
+        }
+    }
+    printf("usage: breakpointtest --check-exec | --check-watch | --check-dma\n");
+    return 1;
+}
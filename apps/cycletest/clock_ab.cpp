@@ -0,0 +1,311 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * cycletest --clock-ab
+ *
+ * A/B check of the NClockII / NClockIIgs tick() engines against the old
+ * per-cycle virtual slow_incr_cycles() implementation, kept here verbatim as
+ * the reference. Both clocks are driven with the same pseudo-random stream of
+ * cycle types and must agree on cycles, 14M, video cycles and the 14M stamp of
+ * every video_cycle() call. Then both are timed over the same stream.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+
+#include "NClock.hpp"
+#include "mmus/mmu_ii.hpp"
+#include "devices/displaypp/VideoScannerII.hpp"
+
+namespace {
+
+// Old II engine: virtual call per cycle, counters advanced every cycle.
+class NClockIIRef : public NClockII {
+public:
+    NClockIIRef(clock_set_t clock_set) : NClockII(clock_set) { engine = CLOCK_ENGINE_CUSTOM; }
+
+    void set_video_scanner(VideoScannerII *video_scanner) override { this->video_scanner = video_scanner; }
+
+    inline void slow_incr_cycles() override {
+        cycles++;
+        if (cpu_per_14m > 1) {
+            if (++cpu_div < cpu_per_14m) {
+                return;
+            }
+            cpu_div = 0;
+        }
+
+        c_14M += current.c_14M_per_cpu_cycle;
+
+        if (video_scanner) {
+            video_cycle_14M_count += current.c_14M_per_cpu_cycle;
+            scanline_14M_count += current.c_14M_per_cpu_cycle;
+
+            if (video_cycle_14M_count >= 14) {
+                video_cycle_14M_count -= 14;
+                video_scanner->video_cycle();
+                video_cycles++;
+
+                for (auto &cycle_handler : cycle_handlers) {
+                    cycle_handler();
+                }
+            }
+            if (scanline_14M_count >= 910) {  // end of scanline
+                c_14M += current.extra_per_scanline;
+                scanline_14M_count = 0;
+            }
+        }
+    }
+};
+
+// Old IIgs engine.
+class NClockIIgsRef : public NClockIIgs {
+protected:
+    uint64_t video_c14m = 0;
+
+public:
+    NClockIIgsRef(clock_set_t clock_set) : NClockIIgs(clock_set) { engine = CLOCK_ENGINE_CUSTOM; }
+
+    void set_video_scanner(VideoScannerII *video_scanner) override { this->video_scanner = video_scanner; }
+
+    inline void slow_incr_cycles() override {
+        cycles++;
+        if (slow_mode) cycle_type = CYCLE_TYPE_SYNC;
+        if (current.hz_rate == 1020484) cycle_type = CYCLE_TYPE_SYNC;
+
+        const bool sync_cycle = (cycle_type == CYCLE_TYPE_SYNC);
+        if (sync_cycle) {
+            cpu_div = 0;
+        } else if (cpu_per_14m > 1) {
+            if (++cpu_div < cpu_per_14m) {
+                cycle_type = CYCLE_TYPE_FAST;
+                return;
+            }
+            cpu_div = 0;
+        }
+
+        uint64_t c14m_this_cycle;
+        if (sync_cycle) {
+            c14m_this_cycle = 14;
+            if (video_cycle_14M_count) c14m_this_cycle += (14 - video_cycle_14M_count);
+            ram_refresh_cycles += c14m_this_cycle;
+            if (ram_refresh_cycles >= 50) {
+                ram_refresh_cycles -= 50;
+            }
+        } else if (cycle_type == CYCLE_TYPE_FAST_ROM) {
+            c14m_this_cycle = current.c_14M_per_cpu_cycle;
+            ram_refresh_cycles += c14m_this_cycle;
+            if (ram_refresh_cycles >= 50) {
+                ram_refresh_cycles -= 50;
+            }
+        } else {
+            c14m_this_cycle = current.c_14M_per_cpu_cycle;
+            ram_refresh_cycles += c14m_this_cycle;
+            if (ram_refresh_cycles >= 50) {
+                ram_refresh_cycles -= 50;
+                c14m_this_cycle += 5;
+            }
+        }
+        c_14M += c14m_this_cycle;
+
+        if (video_scanner) {
+            uint64_t delta = c_14M - video_c14m;
+            video_cycle_14M_count += delta;
+            video_c14m = c_14M;
+
+            while (video_cycle_14M_count >= 14) {
+                video_cycle_14M_count -= 14;
+                video_scanner->video_cycle();
+                video_cycles++;
+
+                for (auto &cycle_handler : cycle_handlers) {
+                    cycle_handler();
+                }
+
+                vidlinecycles++;
+            }
+            if (vidlinecycles >= 65) {
+                vidlinecycles -= 65;
+                c_14M += current.extra_per_scanline;
+                video_c14m += current.extra_per_scanline;
+            }
+        }
+        cycle_type = CYCLE_TYPE_FAST;
+    }
+};
+
+// Records when the clock asked for each video cycle instead of scanning RAM.
+// One-cycle segments, so catch-up runs on the tick that owes the cycle.
+class ProbeScanner : public VideoScannerII {
+protected:
+    uint32_t segment_length() override { return 1; }
+
+    void scan_cycles(uint32_t count) override {
+        for (uint32_t i = 0; i < count; i++) {
+            calls++;
+            hash = (hash ^ clock->get_c14m()) * 0x100000001b3ULL;
+        }
+    }
+
+public:
+    NClock *clock = nullptr;
+    uint64_t calls = 0;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    ProbeScanner(MMU_II *mmu, NClock *clock) : VideoScannerII(mmu), clock(clock) {}
+};
+
+struct xorshift {
+    uint64_t s;
+    inline uint64_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+};
+
+struct ab_case {
+    const char *name;
+    bool iigs;
+    clock_mode_t mode;
+    uint32_t cpu_per_14m;
+};
+
+const ab_case ab_cases[] = {
+    { "II   1.0205 MHz", false, CLOCK_1_024MHZ, 1 },
+    { "II   2.8 MHz",    false, CLOCK_2_8MHZ,   1 },
+    { "II   7.1 MHz",    false, CLOCK_7_159MHZ, 1 },
+    { "II   14.3 MHz",   false, CLOCK_14_3MHZ,  1 },
+    { "II   Ludicrous",  false, CLOCK_FREE_RUN, 5 },
+    { "IIgs 1.0205 MHz", true,  CLOCK_1_024MHZ, 1 },
+    { "IIgs 2.8 MHz",    true,  CLOCK_2_8MHZ,   1 },
+    { "IIgs 7.1 MHz",    true,  CLOCK_7_159MHZ, 1 },
+    { "IIgs Ludicrous",  true,  CLOCK_FREE_RUN, 7 },
+};
+
+constexpr uint64_t AB_CYCLES = 2'000'000;
+
+// IIgs: mostly fast RAM cycles with some ROM and 1 MHz sync cycles, like the MMU produces.
+inline void set_cycle_type(NClock *clock, uint64_t r) {
+    uint64_t pick = r % 100;
+    cycle_type_t t = (pick < 75) ? CYCLE_TYPE_FAST : (pick < 90) ? CYCLE_TYPE_FAST_ROM : CYCLE_TYPE_SYNC;
+    ((NClockIIgs *)clock)->set_next_cycle_type(t);
+}
+
+NClockII *make_clock(const ab_case &c, bool reference) {
+    NClockII *clock;
+    if (c.iigs) {
+        clock = reference ? (NClockII *)new NClockIIgsRef(CLOCK_SET_US) : new NClockIIgs(CLOCK_SET_US);
+    } else {
+        clock = reference ? (NClockII *)new NClockIIRef(CLOCK_SET_US) : new NClockII(CLOCK_SET_US);
+    }
+    clock->set_clock_mode(c.mode);
+    if (c.mode == CLOCK_FREE_RUN) {
+        clock->set_cpu_per_14m(c.cpu_per_14m);
+    }
+    return clock;
+}
+
+bool run_case(const ab_case &c, MMU_II *mmu) {
+    NClockII *ref = make_clock(c, true);
+    NClockII *dut = make_clock(c, false);
+    ProbeScanner ref_scan(mmu, ref);
+    ProbeScanner dut_scan(mmu, dut);
+    uint64_t ref_handler = 0, dut_handler = 0;
+    ref->set_cycle_handler([&ref_handler]() { ref_handler++; });
+    dut->set_cycle_handler([&dut_handler]() { dut_handler++; });
+    ref->set_video_scanner(&ref_scan);
+    dut->set_video_scanner(&dut_scan);
+
+    xorshift rng{0x9E3779B97F4A7C15ULL};
+    bool ok = true;
+    for (uint64_t i = 0; i < AB_CYCLES; i++) {
+        uint64_t r = rng.next();
+        if (c.iigs) {
+            // toggle slow mode now and then, as the speed register would.
+            if ((r & 0xFFFF) == 0) {
+                bool slow = !((NClockIIgs *)ref)->get_slow_mode();
+                ref->set_slow_mode(slow);
+                dut->set_slow_mode(slow);
+            }
+            set_cycle_type(ref, r >> 16);
+            set_cycle_type(dut, r >> 16);
+        }
+        ref->incr_cycles();
+        dut->incr_cycles();
+        if (ref->get_c14m() != dut->get_c14m() || ref->get_vid_cycles() != dut->get_vid_cycles()) {
+            printf("  %s: mismatch at cycle %llu: c14m %llu/%llu vid %llu/%llu\n", c.name,
+                   (unsigned long long)i,
+                   (unsigned long long)ref->get_c14m(), (unsigned long long)dut->get_c14m(),
+                   (unsigned long long)ref->get_vid_cycles(), (unsigned long long)dut->get_vid_cycles());
+            ok = false;
+            break;
+        }
+    }
+    ok = ok && ref->get_cycles() == dut->get_cycles()
+            && ref->get_video_cycle_14M_count() == dut->get_video_cycle_14M_count()
+            && ref->get_scanline_14M_count() == dut->get_scanline_14M_count()
+            && ref_scan.calls == dut_scan.calls && ref_scan.hash == dut_scan.hash
+            && ref_handler == dut_handler;
+
+    printf("%-16s %s  cycles %llu  14M %llu  vid %llu\n", c.name, ok ? "identical" : "DIFFERENT",
+           (unsigned long long)dut->get_cycles(), (unsigned long long)dut->get_c14m(),
+           (unsigned long long)dut->get_vid_cycles());
+    delete ref;
+    delete dut;
+    return ok;
+}
+
+double time_case(const ab_case &c, MMU_II *mmu, bool reference) {
+    NClockII *clock = make_clock(c, reference);
+    ProbeScanner scan(mmu, clock);
+    uint64_t handler = 0;
+    clock->set_cycle_handler([&handler]() { handler++; });
+    clock->set_video_scanner(&scan);
+
+    xorshift rng{0x9E3779B97F4A7C15ULL};
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < AB_CYCLES; i++) {
+        if (c.iigs) set_cycle_type(clock, rng.next());
+        clock->incr_cycles();
+    }
+    auto end = std::chrono::steady_clock::now();
+    delete clock;
+    return std::chrono::duration<double, std::nano>(end - start).count() / AB_CYCLES;
+}
+
+} // namespace
+
+int run_clock_ab() {
+    static uint8_t rom[12 * 1024] = {};
+    MMU_II *mmu = new MMU_II(256, 48 * 1024, rom);
+
+    printf("Clock A/B: %llu cycles per case\n", (unsigned long long)AB_CYCLES);
+    int failed = 0;
+    for (const ab_case &c : ab_cases) {
+        if (!run_case(c, mmu)) failed++;
+    }
+
+    printf("\n%-16s %10s %10s\n", "", "old ns/cy", "new ns/cy");
+    for (const ab_case &c : ab_cases) {
+        double old_ns = time_case(c, mmu, true);
+        double new_ns = time_case(c, mmu, false);
+        printf("%-16s %10.2f %10.2f  (%.2fx)\n", c.name, old_ns, new_ns, new_ns > 0 ? old_ns / new_ns : 0.0);
+    }
+
+    printf("Failed cases: %d\n", failed);
+    delete mmu;
+    return failed ? 1 : 0;
+}
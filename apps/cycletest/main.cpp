@@ -1285,6 +1285,9 @@ bool test_instruction(std::unique_ptr<BaseCPU> &cpux, cpu_state *cpu, test_recor
     return true;
 }
 
+int run_clock_ab(); // clock_ab.cpp
+int run_scan_ab();  // scan_ab.cpp
+
 /**
  * ------------------------------------------------------------------------------------
  * Main
@@ -1296,7 +1299,11 @@ int main(int argc, char **argv) {
 
 
     for (int i = 1; i < argc; i++) {
-        if (strcmp(argv[i], "trace") == 0) {
+        if (strcmp(argv[i], "--clock-ab") == 0) {
+            return run_clock_ab();
+        } else if (strcmp(argv[i], "--scan-ab") == 0) {
+            return run_scan_ab();
+        } else if (strcmp(argv[i], "trace") == 0) {
             trace_on = true;
         } else if (strcmp(argv[i], "6502") == 0) {
             cputype = PROCESSOR_6502;
@@ -1305,7 +1312,7 @@ int main(int argc, char **argv) {
         } else if (strcmp(argv[i], "65816") == 0) {
             cputype = PROCESSOR_65816;
         } else {
-            printf("usage: cputest [trace] [6502|65c02] [test6502|test65c02|testdecimal]\n");
+            printf("usage: cputest [trace] [6502|65c02] [test6502|test65c02|testdecimal] | --clock-ab | --scan-ab\n");
         }
     }
 
@@ -0,0 +1,269 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * cycletest --scan-ab
+ *
+ * A/B check of catch-up video scanning. One scanner is stepped with
+ * video_cycle() every video cycle (the old lockstep behaviour), the other only
+ * has cycles owed with owe_cycle() and scans them in batches. Both see the same
+ * random stream of video memory writes (main and aux), softswitch changes,
+ * floating bus reads and counter reads, and must produce the same ScanBuffer,
+ * floating bus values, counters and IIgs IRQ timing. Then both are timed.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include "mmus/mmu_ii.hpp"
+#include "devices/displaypp/VideoScannerII.hpp"
+#include "devices/displaypp/VideoScannerIIe.hpp"
+#include "devices/displaypp/VideoScannerIIePAL.hpp"
+#include "devices/displaypp/VideoScannerIIgs.hpp"
+
+namespace {
+
+enum scan_kind_t { SCAN_II, SCAN_IIE, SCAN_IIE_PAL, SCAN_IIGS };
+
+struct scan_case {
+    const char *name;
+    scan_kind_t kind;
+};
+
+const scan_case scan_cases[] = {
+    { "II",       SCAN_II },
+    { "IIe",      SCAN_IIE },
+    { "IIe PAL",  SCAN_IIE_PAL },
+    { "IIgs",     SCAN_IIGS },
+};
+
+constexpr uint64_t SCAN_AB_CYCLES = 17030 * 6;
+
+struct xorshift {
+    uint64_t s;
+    inline uint64_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+};
+
+struct irq_log {
+    const uint64_t *cycle;
+    std::vector<uint64_t> events;
+};
+
+void log_irq(void *context, VideoScannerEvent event) {
+    irq_log *log = (irq_log *)context;
+    log->events.push_back((*log->cycle << 2) | (uint64_t)event);
+}
+
+struct rig {
+    uint8_t rom[12 * 1024] = {};
+    MMU_II *mmu;
+    VideoScannerII *scanner;
+    irq_log irqs;
+    uint64_t cycle = 0;
+
+    rig(scan_kind_t kind) {
+        mmu = new MMU_II(256, 128 * 1024, rom);
+        memset(mmu->get_memory_base(), 0, 128 * 1024);
+        switch (kind) {
+            case SCAN_II:      scanner = new VideoScannerII(mmu); break;
+            case SCAN_IIE:     scanner = new VideoScannerIIe(mmu); break;
+            case SCAN_IIE_PAL: scanner = new VideoScannerIIePAL(mmu); break;
+            case SCAN_IIGS:    scanner = new VideoScannerIIgs(mmu); break;
+        }
+        scanner->initialize();
+        irqs.cycle = &cycle;
+        scanner->set_irq_handler({log_irq, &irqs});
+    }
+
+    ~rig() {
+        delete scanner;
+        delete mmu;
+    }
+
+    // RAMWRT-style: point the CPU's writes at $0400-$BFFF to main or aux.
+    void map_writes(bool aux) {
+        uint8_t *base = mmu->get_memory_base() + (aux ? 0x10000 : 0);
+        for (page_t page = 0x04; page < 0xC0; page++) {
+            mmu->map_page_write(page, base + page * GS2_PAGE_SIZE, aux ? "AUX" : "MAIN");
+        }
+    }
+};
+
+inline bool same_scan(const Scan_t &a, const Scan_t &b) {
+    if (a.mode != b.mode) return false;
+    switch (a.mode) {
+        case VM_SHR:
+        case VM_SHR_PALETTE:
+            return a.shr_bytes == b.shr_bytes;
+        case VM_SHR_MODE:
+        case VM_BORDER_COLOR:
+        case VM_BLANK:
+        case VM_VSYNC:
+        case VM_HSYNC:
+            return a.mainbyte == b.mainbyte && a.flags == b.flags;
+        default:
+            return a.mainbyte == b.mainbyte && a.auxbyte == b.auxbyte && a.flags == b.flags && a.shr_bytes == b.shr_bytes;
+    }
+}
+
+// Compares and empties both ScanBuffers.
+bool drain_compare(rig &ref, rig &dut) {
+    ScanBuffer *a = ref.scanner->get_frame_scan();
+    ScanBuffer *b = dut.scanner->get_frame_scan();
+    if (a->get_count() != b->get_count()) {
+        printf("    scan count %u / %u\n", a->get_count(), b->get_count());
+        return false;
+    }
+    bool ok = true;
+    while (a->get_count()) {
+        Scan_t sa = a->pull();
+        Scan_t sb = b->pull();
+        if (ok && !same_scan(sa, sb)) {
+            printf("    scan %u: mode %d/%d main %02X/%02X aux %02X/%02X flags %02X/%02X shr %08X/%08X\n", a->get_count(), sa.mode, sb.mode, sa.mainbyte, sb.mainbyte, sa.auxbyte, sb.auxbyte, sa.flags, sb.flags, sa.shr_bytes, sb.shr_bytes);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void softswitch(VideoScannerII *s, uint64_t r, bool iigs) {
+    bool on = (r >> 8) & 1;
+    switch (r % (iigs ? 12 : 9)) {
+        case 0: on ? s->set_graf() : s->set_text(); break;
+        case 1: on ? s->set_mixed() : s->set_full(); break;
+        case 2: on ? s->set_page_2() : s->set_page_1(); break;
+        case 3: on ? s->set_hires() : s->set_lores(); break;
+        case 4: s->set_80store(on); break;
+        case 5: s->set_80col_f(on); break;
+        case 6: s->set_altchrset_f(on); break;
+        case 7: s->set_dblres_f(on); break;
+        case 8: s->set_text_fg((r >> 9) & 0x0F); break;
+        case 9: on ? s->set_shr() : s->reset_shr(); break;
+        case 10: s->set_border_color((r >> 9) & 0x0F); break;
+        case 11: s->set_text_bg((r >> 9) & 0x0F); break;
+    }
+}
+
+// Addresses the scanners fetch from: text/lores, hires, SHR (aux) and the II+ HBL area.
+inline uint16_t video_address(uint64_t r) {
+    switch (r % 4) {
+        case 0: return 0x0400 + (r >> 2) % 0x0800;
+        case 1: return 0x1000 + (r >> 2) % 0x1000;
+        case 2: return 0x2000 + (r >> 2) % 0x4000;
+        default: return 0x6000 + (r >> 2) % 0x4000;
+    }
+}
+
+bool run_case(const scan_case &c) {
+    rig ref(c.kind);
+    rig dut(c.kind);
+    const bool iigs = c.kind == SCAN_IIGS;
+
+    xorshift rng{0x2545F4914F6CDD1DULL};
+    bool ok = true;
+    uint64_t fb_reads = 0, writes = 0, switches = 0;
+    for (uint64_t i = 0; i < SCAN_AB_CYCLES && ok; i++) {
+        uint64_t r = rng.next();
+        uint32_t op = r & 0xFF;
+        r >>= 8;
+        if (op < 24) {
+            uint16_t addr = video_address(r);
+            uint8_t val = (uint8_t)(r >> 20);
+            ref.mmu->write(addr, val);
+            dut.mmu->write(addr, val);
+            writes++;
+        } else if (op < 28) {
+            softswitch(ref.scanner, r, iigs);
+            softswitch(dut.scanner, r, iigs);
+            switches++;
+        } else if (op < 30) {
+            ref.map_writes(r & 1);
+            dut.map_writes(r & 1);
+        } else if (op < 34) {
+            uint8_t a = ref.mmu->floating_bus_read();
+            uint8_t b = dut.mmu->floating_bus_read();
+            fb_reads++;
+            if (a != b) {
+                printf("    floating bus %02X / %02X at cycle %llu\n", a, b, (unsigned long long)i);
+                ok = false;
+            }
+        } else if (op < 35) {
+            if (ref.scanner->get_vcounter() != dut.scanner->get_vcounter() ||
+                ref.scanner->get_hcounter() != dut.scanner->get_hcounter() ||
+                ref.scanner->is_vbl() != dut.scanner->is_vbl()) {
+                printf("    counters differ at cycle %llu\n", (unsigned long long)i);
+                ok = false;
+            }
+        }
+
+        ref.cycle = dut.cycle = i;
+        ref.scanner->video_cycle();
+        dut.scanner->owe_cycle();
+
+        if ((i % 8000) == 7999) {
+            ok = ok && drain_compare(ref, dut);
+        }
+    }
+    ok = ok && drain_compare(ref, dut);
+    ok = ok && ref.irqs.events == dut.irqs.events;
+    ok = ok && ref.scanner->get_scan_cycle() == dut.scanner->get_scan_cycle();
+
+    printf("%-10s %s  writes %llu  switches %llu  fb reads %llu  irqs %zu\n", c.name, ok ? "identical" : "DIFFERENT",
+           (unsigned long long)writes, (unsigned long long)switches, (unsigned long long)fb_reads, dut.irqs.events.size());
+    return ok;
+}
+
+// Plain frames with no observers: lockstep video_cycle() vs owe_cycle() plus end-of-frame sync.
+double time_case(const scan_case &c, bool lazy) {
+    rig r(c.kind);
+    r.scanner->set_graf();
+    r.scanner->set_hires();
+    constexpr int FRAMES = 60;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++) {
+        for (int i = 0; i < 17030; i++) {
+            if (lazy) r.scanner->owe_cycle();
+            else r.scanner->video_cycle();
+        }
+        r.scanner->get_frame_scan()->clear();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (FRAMES * 17030.0);
+}
+
+} // namespace
+
+int run_scan_ab() {
+    printf("Scanner A/B: %llu video cycles per case\n", (unsigned long long)SCAN_AB_CYCLES);
+    int failed = 0;
+    for (const scan_case &c : scan_cases) {
+        if (!run_case(c)) failed++;
+    }
+
+    printf("\n%-10s %12s %12s\n", "", "lockstep ns", "catch-up ns");
+    for (const scan_case &c : scan_cases) {
+        double old_ns = time_case(c, false);
+        double new_ns = time_case(c, true);
+        printf("%-10s %12.2f %12.2f  (%.2fx)\n", c.name, old_ns, new_ns, new_ns > 0 ? old_ns / new_ns : 0.0);
+    }
+
+    printf("Failed cases: %d\n", failed);
+    return failed ? 1 : 0;
+}
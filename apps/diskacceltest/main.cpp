@@ -0,0 +1,246 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * diskacceltest --check
+ *
+ * Runs the disk accelerator frame by frame against a real clock and a Mounts
+ * with fake drives whose motors the test switches on and off:
+ *   - only Disk II / 5.25 / 3.5 motors count, block devices don't;
+ *   - the clock goes to the accelerator speed and back to the one it
+ *     interrupted, with its Ludicrous N;
+ *   - a speed already at or above the accelerator's is left alone, and so is
+ *     one the user picks during a spell;
+ *   - free-run calibrates on the first spell only and reuses that N after.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "NClock.hpp"
+#include "util/DiskAccelerator.hpp"
+#include "util/mount.hpp"
+
+uint64_t debug_level = 0;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool cond, const char *what) {
+    if (!cond) {
+        printf("  FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+struct FakeDrive : StorageDevice {
+    bool motor = false;
+    int polls = 0;
+
+    bool mount(storage_key_t, std::vector<media_descriptor *>) override { return false; }
+    bool unmount(storage_key_t) override { return false; }
+    bool writeback(storage_key_t) override { return false; }
+    drive_status_t status(storage_key_t) override {
+        polls++;
+        return {true, "", motor, 0, false, false};
+    }
+};
+
+storage_key_t key(uint16_t slot, uint16_t drive) {
+    storage_key_t k;
+    k.slot = slot;
+    k.drive = drive;
+    return k;
+}
+
+/** The accelerator and calibrator as computer_t drives them, one frame per call. */
+struct Machine {
+    NClock clock;
+    Mounts mounts;
+    DiskAccelerator accel;
+    clock_mode_t accel_speed;
+    bool locked = false;
+    int calibrations = 0;
+
+    Machine(clock_mode_t accel_speed, clock_mode_t start) : accel_speed(accel_speed) {
+        clock.set_clock_mode(start);
+    }
+
+    DiskAccelerator::action_t frame() {
+        DiskAccelerator::action_t action = accel.update(&clock, mounts.any_floppy_motor_on(), accel_speed, locked);
+        if (action == DiskAccelerator::CALIBRATE) {
+            calibrations++;
+            locked = false;
+            clock.set_cpu_per_14m(LUDICROUS_CPU_PER_14M_MIN);
+        } else if (action == DiskAccelerator::REUSE_N) {
+            locked = true;
+        }
+        return action;
+    }
+    void frames(int n) {
+        for (int i = 0; i < n; i++) frame();
+    }
+    // what the calibrator does once it settles, a few seconds into a spell
+    void settle(uint32_t n) {
+        clock.set_cpu_per_14m(n);
+        locked = true;
+    }
+    // the user picks a speed from the menu; leaving free-run drops calibration
+    void user_speed(clock_mode_t mode) {
+        clock.set_clock_mode(mode);
+        if (mode != CLOCK_FREE_RUN) locked = false;
+    }
+};
+
+void check_motors() {
+    Machine m(CLOCK_14_3MHZ, CLOCK_1_024MHZ);
+    FakeDrive disk2, block, d35;
+    m.mounts.register_storage_device(key(6, 0), &disk2, DRIVE_TYPE_DISKII);
+    m.mounts.register_storage_device(key(7, 0), &block, DRIVE_TYPE_PRODOS_BLOCK);
+    m.mounts.register_storage_device(key(5, 0), &d35, DRIVE_TYPE_APPLEDISK_35);
+
+    block.motor = true;
+    m.frames(10);
+    expect(m.clock.get_clock_mode() == CLOCK_1_024MHZ && !m.accel.active, "motors: a block device doesn't accelerate");
+    expect(block.polls == 0, "motors: block devices aren't polled");
+
+    disk2.motor = true;
+    m.frame();
+    expect(m.clock.get_clock_mode() == CLOCK_14_3MHZ && m.accel.active, "motors: Disk II motor on accelerates");
+    m.frames(100);
+    expect(m.clock.get_clock_mode() == CLOCK_14_3MHZ, "motors: stays accelerated while the motor runs");
+
+    // hand-over from one drive to another without a gap keeps the spell going
+    d35.motor = true;
+    m.frame();
+    disk2.motor = false;
+    m.frames(5);
+    expect(m.clock.get_clock_mode() == CLOCK_14_3MHZ && m.accel.active, "motors: 3.5 motor keeps it accelerated");
+
+    d35.motor = false;
+    m.frame();
+    expect(m.clock.get_clock_mode() == CLOCK_1_024MHZ && !m.accel.active, "motors: back to 1 MHz the frame the motors stop");
+    expect(m.clock.get_cpu_per_14m() == 1, "motors: N is 1 outside free-run");
+
+    d35.motor = true;
+    m.frame();
+    expect(m.clock.get_clock_mode() == CLOCK_14_3MHZ, "motors: a second spell accelerates again");
+}
+
+void check_speeds() {
+    // at or above the accelerator speed already: nothing to do, nothing to restore
+    Machine fast(CLOCK_2_8MHZ, CLOCK_7_159MHZ);
+    FakeDrive d;
+    fast.mounts.register_storage_device(key(6, 1), &d, DRIVE_TYPE_APPLEDISK_525);
+    d.motor = true;
+    fast.frames(3);
+    expect(fast.clock.get_clock_mode() == CLOCK_7_159MHZ && !fast.accel.active, "speeds: a faster clock is left alone");
+    d.motor = false;
+    fast.frames(3);
+    expect(fast.clock.get_clock_mode() == CLOCK_7_159MHZ, "speeds: and not restored to anything afterwards");
+
+    Machine same(CLOCK_14_3MHZ, CLOCK_14_3MHZ);
+    same.mounts.register_storage_device(key(6, 1), &d, DRIVE_TYPE_APPLEDISK_525);
+    d.motor = true;
+    same.frame();
+    expect(!same.accel.active, "speeds: the same speed is left alone");
+
+    Machine ludicrous(CLOCK_14_3MHZ, CLOCK_FREE_RUN);
+    ludicrous.settle(14);
+    ludicrous.mounts.register_storage_device(key(6, 1), &d, DRIVE_TYPE_APPLEDISK_525);
+    ludicrous.frames(3);
+    d.motor = false;
+    ludicrous.frames(3);
+    expect(ludicrous.clock.get_clock_mode() == CLOCK_FREE_RUN && ludicrous.clock.get_cpu_per_14m() == 14,
+        "speeds: free-run is never slowed down");
+
+    // the user picks a speed during a spell: it sticks when the motor stops
+    Machine user(CLOCK_14_3MHZ, CLOCK_1_024MHZ);
+    user.mounts.register_storage_device(key(6, 1), &d, DRIVE_TYPE_APPLEDISK_525);
+    d.motor = true;
+    user.frame();
+    user.user_speed(CLOCK_2_8MHZ);
+    user.frames(3);
+    d.motor = false;
+    user.frame();
+    expect(user.clock.get_clock_mode() == CLOCK_2_8MHZ && !user.accel.active, "speeds: a speed picked mid-spell is kept");
+    d.motor = true;
+    user.frame();
+    expect(user.clock.get_clock_mode() == CLOCK_14_3MHZ, "speeds: the next spell accelerates from the picked speed");
+    d.motor = false;
+    user.frame();
+    expect(user.clock.get_clock_mode() == CLOCK_2_8MHZ, "speeds: and goes back to it");
+}
+
+void check_free_run() {
+    Machine m(CLOCK_FREE_RUN, CLOCK_2_8MHZ);
+    FakeDrive d;
+    m.mounts.register_storage_device(key(6, 0), &d, DRIVE_TYPE_DISKII);
+
+    d.motor = true;
+    expect(m.frame() == DiskAccelerator::CALIBRATE, "free-run: the first spell calibrates");
+    expect(m.clock.get_clock_mode() == CLOCK_FREE_RUN, "free-run: clock in free-run");
+    m.frames(30);
+    m.settle(11);
+    m.frames(30);
+    expect(m.calibrations == 1, "free-run: calibrated once per spell");
+
+    d.motor = false;
+    m.frame();
+    expect(m.clock.get_clock_mode() == CLOCK_2_8MHZ && m.clock.get_cpu_per_14m() == 1, "free-run: back to 2.8 MHz");
+    expect(m.accel.locked_n == 11, "free-run: the settled N is kept");
+
+    d.motor = true;
+    expect(m.frame() == DiskAccelerator::REUSE_N, "free-run: the second spell reuses N");
+    expect(m.clock.get_clock_mode() == CLOCK_FREE_RUN && m.clock.get_cpu_per_14m() == 11,
+        "free-run: second spell runs at the kept N");
+    expect(m.calibrations == 1, "free-run: no second calibration");
+
+    // a spell that ends before calibration settles doesn't keep a half-searched N
+    Machine early(CLOCK_FREE_RUN, CLOCK_1_024MHZ);
+    early.mounts.register_storage_device(key(6, 0), &d, DRIVE_TYPE_DISKII);
+    d.motor = true;
+    early.frame();
+    early.clock.set_cpu_per_14m(9);
+    d.motor = false;
+    early.frame();
+    expect(early.accel.locked_n == 0, "free-run: an unsettled N isn't kept");
+    d.motor = true;
+    expect(early.frame() == DiskAccelerator::CALIBRATE, "free-run: so the next spell calibrates again");
+}
+
+bool run_check() {
+    check_motors();
+    check_speeds();
+    check_free_run();
+    printf("disk accelerator: %s\n", failures ? "FAIL" : "PASS");
+    return failures == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            return run_check() ? 0 : 1;
+        }
+    }
+    printf("usage: diskacceltest --check\n");
+    return 1;
+}
@@ -0,0 +1,363 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * es5503test --check
+ *
+ * Runs ES5503::generate_samples, which mixes each oscillator in runs with
+ * render_osc, against LegacyES5503 below: the per-sample, channel-by-channel
+ * loop it replaced. Both chips get the same random register writes (all
+ * modes, sync/AM and swap pairs, every table size and resolution), wave
+ * memory with no, few and many zero bytes, mono and stereo, and buffer
+ * sizes from 0 up to a full frame. After every buffer the output, all 32
+ * oscillators, the channel strobe, $E0 and the IRQ callbacks must match.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "devices/es5503/ensoniq.hpp"
+
+uint64_t debug_level = 0;
+
+namespace {
+
+constexpr uint16_t wavesizes[8] = { 256, 512, 1024, 2048, 4096, 8192, 16384, 32768 };
+constexpr uint32_t wavemasks[8] = { 0x1ff00, 0x1fe00, 0x1fc00, 0x1f800, 0x1f000, 0x1e000, 0x1c000, 0x18000 };
+constexpr uint32_t accmasks[8]  = { 0xff, 0x1ff, 0x3ff, 0x7ff, 0xfff, 0x1fff, 0x3fff, 0x7fff };
+constexpr int      resshifts[8] = { 9, 10, 11, 12, 13, 14, 15, 16 };
+
+/* The ES5503 as it was before render_osc: only what mixing touches is kept. */
+class LegacyES5503 {
+public:
+    Oscillator m_oscillators[32];
+    int m_oscsenabled = 1;
+    uint8_t m_channel_strobe = 0;
+    uint8_t m_rege0 = 0xff;
+    int m_output_channels = 1;
+    uint8_t *m_wave_memory = nullptr;
+    std::vector<int32_t> m_mix_buffer;
+    std::function<void(bool)> m_irq_callback;
+
+    enum { MODE_FREE = 0, MODE_ONESHOT = 1, MODE_SYNCAM = 2, MODE_SWAP = 3 };
+
+    void init(int output_channels, int max_samples) {
+        m_output_channels = output_channels;
+        m_mix_buffer.resize(max_samples * output_channels);
+        for (auto &osc : m_oscillators) {
+            osc = Oscillator{};
+            osc.data = 0x80;
+        }
+        m_oscsenabled = 1;
+        m_rege0 = 0xff;
+        update_irq_status();
+    }
+
+    uint8_t read_wave_byte(uint32_t address) { return m_wave_memory[address & 0xFFFF]; }
+
+    int update_irq_status() {
+        int i = 0;
+        bool any_irq_pending = false;
+        for (i = 0; i < m_oscsenabled; i++) {
+            if (m_oscillators[i].irqpend) {
+                any_irq_pending = true;
+                break;
+            }
+        }
+        if (m_irq_callback) m_irq_callback(any_irq_pending);
+        m_rege0 = (m_rege0 & 0x7f) | (any_irq_pending ? 0 : 0x80);
+        if (any_irq_pending) {
+            m_rege0 = (m_rege0 & ~0x3e) | ((i & 0x1f) << 1);
+            return i;
+        }
+        return -1;
+    }
+
+    void halt_osc(int onum, int type, uint32_t *accumulator, int resshift, uint8_t newCtrl) {
+        Oscillator *pOsc = &m_oscillators[onum];
+        Oscillator *pPartner = &m_oscillators[onum ^ 1];
+        int mode = (pOsc->control >> 1) & 3;
+        const int partnerMode = (pPartner->control >> 1) & 3;
+
+        if (mode == MODE_SYNCAM) {
+            if (!(onum & 1)) {
+                if (!(m_oscillators[onum - 1].control & 1)) {
+                    m_oscillators[onum - 1].accumulator = 0;
+                }
+            }
+            mode = MODE_FREE;
+        }
+
+        if ((mode != MODE_FREE) || (type != 0)) {
+            pOsc->control |= 1;
+        } else {
+            const uint16_t wtsize_m1 = pOsc->wtsize - 1;
+            *accumulator -= ((uint32_t)wtsize_m1 << resshift);
+        }
+
+        if (mode == MODE_SWAP) {
+            pPartner->control &= ~1;
+            pPartner->accumulator = 0;
+        } else {
+            if ((partnerMode == MODE_SWAP) && ((onum & 1) == 0)) {
+                pOsc->control &= ~1;
+                uint16_t wtsize = pOsc->wtsize - 1;
+                *accumulator -= (wtsize << resshift);
+            }
+        }
+
+        if (pOsc->control & 0x08) {
+            if ((type == 0) && !(newCtrl & 0x08)) {
+                return;
+            }
+            pOsc->irqpend = 1;
+            update_irq_status();
+        }
+    }
+
+    void write(uint8_t offset, uint8_t data) {
+        if (offset >= 0xe0) {
+            if (offset == 0xe1) m_oscsenabled = ((data >> 1) & 0x1f) + 1;
+            return;
+        }
+        Oscillator &o = m_oscillators[offset & 0x1f];
+        switch (offset & 0xe0) {
+            case 0x00: o.freq = (o.freq & 0xff00) | data; break;
+            case 0x20: o.freq = (o.freq & 0x00ff) | (data << 8); break;
+            case 0x40: o.vol = data; break;
+            case 0x80: o.wavetblpointer = (data << 8); break;
+            case 0xa0:
+                if ((o.control & 1) && (!(data & 1))) {
+                    o.accumulator = 0;
+                }
+                if (!(o.control & 1) && ((data & 1)) && ((data >> 1) & 1)) {
+                    halt_osc(offset & 0x1f, 0, &o.accumulator, resshifts[o.resolution], data);
+                }
+                o.control = data;
+                break;
+            case 0xc0:
+                if (data & 0x40) o.wavetblpointer |= 0x10000;
+                else o.wavetblpointer &= 0xffff;
+                o.wavetblsize = ((data >> 3) & 7);
+                o.wtsize = wavesizes[o.wavetblsize];
+                o.resolution = (data & 7);
+                break;
+        }
+    }
+
+    void generate_samples(int16_t *buffer, int num_samples) {
+        std::fill_n(&m_mix_buffer[0], num_samples * m_output_channels, 0);
+
+        for (int chan = 0; chan < m_output_channels; chan++) {
+            for (int osc = 0; osc < m_oscsenabled; osc++) {
+                Oscillator *pOsc = &m_oscillators[osc];
+
+                int assigned = (pOsc->control >> 4) & (m_output_channels - 1);
+                if (m_output_channels == 2) {
+                    assigned ^= 1;
+                }
+                if (!(pOsc->control & 1) && assigned == chan) {
+                    uint32_t wtptr = pOsc->wavetblpointer & wavemasks[pOsc->wavetblsize];
+                    uint32_t acc = pOsc->accumulator;
+                    const uint16_t wtsize = pOsc->wtsize - 1;
+                    uint8_t ctrl = pOsc->control;
+                    const uint16_t freq = pOsc->freq;
+                    int16_t vol = pOsc->vol;
+                    int8_t data = -128;
+                    const int resshift = resshifts[pOsc->resolution] - pOsc->wavetblsize;
+                    const uint32_t sizemask = accmasks[pOsc->wavetblsize];
+                    const int mode = (pOsc->control >> 1) & 3;
+                    int32_t *mixp = &m_mix_buffer[0] + chan;
+
+                    for (int snum = 0; snum < num_samples; snum++) {
+                        uint32_t altram = acc >> resshift;
+                        uint32_t ramptr = altram & sizemask;
+
+                        acc += freq;
+
+                        m_channel_strobe = (ctrl >> 4) & 0xf;
+                        data = (int32_t)read_wave_byte(ramptr + wtptr) ^ 0x80;
+
+                        if (read_wave_byte(ramptr + wtptr) == 0x00) {
+                            halt_osc(osc, 1, &acc, resshift, pOsc->control);
+                            ctrl = pOsc->control;
+                        } else {
+                            if (mode != MODE_SYNCAM) {
+                                *mixp += data * vol;
+                                if (osc == (m_oscsenabled - 1)) {
+                                    *mixp += data * vol;
+                                    *mixp += data * vol;
+                                }
+                            } else {
+                                if (osc & 1) {
+                                    if (osc < 31) {
+                                        if (!(m_oscillators[osc + 1].control & 1)) {
+                                            m_oscillators[osc + 1].vol = data ^ 0x80;
+                                        }
+                                    }
+                                } else {
+                                    *mixp += data * vol;
+                                    if (osc == (m_oscsenabled - 1)) {
+                                        *mixp += data * vol;
+                                        *mixp += data * vol;
+                                    }
+                                }
+                            }
+                            mixp += m_output_channels;
+
+                            if (altram >= wtsize) {
+                                halt_osc(osc, 0, &acc, resshift, pOsc->control);
+                                ctrl = pOsc->control;
+                            }
+                        }
+
+                        if (pOsc->control & 1) {
+                            ctrl = pOsc->control;
+                            break;
+                        }
+                    }
+
+                    pOsc->control = ctrl;
+                    pOsc->accumulator = acc;
+                    pOsc->data = data ^ 0x80;
+                }
+            }
+        }
+
+        int32_t *mixp = &m_mix_buffer[0];
+        for (int i = 0; i < num_samples * m_output_channels; i++) {
+            int32_t sample = *mixp++ / 8;
+            if (sample > 32767) sample = 32767;
+            if (sample < -32768) sample = -32768;
+            buffer[i] = (int16_t)sample;
+        }
+    }
+};
+
+bool same_osc(const Oscillator &a, const Oscillator &b) {
+    return a.freq == b.freq && a.wtsize == b.wtsize && a.control == b.control && a.vol == b.vol &&
+           a.data == b.data && a.wavetblpointer == b.wavetblpointer && a.wavetblsize == b.wavetblsize &&
+           a.resolution == b.resolution && a.accumulator == b.accumulator && a.irqpend == b.irqpend;
+}
+
+/* Wave RAM: random bytes with no zeros, the odd zero from rng, or about one zero per 512 bytes. */
+void fill_wave(std::mt19937 &rng, uint8_t *wave, int zeros) {
+    for (int i = 0; i < 65536; i++) {
+        uint8_t v = rng() & 0xFF;
+        if (v == 0 && zeros == 0) v = 0x80;
+        if (zeros == 2 && (rng() % 512) == 0) v = 0;
+        wave[i] = v;
+    }
+}
+
+bool run_check() {
+    const int RUNS = 400;
+    const int BUFFERS = 40;
+    const uint32_t CLOCK = 7159090;
+    const int MAX_SAMPLES = (int)(CLOCK / 8 / 3 / 50);  // one 50 Hz frame at the fastest rate
+
+    std::mt19937 rng(0x5503);
+    static uint8_t wave[65536];
+    std::vector<int> irq_cur, irq_ref;
+    long samples = 0;
+
+    for (int run = 0; run < RUNS; run++) {
+        const int channels = (rng() & 1) ? 2 : 1;
+        fill_wave(rng, wave, run % 3);
+
+        ES5503 *cur = new ES5503;
+        LegacyES5503 *ref = new LegacyES5503;
+        cur->set_wave_memory(wave);
+        ref->m_wave_memory = wave;
+        cur->init(CLOCK, 48000, channels);
+        ref->init(channels, MAX_SAMPLES);
+        irq_cur.clear();
+        irq_ref.clear();
+        cur->set_irq_callback([&](bool b) { irq_cur.push_back(b); });
+        ref->m_irq_callback = [&](bool b) { irq_ref.push_back(b); };
+
+        auto wr = [&](uint8_t r, uint8_t d) { cur->write(r, d); ref->write(r, d); };
+        wr(0xE1, (uint8_t)((rng() % 32) << 1));
+
+        for (int b = 0; b < BUFFERS; b++) {
+            int writes = rng() % 12;
+            for (int w = 0; w < writes; w++) {
+                int osc = rng() % 32;
+                switch (rng() % 6) {
+                    case 0: wr(0x00 + osc, rng()); break;
+                    case 1: wr(0x20 + osc, (rng() % 3) ? rng() % 8 : rng()); break;
+                    case 2: wr(0x40 + osc, rng()); break;
+                    case 3: wr(0x80 + osc, rng()); break;
+                    case 4: {
+                        uint8_t c = rng();
+                        // oscillator 0 has no partner below it to sync
+                        if (osc == 0 && ((c >> 1) & 3) == 2) c &= ~4;
+                        wr(0xA0 + osc, c);
+                        break;
+                    }
+                    case 5: wr(0xC0 + osc, rng() & 0x7F); break;
+                }
+            }
+            if (rng() % 20 == 0) wr(0xE1, (uint8_t)((rng() % 32) << 1));
+
+            int n = (rng() % 4 == 0) ? rng() % 9 : rng() % 800;
+            if (n > MAX_SAMPLES) n = MAX_SAMPLES;
+            std::vector<int16_t> out_cur(n * channels + 1, 0x5555), out_ref(n * channels + 1, 0x5555);
+            cur->generate_samples(out_cur.data(), n);
+            ref->generate_samples(out_ref.data(), n);
+            samples += n;
+
+            const char *what = nullptr;
+            if (out_cur != out_ref) what = "output";
+            for (int k = 0; k < 32 && !what; k++) {
+                if (!same_osc(*cur->get_oscillator(k), ref->m_oscillators[k])) what = "oscillator state";
+            }
+            if (!what && cur->get_channel_strobe() != ref->m_channel_strobe) what = "channel strobe";
+            if (!what && cur->get_rege0() != ref->m_rege0) what = "$E0";
+            if (!what && irq_cur != irq_ref) what = "IRQ callbacks";
+            if (what) {
+                printf("  run %d buffer %d (%d samples, %s): %s differs\n", run, b, n,
+                    channels == 2 ? "stereo" : "mono", what);
+                printf("es5503 span mixer: FAIL\n");
+                delete cur;
+                delete ref;
+                return false;
+            }
+        }
+        delete cur;
+        delete ref;
+    }
+
+    printf("es5503 span mixer: %d runs, %ld samples: PASS\n", RUNS, samples);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            return run_check() ? 0 : 1;
+        }
+    }
+    printf("usage: es5503test --check\n");
+    return 1;
+}
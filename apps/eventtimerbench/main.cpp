@@ -0,0 +1,412 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * eventtimerbench --check
+ *
+ * Replays a recorded schedule / cancel pattern through EventTimer and through
+ * LegacyEventTimer (the original vector + find_if + make_heap queue). The
+ * pattern models a busy machine: two Mockingboards (four 6522s, free-running
+ * T1 and one-shot T2 rewritten by the music driver), mouse VBL, RTC, Disk II
+ * phase timers and a serial port. Both queues must fire the same events at
+ * the same process calls; then both are timed.
+ *
+ * It then runs a random mix of inserts, reschedules (earlier and later),
+ * cancels of queued, idle and unknown instances, and process calls against
+ * EventTimer, LegacyEventTimer and a plain map. After every step the next
+ * event cycle must be the earliest pending trigger, and the run loop's
+ * cached deadline must have been reset exactly when an insert went to the
+ * front of the queue.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "util/EventTimer.hpp"
+
+uint64_t debug_level = 0;
+
+namespace {
+
+/** The queue as it was before the indexed heap, kept as the reference. */
+class LegacyEventTimer {
+    struct Event {
+        uint64_t triggerCycles;
+        void (*triggerCallback)(uint64_t, void*);
+        uint64_t instanceID;
+        void* userData;
+    };
+    static bool later(const Event& a, const Event& b) { return a.triggerCycles > b.triggerCycles; }
+    std::vector<Event> events;
+
+    void updateNextEventCycle() {
+        next_event_cycle = events.empty() ? std::numeric_limits<uint64_t>::max() : events.front().triggerCycles;
+    }
+
+public:
+    uint64_t next_event_cycle = 0;
+
+    void scheduleEvent(uint64_t triggerCycles, void (*callback)(uint64_t, void*), uint64_t instanceID, void* userData = nullptr) {
+        auto existing = std::find_if(events.begin(), events.end(),
+            [instanceID](const Event& event) { return event.instanceID == instanceID; });
+        if (existing != events.end()) {
+            existing->triggerCycles = triggerCycles;
+            existing->triggerCallback = callback;
+            existing->userData = userData;
+            std::make_heap(events.begin(), events.end(), later);
+        } else {
+            events.push_back(Event{triggerCycles, callback, instanceID, userData});
+            std::push_heap(events.begin(), events.end(), later);
+        }
+        updateNextEventCycle();
+    }
+    void processEvents(uint64_t currentCycles) {
+        while (!events.empty() && events.front().triggerCycles <= currentCycles) {
+            Event event = events.front();
+            std::pop_heap(events.begin(), events.end(), later);
+            events.pop_back();
+            if (event.triggerCallback) event.triggerCallback(event.instanceID, event.userData);
+        }
+        updateNextEventCycle();
+    }
+    void cancelEvents(uint64_t instanceID) {
+        auto newEnd = std::remove_if(events.begin(), events.end(),
+            [instanceID](const Event& event) { return event.instanceID == instanceID; });
+        if (newEnd != events.end()) {
+            events.erase(newEnd, events.end());
+            std::make_heap(events.begin(), events.end(), later);
+        }
+        updateNextEventCycle();
+    }
+    inline bool isEventPassed(uint64_t currentCycles) { return currentCycles >= next_event_cycle; }
+};
+
+struct xorshift {
+    uint64_t s;
+    uint64_t next() {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        return s;
+    }
+};
+
+enum op_kind_t { OP_RUN, OP_SCHEDULE, OP_CANCEL };
+
+/* One recorded step. OP_RUN advances the clock by delta and polls the queue the
+   way the run loop does; OP_SCHEDULE asks for an event delta cycles out. */
+struct op_t {
+    op_kind_t kind;
+    uint32_t delta;
+    uint64_t id;
+};
+
+constexpr uint64_t MB_T1 = 0x10000000;
+constexpr uint64_t MB_T2 = 0x10010000;
+
+/* Free-running timers re-arm themselves from the callback; the period is a
+   function of the id so both queues re-arm identically. */
+uint32_t rearm_period(uint64_t id) {
+    if ((id & 0xFFFF0000) == MB_T1) return 2000 + (uint32_t)(id & 0x0F) * 997;
+    if (id == 0x00A0) return 17030;   // mouse VBL
+    if (id == 0x00A1) return 1020484; // RTC second
+    return 0;
+}
+
+std::vector<op_t> record_pattern(size_t frames) {
+    std::vector<op_t> ops;
+    xorshift rng{0x4556454E'54424E43ull};
+    uint64_t vias[4];
+    for (int v = 0; v < 4; v++) vias[v] = (uint64_t)((4 + v / 2) << 8) | (v & 1);
+
+    for (int v = 0; v < 4; v++) ops.push_back({OP_SCHEDULE, rearm_period(MB_T1 | vias[v]), MB_T1 | vias[v]});
+    ops.push_back({OP_SCHEDULE, 17030, 0x00A0});
+    ops.push_back({OP_SCHEDULE, 1020484, 0x00A1});
+
+    for (size_t f = 0; f < frames; f++) {
+        // A frame of CPU time in 16-cycle slices, with device traffic sprinkled in.
+        for (int slice = 0; slice < 1064; slice++) {
+            ops.push_back({OP_RUN, 16, 0});
+            uint64_t r = rng.next();
+            uint64_t via = vias[(r >> 8) & 3];
+            switch (r % 160) {
+                case 0: case 1: case 2:
+                    // music driver rewrites T1 / T2 counters
+                    ops.push_back({OP_SCHEDULE, 500 + (uint32_t)((r >> 16) % 20000), MB_T1 | via});
+                    break;
+                case 3: case 4:
+                    ops.push_back({OP_SCHEDULE, 100 + (uint32_t)((r >> 16) % 5000), MB_T2 | via});
+                    break;
+                case 5:
+                    ops.push_back({OP_CANCEL, 0, MB_T2 | via});
+                    break;
+                case 6:
+                    // Disk II phase change, then the motor-off timer gets pushed back
+                    ops.push_back({OP_SCHEDULE, 520, 0x00B0 | ((r >> 16) & 1)});
+                    ops.push_back({OP_SCHEDULE, 1020484, 0x00B8});
+                    break;
+                case 7:
+                    ops.push_back({OP_SCHEDULE, 1000 + (uint32_t)((r >> 16) % 3000), 0x00C0 | ((r >> 20) & 1)});
+                    break;
+                case 8:
+                    ops.push_back({OP_CANCEL, 0, 0x00C0 | ((r >> 20) & 1)});
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    return ops;
+}
+
+/* fired: (process call number, trigger cycle, id) for everything that fired. */
+using fire_log_t = std::vector<std::tuple<uint64_t, uint64_t, uint64_t>>;
+
+template <class Timer>
+struct Replay {
+    Timer timer;
+    uint64_t now = 0;
+    uint64_t process_calls = 0;
+    uint64_t fired = 0;
+    fire_log_t *log = nullptr;
+
+    static void callback(uint64_t id, void *userdata) {
+        Replay *r = static_cast<Replay *>(userdata);
+        r->fired++;
+        if (r->log) r->log->emplace_back(r->process_calls, r->now, id);
+        uint32_t period = rearm_period(id);
+        if (period) r->timer.scheduleEvent(r->now + period, callback, id, r);
+    }
+
+    void run(const std::vector<op_t> &ops) {
+        for (const op_t &op : ops) {
+            switch (op.kind) {
+                case OP_RUN:
+                    now += op.delta;
+                    if (timer.isEventPassed(now)) {
+                        process_calls++;
+                        timer.processEvents(now);
+                    }
+                    break;
+                case OP_SCHEDULE:
+                    timer.scheduleEvent(now + op.delta, callback, op.id, this);
+                    break;
+                case OP_CANCEL:
+                    timer.cancelEvents(op.id);
+                    break;
+            }
+        }
+    }
+};
+
+template <class Timer>
+double time_replay(const std::vector<op_t> &ops, uint64_t &fired) {
+    auto t0 = std::chrono::steady_clock::now();
+    Replay<Timer> *r = new Replay<Timer>;
+    r->run(ops);
+    fired = r->fired;
+    delete r;
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+/* Random queue traffic, with the earliest pending trigger checked after every step. */
+struct DeadlineCheck {
+    EventTimer timer;
+    LegacyEventTimer legacy;
+    std::map<uint64_t, uint64_t> pending;   // instance -> trigger, the reference
+    std::vector<uint64_t> fired, legacy_fired;
+    uint64_t now = 0;
+    uint64_t deadline = 0;
+
+    // odd instances re-arm from their callback, like a free-running timer
+    static uint64_t rearm(uint64_t id) { return (id & 1) ? 1 + (id * 37) % 700 : 0; }
+
+    static void callback(uint64_t id, void *userdata) {
+        DeadlineCheck *c = static_cast<DeadlineCheck *>(userdata);
+        c->fired.push_back(id);
+        if (rearm(id)) c->timer.scheduleEvent(c->now + rearm(id), callback, id, c);
+    }
+    static void legacy_callback(uint64_t id, void *userdata) {
+        DeadlineCheck *c = static_cast<DeadlineCheck *>(userdata);
+        c->legacy_fired.push_back(id);
+        if (rearm(id)) c->legacy.scheduleEvent(c->now + rearm(id), legacy_callback, id, c);
+    }
+
+    uint64_t earliest() const {
+        uint64_t next = std::numeric_limits<uint64_t>::max();
+        for (const auto &[id, when] : pending) next = std::min(next, when);
+        return next;
+    }
+
+    bool run(uint64_t seed, int steps) {
+        xorshift rng{seed};
+        timer.set_deadline_reset(&deadline);
+        for (int step = 0; step < steps; step++) {
+            uint64_t r = rng.next();
+            uint64_t id = 1 + (r >> 8) % 40;
+            const uint64_t before = timer.getNextEventCycle();
+            deadline = 0xDEAD;
+            bool reset_expected = false;
+            const char *what;
+
+            switch (r % 8) {
+                case 0: case 1: case 2: {
+                    // new instance or reschedule; sometimes right at, or before, the current front
+                    uint64_t when = now + 1 + (r >> 16) % 5000;
+                    if ((r >> 40) % 4 == 0 && before != std::numeric_limits<uint64_t>::max()) {
+                        when = std::max(now, before - std::min<uint64_t>(before - now, (r >> 44) % 3));
+                    }
+                    pending[id] = when;
+                    reset_expected = when == earliest();
+                    timer.scheduleEvent(when, callback, id, this);
+                    legacy.scheduleEvent(when, legacy_callback, id, this);
+                    what = "schedule";
+                    break;
+                }
+                case 3: case 4:
+                    // the front instance, a random one, or one never seen
+                    if ((r >> 16) % 3 == 0 && !pending.empty()) {
+                        for (const auto &[pid, when] : pending) if (when == earliest()) { id = pid; break; }
+                    } else if ((r >> 16) % 3 == 1) {
+                        id += 1000;
+                    }
+                    pending.erase(id);
+                    timer.cancelEvents(id);
+                    legacy.cancelEvents(id);
+                    what = "cancel";
+                    break;
+                default: {
+                    now += (r >> 16) % 900;
+                    fired.clear();
+                    legacy_fired.clear();
+                    std::vector<uint64_t> want;
+                    // fire in trigger order; re-arms land after now, so never fire twice
+                    while (!pending.empty() && earliest() <= now) {
+                        uint64_t first = 0, when = earliest();
+                        for (const auto &[pid, w] : pending) if (w == when) { first = pid; break; }
+                        pending.erase(first);
+                        want.push_back(first);
+                    }
+                    for (uint64_t f : want) if (rearm(f)) pending[f] = now + rearm(f);
+                    if (timer.isEventPassed(now)) timer.processEvents(now);
+                    if (legacy.isEventPassed(now)) legacy.processEvents(now);
+                    std::sort(want.begin(), want.end());
+                    std::sort(fired.begin(), fired.end());
+                    std::sort(legacy_fired.begin(), legacy_fired.end());
+                    if (fired != want || legacy_fired != want) {
+                        printf("  step %d: process at %llu fired %zu events, expected %zu\n",
+                            step, (unsigned long long)now, fired.size(), want.size());
+                        return false;
+                    }
+                    what = "process";
+                    break;
+                }
+            }
+
+            const uint64_t next = timer.getNextEventCycle();
+            if (next != earliest() || timer.next_event_cycle != next || legacy.next_event_cycle != next) {
+                printf("  step %d: after %s of %llu next event %llu, expected %llu\n", step, what,
+                    (unsigned long long)id, (unsigned long long)next, (unsigned long long)earliest());
+                return false;
+            }
+            if ((r % 8) <= 2 && (deadline == 0) != reset_expected) {
+                printf("  step %d: schedule of %llu %s the cached deadline\n", step, (unsigned long long)id,
+                    reset_expected ? "didn't reset" : "needlessly reset");
+                return false;
+            }
+            // (process may legitimately reset it: re-arms from callbacks are inserts)
+            if ((r % 8 == 3 || r % 8 == 4) && deadline != 0xDEAD) {
+                printf("  step %d: %s reset the cached deadline\n", step, what);
+                return false;
+            }
+            if (deadline != 0 && next < before && (r % 8) <= 2) {
+                printf("  step %d: next event moved earlier without a deadline reset\n", step);
+                return false;
+            }
+            for (const auto &[pid, when] : pending) {
+                uint64_t at = 0;
+                if (!timer.isPending(pid, at) || at != when) {
+                    printf("  step %d: instance %llu not pending at %llu\n", step, (unsigned long long)pid,
+                        (unsigned long long)when);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+bool run_check() {
+    std::vector<op_t> ops = record_pattern(3000);
+    size_t queue_ops = 0;
+    for (const op_t &op : ops) if (op.kind != OP_RUN) queue_ops++;
+
+    fire_log_t ref_log, new_log;
+    Replay<LegacyEventTimer> *ref = new Replay<LegacyEventTimer>;
+    Replay<EventTimer> *cur = new Replay<EventTimer>;
+    ref->log = &ref_log;
+    cur->log = &new_log;
+    ref->run(ops);
+    cur->run(ops);
+    // Events due on the same cycle may come out of either heap in any order.
+    std::sort(ref_log.begin(), ref_log.end());
+    std::sort(new_log.begin(), new_log.end());
+    bool ok = ref_log == new_log && ref->process_calls == cur->process_calls;
+    printf("eventtimer check: %zu recorded queue ops, %zu events fired, %llu process calls: %s\n",
+        queue_ops, new_log.size(), (unsigned long long)cur->process_calls, ok ? "PASS" : "FAIL");
+    if (!ok) {
+        size_t i = 0;
+        while (i < ref_log.size() && i < new_log.size() && ref_log[i] == new_log[i]) i++;
+        printf("  first difference at fire %zu of %zu / %zu\n", i, ref_log.size(), new_log.size());
+    }
+    delete ref;
+    delete cur;
+
+    const int DEADLINE_STEPS = 200000;
+    DeadlineCheck *dc = new DeadlineCheck;
+    bool deadline_ok = dc->run(0x444541444C494E45ull, DEADLINE_STEPS);
+    printf("eventtimer deadline check: %d random steps: %s\n", DEADLINE_STEPS, deadline_ok ? "PASS" : "FAIL");
+    delete dc;
+    ok = ok && deadline_ok;
+
+    uint64_t ref_fired = 0, new_fired = 0;
+    double ref_ms = time_replay<LegacyEventTimer>(ops, ref_fired);
+    double new_ms = time_replay<EventTimer>(ops, new_fired);
+    printf("eventtimer timing: legacy %.2f ms, indexed heap %.2f ms (%.2fx)\n",
+        ref_ms, new_ms, new_ms > 0 ? ref_ms / new_ms : 0.0);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            return run_check() ? 0 : 1;
+        }
+    }
+    printf("usage: eventtimerbench --check\n");
+    return 1;
+}
@@ -1,6 +1,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <unistd.h>
 #include <vector>
 #include "AsmFile.hpp"
@@ -9,6 +10,7 @@
 #include "mmus/mmu_iigs.hpp"
 #include "mmus/mmu_iie.hpp"
 #include "mmus/iigs_memory.hpp"
+#include "util/Snapshot.hpp"
 
 uint64_t debug_level = 0;
 
@@ -255,6 +257,254 @@ int liveTest(const MMUTest::Test& test, MMU_IIgs *mmu_iigs) {
     return failures;
 }
 
+/*
+ * Cross-check the bank $00/$01/$E0/$E1 fast page table against the bank
+ * handlers. Two MMUs get the same random stream of softswitch / shadow / LC
+ * changes; one does its RAM accesses through MMU_IIgs::read/write, the other
+ * calls the handlers via MMU::read/write. Values, cycle types and both RAM
+ * images must stay identical.
+ */
+struct FastMapRig {
+    MMU_IIe *megaii;
+    MMU_IIgs *mmu;
+    NClockIIgs clock;
+
+    FastMapRig(uint8_t *rom, size_t rom_size, size_t fast_ram) {
+        megaii = new MMU_IIe(256, 128*1024, rom + rom_size - 65536 + 0xC000);
+        mmu = new MMU_IIgs(256, (int)fast_ram, (uint32_t)rom_size, rom, megaii);
+        mmu->set_clock(&clock);
+        mmu->init_map();
+        memset(mmu->get_memory_base(), 0, mmu->get_memory_size());
+        memset(megaii->get_memory_base(), 0, 128*1024);
+    }
+    ~FastMapRig() { delete mmu; delete megaii; }
+};
+
+int runFastMapCheck(uint8_t *rom, size_t rom_size, size_t fast_ram) {
+    FastMapRig fast(rom, rom_size, fast_ram);
+    FastMapRig slow(rom, rom_size, fast_ram);
+    const uint8_t banks[] = { 0x00, 0x01, 0xE0, 0xE1 };
+    const uint16_t switches[] = {
+        0xC000, 0xC001, 0xC002, 0xC003, 0xC004, 0xC005, 0xC008, 0xC009,
+        0xC054, 0xC055, 0xC056, 0xC057, 0xC029, 0xC035, 0xC036, 0xC068,
+        0xC080, 0xC081, 0xC083, 0xC088, 0xC089, 0xC08B,
+    };
+    uint64_t s = 0x9E3779B97F4A7C15ULL;
+    int failures = 0;
+    long reads = 0, writes = 0, changes = 0;
+
+    for (int i = 0; i < 2000000 && failures < 10; i++) {
+        s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+        uint32_t op = s % 100;
+        uint32_t page = (s >> 8) & 0xFF;
+        if (page >= 0xC0 && page <= 0xCF) page = (s >> 16) & 0x3F; // keep I/O side effects out of the comparison
+        uint32_t address = ((uint32_t)banks[(s >> 24) & 3] << 16) | (page << 8) | ((s >> 32) & 0xFF);
+        uint8_t value = (uint8_t)(s >> 40);
+
+        if (op < 2) {
+            // softswitches through $E0, which always decodes them (IOLC inhibit moves $00's away)
+            uint16_t sw = switches[(s >> 48) % (sizeof(switches) / sizeof(switches[0]))];
+            if (sw == 0xC036) value &= 0x9F; // keep the bank-shadow-all bit in play, not the disk motor bits
+            bool do_read = (sw >= 0xC080) || ((sw >= 0xC054) && (s >> 60) & 1);
+            for (FastMapRig *r : { &fast, &slow }) {
+                if (do_read) { r->mmu->read(0xE00000 | sw); r->mmu->read(0xE00000 | sw); }
+                else r->mmu->write(0xE00000 | sw, value);
+            }
+            changes++;
+            continue;
+        }
+
+        fast.clock.cycle_type = slow.clock.cycle_type = CYCLE_TYPE_FAST;
+        if (op < 55) {
+            uint8_t a = fast.mmu->read(address);
+            uint8_t b = slow.mmu->MMU::read(address);
+            reads++;
+            if (a != b || fast.clock.cycle_type != slow.clock.cycle_type) {
+                printf("  read %06X: %02X/%02X cycle %d/%d\n", address, a, b, fast.clock.cycle_type, slow.clock.cycle_type);
+                failures++;
+            }
+        } else {
+            fast.mmu->write(address, value);
+            slow.mmu->MMU::write(address, value);
+            writes++;
+            if (fast.clock.cycle_type != slow.clock.cycle_type) {
+                printf("  write %06X: cycle %d/%d\n", address, fast.clock.cycle_type, slow.clock.cycle_type);
+                failures++;
+            }
+        }
+    }
+    if (memcmp(fast.mmu->get_memory_base(), slow.mmu->get_memory_base(), fast.mmu->get_memory_size()) != 0) {
+        printf("  FPI RAM differs\n");
+        failures++;
+    }
+    if (memcmp(fast.megaii->get_memory_base(), slow.megaii->get_memory_base(), 128*1024) != 0) {
+        printf("  Mega II RAM differs\n");
+        failures++;
+    }
+    printf("Fast map check: %ld reads, %ld writes, %ld state changes: %s\n", reads, writes, changes, failures ? "FAIL" : "PASS");
+    return failures;
+}
+
+/*
+ * DMA cross-check. Two MMUs get the same random stream of softswitch changes;
+ * between them one rig moves random spans with write_block / read_block and
+ * the other with byte-at-a-time write / read. Data read back and both RAM
+ * images must stay identical.
+ */
+int runBlockCheck(uint8_t *rom, size_t rom_size, size_t fast_ram) {
+    FastMapRig block(rom, rom_size, fast_ram);
+    FastMapRig bytes(rom, rom_size, fast_ram);
+    const uint8_t banks[] = { 0x00, 0x01, 0x02, 0xE0, 0xE1 };
+    const uint16_t switches[] = {
+        0xC000, 0xC001, 0xC002, 0xC003, 0xC004, 0xC005, 0xC008, 0xC009,
+        0xC054, 0xC055, 0xC056, 0xC057, 0xC029, 0xC035, 0xC036, 0xC068,
+        0xC080, 0xC081, 0xC083, 0xC088, 0xC089, 0xC08B,
+    };
+    uint64_t s = 0xBF58476D1CE4E5B9ULL;
+    uint8_t src[1024], a[1024], b[1024];
+    int failures = 0;
+    long transfers = 0;
+
+    for (int i = 0; i < 20000 && failures < 10; i++) {
+        s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+        if (s % 8 == 0) {
+            uint16_t sw = switches[(s >> 48) % (sizeof(switches) / sizeof(switches[0]))];
+            uint8_t value = (uint8_t)(s >> 40);
+            if (sw == 0xC036) value &= 0x9F;
+            bool do_read = (sw >= 0xC080) || ((sw >= 0xC054) && (s >> 60) & 1);
+            for (FastMapRig *r : { &block, &bytes }) {
+                if (do_read) { r->mmu->read(0xE00000 | sw); r->mmu->read(0xE00000 | sw); }
+                else r->mmu->write(0xE00000 | sw, value);
+            }
+            continue;
+        }
+        // Spans stay below $C000 so no I/O side effects land in the comparison.
+        uint32_t len = 1 + (uint32_t)((s >> 8) % sizeof(src));
+        uint32_t offset = (uint32_t)((s >> 20) % (0xC000 - len));
+        uint32_t address = ((uint32_t)banks[(s >> 40) % sizeof(banks)] << 16) | offset;
+        for (uint32_t j = 0; j < len; j++) src[j] = (uint8_t)(s >> (j & 31)) ^ (uint8_t)j;
+        transfers++;
+        if ((s >> 56) & 1) {
+            block.mmu->write_block(address, src, len);
+            for (uint32_t j = 0; j < len; j++) bytes.mmu->write(address + j, src[j]);
+        } else {
+            block.mmu->read_block(address, a, len);
+            for (uint32_t j = 0; j < len; j++) b[j] = bytes.mmu->read(address + j);
+            if (memcmp(a, b, len) != 0) {
+                printf("  read_block %06X len %u differs\n", address, len);
+                failures++;
+            }
+        }
+    }
+    if (memcmp(block.mmu->get_memory_base(), bytes.mmu->get_memory_base(), block.mmu->get_memory_size()) != 0) {
+        printf("  FPI RAM differs\n");
+        failures++;
+    }
+    if (memcmp(block.megaii->get_memory_base(), bytes.megaii->get_memory_base(), 128*1024) != 0) {
+        printf("  Mega II RAM differs\n");
+        failures++;
+    }
+    printf("Block transfer check: %ld transfers: %s\n", transfers, failures ? "FAIL" : "PASS");
+    return failures;
+}
+
+/*
+ * Snapshot round trip. One rig runs a random softswitch / RAM stream, saves a
+ * full snapshot, runs on, saves an incremental one against it and then keeps
+ * going while recording every read. A second rig loads the incremental file
+ * (which pulls in the full one) and replays the same stream: reads and both
+ * RAM images must match the first rig.
+ */
+struct SnapshotRig : FastMapRig {
+    SnapshotManager snapshots;
+
+    SnapshotRig(uint8_t *rom, size_t rom_size, size_t fast_ram) : FastMapRig(rom, rom_size, fast_ram) {
+        snapshots.register_ram_region("main", megaii->get_memory_base(), 128*1024);
+        snapshots.register_ram_region("fpi", mmu->get_memory_base(), mmu->get_memory_size());
+        snapshots.register_state_handler("mmu_iigs", [this](SnapshotIO &io) { mmu->snapshot(io); });
+    }
+};
+
+static int snapshotStep(SnapshotRig &r, uint64_t &s) {
+    const uint8_t banks[] = { 0x00, 0x01, 0xE0, 0xE1 };
+    const uint16_t switches[] = {
+        0xC000, 0xC001, 0xC002, 0xC003, 0xC004, 0xC005, 0xC008, 0xC009,
+        0xC054, 0xC055, 0xC056, 0xC057, 0xC029, 0xC035, 0xC036, 0xC068,
+        0xC080, 0xC081, 0xC083, 0xC088, 0xC089, 0xC08B,
+    };
+    s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+    uint32_t op = s % 100;
+    uint32_t page = (s >> 8) & 0xFF;
+    if (page >= 0xC0 && page <= 0xCF) page = (s >> 16) & 0x3F;
+    uint32_t address = ((uint32_t)banks[(s >> 24) & 3] << 16) | (page << 8) | ((s >> 32) & 0xFF);
+    uint8_t value = (uint8_t)(s >> 40);
+
+    if (op < 2) {
+        uint16_t sw = switches[(s >> 48) % (sizeof(switches) / sizeof(switches[0]))];
+        if (sw == 0xC036) value &= 0x9F;
+        bool do_read = (sw >= 0xC080) || ((sw >= 0xC054) && (s >> 60) & 1);
+        if (do_read) { r.mmu->read(0xE00000 | sw); r.mmu->read(0xE00000 | sw); }
+        else r.mmu->write(0xE00000 | sw, value);
+        return -1;
+    }
+    if (op < 55) return r.mmu->read(address);
+    r.mmu->write(address, value);
+    return -1;
+}
+
+int runSnapshotCheck(uint8_t *rom, size_t rom_size, size_t fast_ram) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path dir = fs::temp_directory_path(ec) / ("iigsmmutest_snap_" + std::to_string(getpid()));
+    fs::create_directories(dir, ec);
+    std::string base_path = (dir / "base.gs2snap").string();
+    std::string incr_path = (dir / "incr.gs2snap").string();
+    std::string err;
+    int failures = 0;
+
+    SnapshotRig a(rom, rom_size, fast_ram);
+    uint64_t s = 0xD1B54A32D192ED03ULL;
+    for (int i = 0; i < 500000; i++) snapshotStep(a, s);
+    if (!a.snapshots.save(base_path, false, err)) {
+        printf("  full save: %s\n", err.c_str());
+        failures++;
+    }
+    for (int i = 0; i < 5000; i++) snapshotStep(a, s);
+    if (!a.snapshots.save(incr_path, true, err)) {
+        printf("  incremental save: %s\n", err.c_str());
+        failures++;
+    }
+    uint64_t replay_s = s;
+    std::vector<int> reads;
+    for (int i = 0; i < 500000; i++) reads.push_back(snapshotStep(a, s));
+
+    SnapshotRig b(rom, rom_size, fast_ram);
+    if (!failures && !b.snapshots.load(incr_path, err)) {
+        printf("  load: %s\n", err.c_str());
+        failures++;
+    }
+    long mismatches = 0;
+    for (int i = 0; i < 500000 && !failures; i++) {
+        int v = snapshotStep(b, replay_s);
+        if (v != reads[i] && mismatches++ < 10) printf("  step %d: read %d / %d\n", i, reads[i], v);
+    }
+    if (mismatches) failures++;
+    if (memcmp(a.mmu->get_memory_base(), b.mmu->get_memory_base(), a.mmu->get_memory_size()) != 0) {
+        printf("  FPI RAM differs\n");
+        failures++;
+    }
+    if (memcmp(a.megaii->get_memory_base(), b.megaii->get_memory_base(), 128*1024) != 0) {
+        printf("  Mega II RAM differs\n");
+        failures++;
+    }
+    uintmax_t full_size = fs::file_size(base_path, ec);
+    uintmax_t incr_size = fs::file_size(incr_path, ec);
+    fs::remove_all(dir, ec);
+
+    printf("Snapshot check: full %ju bytes, incremental %ju bytes: %s\n", full_size, incr_size, failures ? "FAIL" : "PASS");
+    return failures;
+}
+
 static FILE *open_rom_file(const char *path) {
     FILE *f = fopen(path, "rb");
     if (f) return f;
@@ -265,11 +515,14 @@ static FILE *open_rom_file(const char *path) {
 }
 
 void printUsage(const char *progname) {
-    printf("Usage: %s [-a] [-l] [-3] [-p] [testnum]\n", progname);
+    printf("Usage: %s [-a] [-l] [-3] [-p] [-x] [-s] [-d] [testnum]\n", progname);
     printf("  -a  Emit assembly output (test.asm)\n");
     printf("  -l  Run live test against MMU module (ROM01 128K by default)\n");
     printf("  -3  With -l: use ROM03 256K image (enables is_rom03 / text page 2 shadow)\n");
     printf("  -p  Print the tests\n");
+    printf("  -x  With -l: cross-check the bank $00/$01/$E0/$E1 fast page table against the bank handlers\n");
+    printf("  -s  With -l: save / incremental save / load round trip through SnapshotManager\n");
+    printf("  -d  With -l: cross-check write_block / read_block against byte-at-a-time access\n");
     printf("\nIf no flags are specified, all operations are performed.\n");
 }
 
@@ -279,6 +532,9 @@ int main(int argc, char *argv[])
     bool live_test = false;
     bool print_tests = false;
     bool use_rom03 = false;
+    bool fast_map_check = false;
+    bool snapshot_check = false;
+    bool block_check = false;
     bool any_flag_set = false;
     int testNumber = -1;
     int tests_run = 0;
@@ -287,7 +543,7 @@ int main(int argc, char *argv[])
     std::vector<int> failed_tests;
 
     int opt;
-    while ((opt = getopt(argc, argv, "al3ph")) != -1) {
+    while ((opt = getopt(argc, argv, "al3pxsdh")) != -1) {
         switch (opt) {
             case 'a':
                 emit_assembly = true;
@@ -305,6 +561,18 @@ int main(int argc, char *argv[])
                 print_tests = true;
                 any_flag_set = true;
                 break;
+            case 'x':
+                fast_map_check = true;
+                any_flag_set = true;
+                break;
+            case 's':
+                snapshot_check = true;
+                any_flag_set = true;
+                break;
+            case 'd':
+                block_check = true;
+                any_flag_set = true;
+                break;
             case 'h':
                 printUsage(argv[0]);
                 return 0;
@@ -396,6 +664,10 @@ int main(int argc, char *argv[])
         delete mmu_iigs;
         delete mmu_iie;
 
+        if (fast_map_check && runFastMapCheck(rom.data(), rom_size, fast_ram)) tests_failed++;
+        if (snapshot_check && runSnapshotCheck(rom.data(), rom_size, fast_ram)) tests_failed++;
+        if (block_check && runBlockCheck(rom.data(), rom_size, fast_ram)) tests_failed++;
+
         printf("\n===== %s: %d tests run, %d failed, %d assertion failures =====\n",
                tests_failed ? "FAILURES" : "ALL PASS",
                tests_run, tests_failed, assertion_failures);
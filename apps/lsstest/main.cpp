@@ -0,0 +1,161 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * lsstest --check
+ *
+ * Feeds the same track bitstream to two 5.25 drives. One is read through
+ * DiskII_WOZ_Controller::readshift() (a byte per table lookup where it can),
+ * the other one bit cell at a time through read_pulse() and readshift_step(),
+ * in the same catch-up sized chunks fast_forward() hands out. After every
+ * chunk the data latch, the sequencer state, the read position and the
+ * fake-bit generator must agree. Tracks: random bits (lots of zero runs),
+ * nibble tracks with sync runs, odd lengths, a track shorter than a byte and
+ * an empty one.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "devices/diskii/diskii_controller.hpp"
+
+uint64_t debug_level = 0;
+
+namespace {
+
+/**
+ * A 5.25 drive spinning over a track the test builds, with its read state exposed.
+ * The head is never moved by the clock here, so it has none.
+ */
+struct TestDrive : Floppy525_woz {
+    TestDrive() : Floppy525_woz(nullptr, nullptr, nullptr, 6, 0) {}
+
+    void insert(woz_track_t *track, uint64_t start_bit) {
+        cur_track_ptr = track;
+        enable = true;
+        read_position = start_bit * POSITION_FP_MUL;
+    }
+    bool same_as(const TestDrive &o) const {
+        return read_position == o.read_position && random_bits == o.random_bits
+            && (windowBits & 0xF) == (o.windowBits & 0xF);
+    }
+    uint64_t bit_position() const { return read_position >> POSITION_FP_SHIFT; }
+};
+
+void put_bits(woz_track_t &t, uint32_t value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        if (t.bit_count % 8 == 0) t.bits.push_back(0);
+        if ((value >> i) & 1) t.bits.back() |= 0x80 >> (t.bit_count % 8);
+        t.bit_count++;
+    }
+}
+
+woz_track_t random_track(std::mt19937 &rng, uint32_t bit_count) {
+    woz_track_t t;
+    for (uint32_t i = 0; i < bit_count; i++) put_bits(t, rng() & 1, 1);
+    return t;
+}
+
+/** Disk bytes (bit 7 set, no two zeros in a row) between runs of 10-bit sync FFs. */
+woz_track_t nibble_track(std::mt19937 &rng, uint32_t min_bits) {
+    std::vector<uint8_t> nibbles;
+    for (int b = 0x96; b <= 0xFF; b++) {
+        if (!(~b & (~b >> 1) & 0x7F)) nibbles.push_back(b);
+    }
+    woz_track_t t;
+    while (t.bit_count < min_bits) {
+        int sync = 5 + rng() % 12;
+        for (int i = 0; i < sync; i++) put_bits(t, 0xFF << 2, 10);
+        int data = 20 + rng() % 360;
+        for (int i = 0; i < data; i++) put_bits(t, nibbles[rng() % nibbles.size()], 8);
+    }
+    return t;
+}
+
+bool run_track(const char *name, woz_track_t &track, std::mt19937 &rng, uint64_t &total_bits, uint64_t &nibbles) {
+    TestDrive fast, slow;
+    uint64_t start = track.bit_count ? rng() % track.bit_count : 0;
+    fast.insert(&track, start);
+    slow.insert(&track, start);
+
+    uint8_t fast_dr = (uint8_t)rng(), slow_dr = fast_dr;
+    bool fast_ss = rng() & 1, slow_ss = fast_ss;
+
+    // three turns of the disk, or a while on tiny tracks
+    const uint64_t bits = track.bit_count > 1000 ? track.bit_count * 3ull : 20000;
+    for (uint64_t done = 0; done < bits;) {
+        uint64_t chunk = 1 + rng() % 32;     // fast_forward() caps a catch-up at 32 bits
+        if (rng() % 4 == 0) chunk = 32;
+        DiskII_WOZ_Controller::readshift(fast, fast_dr, fast_ss, chunk);
+        for (uint64_t i = 0; i < chunk; i++) {
+            DiskII_WOZ_Controller::readshift_step(slow_dr, slow_ss, slow.read_pulse());
+            if (slow_dr & 0x80 && !slow_ss) nibbles++;
+        }
+        if (fast_dr != slow_dr || fast_ss != slow_ss || !fast.same_as(slow)) {
+            printf("%s: after %llu bits from %llu: latch %02X/%d, expected %02X/%d, bit %llu, expected %llu\n",
+                name, (unsigned long long)(done + chunk), (unsigned long long)start, fast_dr, fast_ss, slow_dr, slow_ss,
+                (unsigned long long)fast.bit_position(), (unsigned long long)slow.bit_position());
+            return false;
+        }
+        done += chunk;
+        total_bits += chunk;
+    }
+    return true;
+}
+
+bool run_check() {
+    std::mt19937 rng(0x1557E57);
+    uint64_t total_bits = 0, nibbles = 0;
+    int tracks = 0;
+
+    for (int i = 0; i < 40; i++, tracks++) {
+        woz_track_t t = random_track(rng, 6000 + rng() % 50000);
+        if (!run_track("random", t, rng, total_bits, nibbles)) return false;
+    }
+    for (int i = 0; i < 40; i++, tracks++) {
+        woz_track_t t = nibble_track(rng, 50000 + rng() % 2000);
+        if (!run_track("nibble", t, rng, total_bits, nibbles)) return false;
+    }
+    for (uint32_t len : {1u, 7u, 8u, 9u, 15u, 16u, 17u, 51021u, 50304u, 53248u}) {
+        woz_track_t t = (len & 1) ? random_track(rng, len) : nibble_track(rng, len);
+        t.bit_count = len;      // nibble_track() overshoots; the tail bits are just ignored
+        if (!run_track("length", t, rng, total_bits, nibbles)) return false;
+        tracks++;
+    }
+    woz_track_t empty;
+    if (!run_track("empty", empty, rng, total_bits, nibbles)) return false;
+    tracks++;
+
+    printf("readshift check: %d tracks, %llu bits, %llu nibbles: PASS\n",
+        tracks, (unsigned long long)total_bits, (unsigned long long)nibbles);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            return run_check() ? 0 : 1;
+        }
+    }
+    printf("usage: lsstest --check\n");
+    return 1;
+}
@@ -0,0 +1,183 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * ntsctest --golden
+ *
+ * Golden-image check of the NTSC560 renderer. Frames of dots (random, solid,
+ * alternating, hires-like byte patterns, sparse) with every mix of color burst,
+ * phase offset and display shift are rendered by NTSC560::render() and by the
+ * original one-pixel-at-a-time NTSC560::render_reference(); the RGBA frames must
+ * be byte-identical. On x86 this runs once with the AVX2 loop (when the host has
+ * it) and once without. Then both are timed.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include "gs2.hpp"
+#include "devices/displaypp/frame/Frames.hpp"
+#include "devices/displaypp/render/NTSC560.hpp"
+
+gs2_app_t gs2_app_values;
+
+namespace {
+
+struct xorshift {
+    uint64_t s;
+    uint64_t next() {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        return s;
+    }
+};
+
+enum pattern_t { PAT_RANDOM, PAT_SOLID, PAT_ALTERNATE, PAT_HIRES, PAT_SPARSE, PAT_COUNT };
+const char *pattern_names[PAT_COUNT] = { "random", "solid", "alternate", "hires", "sparse" };
+
+/* Fill the 192 visible lines. Line modes cycle through burst on/off and both phases. */
+void fill_frame(Frame560 *f, pattern_t pat, xorshift &rng) {
+    for (uint32_t y = 0; y < 192; y++) {
+        f->set_line(y);
+        uint8_t hires_byte = 0;
+        for (uint32_t x = 0; x < 560; x++) {
+            uint8_t dot = 0;
+            switch (pat) {
+                case PAT_RANDOM:    dot = rng.next() & 1; break;
+                case PAT_SOLID:     dot = 1; break;
+                case PAT_ALTERNATE: dot = (x + y) & 1; break;
+                case PAT_HIRES:
+                    // 7 dots per byte, each doubled, as the composite generator lays them out
+                    if ((x % 14) == 0) hires_byte = (uint8_t)rng.next();
+                    dot = (hires_byte >> ((x % 14) / 2)) & 1;
+                    break;
+                case PAT_SPARSE:    dot = (rng.next() % 29) == 0; break;
+                default: break;
+            }
+            // The renderer treats any non-zero byte as a dot.
+            if (dot && (rng.next() & 7) == 0) dot = 0x80;
+            f->push(dot);
+        }
+        color_mode_t mode = {};
+        mode.colorburst = (y % 5) != 0;
+        mode.phase_offset = (y / 3) & 1;
+        mode.mixed_mode = 0;
+        f->set_color_mode(y, mode);
+    }
+}
+
+/* Render each case with NTSC560::render() and the reference; returns the number that differ. */
+int check_golden(const char *path, Frame560 *src, FrameVSG *ref, FrameVSG *out) {
+    NTSC560 ntsc;
+    xorshift rng{0x4E545343'35363021ull};
+    int failures = 0;
+    int cases = 0;
+
+    for (int shift = 0; shift < 2; shift++) {
+        ntsc.set_shift_enabled(shift != 0);
+        for (int pat = 0; pat < PAT_COUNT; pat++) {
+            for (int rep = 0; rep < 4; rep++) {
+                ntsc.set_mono_color(RGBA_t::make((uint8_t)rng.next(), (uint8_t)rng.next(), (uint8_t)rng.next(), 0xFF));
+                fill_frame(src, (pattern_t)pat, rng);
+                ref->clear(RGBA_t::make(0x12, 0x34, 0x56, 0x78));
+                out->clear(RGBA_t::make(0x12, 0x34, 0x56, 0x78));
+                ntsc.render_reference(src, ref);
+                ntsc.render(src, out);
+                cases++;
+                if (memcmp(ref->data(), out->data(), 910 * 263 * sizeof(RGBA_t)) != 0) {
+                    const RGBA_t *a = ref->data();
+                    const RGBA_t *b = out->data();
+                    uint32_t i = 0;
+                    while (a[i] == b[i]) i++;
+                    printf("FAIL (%s): %s shift=%d rep=%d: first difference at line %u x %u (%08X vs %08X)\n",
+                        path, pattern_names[pat], shift, rep, i / 910, i % 910, a[i].rgba, b[i].rgba);
+                    failures++;
+                }
+            }
+        }
+    }
+    printf("ntsc golden (%s): %d cases, %d failed\n", path, cases, failures);
+    return failures;
+}
+
+bool run_golden() {
+    Frame560 *src = new Frame560(560, 263);
+    FrameVSG *ref = new FrameVSG(910, 263);
+    FrameVSG *out = new FrameVSG(910, 263);
+    int failures = 0;
+#if defined(NTSC560_AVX2_DISPATCH)
+    const bool host_avx2 = NTSC560::use_avx2;
+    if (host_avx2) failures += check_golden("avx2", src, ref, out);
+    NTSC560::use_avx2 = false;
+    failures += check_golden("portable", src, ref, out);
+    NTSC560::use_avx2 = host_avx2;
+#else
+    failures += check_golden("portable", src, ref, out);
+#endif
+
+    // Timing, on the random pattern with every line in color.
+    NTSC560 ntsc;
+    xorshift rng{0x54494D45'4E545343ull};
+    fill_frame(src, PAT_RANDOM, rng);
+    for (uint32_t y = 0; y < 192; y++) {
+        color_mode_t mode = {};
+        mode.colorburst = 1;
+        mode.phase_offset = y & 1;
+        src->set_color_mode(y, mode);
+    }
+    constexpr int FRAMES = 600;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; i++) ntsc.render_reference(src, ref);
+    auto t1 = std::chrono::steady_clock::now();
+    const double ref_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / FRAMES;
+    auto time_render = [&](const char *path) {
+        auto t2 = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; i++) ntsc.render(src, out);
+        auto t3 = std::chrono::steady_clock::now();
+        double new_us = std::chrono::duration<double, std::micro>(t3 - t2).count() / FRAMES;
+        printf("ntsc timing: reference %.1f us/frame, render (%s) %.1f us/frame (%.2fx)\n",
+            ref_us, path, new_us, new_us > 0 ? ref_us / new_us : 0.0);
+    };
+#if defined(NTSC560_AVX2_DISPATCH)
+    if (host_avx2) time_render("avx2");
+    NTSC560::use_avx2 = false;
+    time_render("portable");
+    NTSC560::use_avx2 = host_avx2;
+#else
+    time_render("portable");
+#endif
+
+    delete src;
+    delete ref;
+    delete out;
+    return failures == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--golden") == 0) {
+            return run_golden() ? 0 : 1;
+        }
+    }
+    printf("usage: ntsctest --golden\n");
+    return 1;
+}
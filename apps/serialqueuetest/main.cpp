@@ -0,0 +1,155 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * serialqueuetest --check
+ *
+ * Two-thread check of SerialQueue. A producer thread streams numbered messages
+ * through a deliberately small queue, pausing now and then so the consumer goes
+ * to sleep in wait(); the consumer must see every message, in order. Then two
+ * threads ping-pong a message through a pair of queues and the mean round trip
+ * is reported - this is the latency a device thread adds to each exchange.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include <SDL3/SDL.h>
+
+#include "serial_devices/SerialDevice.hpp"
+
+namespace {
+
+constexpr uint64_t STREAM_COUNT = 500'000;
+constexpr uint32_t PINGS = 20'000;
+
+struct stream_state {
+    SerialQueue q{64};
+    uint64_t full_retries = 0;
+};
+
+int SDLCALL stream_producer(void *data) {
+    stream_state *s = (stream_state *)data;
+    for (uint64_t i = 0; i < STREAM_COUNT; i++) {
+        while (!s->q.send(SerialMessage{MESSAGE_DATA, i})) {
+            s->full_retries++;
+            SDL_Delay(0);
+        }
+        if ((i & 0x3FFF) == 0x3FFF) SDL_Delay(1); // let the consumer fall asleep
+    }
+    while (!s->q.send(SerialMessage{MESSAGE_SHUTDOWN, 0})) SDL_Delay(0);
+    return 0;
+}
+
+bool run_stream() {
+    stream_state s;
+    SDL_Thread *t = SDL_CreateThread(stream_producer, "producer", &s);
+    uint64_t expect = 0;
+    uint64_t wakeups = 0;
+    bool ok = true;
+    bool done = false;
+    while (!done) {
+        s.q.wait(-1);
+        wakeups++;
+        while (!s.q.is_empty()) {
+            SerialMessage msg = s.q.get();
+            if (msg.type == MESSAGE_SHUTDOWN) {
+                done = true;
+                break;
+            }
+            if (msg.type != MESSAGE_DATA || msg.data != expect) {
+                printf("FAIL: stream message %llu: type %d data %llu\n",
+                    (unsigned long long)expect, msg.type, (unsigned long long)msg.data);
+                ok = false;
+                done = true;
+                break;
+            }
+            expect++;
+        }
+    }
+    SDL_WaitThread(t, nullptr);
+    if (ok && expect != STREAM_COUNT) {
+        printf("FAIL: stream ended after %llu of %llu messages\n",
+            (unsigned long long)expect, (unsigned long long)STREAM_COUNT);
+        ok = false;
+    }
+
+    // A wakeup left on the doorbell would make this return at once.
+    uint64_t t0 = SDL_GetTicksNS();
+    bool got = s.q.wait(20);
+    uint64_t waited_ms = (SDL_GetTicksNS() - t0) / 1'000'000;
+    if (got || waited_ms < 15) {
+        printf("FAIL: wait() on an empty queue returned %d after %llu ms\n", got, (unsigned long long)waited_ms);
+        ok = false;
+    }
+    printf("serialqueue stream: %llu messages through depth %u, %llu consumer wakeups, %llu full retries: %s\n",
+        (unsigned long long)expect, s.q.get_depth(), (unsigned long long)wakeups,
+        (unsigned long long)s.full_retries, ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+struct pingpong_state {
+    SerialQueue to_dev;
+    SerialQueue to_host;
+};
+
+int SDLCALL echo_device(void *data) {
+    pingpong_state *s = (pingpong_state *)data;
+    while (true) {
+        s->to_dev.wait(-1);
+        SerialMessage msg = s->to_dev.get();
+        if (msg.type == MESSAGE_SHUTDOWN) return 0;
+        if (msg.type == MESSAGE_DATA) s->to_host.send(msg);
+    }
+}
+
+bool run_pingpong() {
+    pingpong_state s;
+    SDL_Thread *t = SDL_CreateThread(echo_device, "echo", &s);
+    bool ok = true;
+    uint64_t t0 = SDL_GetTicksNS();
+    for (uint32_t i = 0; i < PINGS && ok; i++) {
+        s.to_dev.send(SerialMessage{MESSAGE_DATA, i});
+        s.to_host.wait(1000);
+        SerialMessage msg = s.to_host.get();
+        if (msg.type != MESSAGE_DATA || msg.data != i) {
+            printf("FAIL: ping %u came back as type %d data %llu\n", i, msg.type, (unsigned long long)msg.data);
+            ok = false;
+        }
+    }
+    uint64_t t1 = SDL_GetTicksNS();
+    s.to_dev.send(SerialMessage{MESSAGE_SHUTDOWN, 0});
+    SDL_WaitThread(t, nullptr);
+    printf("serialqueue ping-pong: %u round trips, %.1f us each: %s\n",
+        PINGS, (double)(t1 - t0) / 1000.0 / PINGS, ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            bool ok = run_stream();
+            ok = run_pingpong() && ok;
+            return ok ? 0 : 1;
+        }
+    }
+    printf("usage: serialqueuetest --check\n");
+    return 1;
+}
@@ -0,0 +1,465 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * snapshottest --check
+ *
+ * Save -> load -> compare round trips for the device state handlers:
+ *   - SnapshotIO::cycle_time rebasing onto a later clock;
+ *   - EventTimer queues (whole queue and single instance), loaded on a
+ *     machine whose clock is elsewhere and whose power-on queue differs;
+ *   - a 6522 mid-count, which must keep counting and interrupt exactly as
+ *     the original does;
+ *   - the AY8910 pair with queued register writes, loaded at two different
+ *     clock positions, which must produce the same samples;
+ *   - SnapshotManager::load on damaged files (a corrupt or truncated page in
+ *     the last RAM region, a region of the wrong size, a missing parent, a
+ *     truncated state chunk after one that loaded), none of which may change
+ *     the machine's RAM or state.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "NClock.hpp"
+#include "util/EventTimer.hpp"
+#include "util/InterruptController.hpp"
+#include "util/Snapshot.hpp"
+#include "devices/mockingboard/W6522.hpp"
+#include "devices/mockingboard/AY8910-2.hpp"
+
+uint64_t debug_level = 0;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool cond, const char *what) {
+    if (!cond) {
+        printf("  FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+template <typename F>
+std::vector<uint8_t> save(F &&handler) {
+    std::vector<uint8_t> out;
+    SnapshotIO io(out);
+    handler(io);
+    return out;
+}
+
+template <typename F>
+bool load(const std::vector<uint8_t> &data, F &&handler) {
+    SnapshotIO io(data.data(), data.size());
+    handler(io);
+    return io.ok();
+}
+
+void check_cycle_time() {
+    uint64_t pending = 1500, unset = 0, past = 10;
+    std::vector<uint8_t> data = save([&](SnapshotIO &io) {
+        io.cycle_time(pending, 1000);
+        io.cycle_time(unset, 1000);
+        io.cycle_time(past, 1000);
+    });
+
+    uint64_t a = 0, b = 7, c = 0;
+    expect(load(data, [&](SnapshotIO &io) {
+        io.cycle_time(a, 90000);
+        io.cycle_time(b, 90000);
+        io.cycle_time(c, 90000);
+    }), "cycle_time: load ran short");
+    expect(a == 90500, "cycle_time: future time rebased onto the new clock");
+    expect(b == 0, "cycle_time: unset time stays unset");
+    expect(c == 90000 - 990, "cycle_time: past time rebased onto the new clock");
+
+    // a time further in the past than the loading clock has run stays set
+    expect(load(data, [&](SnapshotIO &io) {
+        io.cycle_time(a, 400);
+        io.cycle_time(b, 400);
+        io.cycle_time(c, 400);
+    }), "cycle_time: second load ran short");
+    expect(a == 900 && b == 0 && c == 1, "cycle_time: underflow clamps to 1, not 0");
+}
+
+struct Fired {
+    std::vector<std::pair<uint64_t, uint64_t>> log; // instance, cycle
+    uint64_t now = 0;
+};
+
+void on_event(uint64_t id, void *ud) {
+    Fired *f = (Fired *)ud;
+    f->log.push_back({id, f->now});
+}
+
+void run_until(EventTimer &t, Fired &f, uint64_t until) {
+    for (f.now = 0; f.now <= until; f.now++) {
+        if (t.isEventPassed(f.now)) t.processEvents(f.now);
+    }
+}
+
+void check_event_timer() {
+    Fired fa, fb;
+    EventTimer a;
+    a.scheduleEvent(1100, on_event, 1, &fa);
+    a.scheduleEvent(1300, on_event, 2, &fa);
+    a.scheduleEvent(1200, on_event, 3, &fa);     // never scheduled on the loading side
+    std::vector<uint8_t> data = save([&](SnapshotIO &io) { a.snapshot(io, 1000); });
+
+    // the loading machine has its own power-on queue: 1 and 2 exist (2 cancelled),
+    // and 4 is pending but wasn't in the saved machine.
+    EventTimer b;
+    uint64_t deadline = 12345;
+    b.set_deadline_reset(&deadline);
+    b.scheduleEvent(5, on_event, 1, &fb);
+    b.scheduleEvent(7, on_event, 2, &fb);
+    b.cancelEvents(2);
+    b.scheduleEvent(8000, on_event, 4, &fb);
+    deadline = 12345;
+    expect(load(data, [&](SnapshotIO &io) { b.snapshot(io, 5000); }), "events: load ran short");
+
+    uint64_t at = 0;
+    expect(b.isPending(1, at) && at == 5100, "events: instance 1 rebased");
+    expect(b.isPending(2, at) && at == 5300, "events: cancelled instance re-armed");
+    expect(!b.isPending(3, at), "events: instance without a callback is dropped");
+    expect(!b.isPending(4, at), "events: power-on event not in the snapshot is gone");
+    expect(b.getNextEventCycle() == 5100, "events: next event recomputed");
+    expect(deadline == 0, "events: cached deadline reset");
+
+    run_until(b, fb, 6000);
+    std::vector<std::pair<uint64_t, uint64_t>> want = {{1, 5100}, {2, 5300}};
+    expect(fb.log == want, "events: restored queue fires in order at the rebased cycles");
+
+    // a single instance the loading machine has never scheduled
+    Fired fc;
+    EventTimer c, d;
+    c.scheduleEvent(2600, on_event, 9, &fc);
+    std::vector<uint8_t> one = save([&](SnapshotIO &io) {
+        c.snapshot_event(io, 2000, 9, on_event, &fc);
+        c.snapshot_event(io, 2000, 10, on_event, &fc);
+    });
+    d.scheduleEvent(100, on_event, 10, &fc);
+    expect(load(one, [&](SnapshotIO &io) {
+        d.snapshot_event(io, 300, 9, on_event, &fc);
+        d.snapshot_event(io, 300, 10, on_event, &fc);
+    }), "event: load ran short");
+    expect(d.isPending(9, at) && at == 900, "event: new instance armed at the rebased cycle");
+    expect(!d.isPending(10, at), "event: instance not pending when saved is cancelled");
+
+    // loading what was just saved gives back the same bytes
+    std::vector<uint8_t> again = save([&](SnapshotIO &io) { b.snapshot(io, 5000); });
+    EventTimer e;
+    e.scheduleEvent(1, on_event, 1, &fb);
+    e.scheduleEvent(1, on_event, 2, &fb);
+    load(again, [&](SnapshotIO &io) { e.snapshot(io, 5000); });
+    expect(save([&](SnapshotIO &io) { e.snapshot(io, 5000); }) == again, "events: save -> load -> save is stable");
+}
+
+void check_6522() {
+    InterruptController irq_a, irq_b;
+    N6522 a("A", nullptr, &irq_a, 4, 0);
+    a.write(0x03, 0xFF);    // DDRA
+    a.write(0x01, 0x5A);    // ORA
+    a.write(0x0B, 0x40);    // ACR: T1 free-running
+    a.write(0x0E, 0xC0);    // IER: T1
+    a.write(0x04, 0x34);    // T1C_L
+    a.write(0x05, 0x01);    // T1C_H: start
+    a.write(0x08, 0x80);    // T2L_L
+    a.write(0x09, 0x02);    // T2C_H: one-shot
+    for (int i = 0; i < 500; i++) a.incr_cycle();
+    a.read(0x04);           // clear the T1 interrupt
+    for (int i = 0; i < 77; i++) a.incr_cycle();
+
+    std::vector<uint8_t> data = save([&](SnapshotIO &io) { a.snapshot(io); });
+
+    // a different slot and chip start with different timer garbage
+    N6522 b("B", nullptr, &irq_b, 5, 1);
+    expect(load(data, [&](SnapshotIO &io) { b.snapshot(io); }), "6522: load ran short");
+    expect(save([&](SnapshotIO &io) { b.snapshot(io); }) == data, "6522: save -> load -> save is stable");
+
+    bool same = true;
+    for (int i = 0; i < 2000 && same; i++) {
+        a.incr_cycle();
+        b.incr_cycle();
+        same = a.read(0x0D) == b.read(0x0D) && a.read(0x08) == b.read(0x08) && a.read(0x05) == b.read(0x05)
+            && irq_a.any_irq_asserted() == irq_b.any_irq_asserted();
+        if (i % 300 == 299) {
+            a.read(0x04);
+            b.read(0x04);
+        }
+    }
+    expect(same, "6522: restored timers count and interrupt like the original");
+    expect(a.read(0x01) == b.read(0x01), "6522: port A");
+}
+
+constexpr uint32_t AY_RATE = 44100;
+
+void ay_write(AY8910s &ay, uint64_t cycle, uint8_t chip, uint8_t reg, uint8_t value) {
+    ay.queueRegisterChange(cycle, chip, reg, value);
+}
+
+void check_ay8910() {
+    NClock clock;
+    std::vector<float> buf_a, buf_b, buf_c;
+    AY8910s a(&buf_a, nullptr, &clock, nullptr, AY_RATE);
+    a.reset();
+
+    // tone on A, noise on B, enveloped tone on C, for both chips
+    for (uint8_t chip = 0; chip < 2; chip++) {
+        ay_write(a, 100, chip, 0, 0x40 + chip);
+        ay_write(a, 100, chip, 4, 0x25);
+        ay_write(a, 100, chip, 6, 0x0C);
+        ay_write(a, 100, chip, 7, 0x30);
+        ay_write(a, 100, chip, 8, 0x0F);
+        ay_write(a, 100, chip, 9, 0x0A);
+        ay_write(a, 100, chip, 10, 0x10);
+        ay_write(a, 100, chip, 11, 0x30);
+        ay_write(a, 100, chip, 13, 0x0E);
+    }
+    a.generateSamples(700);
+
+    // a change still queued, beyond the last generated sample
+    const uint64_t now = 700ull * clock.get_vid_cycles_per_second() / AY_RATE;
+    ay_write(a, now + 600, 0, 8, 0x04);
+    ay_write(a, now + 900, 1, 2, 0x99);
+    std::vector<uint8_t> data = save([&](SnapshotIO &io) { a.snapshot(io, now); });
+
+    // loaded at the same cycle it was saved at: saving again gives the same bytes
+    AY8910s b(&buf_b, nullptr, &clock, nullptr, AY_RATE);
+    expect(load(data, [&](SnapshotIO &io) { b.snapshot(io, now); }), "ay8910: load ran short");
+    expect(save([&](SnapshotIO &io) { b.snapshot(io, now); }) == data, "ay8910: save -> load -> save is stable");
+
+    // loaded on a machine whose clock has run much further: same sound
+    AY8910s c(&buf_c, nullptr, &clock, nullptr, AY_RATE);
+    expect(load(data, [&](SnapshotIO &io) { c.snapshot(io, now + 123456789); }), "ay8910: shifted load ran short");
+
+    buf_b.clear();
+    buf_c.clear();
+    b.generateSamples(3000);
+    c.generateSamples(3000);
+    expect(buf_b.size() == buf_c.size() && buf_b == buf_c, "ay8910: rebased generators produce the same samples");
+    expect(b.chips[0].registers[8] == 0x04 && c.chips[0].registers[8] == 0x04, "ay8910: queued write applied after load");
+
+    bool silent = true;
+    for (float s : buf_c) if (s != 0.0f) silent = false;
+    expect(!silent, "ay8910: restored generators make sound");
+}
+
+/* A small machine for SnapshotManager: two RAM regions and two state handlers. */
+struct SnapMachine {
+    std::vector<uint8_t> main_ram = std::vector<uint8_t>(3 * SnapshotManager::PAGE_SIZE);
+    std::vector<uint8_t> aux_ram;
+    uint32_t first = 0;
+    uint64_t second[4] = {};
+    SnapshotManager snapshots{0x42};
+
+    explicit SnapMachine(size_t aux_pages = 1) : aux_ram(aux_pages * SnapshotManager::PAGE_SIZE) {
+        snapshots.register_state_handler("first", [this](SnapshotIO &io) { io.field(first); });
+        snapshots.register_state_handler("second", [this](SnapshotIO &io) {
+            for (uint64_t &v : second) io.field(v);
+        });
+        snapshots.register_ram_region("main", main_ram.data(), main_ram.size());
+        snapshots.register_ram_region("aux", aux_ram.data(), aux_ram.size());
+    }
+
+    // Pages that save as raw, as PackBits and as zero.
+    void fill(uint32_t seed) {
+        uint32_t x = seed;
+        for (size_t i = 0; i < SnapshotManager::PAGE_SIZE; i++) {
+            x = x * 1664525u + 1013904223u;
+            main_ram[i] = (uint8_t)(x >> 24);
+        }
+        for (size_t i = SnapshotManager::PAGE_SIZE; i < main_ram.size(); i++) main_ram[i] = (uint8_t)(seed + i / 64);
+        std::fill(aux_ram.begin(), aux_ram.end(), 0);
+        for (size_t i = 0; i < aux_ram.size(); i += 97) aux_ram[i] = (uint8_t)(seed ^ i);
+        first = seed;
+        for (int i = 0; i < 4; i++) second[i] = (uint64_t)seed * 0x9E3779B97F4A7C15ULL + i;
+    }
+
+    bool same_as(const SnapMachine &o) const {
+        return main_ram == o.main_ram && aux_ram == o.aux_ram && first == o.first &&
+            memcmp(second, o.second, sizeof(second)) == 0;
+    }
+};
+
+struct SnapChunk {
+    uint32_t tag;
+    std::vector<uint8_t> data;
+};
+
+uint32_t le32(const uint8_t *p) { return (uint32_t)p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+std::vector<uint8_t> read_file(const std::string &path) {
+    std::vector<uint8_t> out;
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (!fp) return out;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) out.insert(out.end(), buf, buf + n);
+    fclose(fp);
+    return out;
+}
+
+void write_file(const std::string &path, const std::vector<uint8_t> &data) {
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp) return;
+    fwrite(data.data(), 1, data.size(), fp);
+    fclose(fp);
+}
+
+// Header, then the chunks up to (not including) END.
+std::vector<SnapChunk> split_snapshot(const std::vector<uint8_t> &file, std::vector<uint8_t> &header) {
+    std::vector<SnapChunk> chunks;
+    header.assign(file.begin(), file.begin() + 32);
+    size_t pos = 32;
+    while (pos + 16 <= file.size()) {
+        uint32_t tag = le32(&file[pos]);
+        uint64_t len = le32(&file[pos + 8]) | ((uint64_t)le32(&file[pos + 12]) << 32);
+        pos += 16;
+        if (tag == le32((const uint8_t *)"END ")) break;
+        chunks.push_back({tag, std::vector<uint8_t>(file.begin() + pos, file.begin() + pos + len)});
+        pos += len;
+    }
+    return chunks;
+}
+
+std::vector<uint8_t> join_snapshot(const std::vector<uint8_t> &header, const std::vector<SnapChunk> &chunks) {
+    std::vector<uint8_t> out = header;
+    auto put = [&](uint32_t tag, const std::vector<uint8_t> &data) {
+        uint64_t len = data.size();
+        for (int i = 0; i < 4; i++) out.push_back((uint8_t)(tag >> (8 * i)));
+        for (int i = 0; i < 4; i++) out.push_back(0);
+        for (int i = 0; i < 8; i++) out.push_back((uint8_t)(len >> (8 * i)));
+        out.insert(out.end(), data.begin(), data.end());
+    };
+    for (const SnapChunk &c : chunks) put(c.tag, c.data);
+    put(le32((const uint8_t *)"END "), {});
+    return out;
+}
+
+SnapChunk *find_chunk(std::vector<SnapChunk> &chunks, const char *tag, const char *name) {
+    for (SnapChunk &c : chunks) {
+        if (c.tag == le32((const uint8_t *)tag) && c.data.size() >= 2 + strlen(name) &&
+            memcmp(c.data.data() + 2, name, strlen(name)) == 0) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
+void check_failed_load() {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path dir = fs::temp_directory_path(ec) / ("snapshottest_" + std::to_string(getpid()));
+    fs::create_directories(dir, ec);
+    const std::string full_path = (dir / "full.gs2snap").string();
+    const std::string incr_path = (dir / "incr.gs2snap").string();
+    const std::string bad_path = (dir / "bad.gs2snap").string();
+    std::string err;
+
+    SnapMachine saver;
+    saver.fill(11);
+    expect(saver.snapshots.save(full_path, false, err), "load: full save");
+    SnapMachine full_state = saver;
+    saver.fill(12);
+    expect(saver.snapshots.save(incr_path, true, err), "load: incremental save");
+    SnapMachine incr_state = saver;
+
+    std::vector<uint8_t> header;
+    const std::vector<SnapChunk> full_chunks = split_snapshot(read_file(full_path), header);
+    std::vector<uint8_t> full_header = header;
+
+    // Each damaged file must fail to load and leave the machine exactly as it was.
+    auto expect_rejected = [&](SnapMachine &m, const std::string &path, const char *what) {
+        m.fill(99);
+        SnapMachine before = m;
+        std::string e;
+        bool loaded = m.snapshots.load(path, e);
+        expect(!loaded, what);
+        expect(m.same_as(before), what);
+    };
+
+    SnapMachine live;
+
+    std::vector<SnapChunk> chunks = full_chunks;
+    SnapChunk *aux = find_chunk(chunks, "RAM ", "aux");
+    expect(aux && aux->data.size() > 2 + 3 + 8, "load: aux RAM chunk present");
+    if (aux) {
+        aux->data[2 + 3 + 8] = 9;  // page kind
+        write_file(bad_path, join_snapshot(full_header, chunks));
+        expect_rejected(live, bad_path, "load: bad page kind in the last region leaves the machine alone");
+
+        chunks = full_chunks;
+        aux = find_chunk(chunks, "RAM ", "aux");
+        aux->data.resize(aux->data.size() - 3);
+        write_file(bad_path, join_snapshot(full_header, chunks));
+        expect_rejected(live, bad_path, "load: truncated last region leaves the machine alone");
+    }
+
+    SnapMachine bigger(2);
+    expect_rejected(bigger, full_path, "load: region size mismatch leaves the machine alone");
+
+    chunks = full_chunks;
+    SnapChunk *second = find_chunk(chunks, "STAT", "second");
+    expect(second != nullptr, "load: second state chunk present");
+    if (second) {
+        second->data.resize(second->data.size() - 1);
+        write_file(bad_path, join_snapshot(full_header, chunks));
+        expect_rejected(live, bad_path, "load: truncated state puts back RAM and the handlers already run");
+    }
+
+    fs::rename(full_path, bad_path, ec);
+    expect_rejected(live, incr_path, "load: missing parent leaves the machine alone");
+    fs::rename(bad_path, full_path, ec);
+
+    // Undamaged files still load, and the base for later incrementals is the parent.
+    expect(live.snapshots.load(incr_path, err) && live.same_as(incr_state), "load: incremental restores its RAM and state");
+    expect(live.snapshots.get_base_path() == full_path, "load: incremental's parent becomes the base");
+    expect(live.snapshots.load(full_path, err) && live.same_as(full_state), "load: full snapshot restores its RAM and state");
+
+    fs::remove_all(dir, ec);
+}
+
+bool run_check() {
+    check_cycle_time();
+    check_event_timer();
+    check_6522();
+    check_ay8910();
+    check_failed_load();
+    printf("snapshot round trip: %s\n", failures ? "FAIL" : "PASS");
+    return failures == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            return run_check() ? 0 : 1;
+        }
+    }
+    printf("usage: snapshottest --check\n");
+    return 1;
+}
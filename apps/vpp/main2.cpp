@@ -380,8 +380,9 @@ int main(int argc, char **argv) {
     video_scanner_iigs->initialize();
     video_scanner_iigs->set_border_color(0x0F);
 
-    FrameVSG *fr_vsg = new(std::align_val_t(64)) FrameVSG(910, 263, renderer, PIXEL_FORMAT);
+    FrameVSG *fr_vsg = new FrameVSG(910, 263);
     fr_vsg->clear(RGBA_t::make(0xE0, 0x00, 0x00, 0xFF));
+    SDL_Texture *tex_vsg = SDL_CreateTexture(renderer, PIXEL_FORMAT, SDL_TEXTUREACCESS_STREAMING, 910, 263);
     VideoScanGenerator_RGB *vsgr = new VideoScanGenerator_RGB(&iie_rom, false, fr_vsg);
     VideoScanGenerator_Comp *vsgc = new VideoScanGenerator_Comp(&iie_rom, false, fr_vsg);
     VideoScanGeneratorIntf *vsg = vsgr;
@@ -584,7 +585,7 @@ int main(int argc, char **argv) {
                     
                     case SDLK_P:
                         sharpness = (sharpness + 1) % 3;
-                        SDL_SetTextureScaleMode(fr_vsg->get_texture(), scales[sharpness]);
+                        SDL_SetTextureScaleMode(tex_vsg, scales[sharpness]);
                         
                         //SDL_SetTextureScaleMode(txt_shr, scales[sharpness]);
                         printf("Sharpness: %d\n", sharpness);
@@ -753,29 +754,11 @@ int main(int argc, char **argv) {
 
         start = SDL_GetTicksNS();
 
-        // if we are doing partial frame update (e.g., one cycle, or one scanline) we need to read the texture data back into frame.
-        if (cycle_mode != 3 && cycle_mode != 4) {
-            SDL_SetRenderTarget(renderer, stage2);
-            if (!SDL_RenderTexture(renderer, fr_vsg->get_texture(), nullptr, nullptr)) assert(false);
-
-            SDL_Rect irect = { 0, 0, 910, 263 };
-            SDL_Surface *surface = SDL_RenderReadPixels(renderer, &irect);
-            SDL_SetRenderTarget(renderer, nullptr);
-            fr_vsg->open();
-            memcpy(fr_vsg->data(), surface->pixels, 910 * 263 * sizeof(RGBA_t));
-            
-            if (render_mode == 3) vsg->generate_frame(scanbuf);
-            else vsgc->generate_frame(scanbuf);
-            
-            fr_vsg->close();
-            SDL_DestroySurface(surface);
-        } else {
-            // generate new pixmap and update texture all in one.. or just do a partial update, and, copy updated data back into texture.
-            fr_vsg->open();
-            if (render_mode == 3) vsg->generate_frame(scanbuf);
-            else vsgc->generate_frame(scanbuf);
-            fr_vsg->close();
-        }
+        // The frame is plain memory and keeps its contents, so a partial update (one cycle,
+        // one scanline) just draws over the last frame before it is uploaded.
+        if (render_mode == 3) vsg->generate_frame(scanbuf);
+        else vsgc->generate_frame(scanbuf);
+        SDL_UpdateTexture(tex_vsg, nullptr, fr_vsg->data(), FrameVSG::max_width() * sizeof(RGBA_t));
 
         // Content rectangles for use with VSG2
         constexpr SDL_FRect content_rec_vsg2[3][2] = {
@@ -818,7 +801,7 @@ int main(int argc, char **argv) {
         SDL_RenderClear(renderer);
 
         //if (!SDL_RenderTexture(renderer, stage2, &ii_frame_src, &ii_frame_dst)) {
-        if (!SDL_RenderTexture(renderer, fr_vsg->get_texture(), &ii_frame_src, nullptr)) {
+        if (!SDL_RenderTexture(renderer, tex_vsg, &ii_frame_src, nullptr)) {
             printf("Failed to render stage2 texture: %s\n", SDL_GetError());
         }
         static char txt[100];
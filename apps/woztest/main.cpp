@@ -0,0 +1,261 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * woztest --check
+ *
+ * Round trips a WOZ2 file through the lazy loader and in-place writeback:
+ *   - load reads no track bits until a track is asked for, and rejects a
+ *     file whose CRC32 doesn't match;
+ *   - modify some tracks -> writeback -> load again gives the modified
+ *     tracks, the untouched ones unchanged, the same file size and a CRC32
+ *     that still checks;
+ *   - a 5.25 drive writing through write_pulse() flushes its tracks to the
+ *     file at the first frame after the motor stops, not in the motor-off
+ *     itself and not when it is unmounted; the flushed file, as a crash
+ *     would leave it, loads with its CRC cleared, and unmount puts the CRC
+ *     back;
+ *   - a file that can only be opened read-only mounts write-protected and
+ *     its writeback fails without touching it.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/woz.hpp"
+#include "util/media.hpp"
+#include "devices/floppy/Floppy525_woz.hpp"
+
+uint64_t debug_level = 0;
+
+namespace {
+
+int failures = 0;
+
+void expect(bool cond, const char *what) {
+    if (!cond) {
+        printf("  FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+std::vector<uint8_t> read_file(const std::string &path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string &path, const std::vector<uint8_t> &data) {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f.write((const char *)data.data(), data.size());
+}
+
+/** 35 tracks of random bits, each on its quarter-track and the ones either side. */
+std::vector<woz_track_t> make_tracks(std::mt19937 &rng) {
+    std::vector<woz_track_t> tracks(35);
+    for (woz_track_t &t : tracks) {
+        t.bit_count = 50000 + rng() % 2000;
+        t.bits.resize((t.bit_count + 7) / 8);
+        for (uint8_t &b : t.bits) b = (uint8_t)rng();
+        t.bits.back() &= (uint8_t)(0xFF00 >> (((t.bit_count - 1) & 7) + 1));
+    }
+    return tracks;
+}
+
+bool save_image(const std::string &path, const std::vector<woz_track_t> &tracks) {
+    Woz w;
+    woz_image_t &img = w.image();
+    img.tracks = tracks;
+    for (size_t t = 0; t < tracks.size(); t++) {
+        for (int q = -1; q <= 1; q++) {
+            int qt = (int)t * 4 + q;
+            if (qt >= 0 && qt < 160) img.tmap[qt] = (uint8_t)t;
+        }
+    }
+    return w.save(path) == 0;
+}
+
+bool same_bits(Woz &w, const std::vector<woz_track_t> &tracks) {
+    for (size_t t = 0; t < tracks.size(); t++) {
+        const woz_track_t *trk = w.get_track_ptr((int)t * 4);
+        if (!trk || trk->bit_count != tracks[t].bit_count || trk->bits != tracks[t].bits) return false;
+    }
+    return true;
+}
+
+void flip_bits(std::mt19937 &rng, woz_track_t &t, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t bit = rng() % t.bit_count;
+        t.bits[bit >> 3] ^= 0x80 >> (bit & 7);
+    }
+}
+
+void check_writeback(const std::string &path, std::mt19937 &rng) {
+    std::vector<woz_track_t> tracks = make_tracks(rng);
+    expect(save_image(path, tracks), "writeback: save");
+    const size_t size = read_file(path).size();
+
+    Woz a;
+    expect(a.load(path) == 0, "writeback: load");
+    bool lazy = true;
+    for (const woz_track_t &t : a.image().tracks) lazy &= t.bits.empty() && t.file_offset != 0;
+    expect(lazy, "writeback: no track read at load");
+    a.get_track_ptr(17 * 4);
+    expect(!a.image().tracks[17].bits.empty() && a.image().tracks[16].bits.empty(),
+        "writeback: asking for a track reads just that one");
+
+    for (int t : {0, 17, 34}) {
+        woz_track_t *trk = a.get_track_ptr(t * 4);
+        flip_bits(rng, *trk, 300);
+        trk->dirty = true;
+        tracks[t].bits = trk->bits;
+    }
+    expect(a.writeback() == 0, "writeback: writeback");
+    expect(read_file(path).size() == size, "writeback: file size unchanged");
+
+    Woz b;
+    expect(b.load(path) == 0, "writeback: reload passes the CRC check");
+    expect(same_bits(b, tracks), "writeback: reload has the written tracks and the rest unchanged");
+
+    // nothing dirty: writeback leaves the file alone
+    std::vector<uint8_t> before = read_file(path);
+    expect(b.writeback() == 0 && read_file(path) == before, "writeback: clean image writes nothing");
+
+    // a flipped bit in track data the loader never reads must still fail the CRC
+    std::vector<uint8_t> bad = before;
+    bad[bad.size() - 700] ^= 0x10;
+    write_file(path, bad);
+    Woz c;
+    expect(c.load(path) != 0, "crc: corrupt WOZ2 track data is rejected at load");
+}
+
+/** A 5.25 drive with no clock or sound, turned by hand. */
+struct TestDrive : Floppy525_woz {
+    TestDrive() : Floppy525_woz(nullptr, nullptr, nullptr, 6, 0) {}
+    uint64_t get_current_time() override { return 0; }
+    void play_sound(uint64_t) override {}
+    bool is_modified() const { return modified; }
+};
+
+media_descriptor woz_media(const std::string &path) {
+    media_descriptor md;
+    md.filename = path;
+    md.filestub = std::filesystem::path(path).filename().string();
+    md.media_type = MEDIA_WOZ;
+    return md;
+}
+
+void check_idle_flush(const std::string &path, std::mt19937 &rng) {
+    std::vector<woz_track_t> tracks = make_tracks(rng);
+    expect(save_image(path, tracks), "idle: save");
+    media_descriptor md = woz_media(path);
+
+    TestDrive d;
+    expect(d.mount(0, &md), "idle: mount");
+    d.set_enable(true);
+    for (int i = 0; i < 4000; i++) d.write_pulse(rng() & 1);
+    expect(d.is_modified(), "idle: drive modified");
+
+    Woz probe;
+    probe.load(path);
+    expect(same_bits(probe, tracks), "idle: nothing written while the motor runs");
+    const std::vector<uint8_t> spinning = read_file(path);
+
+    d.set_enable(false);
+    expect(d.is_modified() && read_file(path) == spinning,
+        "idle: motor off leaves the write to the frame");
+    d.frame_flush();
+    expect(!d.is_modified(), "idle: frame after motor off flushes");
+    std::vector<uint8_t> flushed = read_file(path);
+    expect(flushed.size() > 12 && flushed[8] == 0 && flushed[9] == 0 && flushed[10] == 0 && flushed[11] == 0,
+        "idle: flush clears the CRC");
+    Woz after;
+    expect(after.load(path) == 0, "idle: flushed file loads as a crash would leave it");
+    expect(!same_bits(after, tracks), "idle: flushed file has the written bits");
+
+    // written again, then unmounted without saving: the file keeps the flushed
+    // tracks and gets its CRC back
+    d.set_enable(true);
+    for (int i = 0; i < 4000; i++) d.write_pulse(rng() & 1);
+    d.unmount(0);
+    std::vector<uint8_t> closed = read_file(path);
+    expect(closed.size() == flushed.size() && std::equal(closed.begin() + 12, closed.end(), flushed.begin() + 12),
+        "idle: unmount without saving doesn't flush");
+    expect(closed[8] | closed[9] | closed[10] | closed[11], "idle: unmount puts the CRC back");
+    Woz sealed;
+    expect(sealed.load(path) == 0, "idle: unmounted file passes the CRC check");
+}
+
+void check_read_only(const std::string &path, std::mt19937 &rng) {
+    std::vector<woz_track_t> tracks = make_tracks(rng);
+    expect(save_image(path, tracks), "read-only: save");
+    namespace fs = std::filesystem;
+    fs::permissions(path, fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read);
+
+    Woz probe;
+    probe.load(path);
+    if (!probe.is_read_only()) {
+        // root (or a filesystem ignoring modes) opens it read-write anyway
+        printf("  read-only: file opened read-write, skipped\n");
+    } else {
+        media_descriptor md = woz_media(path);
+        TestDrive d;
+        expect(d.mount(0, &md), "read-only: mount");
+        expect(md.write_protected && d.get_write_protect(), "read-only: mounted write-protected");
+
+        std::vector<uint8_t> before = read_file(path);
+        woz_track_t *trk = probe.get_track_ptr(0);
+        flip_bits(rng, *trk, 10);
+        trk->dirty = true;
+        expect(probe.writeback() != 0, "read-only: writeback reports an error");
+        expect(read_file(path) == before, "read-only: file untouched");
+    }
+    fs::permissions(path, fs::perms::owner_read | fs::perms::owner_write);
+}
+
+bool run_check() {
+    std::mt19937 rng(0x3020B);
+    std::string path = (std::filesystem::temp_directory_path()
+        / ("woztest_" + std::to_string(std::random_device{}()) + ".woz")).string();
+
+    check_writeback(path, rng);
+    check_idle_flush(path, rng);
+    check_read_only(path, rng);
+    std::filesystem::remove(path);
+
+    printf("woz writeback: %s\n", failures ? "FAIL" : "PASS");
+    return failures == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) {
+            return run_check() ? 0 : 1;
+        }
+    }
+    printf("usage: woztest --check\n");
+    return 1;
+}
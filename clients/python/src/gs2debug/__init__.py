@@ -6,7 +6,9 @@ from .client import (
     HelloInfo,
     StatusInfo,
     StoppedEvent,
+    RamWindow,
     TraceWindow,
+    Update,
     VideoText,
 )
 from .errors import ProtocolError
@@ -27,6 +29,7 @@ from .keys import (
     SCANCODE_UP,
 )
 from .types import (
+    BATCH,
     BP_ACCESS_NONE,
     BP_ACCESS_R,
     BP_ACCESS_RW,
@@ -46,6 +49,7 @@ from .types import (
     ERROR,
     EVENT,
     EVT_RUN_STATE,
+    EVT_UPDATE,
     EVT_STOPPED,
     EXEC_NORMAL,
     EXEC_PAUSED,
@@ -58,12 +62,15 @@ from .types import (
     HELLO,
     KEYEVENT,
     PASTE_TEXT,
+    PASTE_BASIC,
     MEM_ADBMICRO,
     MEM_ENSONIQ,
     MEM_MAIN,
     MEM_MAIN_RAW,
     MEM_MEGAII,
     MEM_MEGAII_RAW,
+    MEMSHARE,
+    MEMSHARE_WRITABLE,
     PAUSE,
     PING,
     QUIT,
@@ -83,6 +90,11 @@ from .types import (
     STATE_GET,
     STATE_SET,
     STEP_INTO,
+    SUB_CLOSED,
+    SUB_MEM,
+    SUB_REGS,
+    SUB_TRACE,
+    SUBSCRIBE,
     DEVICE_ID_DISK_II,
     DEVICE_ID_MOUSE,
     DEVICE_ID_ENSONIQ,
@@ -99,6 +111,7 @@ from .types import (
     MEDIA_UNMOUNT_FAILED,
     MOUNT,
     UNMOUNT,
+    UNSUBSCRIBE,
     VF_80COL,
     VF_ALTCHAR,
     VF_HIRES,
@@ -127,12 +140,17 @@ __all__ = [
     "StatusInfo",
     "BpInfo",
     "StoppedEvent",
+    "RamWindow",
     "TraceWindow",
+    "Update",
     "VideoText",
     "ProtocolError",
     "HELLO",
     "PING",
     "QUIT",
+    "BATCH",
+    "SUBSCRIBE",
+    "UNSUBSCRIBE",
     "ERROR",
     "EVENT",
     "GET_STATUS",
@@ -153,6 +171,8 @@ __all__ = [
     "WRITEMEM",
     "FINDMEM",
     "FINDMEM_HAS_MASK",
+    "MEMSHARE",
+    "MEMSHARE_WRITABLE",
     "REG_PC",
     "REG_PB",
     "REG_DB",
@@ -170,6 +190,7 @@ __all__ = [
     "BP_LIST",
     "KEYEVENT",
     "PASTE_TEXT",
+    "PASTE_BASIC",
     "VIDEO_TEXT",
     "VIDEO_PAGE_CURRENT",
     "VIDEO_MODE_CURRENT",
@@ -206,6 +227,11 @@ __all__ = [
     "BP_FLAG_DATA_MATCH",
     "EVT_STOPPED",
     "EVT_RUN_STATE",
+    "EVT_UPDATE",
+    "SUB_MEM",
+    "SUB_REGS",
+    "SUB_TRACE",
+    "SUB_CLOSED",
     "STOP_BP_EXEC",
     "STOP_BP_DATA",
     "STOP_BP_IO",
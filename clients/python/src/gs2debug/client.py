@@ -2,9 +2,12 @@
 
 from __future__ import annotations
 
+import mmap
+import os
 import socket
 import struct
 import time
+from collections import deque
 from collections.abc import Callable
 from dataclasses import dataclass
 
@@ -12,6 +15,7 @@ from .errors import ProtocolError
 from .frame import HEADER_SIZE, Frame, pack_frame, unpack_header
 from .keys import KMOD_LSHIFT, SCANCODE_LSHIFT, ascii_to_key
 from .types import (
+    BATCH,
     BP_ACCESS_NONE,
     BP_ACCESS_R,
     BP_ACCESS_RW,
@@ -29,6 +33,7 @@ from .types import (
     ERROR,
     EVENT,
     EVT_RUN_STATE,
+    EVT_UPDATE,
     EVT_STOPPED,
     EXEC_NORMAL,
     EXEC_PAUSED,
@@ -40,6 +45,9 @@ from .types import (
     GET_TRACE,
     HELLO,
     KEYEVENT,
+    MEMSHARE,
+    MEMSHARE_WRITABLE,
+    PASTE_BASIC,
     PASTE_TEXT,
     PAUSE,
     PING,
@@ -56,8 +64,14 @@ from .types import (
     STOP_BP_IO,
     STOP_PAUSE,
     STOP_STEP,
+    SUB_CLOSED,
+    SUB_MEM,
+    SUB_REGS,
+    SUB_TRACE,
+    SUBSCRIBE,
     MOUNT,
     UNMOUNT,
+    UNSUBSCRIBE,
     VIDEO_MODE_CURRENT,
     VIDEO_PAGE_CURRENT,
     VIDEO_TEXT,
@@ -139,6 +153,81 @@ class VideoText:
         return lines
 
 
+@dataclass(frozen=True)
+class Update:
+    """EVT_UPDATE: what changed in one subscription since its previous update.
+
+    MEM: ``runs`` of (offset into the range, bytes); the first update is the whole range.
+    REGS: ``regs`` is a 40-byte system_trace_entry_t. TRACE: ``entries`` (40-byte blobs,
+    oldest → newest) and ``dropped``, entries that went by without being sent.
+    ``closed``: the subscription has ended (machine replaced); no data.
+    """
+
+    sub_id: int
+    kind: int
+    closed: bool
+    cycle: int
+    runs: list[tuple[int, bytes]]
+    regs: bytes
+    dropped: int
+    entries: list[bytes]
+
+    def apply(self, buf: bytearray) -> None:
+        """Patch a MEM mirror of the subscribed range with this update's runs."""
+        for offset, data in self.runs:
+            buf[offset : offset + len(data)] = data
+
+
+class RamWindow:
+    """MEMSHARE window: guest RAM mapped in place, plus its page generation table.
+
+    ``memory`` follows the emulated machine live. The server stamps each page that
+    changed with a new generation once per frame; ``changed_since(gen)`` lists the
+    pages stamped after ``gen``. A generation of 0xFFFFFFFF means the window closed
+    (the machine was replaced, or a newer window took over) and stopped updating.
+    """
+
+    CLOSED = 0xFFFFFFFF
+    _TABLE_HEADER = 16
+
+    def __init__(self, ram_fd: int, table_fd: int, size: int, page_size: int, page_count: int, flags: int) -> None:
+        self.size = size
+        self.page_size = page_size
+        self.page_count = page_count
+        self.writable = bool(flags & MEMSHARE_WRITABLE)
+        prot = mmap.PROT_READ | (mmap.PROT_WRITE if self.writable else 0)
+        try:
+            self.memory = mmap.mmap(ram_fd, size, mmap.MAP_SHARED, prot)
+            self._table = mmap.mmap(
+                table_fd, self._TABLE_HEADER + page_count * 4, mmap.MAP_SHARED, mmap.PROT_READ
+            )
+        finally:
+            os.close(ram_fd)
+            os.close(table_fd)
+
+    @property
+    def generation(self) -> int:
+        return struct.unpack_from("<I", self._table, 0)[0]
+
+    @property
+    def closed(self) -> bool:
+        return self.generation == self.CLOSED
+
+    def changed_since(self, generation: int) -> list[int]:
+        """Indices of pages stamped with a generation newer than ``generation``."""
+        stamps = struct.unpack_from(f"<{self.page_count}I", self._table, self._TABLE_HEADER)
+        return [i for i, g in enumerate(stamps) if g > generation]
+
+    def read(self, address: int, length: int) -> bytes:
+        if address < 0 or length < 0 or address + length > self.size:
+            raise ValueError("range outside window")
+        return bytes(self.memory[address : address + length])
+
+    def close(self) -> None:
+        self.memory.close()
+        self._table.close()
+
+
 EventHandler = Callable[[int, int, bytes], None]
 
 
@@ -149,6 +238,8 @@ class Client:
         self._handshaked = False
         self._event_handler: EventHandler | None = None
         self._busy = False
+        self._fds: list[int] = []
+        self._updates: deque[bytes] = deque()
 
     def connect(self, path: str) -> None:
         if self._sock is not None:
@@ -166,6 +257,7 @@ class Client:
             finally:
                 self._sock = None
                 self._handshaked = False
+                self._close_fds()
 
     def on_event(self, handler: EventHandler | None) -> None:
         self._event_handler = handler
@@ -452,6 +544,8 @@ class Client:
         """Wait for EVT_STOPPED and parse the payload."""
         while True:
             event_id, _seq, data = self.wait_event(timeout=timeout)
+            if event_id == EVT_UPDATE and self._event_handler is None:
+                self._updates.append(data)
             if event_id != EVT_STOPPED:
                 continue
             if len(data) < 32:
@@ -472,6 +566,51 @@ class Client:
                 trace=trace,
             )
 
+    def wait_update(self, *, timeout: float | None = 5.0) -> Update:
+        """Wait for EVT_UPDATE (skipping other events) and parse it. Updates that arrived
+        during other calls, with no on_event handler set, are returned first, in order."""
+        if self._updates:
+            return self.parse_update(self._updates.popleft())
+        while True:
+            event_id, _seq, data = self.wait_event(timeout=timeout)
+            if event_id == EVT_UPDATE:
+                return self.parse_update(data)
+
+    @staticmethod
+    def parse_update(data: bytes) -> Update:
+        """Parse EVT_UPDATE event data (after the event id), e.g. from an on_event handler."""
+        if len(data) < 24:
+            raise ProtocolError(0, f"EVT_UPDATE data too short ({len(data)})")
+        sub_id, kind, flags, _reserved, cycle = struct.unpack_from("<IIIIQ", data, 0)
+        closed = bool(flags & SUB_CLOSED)
+        runs: list[tuple[int, bytes]] = []
+        regs = b""
+        dropped = 0
+        entries: list[bytes] = []
+        body = data[24:]
+        if not closed and kind == SUB_MEM:
+            (count,) = struct.unpack_from("<I", body, 0)
+            off = 4
+            for _ in range(count):
+                offset, length = struct.unpack_from("<II", body, off)
+                runs.append((offset, bytes(body[off + 8 : off + 8 + length])))
+                off += 8 + length
+        elif not closed and kind == SUB_REGS:
+            regs = bytes(body[:40])
+        elif not closed and kind == SUB_TRACE:
+            dropped, count = struct.unpack_from("<II", body, 0)
+            entries = [bytes(body[8 + i * 40 : 8 + (i + 1) * 40]) for i in range(count)]
+        return Update(
+            sub_id=sub_id,
+            kind=kind,
+            closed=closed,
+            cycle=cycle,
+            runs=runs,
+            regs=regs,
+            dropped=dropped,
+            entries=entries,
+        )
+
     def read_mem(self, domain: int, address: int, length: int) -> bytes:
         """Send READMEM; return `length` bytes from domain/address.
         Domains: MAIN, MEGAII (IIgs), MAIN_RAW, MEGAII_RAW (IIgs)."""
@@ -593,6 +732,54 @@ class Client:
             raise ProtocolError(0, f"FINDMEM reply length {len(reply)}, expected {expect}")
         return list(struct.unpack_from(f"<{hit_count}I", reply, 4)) if hit_count else []
 
+    def subscribe(self, kind: int, arg0: int = 0, arg1: int = 0, arg2: int = 0, *, period: int = 1) -> int:
+        """Send SUBSCRIBE; return the subscription id. Updates arrive as EVT_UPDATE events,
+        at most one every ``period`` frames. Prefer subscribe_mem / _regs / _trace."""
+        if not self._handshaked:
+            raise RuntimeError("hello() required before subscribe()")
+        if period < 0:
+            raise ValueError("period must be non-negative")
+        reply = self.request(SUBSCRIBE, struct.pack("<IIIIII", kind, 0, period, arg0, arg1, arg2))
+        if len(reply) != 4:
+            raise ProtocolError(0, f"SUBSCRIBE reply length {len(reply)}, expected 4")
+        return struct.unpack("<I", reply)[0]
+
+    def subscribe_mem(self, domain: int, address: int, length: int, *, period: int = 1) -> int:
+        """Watch ``length`` bytes at domain/address (same domains as read_mem)."""
+        return self.subscribe(SUB_MEM, domain, address, length, period=period)
+
+    def subscribe_regs(self, *, period: int = 1) -> int:
+        """Watch the CPU registers; an update whenever they differ from the last one sent."""
+        return self.subscribe(SUB_REGS, period=period)
+
+    def subscribe_trace(self, max_entries: int = 256, *, period: int = 1) -> int:
+        """Follow the instruction trace ring (needs tracing on); at most max_entries per update."""
+        return self.subscribe(SUB_TRACE, max_entries, period=period)
+
+    def unsubscribe(self, sub_id: int) -> None:
+        """Send UNSUBSCRIBE. Updates already on their way may still arrive."""
+        reply = self.request(UNSUBSCRIBE, struct.pack("<I", sub_id))
+        if reply:
+            raise ProtocolError(0, f"UNSUBSCRIBE reply not empty ({len(reply)} bytes)")
+
+    def share_mem(self, domain: int, *, writable: bool = False) -> RamWindow:
+        """Send MEMSHARE; map the domain's RAM (MAIN_RAW or MEGAII_RAW) into this process.
+        Needs a local server started with -D on a POSIX host."""
+        if not self._handshaked:
+            raise RuntimeError("hello() required before share_mem()")
+        if not hasattr(socket, "CMSG_SPACE"):
+            raise RuntimeError("MEMSHARE needs descriptor passing (POSIX)")
+        flags = MEMSHARE_WRITABLE if writable else 0
+        self._close_fds()
+        reply = self.request(MEMSHARE, struct.pack("<II", domain, flags))
+        fds, self._fds = self._fds, []
+        if len(reply) != 16 or len(fds) != 2:
+            for fd in fds:
+                os.close(fd)
+            raise ProtocolError(0, f"MEMSHARE reply length {len(reply)} with {len(fds)} descriptors")
+        size, page_size, page_count, reply_flags = struct.unpack("<IIII", reply)
+        return RamWindow(fds[0], fds[1], size, page_size, page_count, reply_flags)
+
     def key_event(self, down: bool, scancode: int, mod: int = 0) -> None:
         """Send KEYEVENT (one SDL key down or up)."""
         if not self._handshaked:
@@ -655,6 +842,121 @@ class Client:
         if reply:
             raise ProtocolError(0, f"PASTE_TEXT reply not empty ({len(reply)} bytes)")
 
+    def paste_basic(self, listing: str) -> int:
+        """Tokenize an Applesoft listing in the emulator and write it straight into memory
+        (PASTE_BASIC). Replaces the program in memory; returns the number of lines.
+
+        Much faster than paste_text for programs. Call at the BASIC prompt. Raises
+        ProtocolError if Applesoft is not in memory or a line has no line number.
+        """
+        if not self._handshaked:
+            raise RuntimeError("hello() required before paste_basic()")
+        try:
+            payload = listing.encode("latin-1")
+        except UnicodeEncodeError as exc:
+            raise ValueError("paste_basic only supports latin-1 / 8-bit characters") from exc
+        reply = self.request(PASTE_BASIC, payload)
+        if len(reply) != 4:
+            raise ProtocolError(0, f"PASTE_BASIC reply length {len(reply)}, expected 4")
+        (lines,) = struct.unpack("<I", reply)
+        return lines
+
+    def request_many(
+        self,
+        requests: list[tuple[int, bytes]],
+        *,
+        timeout: float | None = None,
+    ) -> list[bytes | ProtocolError]:
+        """Send every (type, payload) request, then collect the replies. One round-trip.
+
+        The server answers in request order. Each result is the reply payload, or the
+        ProtocolError the server sent for that request. KEYEVENT and QUIT may be
+        included; the server holds them until everything sent before them is answered.
+        """
+        sock = self._require_sock()
+        if self._busy:
+            raise RuntimeError("only one outstanding request allowed")
+        self._busy = True
+        try:
+            seqs = [self._alloc_seq() for _ in requests]
+            self._send_all(
+                b"".join(pack_frame(t, seq, p) for (t, p), seq in zip(requests, seqs))
+            )
+            deadline = None if timeout is None else time.monotonic() + timeout
+            results: list[bytes | ProtocolError] = []
+            while len(results) < len(requests):
+                remaining = None
+                if deadline is not None:
+                    remaining = deadline - time.monotonic()
+                    if remaining <= 0:
+                        raise TimeoutError("request timed out")
+                frame = self._recv_frame(timeout=remaining)
+                if frame.type == EVENT:
+                    self._dispatch_event(frame)
+                    continue
+                i = len(results)
+                type_word = requests[i][0]
+                if frame.seq != seqs[i]:
+                    raise ProtocolError(0, f"seq mismatch: got {frame.seq}, want {seqs[i]}")
+                if frame.type == ERROR:
+                    results.append(ProtocolError(*self._parse_error(frame.payload)))
+                elif frame.type != type_word:
+                    raise ProtocolError(
+                        0,
+                        f"type mismatch: got 0x{frame.type:08x}, want 0x{type_word:08x}",
+                    )
+                else:
+                    results.append(frame.payload)
+            return results
+        finally:
+            self._busy = False
+            sock.settimeout(None)
+
+    def batch(
+        self,
+        requests: list[tuple[int, bytes]],
+        *,
+        timeout: float | None = None,
+    ) -> list[bytes | ProtocolError]:
+        """Send (type, payload) requests as one BATCH frame; the main thread runs them
+        back to back. Returns one reply payload or ProtocolError per entry.
+
+        HELLO, QUIT, KEYEVENT and BATCH are not allowed as entries.
+        """
+        if not self._handshaked:
+            raise RuntimeError("hello() required before batch()")
+        parts = [struct.pack("<I", len(requests))]
+        for type_word, payload in requests:
+            parts.append(struct.pack("<II", type_word, len(payload)))
+            parts.append(payload)
+        reply = self.request(BATCH, b"".join(parts), timeout=timeout)
+        if len(reply) < 4:
+            raise ProtocolError(0, f"BATCH reply length {len(reply)}, expected >= 4")
+        (count,) = struct.unpack_from("<I", reply, 0)
+        if count != len(requests):
+            raise ProtocolError(0, f"BATCH reply count {count}, expected {len(requests)}")
+        results: list[bytes | ProtocolError] = []
+        off = 4
+        for type_word, _ in requests:
+            if len(reply) - off < 8:
+                raise ProtocolError(0, "BATCH reply truncated")
+            entry_type, length = struct.unpack_from("<II", reply, off)
+            off += 8
+            data = reply[off : off + length]
+            if len(data) != length:
+                raise ProtocolError(0, "BATCH reply truncated")
+            off += length
+            if entry_type == ERROR:
+                results.append(ProtocolError(*self._parse_error(data)))
+            elif entry_type != type_word:
+                raise ProtocolError(
+                    0,
+                    f"BATCH type mismatch: got 0x{entry_type:08x}, want 0x{type_word:08x}",
+                )
+            else:
+                results.append(data)
+        return results
+
     def request(
         self,
         type_word: int,
@@ -720,12 +1022,25 @@ class Client:
             sock.settimeout(timeout)
         buf = bytearray()
         while len(buf) < n:
-            chunk = sock.recv(n - len(buf))
+            if hasattr(sock, "recvmsg") and hasattr(socket, "SCM_RIGHTS"):
+                # MEMSHARE replies carry descriptors alongside the frame header.
+                chunk, ancdata, _, _ = sock.recvmsg(n - len(buf), socket.CMSG_SPACE(2 * 4))
+                for level, kind, data in ancdata:
+                    if level == socket.SOL_SOCKET and kind == socket.SCM_RIGHTS:
+                        count = len(data) // 4
+                        self._fds.extend(struct.unpack_from(f"{count}i", data))
+            else:
+                chunk = sock.recv(n - len(buf))
             if not chunk:
                 raise ConnectionError("socket closed during recv")
             buf.extend(chunk)
         return bytes(buf)
 
+    def _close_fds(self) -> None:
+        for fd in self._fds:
+            os.close(fd)
+        self._fds = []
+
     def _recv_frame(self, timeout: float | None) -> Frame:
         header = self._recv_exact(HEADER_SIZE, timeout)
         type_word, seq, length = unpack_header(header)
@@ -742,6 +1057,8 @@ class Client:
         data = frame.payload[4:]
         if self._event_handler is not None:
             self._event_handler(event_id, frame.seq, data)
+        elif event_id == EVT_UPDATE and self._busy:
+            self._updates.append(data)  # for wait_update(); a missed delta would break a mirror
 
     @staticmethod
     def _parse_error(payload: bytes) -> tuple[int, str]:
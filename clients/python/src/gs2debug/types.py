@@ -7,6 +7,9 @@ PING = 0x00000002
 ERROR = 0x00000003
 EVENT = 0x00000004
 QUIT = 0x00000005
+BATCH = 0x00000006
+SUBSCRIBE = 0x00000007
+UNSUBSCRIBE = 0x00000008
 GET_STATUS = 0x00000101
 RESET = 0x00000102
 PAUSE = 0x00000103
@@ -18,6 +21,7 @@ SET_REGS = 0x00000203
 READMEM = 0x00000301
 WRITEMEM = 0x00000302
 FINDMEM = 0x00000303
+MEMSHARE = 0x00000304
 BP_SET = 0x00000401
 BP_CLEAR = 0x00000402
 BP_CLEAR_ALL = 0x00000403
@@ -25,6 +29,7 @@ BP_ENABLE = 0x00000404
 BP_LIST = 0x00000405
 KEYEVENT = 0x00000501
 PASTE_TEXT = 0x00000502
+PASTE_BASIC = 0x00000503
 STATE_GET = 0x00000601
 STATE_SET = 0x00000602
 VIDEO_TEXT = 0x00000701
@@ -90,8 +95,16 @@ REG_E = 1 << 9
 
 FINDMEM_HAS_MASK = 1 << 0
 
+MEMSHARE_WRITABLE = 1 << 0
+
 EVT_STOPPED = 1
 EVT_RUN_STATE = 2
+EVT_UPDATE = 3
+
+SUB_MEM = 1
+SUB_REGS = 2
+SUB_TRACE = 3
+SUB_CLOSED = 1 << 0
 
 STOP_BP_EXEC = 1
 STOP_BP_DATA = 2
@@ -0,0 +1,31 @@
+"""EVT_UPDATE parsing (no emulator required)."""
+
+import struct
+
+from gs2debug import SUB_CLOSED, SUB_MEM, SUB_TRACE, Client
+
+
+def _header(sub_id, kind, flags=0, cycle=1234):
+    return struct.pack("<IIIIQ", sub_id, kind, flags, 0, cycle)
+
+
+def test_mem_runs_apply():
+    body = struct.pack("<I", 2) + struct.pack("<II", 1, 2) + b"\xaa\xbb" + struct.pack("<II", 6, 1) + b"\xcc"
+    u = Client.parse_update(_header(5, SUB_MEM) + body)
+    assert (u.sub_id, u.kind, u.closed, u.cycle) == (5, SUB_MEM, False, 1234)
+    assert u.runs == [(1, b"\xaa\xbb"), (6, b"\xcc")]
+    buf = bytearray(8)
+    u.apply(buf)
+    assert bytes(buf) == b"\x00\xaa\xbb\x00\x00\x00\xcc\x00"
+
+
+def test_trace_entries():
+    entries = [bytes([i]) * 40 for i in range(3)]
+    u = Client.parse_update(_header(2, SUB_TRACE) + struct.pack("<II", 7, 3) + b"".join(entries))
+    assert u.dropped == 7
+    assert u.entries == entries
+
+
+def test_closed_has_no_body():
+    u = Client.parse_update(_header(9, SUB_MEM, SUB_CLOSED))
+    assert u.closed and u.runs == []
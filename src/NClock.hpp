@@ -23,6 +23,7 @@
 #include "PlatformIDs.hpp"
 #include "util/EventTimer.hpp"
 #include "util/DebugFormatter.hpp"
+#include "util/Snapshot.hpp"
 #include <functional>
 
 // Max CPU cycles per 14M tick in ludicrous (auto) mode (~229 MHz).
@@ -45,6 +46,14 @@ enum clock_set_t {
     NUM_CLOCK_SETS
 };
 
+// Which tick() incr_cycles() dispatches to. CUSTOM falls back to the virtual
+// slow_incr_cycles(), for test harness clocks that override it.
+enum clock_engine_t {
+    CLOCK_ENGINE_CUSTOM = 0,
+    CLOCK_ENGINE_II,
+    CLOCK_ENGINE_IIGS,
+};
+
 enum cycle_type_t {
     CYCLE_TYPE_SYNC = 0,
     CYCLE_TYPE_FAST_ROM = 1,
@@ -107,6 +116,7 @@ protected:
     clock_mode_info_t current = us_clock_mode_info[CLOCK_1_024MHZ];
 
     clock_mode_t clock_mode = INVALID_CLOCK_MODE;
+    clock_engine_t engine = CLOCK_ENGINE_CUSTOM;
 
     // don't let anyone else touch these.
     uint64_t cycles;                // CPU cycle count
@@ -114,8 +124,12 @@ protected:
     uint64_t video_cycles = 0;      // video cycle count
 
     // tight integration aka cross-dependency here.
+    // These are only brought up to date when c_14M crosses vid_deadline_c14M;
+    // in between, c_14M - vid_sync_c14M more 14Ms are owed to both.
     uint64_t video_cycle_14M_count = 0;  // 14MHz cycles since last video cycle
     uint64_t scanline_14M_count = 0;  // 14MHz cycles since last scanline
+    uint64_t vid_sync_c14M = 0;       // c_14M the counters above were last synced at
+    uint64_t vid_deadline_c14M = UINT64_MAX; // first c_14M with video work to do
 
     uint64_t frame_start_c14M = 0;
     uint64_t frame_end_c14M = 0;
@@ -186,14 +200,26 @@ public:
     inline const char *get_clock_mode_name(clock_mode_t cm) { return clock_mode_names[cm]; } // return specified mode name
     inline uint32_t get_clock_mode_asset_id(clock_mode_t mode) { return clock_mode_asset_ids[mode]; }
     inline uint32_t get_current_mode_asset_id() { return clock_mode_asset_ids[clock_mode]; }
-    inline uint64_t get_video_cycle_14M_count() { return video_cycle_14M_count; }
-    inline uint64_t get_scanline_14M_count() { return scanline_14M_count; }
+    inline uint64_t get_video_cycle_14M_count() { return video_cycle_14M_count + pending_video_14M(); }
+    inline virtual uint64_t get_scanline_14M_count() { return scanline_14M_count + pending_video_14M(); }
+    inline uint64_t pending_video_14M() {
+        return (video_scanner && engine != CLOCK_ENGINE_CUSTOM) ? c_14M - vid_sync_c14M : 0;
+    }
+    inline clock_engine_t get_engine() const { return engine; }
+    inline uint64_t get_vid_deadline_c14M() const { return vid_deadline_c14M; }
     inline uint64_t get_cycles_per_scanline() { return current.cycles_per_scanline; }
     inline uint64_t get_cycles_per_frame() { return current.cycles_per_frame; }
     inline uint64_t get_vid_cycles_per_frame() { return current.vid_cycles_per_frame; }
     inline uint64_t get_vid_cycles_per_second() { return current.vid_cycles_per_second; }
     inline VideoScannerII *get_video_scanner() { return video_scanner; }
-    inline void adjust_c14m(uint64_t amount) { c_14M += amount; }
+    inline void adjust_c14m(uint64_t amount) {
+        c_14M += amount;
+        if (engine == CLOCK_ENGINE_II) {
+            // II video counters only advance by CPU cycle steps, not skipped time.
+            vid_sync_c14M += amount;
+            if (vid_deadline_c14M != UINT64_MAX) vid_deadline_c14M += amount;
+        }
+    }
     inline uint64_t get_frame_start_c14M() { return frame_start_c14M; }
     inline uint64_t get_frame_end_c14M() { return frame_end_c14M; }
     inline void next_frame() {
@@ -202,7 +228,7 @@ public:
         frame_count++;
     }
 
-    void set_video_scanner(VideoScannerII *video_scanner) {
+    virtual void set_video_scanner(VideoScannerII *video_scanner) {
         this->video_scanner = video_scanner;
     }
 
@@ -249,8 +275,29 @@ public:
         cycles++; 
     }
     
-    inline void incr_cycles() {
-        slow_incr_cycles();
+    // Called on every bus cycle. Dispatches on engine to the platform tick()
+    // without a virtual call; defined below once the subclasses are complete.
+    inline void incr_cycles();
+
+    // cycles / c_14M stay monotonic across a restore since timers are scheduled
+    // against them; only the speed and the video phase are carried over.
+    virtual void snapshot(SnapshotIO &io) {
+        clock_mode_t mode = clock_mode;
+        uint32_t n = cpu_per_14m, div = cpu_div;
+        uint64_t owed = pending_video_14M();
+        io.field(mode);
+        io.field(n);
+        io.field(div);
+        io.field(video_cycle_14M_count);
+        io.field(scanline_14M_count);
+        io.field(owed);
+        if (io.loading()) {
+            if (mode < 0 || mode >= NUM_CLOCK_MODES) mode = CLOCK_1_024MHZ;
+            set_clock_mode(mode);
+            cpu_per_14m = n ? n : 1;
+            cpu_div = div < cpu_per_14m ? div : 0;
+            vid_sync_c14M = c_14M - (owed < c_14M ? owed : c_14M);
+        }
     }
 
     virtual DebugFormatter *debug() {
@@ -274,11 +321,14 @@ protected:
 public:
     NClockII(clock_set_t clock_set = CLOCK_SET_US, clock_mode_t clock_mode = CLOCK_1_024MHZ) : NClock(clock_set, clock_mode) {
         clock_mode = CLOCK_1_024MHZ;
+        engine = CLOCK_ENGINE_II;
     }
 
     // II, II+, IIe
     // When cpu_per_14m > 1 (ludicrous): N CPU cycles share one 14M tick / scanner step.
-    inline virtual void slow_incr_cycles() override {
+    // Only the c_14M add runs per cycle; the video counters catch up in video_sync()
+    // when the next video cycle or end of scanline is due.
+    inline void tick() {
         cycles++;
         if (cpu_per_14m > 1) {
             if (++cpu_div < cpu_per_14m) {
@@ -288,30 +338,69 @@ public:
         }
 
         c_14M += current.c_14M_per_cpu_cycle;
-        
-        if (video_scanner) {
-            video_cycle_14M_count += current.c_14M_per_cpu_cycle;
-            scanline_14M_count += current.c_14M_per_cpu_cycle;
-
-            if (video_cycle_14M_count >= 14) {
-                video_cycle_14M_count -= 14;
-                video_scanner->video_cycle();
-                video_cycles++;
-                
-                for (auto &cycle_handler : cycle_handlers) {
-                    cycle_handler();
-                }
-            }
-            if (scanline_14M_count >= 910) {  // end of scanline
-                c_14M += current.extra_per_scanline;
-                scanline_14M_count = 0;
+        if (c_14M >= vid_deadline_c14M) {
+            video_sync();
+        }
+    }
+
+    inline virtual void slow_incr_cycles() override {
+        tick();
+    }
+
+    // Only entered on the cycle that crosses the deadline, so at most one video
+    // cycle and one end of scanline are due, same as the old per-cycle checks.
+    void video_sync() {
+        uint64_t elapsed = c_14M - vid_sync_c14M;
+        video_cycle_14M_count += elapsed;
+        scanline_14M_count += elapsed;
+
+        if (video_cycle_14M_count >= 14) {
+            video_cycle_14M_count -= 14;
+            video_scanner->owe_cycle();
+            video_cycles++;
+            
+            for (auto &cycle_handler : cycle_handlers) {
+                cycle_handler();
             }
         }
+        if (scanline_14M_count >= 910) {  // end of scanline
+            c_14M += current.extra_per_scanline;
+            scanline_14M_count = 0;
+        }
+        vid_sync_c14M = c_14M;
+        update_vid_deadline();
+    }
+
+    inline void update_vid_deadline() {
+        if (!video_scanner) {
+            vid_deadline_c14M = UINT64_MAX;
+            return;
+        }
+        uint64_t to_video = 14 - video_cycle_14M_count;
+        uint64_t to_scanline = 910 - scanline_14M_count;
+        vid_deadline_c14M = vid_sync_c14M + (to_video < to_scanline ? to_video : to_scanline);
+    }
+
+    void set_video_scanner(VideoScannerII *video_scanner) override {
+        // counters only run while a scanner is attached; settle what is owed first.
+        uint64_t owed = pending_video_14M();
+        video_cycle_14M_count += owed;
+        scanline_14M_count += owed;
+        if (this->video_scanner && this->video_scanner != video_scanner) this->video_scanner->sync();
+        this->video_scanner = video_scanner;
+        vid_sync_c14M = c_14M;
+        update_vid_deadline();
     }
 
     inline void set_slow_mode(bool value) { slow_mode = value; }
     inline bool get_slow_mode() { return slow_mode; }
 
+    void snapshot(SnapshotIO &io) override {
+        NClock::snapshot(io);
+        io.field(slow_mode);
+        if (io.loading()) update_vid_deadline();
+    }
+
 
     virtual DebugFormatter *debug() override {
         DebugFormatter *f = NClock::debug();
@@ -326,11 +415,11 @@ class NClockIIgs : public NClockII {
 protected:
     uint64_t ram_refresh_cycles = 0;
     uint64_t vidlinecycles = 0;
-    uint64_t video_c14m = 0;
 
     public:
     NClockIIgs(clock_set_t clock_set = CLOCK_SET_US, clock_mode_t clock_mode = CLOCK_2_8MHZ) : NClockII(clock_set, clock_mode) {
         clock_mode = CLOCK_2_8MHZ;
+        engine = CLOCK_ENGINE_IIGS;
     }
 
     cycle_type_t cycle_type = CYCLE_TYPE_FAST;
@@ -340,7 +429,8 @@ protected:
 
     // IIgs
     // Fast path: N CPU cycles per 14M when ludicrous. SYNC / slow / 1 MHz ignore N.
-    inline void slow_incr_cycles() override {
+    // The video loop only runs once c_14M reaches vid_deadline_c14M.
+    inline void tick() {
         cycles++;
         if (slow_mode) cycle_type = CYCLE_TYPE_SYNC;
         if (current.hz_rate == 1020484) cycle_type = CYCLE_TYPE_SYNC; // also get refresh for "free" here.
@@ -360,8 +450,9 @@ protected:
         uint64_t c14m_this_cycle;
         if (sync_cycle) {
     
+            uint64_t video_phase = video_cycle_14M_count + pending_video_14M();
             c14m_this_cycle = 14;                                   // if PH2 start lines up with PH0 start.. 
-            if (video_cycle_14M_count) c14m_this_cycle += (14 - video_cycle_14M_count); // otherwise wait until end of next PH0, then 14 more C14s.
+            if (video_phase) c14m_this_cycle += (14 - video_phase); // otherwise wait until end of next PH0, then 14 more C14s.
             //ram_refresh_cycles = 0;                                 // our refresh needs are satisfied for a bit.
             ram_refresh_cycles += c14m_this_cycle;
             if (ram_refresh_cycles >= 50) {
@@ -389,39 +480,74 @@ protected:
         // if a slow cycle we can use 14-video_accum (or, 16-video_accum for h=64) to get the number of 14Ms to add to
         // c_14M to sync.
     
-        if (video_scanner) {
-            // Here we need to update the video clock to match with the CPU clock.
-            // the previous video clock is video_c14m.
-    
-            // delta between previous video clock and current CPU clock.
-            uint64_t delta = c_14M - video_c14m;
-            video_cycle_14M_count += delta;
-            //scanline_14M += delta;
-    
-            video_c14m = c_14M; // this is now caught up
-    
-            while (video_cycle_14M_count >= 14) {
-                video_cycle_14M_count -= 14;
-                // Do-video-cycle here
-                
-                video_scanner->video_cycle();
-                video_cycles++;
-                
-                for (auto &cycle_handler : cycle_handlers) {
-                    cycle_handler();
-                }
-                
-                vidlinecycles++;
-            }
-            if (vidlinecycles >= 65) {  // end of scanline
-                vidlinecycles -= 65;
-                c_14M += current.extra_per_scanline;
-                video_c14m += current.extra_per_scanline;
-            }
+        if (c_14M >= vid_deadline_c14M) {
+            video_sync();
         }
         cycle_type = CYCLE_TYPE_FAST; // reset here so MMU doesn't have to set for all possible addresses
     }
 
+    inline void slow_incr_cycles() override {
+        tick();
+    }
+
+    void video_sync() {
+        // Here we need to update the video clock to match with the CPU clock.
+        // the previous video clock is vid_sync_c14M.
+
+        // delta between previous video clock and current CPU clock.
+        uint64_t delta = c_14M - vid_sync_c14M;
+        video_cycle_14M_count += delta;
+        //scanline_14M += delta;
+
+        vid_sync_c14M = c_14M; // this is now caught up
+
+        while (video_cycle_14M_count >= 14) {
+            video_cycle_14M_count -= 14;
+            // Do-video-cycle here
+            
+            video_scanner->owe_cycle();
+            video_cycles++;
+            
+            for (auto &cycle_handler : cycle_handlers) {
+                cycle_handler();
+            }
+            
+            vidlinecycles++;
+        }
+        if (vidlinecycles >= 65) {  // end of scanline
+            vidlinecycles -= 65;
+            c_14M += current.extra_per_scanline;
+            vid_sync_c14M += current.extra_per_scanline;
+        }
+        update_vid_deadline();
+    }
+
+    inline void update_vid_deadline() {
+        vid_deadline_c14M = video_scanner ? vid_sync_c14M + (14 - video_cycle_14M_count) : UINT64_MAX;
+    }
+
+    // vid_sync_c14M is deliberately not moved on attach: like the old per-cycle code,
+    // the first tick after attaching catches the scanner up from where it left off.
+    void set_video_scanner(VideoScannerII *video_scanner) override {
+        if (this->video_scanner) {
+            video_cycle_14M_count += c_14M - vid_sync_c14M;
+            vid_sync_c14M = c_14M;
+            if (this->video_scanner != video_scanner) this->video_scanner->sync();
+        }
+        this->video_scanner = video_scanner;
+        update_vid_deadline();
+    }
+
+    inline uint64_t get_scanline_14M_count() override { return scanline_14M_count; }
+
+    void snapshot(SnapshotIO &io) override {
+        NClockII::snapshot(io);
+        io.field(ram_refresh_cycles);
+        io.field(vidlinecycles);
+        io.field(cycle_type);
+        if (io.loading()) update_vid_deadline();
+    }
+
     virtual DebugFormatter *debug() override {
         DebugFormatter *f = NClockII::debug();
         f->addLine("RAM Refresh Cntr: %12llu", ram_refresh_cycles);
@@ -429,6 +555,16 @@ protected:
     }
 };
 
+inline void NClock::incr_cycles() {
+    if (engine == CLOCK_ENGINE_IIGS) {
+        static_cast<NClockIIgs *>(this)->tick();
+    } else if (engine == CLOCK_ENGINE_II) {
+        static_cast<NClockII *>(this)->tick();
+    } else {
+        slow_incr_cycles();
+    }
+}
+
 class NClockFactory {
     public:
     static NClockII *create_clock(PlatformId_t platform, clock_set_t clock_set) {
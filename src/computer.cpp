@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <cstdint>
 
 #include "PlatformIDs.hpp"
@@ -8,10 +11,12 @@
 #include "computer.hpp"
 #include "debugger/debugwindow.hpp"
 #include "debugger/BreakpointTable.hpp"
+#include "debugger/DebugProtocolServer.hpp"
 #include "util/EventDispatcher.hpp"
 #include "util/EventTimer.hpp"
 #include "videosystem.hpp"
 #include "util/mount.hpp"
+#include "util/Applesoft.hpp"
 #include "platforms.hpp"
 #include "mbus/MessageBus.hpp"
 #include "util/DebugFormatter.hpp"
@@ -35,6 +40,7 @@
 computer_t::computer_t(NClockII *clock) {
     this->clock = clock;
     breakpoints = new BreakpointTable();
+    snapshots = new SnapshotManager();
 
     // initialize module store to nullptr.
     for (int i = 0; i < MODULE_NUM_MODULES; i++) {
@@ -86,6 +92,9 @@ computer_t::computer_t(NClockII *clock) {
     event_timer = new EventTimer(clock); // runs at 14MHz clock speed.
     vid_event_timer = new EventTimer(clock); // runs at video clock speed (always 1MHz)
     cpu_event_timer = new EventTimer(clock); // runs at cpu clock speed.
+    event_timer->set_deadline_reset(&event_deadline_c14m);
+    vid_event_timer->set_deadline_reset(&event_deadline_c14m);
+    cpu_event_timer->set_deadline_reset(&event_deadline_c14m);
 
     slot_manager = new SlotManager_t();
     mounts = new Mounts();
@@ -94,6 +103,42 @@ computer_t::computer_t(NClockII *clock) {
     video_system = new video_system_t(this);
     debug_window = new debug_window_t(this);
 
+    // core state; devices register theirs as they are powered on.
+    register_state_handler("cpu", [this](SnapshotIO &io) {
+        uint8_t e = cpu->E;
+        io.field(cpu->full_pc);
+        io.field(cpu->full_db);
+        io.field(cpu->sp);
+        io.field(cpu->a);
+        io.field(cpu->x);
+        io.field(cpu->y);
+        io.field(cpu->d);
+        io.field(cpu->p);
+        io.field(e);
+        io.field(cpu->irq_pipe);
+        io.field(cpu->rdy);
+        io.field(cpu->clock_stopped);
+        if (io.loading()) cpu->E = e;
+    });
+    register_state_handler("clock", [this](SnapshotIO &io) {
+        this->clock->snapshot(io);
+        if (io.loading()) send_clock_mode_message(this->clock->get_clock_mode());
+    });
+    register_state_handler("video", [this](SnapshotIO &io) {
+        VideoScannerII *vs = this->clock->get_video_scanner();
+        bool present = vs != nullptr;
+        io.field(present);
+        if (present && vs) vs->snapshot(io);
+    });
+    register_state_handler("mmu", [this](SnapshotIO &io) {
+        mmu->snapshot(io);
+    });
+    register_state_handler("irq", [this](SnapshotIO &io) {
+        uint64_t mask = irq_control->get_all_irqs();
+        io.field(mask);
+        if (io.loading()) irq_control->set_all_irqs(mask);
+    });
+
     sys_event->registerHandler(SDL_EVENT_MOUSE_BUTTON_DOWN,[this](const SDL_Event &event ) {
         if (event.button.button == SDL_BUTTON_RIGHT && gs2_app_values.right_mouse_accelerate) {
             old_speed = this->clock->get_clock_mode();
@@ -284,6 +329,7 @@ computer_t::~computer_t() {
     delete video_system;
     delete debug_window;
     delete breakpoints;
+    delete snapshots;
     delete event_timer;
     delete sys_event;
     delete dispatch;
@@ -365,6 +411,24 @@ void computer_t::set_clock(NClockII *clock) {
 }
 
 /** State storage for non-slot devices. */
+void computer_t::register_state_handler(std::string name, StateHandler handler) {
+    snapshots->register_state_handler(name, std::move(handler));
+}
+
+void computer_t::register_ram_region(std::string name, uint8_t *base, size_t size) {
+    snapshots->register_ram_region(name, base, size);
+}
+
+bool computer_t::save_snapshot(const std::string &path, bool incremental, std::string &err) {
+    snapshots->set_platform_id(platform ? platform->id : 0);
+    return snapshots->save(path, incremental, err);
+}
+
+bool computer_t::load_snapshot(const std::string &path, std::string &err) {
+    snapshots->set_platform_id(platform ? platform->id : 0);
+    return snapshots->load(path, err);
+}
+
 void *computer_t::get_module_state(module_id_t module_id) {
     void *state = module_store[module_id];
     if (state == nullptr) {
@@ -381,6 +445,7 @@ bool computer_t::start_keyboard_paste(std::string text) {
     auto *kb = static_cast<keyboard_state_t *>(module_store[MODULE_KEYBOARD]);
     if (kb) {
         kb->paste_buffer = std::move(text);
+        kb->paste_pos = 0;
         return true;
     }
     auto *kg_state = static_cast<keygloo_state_t *>(module_store[MODULE_KEYGLOO]);
@@ -391,6 +456,128 @@ bool computer_t::start_keyboard_paste(std::string text) {
     return false;
 }
 
+// "END" / "FOR" at the head of the keyword table says Applesoft is what's mapped in.
+static bool applesoft_in_memory(MMU *m) {
+    static const uint8_t keywords[] = { 'E', 'N', 'D' | 0x80, 'F', 'O', 'R' | 0x80 };
+    for (uint32_t i = 0; i < sizeof(keywords); i++) {
+        if (m->read(APPLESOFT_KEYWORD_TABLE + i) != keywords[i]) return false;
+    }
+    return true;
+}
+
+bool computer_t::inject_basic_program(const std::string &listing, uint32_t &line_count, std::string &err) {
+    MMU *m = cpu ? cpu->mmu : nullptr;
+    if (!m) {
+        err = "no cpu";
+        return false;
+    }
+    if (!applesoft_in_memory(m)) {
+        err = "Applesoft is not in memory";
+        return false;
+    }
+    // The enhanced IIe and IIgs fetch PARSE's input with a JSR to a case-folding helper.
+    const bool fold_lowercase = m->read(APPLESOFT_PARSE_FETCH) == 0x20;
+
+    auto read16 = [m](uint16_t zp) { return (uint16_t)(m->read(zp) | (m->read(zp + 1) << 8)); };
+    auto write16 = [m](uint16_t zp, uint16_t v) {
+        m->write(zp, (uint8_t)(v & 0xFF));
+        m->write(zp + 1, (uint8_t)(v >> 8));
+    };
+    const uint16_t txttab = read16(APPLESOFT_TXTTAB);
+    const uint16_t memsiz = read16(APPLESOFT_MEMSIZ);
+    if (txttab < 0x0801 || txttab >= memsiz) {
+        err = "Applesoft program pointers are not set up";
+        return false;
+    }
+
+    std::vector<uint8_t> image;
+    if (!applesoft_tokenize_listing(listing, txttab, fold_lowercase, image, line_count, err)) {
+        return false;
+    }
+    const uint32_t end = txttab + (uint32_t)image.size();
+    if (end >= memsiz) {
+        err = "program does not fit below HIMEM";
+        return false;
+    }
+
+    m->write(txttab - 1, 0);
+    m->write_block(txttab, image.data(), (uint32_t)image.size());
+    write16(APPLESOFT_VARTAB, (uint16_t)end);
+    write16(APPLESOFT_ARYTAB, (uint16_t)end);
+    write16(APPLESOFT_STREND, (uint16_t)end);
+    write16(APPLESOFT_FRETOP, memsiz);
+    write16(APPLESOFT_PRGEND, (uint16_t)end);
+    write16(APPLESOFT_DATPTR, (uint16_t)(txttab - 1));
+    return true;
+}
+
+bool computer_t::load_binary(uint32_t address, const uint8_t *data, size_t len, std::string &err) {
+    MMU *m = cpu ? cpu->mmu : nullptr;
+    if (!m) {
+        err = "no cpu";
+        return false;
+    }
+    const uint64_t limit = (platform && platform_is_iigs(platform->id)) ? 0x1000000 : 0x10000;
+    if ((uint64_t)address + len > limit) {
+        err = "binary runs past the end of memory";
+        return false;
+    }
+    m->write_block(address, data, (uint32_t)len);
+    return true;
+}
+
+bool computer_t::load_program_file(const std::string &path, std::string &status) {
+    std::string name = path.substr(path.find_last_of("/\\") + 1);
+    std::string lower = name;
+    for (char &c : lower) c = (char)tolower((unsigned char)c);
+
+    // CiderPress names binaries NAME#06AAAA: ProDOS type $06 (BIN), aux type = load address.
+    uint32_t load_address = 0;
+    bool binary = false;
+    size_t hash = lower.rfind("#06");
+    if (hash != std::string::npos && lower.size() == hash + 7) {
+        binary = true;
+        for (size_t i = hash + 3; i < lower.size(); i++) {
+            char c = lower[i];
+            if (!isxdigit((unsigned char)c)) binary = false;
+            load_address = (load_address << 4) | (uint32_t)(isdigit((unsigned char)c) ? c - '0' : c - 'a' + 10);
+        }
+    }
+    const bool listing = !binary && lower.size() > 4 &&
+        (lower.compare(lower.size() - 4, 4, ".bas") == 0 || lower.compare(lower.size() - 4, 4, ".txt") == 0);
+    if (!binary && !listing) return false;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        status = "Cannot open " + name;
+        return true;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::string err;
+    if (binary) {
+        if (load_binary(load_address, data.data(), data.size(), err)) {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "Loaded %zu bytes at $%04X from ", data.size(), load_address);
+            status = buf + name;
+        } else {
+            status = "Load failed: " + err;
+        }
+        return true;
+    }
+
+    std::string text(data.begin(), data.end());
+    uint32_t lines = 0;
+    if (cpu && cpu->mmu && !applesoft_in_memory(cpu->mmu) && start_keyboard_paste(text)) {
+        status = "Typing " + name;     // e.g. Integer BASIC: let the guest tokenize it
+    } else if (inject_basic_program(text, lines, err)) {
+        status = "Loaded " + std::to_string(lines) + " lines from " + name;
+    } else {
+        status = "BASIC load failed: " + err;
+    }
+    return true;
+}
+
 // TODO: should live inside a reconstituted clock class.
 void computer_t::send_clock_mode_message(clock_mode_t clock_mode) {
     static char buffer[256];
@@ -421,6 +608,153 @@ void computer_t::begin_ludicrous_calibration() {
 #endif
 }
 
+/* Run what is due on the three timers, then find the earliest c14M at which
+   anything could be due again. The video and CPU counters can't reach their
+   next event before c14M has advanced a known minimum, so those limits are
+   early, never late:
+   - a video cycle takes 14 14M ticks (the ones already owed count toward it);
+   - a CPU cycle takes at least c14M_per_cpu_cycle, or 1/N of one in Ludicrous
+     (slow and refresh cycles only take longer).
+   Clock mode and N only change between frames, where the run loop resets the
+   deadline. */
+void computer_t::run_due_events() {
+    if (event_timer->isEventPassed(clock->get_c14m())) {
+        event_timer->processEvents(clock->get_c14m());
+    }
+    if (vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
+        vid_event_timer->processEvents(clock->get_vid_cycles());
+    }
+    if (cpu_event_timer->isEventPassed(clock->get_cycles())) {
+        cpu_event_timer->processEvents(clock->get_cycles());
+    }
+
+    const uint64_t now = clock->get_c14m();
+    uint64_t deadline = std::min(clock->get_frame_end_c14M(), event_timer->getNextEventCycle());
+
+    if (vid_event_timer->hasPendingEvents()) {
+        uint64_t vid_next = vid_event_timer->getNextEventCycle();
+        uint64_t vid_now = clock->get_vid_cycles();
+        uint64_t ticks = (vid_next > vid_now) ? (vid_next - vid_now) * 14 : 0;
+        uint64_t owed = clock->get_video_cycle_14M_count();
+        deadline = std::min(deadline, now + (ticks > owed ? ticks - owed : 0));
+    }
+    if (cpu_event_timer->hasPendingEvents()) {
+        uint64_t cpu_next = cpu_event_timer->getNextEventCycle();
+        uint64_t cpu_now = clock->get_cycles();
+        uint64_t cycles = (cpu_next > cpu_now) ? cpu_next - cpu_now : 0;
+        deadline = std::min(deadline, now + (cycles / clock->get_cpu_per_14m()) * clock->get_c14m_per_cpu_cycle());
+    }
+    event_deadline_c14m = deadline;
+}
+
+void computer_t::enter_step_mode(const StopHit *hit) {
+    uint32_t prev = execution_mode;
+    execution_mode = EXEC_STEP_INTO;
+    instructions_left = 0;
+    if (hit && debug_protocol) {
+        debug_protocol->emit_stopped(this, *hit);
+        debug_protocol->emit_run_state(EXEC_STEP_INTO, prev);
+    }
+}
+
+/* Three loops, cheapest last: with the debugger's breakpoint checks (traced core),
+   with only MMU-trapped data watchpoints, and with neither. A stop PC adds a
+   per-instruction compare to whichever runs. */
+computer_t::frame_stop_t computer_t::run_frame_instructions(std::optional<uint32_t> stop_pc) {
+    // --debug-service block: protocol commands also run between instruction blocks.
+    DebugProtocolServer *mid_frame_service = gs2_app_values.debug_service_blocks ? debug_protocol : nullptr;
+    frame_stop_t stop = FRAME_STOP_NONE;
+
+    breakpoints->set_watch_armed(true);
+    if (debug_window->needs_breakpoint_checks()) {
+        while (clock->get_c14m() < clock->get_frame_end_c14M()) { // 1/60th second.
+            poll_events();
+            if (mid_frame_service) mid_frame_service->process_mid_frame(this);
+            if (stop_pc && cpu->full_pc == *stop_pc) {
+                stop = FRAME_STOP_PC;
+                break;
+            }
+            StopHit hit{};
+            if (debug_window->check_pre_breakpoint(cpu, &hit)) {
+                enter_step_mode(&hit);
+                stop = FRAME_STOP_BREAK;
+                break;
+            }
+
+            uint32_t pc_before = cpu->full_pc;
+            (cpu->cpun->execute_next)(cpu);
+            breakpoints->on_instruction_retired(pc_before);
+
+            if (debug_window->check_post_breakpoint(cpu, &cpu->trace_entry, &hit)) {
+                enter_step_mode(&hit);
+                stop = FRAME_STOP_BREAK;
+                break;
+            }
+            if (cpu->trace_entry.opcode == 0x00) { // catch a BRK and stop execution.
+                enter_step_mode(nullptr);
+                stop = FRAME_STOP_BREAK;
+                break;
+            }
+        }
+    } else if (breakpoints->has_watch_traps()) {
+        // Only DATA watchpoints, which the MMU traps: the fast loop plus one flag test.
+        while (clock->get_c14m() < clock->get_frame_end_c14M()) {
+            poll_events();
+            if (mid_frame_service) mid_frame_service->process_mid_frame(this);
+            if (stop_pc && cpu->full_pc == *stop_pc) {
+                stop = FRAME_STOP_PC;
+                break;
+            }
+            (cpu->cpun->execute_next)(cpu);
+            if (breakpoints->watch_hit_pending()) {
+                StopHit hit = *breakpoints->take_watch_hit();
+                enter_step_mode(&hit);
+                stop = FRAME_STOP_BREAK;
+                break;
+            }
+        }
+    } else if (stop_pc) {
+        const uint32_t pc = *stop_pc;
+        while (clock->get_c14m() < clock->get_frame_end_c14M()) {
+            poll_events();
+            if (mid_frame_service) mid_frame_service->process_mid_frame(this);
+            if (cpu->full_pc == pc) {
+                stop = FRAME_STOP_PC;
+                break;
+            }
+            (cpu->cpun->execute_next)(cpu);
+        }
+    } else { // skip all debug checks if debug window is not open - this may seem repetitious but it saves all kinds of cycles where every cycle counts 
+        while (clock->get_c14m() < clock->get_frame_end_c14M()) {
+            if (mid_frame_service) mid_frame_service->process_mid_frame(this);
+            run_due_events();
+            // nothing can come due before the deadline (it is capped at frame end)
+            do {
+                (cpu->cpun->execute_next)(cpu);
+            } while (clock->get_c14m() < event_deadline_c14m);
+        }
+    }
+    breakpoints->set_watch_armed(false);
+    return stop;
+}
+
+void computer_t::update_disk_accelerator() {
+    if (!gs2_app_values.disk_accelerator || mounts == nullptr || speed_shift) return;
+
+    switch (disk_accel.update(clock, mounts->any_floppy_motor_on(),
+                (clock_mode_t)gs2_app_values.disk_accelerator_speed, is_ludicrous_locked())) {
+        case DiskAccelerator::CALIBRATE:
+            begin_ludicrous_calibration();
+            break;
+        case DiskAccelerator::REUSE_N:
+            // Calibrating takes a couple of seconds; keep the N a previous spell settled on.
+            ludicrous_cal_state = LS_CAL_LOCKED;
+            break;
+        default:
+            break;
+    }
+}
+
 void computer_t::update_ludicrous_calibration(
     bool modal_tracking, uint64_t cpu_cycles_this_frame) {
     if (clock->get_clock_mode() != CLOCK_FREE_RUN) {
@@ -622,8 +956,10 @@ void computer_t::frame_status_update() {
         uint64_t frame_counter_delta = this_frame_end_time - last_frame_end_time;
 
         fps = ((float)frame_count * 1000000000) / frame_counter_delta;
+        presented_fps = ((float)frames_presented * 1000000000) / frame_counter_delta;
         last_frame_end_time = this_frame_end_time;
         frame_count = 0;
+        frames_presented = 0;
 
         // TODO: maybe should update this every second instead of every 5 seconds.
         uint64_t delta = clock->get_cycles() - last_5sec_cycles;
@@ -634,8 +970,8 @@ void computer_t::frame_status_update() {
             last_5sec_cycles = clock->get_cycles();
             last_5sec_update = this_frame_end_time;
     
-            fprintf(stdout, "%llu delta %llu cycles clock-mode: %d CPS: %12.8f MHz [ slips: %llu]\n", 
-                u64_t(delta), u64_t(clock->get_cycles()), clock->get_clock_mode(), e_mhz, u64_t(clock_slip));
+            fprintf(stdout, "%llu delta %llu cycles clock-mode: %d CPS: %12.8f MHz [ slips: %llu] frames: %.1f emulated, %.1f presented /s\n", 
+                u64_t(delta), u64_t(clock->get_cycles()), clock->get_clock_mode(), e_mhz, u64_t(clock_slip), fps, presented_fps);
             uint64_t et = event_times.getAverage();
             uint64_t at = audio_times.getAverage();
             uint64_t dt = display_times.getAverage();
@@ -643,6 +979,8 @@ void computer_t::frame_status_update() {
             uint64_t total = et + at + dt + aet;
             fprintf(stdout, "event_time: %10llu, audio_time: %10llu, display_time: %10llu, app_event_time: %10llu, total: %10llu\n", 
                 u64_t(et), u64_t(at), u64_t(dt), u64_t(aet), u64_t(total));
+            fprintf(stdout, "  video generate (worker): %10llu, video upload: %10llu\n",
+                u64_t(video_generate_times.getAverage()), u64_t(video_upload_times.getAverage()));
             fprintf(stdout, "PC: %04X, A: %02X, X: %02X, Y: %02X, P: %02X\n", 
                 cpu->pc, cpu->a, cpu->x, cpu->y, cpu->p);        
             status_count = 0;
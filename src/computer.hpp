@@ -22,6 +22,8 @@
 #include "util/AudioSystem.hpp"
 #include "util/SoundEffect.hpp"
 #include "util/StorageDevice.hpp"
+#include "util/Snapshot.hpp"
+#include "util/DiskAccelerator.hpp"
 #include "systemconfig.hpp"
 #include "device_reset_id.hpp"
 
@@ -37,6 +39,7 @@ class VideoScannerII;
 class ResetController;
 class BreakpointTable;
 class DebugProtocolServer;
+struct StopHit;
 
 // Comment this out to restore the original one-frame guess probe in gs2.cpp.
 #define LUDICROUS_BINARY_SEARCH_PROBE
@@ -73,6 +76,8 @@ struct computer_t {
         std::vector<uint8_t> &reply,
         std::string &err)>;
 
+    using StateHandler = SnapshotManager::StateHandler;
+
     struct DebugDisplayHandlerInfo {
         std::string name;
         uint64_t id;
@@ -103,6 +108,7 @@ struct computer_t {
     debug_window_t *debug_window = nullptr;
     BreakpointTable *breakpoints = nullptr;
     DebugProtocolServer *debug_protocol = nullptr;
+    SnapshotManager *snapshots = nullptr;
 
     AudioSystem *audio_system = nullptr;
     SoundEffect *sound_effect = nullptr;
@@ -111,6 +117,29 @@ struct computer_t {
     EventTimer *vid_event_timer = nullptr;
     EventTimer *cpu_event_timer = nullptr;
 
+    /* No event in any of the three timer domains can be due, and the frame isn't
+       over, before c14M reaches this. The run loops compare against it once per
+       instruction instead of polling each timer; scheduling an event that becomes
+       a timer's first zeroes it. */
+    uint64_t event_deadline_c14m = 0;
+    void run_due_events();
+    inline void poll_events() {
+        if (clock->get_c14m() >= event_deadline_c14m) run_due_events();
+    }
+
+    /* Why run_frame_instructions() returned before the end of the frame. */
+    enum frame_stop_t {
+        FRAME_STOP_NONE,   // ran to the end of the frame
+        FRAME_STOP_BREAK,  // breakpoint, watchpoint or BRK: now in EXEC_STEP_INTO
+        FRAME_STOP_PC,     // about to execute stop_pc
+    };
+    /* The frame's instruction loop, shared by GSSquared and gs2headless: run until
+       the end of the frame or a stop, servicing timer events (and --debug-service
+       protocol commands) as it goes. */
+    frame_stop_t run_frame_instructions(std::optional<uint32_t> stop_pc = std::nullopt);
+    /* Drop into single-step; tells a protocol client why when hit is given. */
+    void enter_step_mode(const StopHit *hit);
+
     EventQueue *event_queue = nullptr;
 
     DeviceFrameDispatcher *device_frame_dispatcher = nullptr;
@@ -135,7 +164,12 @@ struct computer_t {
 
     // Status, Statistics, etc.
     Metrics event_times, audio_times, app_event_times, display_times, device_times;
+    // Parts of display_times: generate + render on the render worker (overlaps emulation),
+    // and the texture upload on the main thread.
+    Metrics video_generate_times, video_upload_times;
     uint64_t frame_count = 0, status_count = 0;
+    uint64_t frames_presented = 0;  // of the frame_count frames in this status window
+    uint64_t last_present_ns = 0;   // SDL_GetTicksNS() of the last presented frame
     uint64_t last_5sec_cycles = 0;
     uint64_t last_frame_end_time = 0, last_5sec_update = 0;
     uint64_t frame_start_cycle = 0;
@@ -150,6 +184,7 @@ struct computer_t {
     // Statistics
     float idle_percent = 0.0f;
     double fps = 0;
+    double presented_fps = 0;
     double e_mhz = 0;
     uint64_t clock_slip = 0;
     bool frame_slipped = false;  // set by frame_sleep for this frame only
@@ -159,6 +194,10 @@ struct computer_t {
     uint32_t ludicrous_slip_streak = 0;
     uint32_t ludicrous_stable_frames = 0;
     uint32_t ludicrous_saved_n = 1; // preserved across temporary 14.3 boost (INSERT / RMB)
+
+    // Disk accelerator (-x): the clock runs at gs2_app_values.disk_accelerator_speed while
+    // a floppy motor is on, then goes back to the speed it interrupted.
+    DiskAccelerator disk_accel;
 #ifdef LUDICROUS_BINARY_SEARCH_PROBE
     uint32_t ludicrous_search_low = LUDICROUS_CPU_PER_14M_MIN;
     uint32_t ludicrous_search_high = LUDICROUS_CPU_PER_14M_MAX;
@@ -196,6 +235,19 @@ struct computer_t {
         return ludicrous_cal_state == LS_CAL_PROBE || ludicrous_cal_state == LS_CAL_DROPPING;
     }
     inline bool is_ludicrous_locked() const { return ludicrous_cal_state == LS_CAL_LOCKED; }
+    /** Once per frame: enter or leave the disk accelerator as floppy motors start and stop. */
+    void update_disk_accelerator();
+    /**
+     * Whether this frame gets generated and presented. Outside Ludicrous, or with the
+     * OSD or debugger up, every frame is. In Ludicrous a frame is shown when it is the
+     * one ending nearest the host's next refresh (host_ns after the last present);
+     * frames that end between two host refreshes are skipped.
+     */
+    inline bool should_present_frame(bool ui_active, uint64_t now_ns, uint64_t host_ns,
+                                     uint64_t frame_ns) const {
+        if (ui_active || clock->get_clock_mode() != CLOCK_FREE_RUN) return true;
+        return now_ns + frame_ns / 2 >= last_present_ns + host_ns;
+    }
 
     void set_mmu(MMU_II *mmu) { this->mmu = mmu; }
     void set_cpu(cpu_state *cpu) { this->cpu = cpu; }
@@ -227,12 +279,35 @@ struct computer_t {
                           std::vector<uint8_t> &reply,
                           std::string &err);
 
+    /** Save / restore hooks. Handlers run in registration order on both save and load. */
+    void register_state_handler(std::string name, StateHandler handler);
+    void register_ram_region(std::string name, uint8_t *base, size_t size);
+    bool save_snapshot(const std::string &path, bool incremental, std::string &err);
+    bool load_snapshot(const std::string &path, std::string &err);
+
     void *get_module_state( module_id_t module_id);
     void set_module_state( module_id_t module_id, void *state);
 
     /** Fill II/IIe or IIgs paste buffer. Returns false if neither keyboard module is present. */
     bool start_keyboard_paste(std::string text);
 
+    /**
+     * Tokenize an Applesoft listing on the host and write it straight into guest memory
+     * at TXTTAB, then set VARTAB / ARYTAB / STREND / PRGEND past it as entering it would
+     * (FRETOP = HIMEM, DATA pointer reset). Replaces the program in memory; meant for the
+     * BASIC prompt. False with err set if Applesoft is not in memory or the listing does
+     * not fit below HIMEM.
+     */
+    bool inject_basic_program(const std::string &listing, uint32_t &line_count, std::string &err);
+    /** Copy a binary blob into the CPU's view of memory at address (24-bit on the IIgs). */
+    bool load_binary(uint32_t address, const uint8_t *data, size_t len, std::string &err);
+    /**
+     * Load a dropped file: a .bas / .txt listing is injected as above (keyboard paste if
+     * the guest is not running Applesoft), and a CiderPress-style "NAME#06AAAA" binary is
+     * loaded at $AAAA. False if the file is neither; otherwise status says what happened.
+     */
+    bool load_program_file(const std::string &path, std::string &status);
+
     void send_clock_mode_message(clock_mode_t clock_mode);
     void frame_status_update();
 
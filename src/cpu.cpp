@@ -18,6 +18,7 @@
 #include <cstdio>
 #include <time.h>
 #include <cstdlib>
+#include <utility>
 
 #include "cpu.hpp"
 
@@ -53,6 +54,26 @@ void cpu_state::reset() {
     core->reset(this);
 }
 
+void cpu_state::set_cores(std::unique_ptr<BaseCPU> traced, std::unique_ptr<BaseCPU> untraced) {
+    cpun = std::move(traced);
+    cpun_alt = std::move(untraced);
+    core = cpun.get();
+    core_traced = true;
+}
+
+/**
+ * The cores carry no state of their own between instructions (everything lives
+ * in cpu_state), so swapping is just exchanging the two instances.
+ */
+void cpu_state::set_traced(bool traced) {
+    if (traced == core_traced || !cpun_alt) {
+        return;
+    }
+    std::swap(cpun, cpun_alt);
+    core = cpun.get();
+    core_traced = traced;
+}
+
 void cpu_state::set_wdm_handler(uint8_t operand, wdm_handler_t handler) {
     wdm_handlers[operand] = handler;
 }
@@ -209,7 +209,9 @@ struct cpu_state {
     processor_type cpu_type = PROCESSOR_6502;
 
     std::unique_ptr<BaseCPU> cpun; // CPU instance.
+    std::unique_ptr<BaseCPU> cpun_alt; // same CPU built with the other TraceTraits; see set_traced().
     BaseCPU *core = nullptr;
+    bool core_traced = true; // true if cpun was built with TraceEnabled.
 
     /* Tracing & Debug */
     /* These are CPU controls, leave them here */
@@ -226,6 +228,11 @@ struct cpu_state {
     void set_processor(processor_type new_cpu_type);
     void reset();
     
+    /** Install traced and trace-free instances of the same CPU; the traced one starts active. */
+    void set_cores(std::unique_ptr<BaseCPU> traced, std::unique_ptr<BaseCPU> untraced);
+    /** Swap to the traced or trace-free core. Only call between instructions. */
+    void set_traced(bool traced);
+
     void set_mmu(MMU *mmu) { this->mmu = mmu; }
     void set_wdm_handler(uint8_t operand, wdm_handler_t handler);
 };
@@ -25,6 +25,9 @@ public:
 };
 
 // Factory function for creating 6502 instances
-std::unique_ptr<BaseCPU> create6502(NClock *clock) {
+std::unique_ptr<BaseCPU> create6502(NClock *clock, bool trace) {
+    if (!trace) {
+        return std::make_unique<CPU6502Core<CPU6502Traits, TraceDisabled>>(clock);
+    }
     return std::make_unique<CPU6502>(clock);
 }
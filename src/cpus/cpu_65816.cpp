@@ -56,13 +56,23 @@ private:
         } */
     }
 
+    // All five width cores share one TraceTraits, so a mode switch never changes tracing.
+    template<typename TraceTraits>
+    void create_cores(NClock *clock) {
+        emulation_core = std::make_unique<CPU6502Core<CPU65816_E_8_8_Traits, TraceTraits>>(clock);
+        native_8_8_core = std::make_unique<CPU6502Core<CPU65816_N_8_8_Traits, TraceTraits>>(clock);
+        native_16_8_core = std::make_unique<CPU6502Core<CPU65816_N_16_8_Traits, TraceTraits>>(clock);
+        native_8_16_core = std::make_unique<CPU6502Core<CPU65816_N_8_16_Traits, TraceTraits>>(clock);
+        native_16_16_core = std::make_unique<CPU6502Core<CPU65816_N_16_16_Traits, TraceTraits>>(clock);
+    }
+
 public:
-    CPU65816(NClock *clock) : BaseCPU(clock) {
-        emulation_core = std::make_unique<CPU6502Core<CPU65816_E_8_8_Traits>>(clock);
-        native_8_8_core = std::make_unique<CPU6502Core<CPU65816_N_8_8_Traits>>(clock);
-        native_16_8_core = std::make_unique<CPU6502Core<CPU65816_N_16_8_Traits>>(clock);
-        native_8_16_core = std::make_unique<CPU6502Core<CPU65816_N_8_16_Traits>>(clock);
-        native_16_16_core = std::make_unique<CPU6502Core<CPU65816_N_16_16_Traits>>(clock);
+    CPU65816(NClock *clock, bool trace = true) : BaseCPU(clock) {
+        if (trace) {
+            create_cores<TraceEnabled>(clock);
+        } else {
+            create_cores<TraceDisabled>(clock);
+        }
         
         current_core = emulation_core.get(); // Start in emulation mode
     }
@@ -83,7 +93,7 @@ public:
 
 
 // Factory function for creating 65816 instances
-std::unique_ptr<BaseCPU> create65816(NClock *clock) {
-    return std::make_unique<CPU65816>(clock);
+std::unique_ptr<BaseCPU> create65816(NClock *clock, bool trace) {
+    return std::make_unique<CPU65816>(clock, trace);
 }
 
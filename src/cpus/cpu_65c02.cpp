@@ -25,6 +25,9 @@ public:
 };
 
 // Factory function for creating 65C02 instances
-std::unique_ptr<BaseCPU> create65C02(NClock *clock) {
+std::unique_ptr<BaseCPU> create65C02(NClock *clock, bool trace) {
+    if (!trace) {
+        return std::make_unique<CPU6502Core<CPU65C02Traits, TraceDisabled>>(clock);
+    }
     return std::make_unique<CPU65C02>(clock);
 } 
\ No newline at end of file
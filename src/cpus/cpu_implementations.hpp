@@ -11,5 +11,6 @@ class CPU6502;
 class CPU65C02;
 class CPU65816;
 
-// Factory function to create CPU instances
-std::unique_ptr<BaseCPU> createCPU(const processor_type cpuType, NClock *clock); 
\ No newline at end of file
+// Factory function to create CPU instances. trace=false builds the cores with
+// TraceDisabled, which compiles out all per-instruction trace bookkeeping.
+std::unique_ptr<BaseCPU> createCPU(const processor_type cpuType, NClock *clock, bool trace = true);
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "debugger/BreakpointTable.hpp"
 
 #include "cpu.hpp"
+#include "NClock.hpp"
+#include "mmus/mmu.hpp"
 
 namespace {
 
@@ -79,6 +81,7 @@ uint32_t BreakpointTable::add(const bp_entry_t &in, const char **error_msg) {
         enabled_count_++;
     }
     entries_.push_back(e);
+    rebuild_index();
     return e.id;
 }
 
@@ -89,6 +92,7 @@ bool BreakpointTable::clear_id(uint32_t id) {
                 enabled_count_--;
             }
             entries_.erase(it);
+            rebuild_index();
             return true;
         }
     }
@@ -98,6 +102,7 @@ bool BreakpointTable::clear_id(uint32_t id) {
 void BreakpointTable::clear_all() {
     entries_.clear();
     enabled_count_ = 0;
+    rebuild_index();
 }
 
 bool BreakpointTable::set_enabled(uint32_t id, bool enabled) {
@@ -113,9 +118,56 @@ bool BreakpointTable::set_enabled(uint32_t id, bool enabled) {
         e->flags &= ~BP_FLAG_ENABLED;
         enabled_count_--;
     }
+    rebuild_index();
     return true;
 }
 
+void BreakpointTable::rebuild_index() {
+    trapped_count_ = 0;
+    if (mmu_) {
+        mmu_->clear_watches();
+        for (const bp_entry_t &e : entries_) {
+            if (!is_trapped(e)) {
+                continue;
+            }
+            uint32_t base = e.address & e.addr_mask;
+            uint64_t end = (uint64_t)base + e.length - 1;
+            if (end > 0xFFFFFF) {
+                end = 0xFFFFFF;
+            }
+            mmu_->watch_range(base, (uint32_t)end, e.access);
+            trapped_count_++;
+        }
+    }
+
+    for (auto &bits : exec_bank_bits_) {
+        bits.clear();
+    }
+    exec_unindexed_ = false;
+    for (const bp_entry_t &e : entries_) {
+        if ((e.flags & BP_FLAG_ENABLED) == 0 || e.kind != BP_KIND_EXEC) {
+            continue;
+        }
+        if ((e.addr_mask & 0xFFFFFF) != 0xFFFFFF) {
+            exec_unindexed_ = true;
+            return;
+        }
+        // With the low 24 bits unmasked a pc matches exactly [base, base + length).
+        uint32_t base = e.address & e.addr_mask;
+        uint64_t end = (uint64_t)base + e.length;
+        if (end > 0x1000000) {
+            end = 0x1000000;
+        }
+        for (uint32_t a = base; a < end; a++) {
+            std::vector<uint64_t> &bits = exec_bank_bits_[a >> 16];
+            if (bits.empty()) {
+                bits.resize(0x10000 / 64);
+            }
+            bits[(a & 0xFFFF) >> 6] |= 1ULL << (a & 63);
+        }
+    }
+}
+
 bp_entry_t *BreakpointTable::find(uint32_t id) {
     for (auto &e : entries_) {
         if (e.id == id) {
@@ -125,6 +177,45 @@ bp_entry_t *BreakpointTable::find(uint32_t id) {
     return nullptr;
 }
 
+void BreakpointTable::attach_mmu(MMU *mmu, cpu_state *cpu, NClock *clock) {
+    if (mmu_ && mmu_ != mmu) {
+        mmu_->clear_watches();
+    }
+    mmu_ = mmu;
+    cpu_ = cpu;
+    clock_ = clock;
+    watch_hit_.reset();
+    if (mmu_) {
+        mmu_->set_watch_handler({watch_hit, this});
+    }
+    rebuild_index();
+}
+
+// Runs inside the trapped access, after it completes. Keeps the first hit until the
+// run loop takes it at the end of the instruction.
+void BreakpointTable::watch_hit(void *context, uint32_t address, uint8_t value, bool is_write) {
+    BreakpointTable *t = static_cast<BreakpointTable *>(context);
+    if (!t->watch_armed_ || t->watch_hit_) {
+        return;
+    }
+    uint8_t access = is_write ? BP_ACCESS_W : BP_ACCESS_R;
+    for (bp_entry_t &e : t->entries_) {
+        if (!t->is_trapped(e)) {
+            continue;
+        }
+        if (!t->address_match(address, e) || !t->access_match(e.access, is_write) || !t->data_match(e, value)) {
+            continue;
+        }
+        uint32_t pc = t->cpu_ ? t->cpu_->full_pc : 0;
+        auto hit = t->maybe_hit(e, STOP_BP_DATA, pc, address, access, value);
+        if (hit) {
+            hit->cycle = t->clock_ ? t->clock_->get_cycles() : 0;
+            t->watch_hit_ = hit;
+            return;
+        }
+    }
+}
+
 bool BreakpointTable::address_match(uint32_t observed, const bp_entry_t &e) const {
     uint32_t masked_a = observed & e.addr_mask;
     uint32_t masked_base = e.address & e.addr_mask;
@@ -196,31 +287,22 @@ std::optional<StopHit> BreakpointTable::check_pre(cpu_state *cpu) {
             return std::nullopt;
         }
     }
-    for (size_t i = 0; i < entries_.size();) {
-        bp_entry_t &e = entries_[i];
+    if (!exec_candidate(fullpc)) {
+        return std::nullopt;
+    }
+    // maybe_hit only removes an entry (temporary) when it returns a hit, so an
+    // ignored hit leaves entries_ as it was.
+    for (bp_entry_t &e : entries_) {
         if ((e.flags & BP_FLAG_ENABLED) == 0 || e.kind != BP_KIND_EXEC) {
-            ++i;
             continue;
         }
         if (!address_match(fullpc, e)) {
-            ++i;
             continue;
         }
-        uint32_t id = e.id;
         auto hit = maybe_hit(e, STOP_BP_EXEC, fullpc, 0, BP_ACCESS_NONE, 0);
         if (hit) {
             return hit;
         }
-        size_t j = 0;
-        for (; j < entries_.size(); ++j) {
-            if (entries_[j].id == id) {
-                i = j + 1;
-                break;
-            }
-        }
-        if (j >= entries_.size()) {
-            break;
-        }
     }
     return std::nullopt;
 }
@@ -244,7 +326,9 @@ std::optional<StopHit> BreakpointTable::check_post(cpu_state *cpu, const system_
         }
         bool matched = false;
         uint32_t reason = 0;
-        if (e.kind == BP_KIND_DATA) {
+        if (is_trapped(e)) {
+            // reported from the MMU trap instead
+        } else if (e.kind == BP_KIND_DATA) {
             if (address_match(eaddr, e) && access_match(e.access, is_write) && data_match(e, observed)) {
                 matched = true;
                 reason = STOP_BP_DATA;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <optional>
 #include <vector>
@@ -7,6 +8,8 @@
 #include "debugger/trace.hpp"
 
 struct cpu_state;
+class MMU;
+class NClock;
 
 // Wire / logical constants (Docs/DebugProtocol.md)
 constexpr uint8_t BP_KIND_EXEC = 1;
@@ -55,6 +58,7 @@ struct StopHit {
     uint32_t pc = 0;
     uint32_t eaddr = 0;
     uint32_t value = 0;
+    uint64_t cycle = 0;     // CPU cycle of the access, for DATA hits caught by a watch trap
 };
 
 class BreakpointTable {
@@ -62,6 +66,10 @@ public:
     BreakpointTable() = default;
 
     bool has_enabled() const { return enabled_count_ > 0; }
+    /** Enabled entries that need check_pre / check_post on every instruction. */
+    bool needs_instruction_checks() const { return enabled_count_ > trapped_count_; }
+    /** Enabled DATA entries the MMU traps; hits arrive via take_watch_hit(). */
+    bool has_watch_traps() const { return trapped_count_ > 0; }
     size_t size() const { return entries_.size(); }
 
     /** Returns new id, or 0 on failure (full / invalid). error_msg may be set. */
@@ -77,6 +85,21 @@ public:
     std::optional<StopHit> check_pre(cpu_state *cpu);
     std::optional<StopHit> check_post(cpu_state *cpu, const system_trace_entry_t *entry);
 
+    /**
+     * DATA entries whose addr_mask keeps the low 24 bits become MMU page traps on mmu
+     * (the CPU's view of memory), so only accesses to watched pages cost anything.
+     * cpu and clock supply the pc and cycle of a hit.
+     */
+    void attach_mmu(MMU *mmu, cpu_state *cpu, NClock *clock);
+    /** Watch traps only stop execution while armed (the run loop's CPU loop). */
+    void set_watch_armed(bool armed) { watch_armed_ = armed; }
+    bool watch_hit_pending() const { return watch_hit_.has_value(); }
+    std::optional<StopHit> take_watch_hit() {
+        std::optional<StopHit> hit = watch_hit_;
+        watch_hit_.reset();
+        return hit;
+    }
+
     /** Policy A: suppress EXEC at pc until PC leaves or one insn retires. */
     void arm_exec_suppress(uint32_t pc);
     void clear_exec_suppress();
@@ -87,6 +110,21 @@ private:
     bool io_match(uint32_t eaddr, const bp_entry_t &e) const;
     bool access_match(uint8_t access_flags, bool is_write) const;
     bool data_match(const bp_entry_t &e, uint8_t observed_byte) const;
+    /** Rebuild the exec index and the MMU watch traps; called whenever entries_ change. */
+    void rebuild_index();
+    bool is_trapped(const bp_entry_t &e) const {
+        return mmu_ && (e.flags & BP_FLAG_ENABLED) && e.kind == BP_KIND_DATA
+            && (e.addr_mask & 0xFFFFFF) == 0xFFFFFF;
+    }
+    static void watch_hit(void *context, uint32_t address, uint8_t value, bool is_write);
+    /** One bit test: could an enabled EXEC entry match this pc? */
+    inline bool exec_candidate(uint32_t pc) const {
+        if (exec_unindexed_ || pc > 0xFFFFFF) {
+            return true;
+        }
+        const std::vector<uint64_t> &bits = exec_bank_bits_[pc >> 16];
+        return !bits.empty() && ((bits[(pc & 0xFFFF) >> 6] >> (pc & 63)) & 1);
+    }
     std::optional<StopHit> maybe_hit(bp_entry_t &e, uint32_t reason, uint32_t pc,
                                      uint32_t eaddr, uint8_t access, uint32_t value);
 
@@ -94,6 +132,19 @@ private:
     uint32_t next_id_ = 1;
     uint32_t enabled_count_ = 0;
 
+    // Enabled EXEC entries, one bit per address; a bank with none has an empty vector.
+    // An entry whose addr_mask drops any of the low 24 bits can't be indexed and sets
+    // exec_unindexed_, which sends every pc to the full scan.
+    std::array<std::vector<uint64_t>, 256> exec_bank_bits_;
+    bool exec_unindexed_ = false;
+
+    MMU *mmu_ = nullptr;
+    cpu_state *cpu_ = nullptr;
+    NClock *clock_ = nullptr;
+    uint32_t trapped_count_ = 0;
+    bool watch_armed_ = false;
+    std::optional<StopHit> watch_hit_;
+
     bool suppress_exec_active_ = false;
     uint32_t suppress_exec_pc_ = 0;
 };
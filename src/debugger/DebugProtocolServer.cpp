@@ -1,12 +1,14 @@
 #include "debugger/DebugProtocolServer.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <deque>
 #include <limits>
+#include <new>
 #include <vector>
 
 #if defined(_WIN32)
@@ -54,6 +56,9 @@ constexpr uint32_t kTypePing      = 0x00000002;
 constexpr uint32_t kTypeError     = 0x00000003;
 constexpr uint32_t kTypeEvent     = 0x00000004;
 constexpr uint32_t kTypeQuit      = 0x00000005;
+constexpr uint32_t kTypeBatch     = 0x00000006;
+constexpr uint32_t kTypeSubscribe = 0x00000007;
+constexpr uint32_t kTypeUnsubscribe = 0x00000008;
 constexpr uint32_t kTypeGetStatus = 0x00000101;
 constexpr uint32_t kTypeReset     = 0x00000102;
 constexpr uint32_t kTypePause     = 0x00000103;
@@ -65,6 +70,7 @@ constexpr uint32_t kTypeSetRegs   = 0x00000203;
 constexpr uint32_t kTypeReadMem   = 0x00000301;
 constexpr uint32_t kTypeWriteMem  = 0x00000302;
 constexpr uint32_t kTypeFindMem   = 0x00000303;
+constexpr uint32_t kTypeMemShare  = 0x00000304;
 constexpr uint32_t kTypeStateGet  = 0x00000601;
 constexpr uint32_t kTypeStateSet  = 0x00000602;
 constexpr uint32_t kTypeBpSet     = 0x00000401;
@@ -74,12 +80,16 @@ constexpr uint32_t kTypeBpEnable  = 0x00000404;
 constexpr uint32_t kTypeBpList    = 0x00000405;
 constexpr uint32_t kTypeKeyEvent  = 0x00000501;
 constexpr uint32_t kTypePasteText = 0x00000502;
+constexpr uint32_t kTypePasteBasic = 0x00000503;
 constexpr uint32_t kTypeVideoText = 0x00000701;
 constexpr uint32_t kTypeMount     = 0x00000801;
 constexpr uint32_t kTypeUnmount   = 0x00000802;
+constexpr uint32_t kTypeSnapSave  = 0x00000901;
+constexpr uint32_t kTypeSnapLoad  = 0x00000902;
 
 constexpr uint32_t kEvtStopped   = 1;
 constexpr uint32_t kEvtRunState  = 2;
+constexpr uint32_t kEvtUpdate    = 3;
 
 constexpr uint32_t kBpSetPayloadSize = 32;
 constexpr uint32_t kBpListRecordSize = 40;
@@ -106,6 +116,29 @@ constexpr uint32_t kRegMaskAll =
 
 constexpr uint32_t kFindMemHasMask = 1u << 0;
 
+constexpr uint32_t kMemShareWritable = 1u << 0;
+constexpr uint32_t kMemSharePageSize = 256;
+constexpr uint32_t kMemShareTableHeader = 16;       // generation, page_count, page_size, reserved
+constexpr uint32_t kMemShareClosed = 0xFFFFFFFFu;   // generation of a window that no longer updates
+constexpr uint32_t kMemShareReplySize = 16;
+
+// The table's generation word, which the client polls from another process.
+static_assert(sizeof(std::atomic<uint32_t>) == 4 && std::atomic<uint32_t>::is_always_lock_free,
+              "MEMSHARE generation must be a plain lock-free 32-bit word");
+
+std::atomic<uint32_t> &share_generation(SharedRam &table) {
+    return *std::launder(reinterpret_cast<std::atomic<uint32_t> *>(table.data()));
+}
+
+constexpr uint32_t kSubMem = 1;
+constexpr uint32_t kSubRegs = 2;
+constexpr uint32_t kSubTrace = 3;
+constexpr uint32_t kSubscribePayloadSize = 24;
+constexpr uint32_t kMaxSubscriptions = 64;
+constexpr uint32_t kSubUpdateHeader = 24;          // sub_id, kind, flags, reserved, cycle (u64)
+constexpr uint32_t kSubClosed = 1u << 0;           // update flag: the subscription has ended
+constexpr uint32_t kSubMergeGap = 8;               // unchanged bytes a MEM run may span
+
 constexpr uint32_t kVideoPageCurrent = 0;
 constexpr uint32_t kVideoModeCurrent = 0;
 constexpr uint32_t kVideoModeText40 = 1;
@@ -128,6 +161,11 @@ constexpr uint32_t kMediaBadPath       = 4;
 constexpr uint32_t kMaxMediaPathLen    = 4096;
 constexpr uint32_t kMaxMediaUnit       = 5;
 
+constexpr uint32_t kSnapOk          = 0;
+constexpr uint32_t kSnapFailed      = 1;
+constexpr uint32_t kSnapBadPath     = 2;
+constexpr uint32_t kSnapIncremental = 1u << 0;
+
 constexpr uint32_t kMemMain    = 0;
 constexpr uint32_t kMemMegaII  = 1;
 constexpr uint32_t kMemEnsoniq = 2;
@@ -143,6 +181,8 @@ constexpr uint32_t kEBusy          = 5;
 constexpr uint32_t kEInternal      = 6;
 
 constexpr int kMainThreadTimeoutMs = 5000;
+constexpr uint32_t kMaxBatchEntries = 256;
+constexpr size_t kMaxPendingRequests = 1024;   // read-ahead limit; the socket is left unread beyond it
 constexpr DebugSocketHandle kInvalidSocket = -1;
 
 #if defined(_WIN32)
@@ -179,6 +219,30 @@ void shutdown_socket(DebugSocketHandle fd) {
 }
 #endif
 
+// Commands that change run state, breakpoints, media or whole-machine state wait for the
+// frame boundary; the rest may also run between instruction blocks.
+bool frame_only_type(uint32_t type) {
+    switch (type) {
+    case kTypeQuit:
+    case kTypeReset:
+    case kTypePause:
+    case kTypeContinue:
+    case kTypeStepInto:
+    case kTypeStateSet:
+    case kTypeBpSet:
+    case kTypeBpClear:
+    case kTypeBpClearAll:
+    case kTypeBpEnable:
+    case kTypeMount:
+    case kTypeUnmount:
+    case kTypeSnapSave:
+    case kTypeSnapLoad:
+        return true;
+    default:
+        return false;
+    }
+}
+
 void remove_socket_path(const std::string &path) {
     if (!path.empty()) {
         std::remove(path.c_str());
@@ -353,8 +417,42 @@ bool read_domain_bytes(computer_t *computer, uint32_t domain, uint32_t address,
     return false;
 }
 
+// The allocation behind a raw RAM domain, for MEMSHARE.
+const SharedRam *ram_block_for(computer_t *computer, uint32_t domain, uint32_t &error, bool &megaii_reject) {
+    MMU *mmu = nullptr;
+    if (domain == kMemMainRaw) {
+        if (computer && computer->cpu) mmu = computer->cpu->mmu;
+    } else if (domain == kMemMegaIIRaw) {
+        if (!computer || !computer->platform || !platform_is_iigs(computer->platform->id)) {
+            error = kEInternal;
+            megaii_reject = true;
+            return nullptr;
+        }
+        mmu = computer->mmu;
+    }
+    const SharedRam *block = mmu ? mmu->get_memory_block() : nullptr;
+    if (!block || !block->data() || block->data() != mmu->get_memory_base()) {
+        error = kEInternal;
+        return nullptr;
+    }
+    return block;
+}
+
+void close_fds(std::vector<int> &fds) {
+#if !defined(_WIN32)
+    for (int fd : fds) {
+        if (fd >= 0) ::close(fd);
+    }
+#endif
+    fds.clear();
+}
+
 } // namespace
 
+DebugProtocolServer::BridgeJob::~BridgeJob() {
+    close_fds(reply_fds);
+}
+
 DebugProtocolServer::DebugProtocolServer(std::string socket_path)
     : socket_path_(std::move(socket_path)) {}
 
@@ -500,46 +598,397 @@ void DebugProtocolServer::stop() {
 #endif
 }
 
+void DebugProtocolServer::update_bridge_state_locked() {
+    bridge_mid_frame_work_.store(!bridge_queue_.empty() && !bridge_queue_.front()->frame_only,
+                                 std::memory_order_relaxed);
+}
+
 void DebugProtocolServer::wake_bridge_locked() {
-    if (bridge_pending_ && !bridge_done_) {
-        bridge_error_ = kEInternal;
-        bridge_done_ = true;
-        bridge_cv_.notify_one();
+    for (const auto &job : bridge_queue_) {
+        job->error = kEInternal;
+        job->done.store(true, std::memory_order_release);
     }
+    bridge_queue_.clear();
+    update_bridge_state_locked();
+    bridge_cv_.notify_all();
 }
 
 void DebugProtocolServer::process_main_thread(computer_t *computer) {
-    std::lock_guard<std::mutex> lock(bridge_mu_);
-    if (!bridge_pending_ || bridge_done_) {
+    drain_bridge(computer, false);
+    if (!ram_shares_.empty()) {
+        update_ram_shares(computer);
+    }
+    if (!subscriptions_.empty()) {
+        update_subscriptions(computer);
+    }
+}
+
+void DebugProtocolServer::open_ram_share(computer_t *computer, BridgeJob &job) {
+    const uint32_t domain = job.arg0;
+    const bool writable = (job.arg1 & kMemShareWritable) != 0;
+    const SharedRam *block = ram_block_for(computer, domain, job.error, job.megaii_platform_reject);
+    if (!block) {
+        return;
+    }
+    if (!block->shareable()) {
+        job.error = kEInternal;
+        job.error_text = "memory not shareable";
+        return;
+    }
+
+    auto share = std::make_unique<RamShare>();
+    share->domain = domain;
+    share->session = client_session_.load();
+    share->block = block;
+    share->base = block->data();
+    const uint32_t size = static_cast<uint32_t>(block->size());
+    const uint32_t page_count = (size + kMemSharePageSize - 1) / kMemSharePageSize;
+    uint32_t *table = reinterpret_cast<uint32_t *>(
+        share->table.allocate(kMemShareTableHeader + static_cast<size_t>(page_count) * 4));
+    new (table) std::atomic<uint32_t>(0);
+    table[1] = page_count;
+    table[2] = kMemSharePageSize;
+    share->shadow.assign(share->base, share->base + size);
+
+    job.reply_fds.push_back(block->share_fd(writable));
+    job.reply_fds.push_back(share->table.share_fd(false));
+    if (job.reply_fds[0] < 0 || job.reply_fds[1] < 0) {
+        close_fds(job.reply_fds);
+        job.error = kEInternal;
+        job.error_text = "memory not shareable";
+        return;
+    }
+
+    // A newer window on the same domain replaces the old one.
+    for (auto it = ram_shares_.begin(); it != ram_shares_.end(); ++it) {
+        if ((*it)->domain == domain) {
+            share_generation((*it)->table).store(kMemShareClosed, std::memory_order_release);
+            ram_shares_.erase(it);
+            break;
+        }
+    }
+    ram_shares_.push_back(std::move(share));
+
+    const uint32_t flags = writable ? kMemShareWritable : 0;
+    job.reply.resize(kMemShareReplySize);
+    std::memcpy(job.reply.data() + 0, &size, 4);
+    std::memcpy(job.reply.data() + 4, &kMemSharePageSize, 4);
+    std::memcpy(job.reply.data() + 8, &page_count, 4);
+    std::memcpy(job.reply.data() + 12, &flags, 4);
+}
+
+void DebugProtocolServer::update_ram_shares(computer_t *computer) {
+    const uint32_t session = client_session_.load();
+    for (auto it = ram_shares_.begin(); it != ram_shares_.end();) {
+        RamShare &share = **it;
+        std::atomic<uint32_t> &generation = share_generation(share.table);
+        uint32_t error = 0;
+        bool megaii_reject = false;
+        const SharedRam *block = ram_block_for(computer, share.domain, error, megaii_reject);
+        // The client went away, or the machine (and its RAM) did.
+        if (share.session != session || block != share.block || !block || block->data() != share.base) {
+            generation.store(kMemShareClosed, std::memory_order_release);
+            it = ram_shares_.erase(it);
+            continue;
+        }
+
+        uint32_t *page_gen = reinterpret_cast<uint32_t *>(share.table.data() + kMemShareTableHeader);
+        uint32_t next = share.generation + 1;
+        if (next == kMemShareClosed) next = 1;
+        bool changed = false;
+        const size_t size = share.shadow.size();
+        for (size_t off = 0, page = 0; off < size; off += kMemSharePageSize, page++) {
+            const size_t n = std::min<size_t>(kMemSharePageSize, size - off);
+            if (std::memcmp(share.base + off, share.shadow.data() + off, n) != 0) {
+                std::memcpy(share.shadow.data() + off, share.base + off, n);
+                page_gen[page] = next;
+                changed = true;
+            }
+        }
+        if (changed) {
+            // Page stamps first: a client that sees the new generation sees them too.
+            share.generation = next;
+            generation.store(next, std::memory_order_release);
+        }
+        ++it;
+    }
+}
+
+void DebugProtocolServer::subscribe(computer_t *computer, BridgeJob &job) {
+    const uint32_t session = client_session_.load();
+    uint32_t count = 0;
+    for (const auto &sub : subscriptions_) {
+        if (sub->session == session) {
+            count++;
+        }
+    }
+    if (count >= kMaxSubscriptions) {
+        job.error = kEBadLength;
+        job.error_text = "too many subscriptions";
         return;
     }
 
-    bridge_reply_.clear();
-    bridge_error_ = 0;
-    bridge_error_text_.clear();
-    bridge_timed_out_ = false;
-    bridge_megaii_platform_reject_ = false;
+    auto sub = std::make_unique<Subscription>();
+    uint32_t period = 0;
+    std::memcpy(&sub->kind, job.request.data() + 0, 4);
+    std::memcpy(&period, job.request.data() + 8, 4);
+    sub->session = session;
+    sub->period = period ? period : 1;
+
+    if (sub->kind == kSubMem) {
+        sub->domain = job.arg0;
+        sub->address = job.arg1;
+        sub->length = job.arg2;
+        // Same checks as READMEM; the first update carries the whole range.
+        std::vector<uint8_t> probe;
+        if (!read_domain_bytes(computer, sub->domain, sub->address, sub->length, probe, job.error,
+                               job.megaii_platform_reject, job.error_text)) {
+            return;
+        }
+    } else if (sub->kind == kSubRegs) {
+        if (!computer || !computer->cpu) {
+            job.error = kEInternal;
+            return;
+        }
+    } else {
+        if (!computer || !computer->cpu || !computer->cpu->trace_buffer) {
+            job.error = kEInternal;
+            return;
+        }
+        sub->max_entries = job.arg0;
+        sub->trace = computer->cpu->trace_buffer;
+        sub->trace_total = sub->trace->total;
+    }
+
+    // Held until the reply is written, so the first update cannot overtake it.
+    sub->in_flight->store(true, std::memory_order_relaxed);
+    job.hold_until_reply = sub->in_flight;
+    sub->id = next_subscription_id_++;
+    if (next_subscription_id_ == 0) {
+        next_subscription_id_ = 1;
+    }
+    job.reply.resize(4);
+    std::memcpy(job.reply.data(), &sub->id, 4);
+    subscriptions_.push_back(std::move(sub));
+}
+
+void DebugProtocolServer::unsubscribe(BridgeJob &job) {
+    const uint32_t session = client_session_.load();
+    for (auto it = subscriptions_.begin(); it != subscriptions_.end(); ++it) {
+        if ((*it)->id == job.arg0 && (*it)->session == session) {
+            subscriptions_.erase(it);
+            return;
+        }
+    }
+    job.error = kEInternal;
+    job.error_text = "unknown id";
+}
+
+bool DebugProtocolServer::poll_subscription(computer_t *computer, Subscription &sub, std::vector<uint8_t> &out,
+                                            bool &closed) {
+    closed = false;
+    if (sub.kind == kSubMem) {
+        std::vector<uint8_t> now;
+        uint32_t error = 0;
+        bool megaii_reject = false;
+        std::string error_text;
+        if (!read_domain_bytes(computer, sub.domain, sub.address, sub.length, now, error, megaii_reject,
+                               error_text)) {
+            closed = true;
+            return true;
+        }
+        // Runs of changed bytes: run_count, then { offset, length, bytes }. Runs closer than
+        // kSubMergeGap are merged; if that is still no smaller than the range, send it whole.
+        out.resize(4);
+        uint32_t runs = 0;
+        if (sub.primed) {
+            size_t i = 0;
+            while (i < now.size()) {
+                if (now[i] == sub.sent[i]) {
+                    i++;
+                    continue;
+                }
+                size_t end = i + 1;
+                size_t last = i;
+                while (end < now.size() && end - last <= kSubMergeGap) {
+                    if (now[end] != sub.sent[end]) {
+                        last = end;
+                    }
+                    end++;
+                }
+                const uint32_t offset = static_cast<uint32_t>(i);
+                const uint32_t run_len = static_cast<uint32_t>(last + 1 - i);
+                const size_t at = out.size();
+                out.resize(at + 8 + run_len);
+                std::memcpy(out.data() + at, &offset, 4);
+                std::memcpy(out.data() + at + 4, &run_len, 4);
+                std::memcpy(out.data() + at + 8, now.data() + i, run_len);
+                runs++;
+                i = last + 1;
+            }
+            if (runs == 0) {
+                return false;
+            }
+        }
+        if (!sub.primed || out.size() > 12 + now.size()) {
+            const uint32_t offset = 0;
+            runs = 1;
+            out.resize(12 + now.size());
+            std::memcpy(out.data() + 4, &offset, 4);
+            std::memcpy(out.data() + 8, &sub.length, 4);
+            std::memcpy(out.data() + 12, now.data(), now.size());
+        }
+        std::memcpy(out.data(), &runs, 4);
+        sub.sent = std::move(now);
+        return true;
+    }
+
+    if (sub.kind == kSubRegs) {
+        if (!computer || !computer->cpu) {
+            closed = true;
+            return true;
+        }
+        system_trace_entry_t live{};
+        fill_live_trace(computer, &live);
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&live);
+        if (sub.primed && std::memcmp(sub.sent.data(), bytes, kTraceEntrySize) == 0) {
+            return false;
+        }
+        sub.sent.assign(bytes, bytes + kTraceEntrySize);
+        out = sub.sent;
+        return true;
+    }
+
+    // Trace tail: entries added since the last update, newest max_entries of them.
+    if (!computer || !computer->cpu || computer->cpu->trace_buffer != sub.trace) {
+        closed = true;
+        return true;
+    }
+    const system_trace_buffer *tb = sub.trace;
+    const uint64_t added = tb->total - sub.trace_total;
+    if (added == 0) {
+        return false;
+    }
+    uint64_t returned = std::min<uint64_t>(added, tb->count);
+    returned = std::min<uint64_t>(returned, sub.max_entries);
+    const uint32_t dropped = static_cast<uint32_t>(std::min<uint64_t>(added - returned, 0xFFFFFFFFu));
+    const uint32_t count = static_cast<uint32_t>(returned);
+    sub.trace_total = tb->total;
+    out.resize(8 + static_cast<size_t>(count) * kTraceEntrySize);
+    std::memcpy(out.data() + 0, &dropped, 4);
+    std::memcpy(out.data() + 4, &count, 4);
+    const size_t sz = tb->size;
+    size_t idx = (tb->head + sz - count) % sz;
+    for (uint32_t i = 0; i < count; ++i) {
+        std::memcpy(out.data() + 8 + static_cast<size_t>(i) * kTraceEntrySize, &tb->entries[idx], kTraceEntrySize);
+        if (++idx >= sz) {
+            idx = 0;
+        }
+    }
+    return true;
+}
+
+void DebugProtocolServer::update_subscriptions(computer_t *computer) {
+    const uint32_t session = client_session_.load();
+    const uint64_t cycle = (computer && computer->clock) ? computer->clock->get_cycles() : 0;
+    std::vector<uint8_t> body;
+    for (auto it = subscriptions_.begin(); it != subscriptions_.end();) {
+        Subscription &sub = **it;
+        if (sub.session != session) {
+            it = subscriptions_.erase(it);
+            continue;
+        }
+        if (sub.frames_left > 0) {
+            sub.frames_left--;
+        }
+        // The client has not been sent the last update yet: let changes pile up into the next one.
+        if (sub.frames_left > 0 || sub.in_flight->load(std::memory_order_acquire)) {
+            ++it;
+            continue;
+        }
+        bool closed = false;
+        body.clear();
+        if (!poll_subscription(computer, sub, body, closed)) {
+            ++it;
+            continue;
+        }
+        if (closed) {
+            body.clear();
+        }
+        const uint32_t flags = closed ? kSubClosed : 0;
+        const uint32_t reserved = 0;
+        QueuedEvent event;
+        event.data.resize(4 + kSubUpdateHeader + body.size());
+        uint8_t *p = event.data.data();
+        std::memcpy(p + 0, &kEvtUpdate, 4);
+        std::memcpy(p + 4, &sub.id, 4);
+        std::memcpy(p + 8, &sub.kind, 4);
+        std::memcpy(p + 12, &flags, 4);
+        std::memcpy(p + 16, &reserved, 4);
+        std::memcpy(p + 20, &cycle, 8);
+        if (!body.empty()) {
+            std::memcpy(p + 4 + kSubUpdateHeader, body.data(), body.size());
+        }
+        event.in_flight = sub.in_flight;
+        event.session = session;
+        sub.in_flight->store(true, std::memory_order_relaxed);
+        push_event(std::move(event));
+        sub.primed = true;
+        sub.frames_left = sub.period;
+        if (closed) {
+            it = subscriptions_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DebugProtocolServer::drain_bridge(computer_t *computer, bool mid_frame) {
+    std::lock_guard<std::mutex> lock(bridge_mu_);
+    bool ran = false;
+    while (!bridge_queue_.empty()) {
+        std::shared_ptr<BridgeJob> job = bridge_queue_.front();
+        if (mid_frame && job->frame_only) {
+            break;
+        }
+        bridge_queue_.pop_front();
+        run_job(computer, *job);
+        job->done.store(true, std::memory_order_release);
+        ran = true;
+    }
+    update_bridge_state_locked();
+    if (ran) {
+        bridge_cv_.notify_all();
+    }
+}
+
+void DebugProtocolServer::run_job(computer_t *computer, BridgeJob &job) {
+    job.reply.clear();
+    job.error = 0;
+    job.error_text.clear();
+    job.timed_out = false;
+    job.megaii_platform_reject = false;
 
-    if (bridge_type_ == kTypeGetStatus) {
+    if (job.type == kTypeGetStatus) {
         if (!computer) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             uint32_t mode = static_cast<uint32_t>(computer->execution_mode);
             uint32_t platform_id = computer->platform
                 ? static_cast<uint32_t>(computer->platform->id)
                 : 0xFFFFFFFFu;
-            bridge_reply_.resize(8);
-            std::memcpy(bridge_reply_.data() + 0, &mode, 4);
-            std::memcpy(bridge_reply_.data() + 4, &platform_id, 4);
+            job.reply.resize(8);
+            std::memcpy(job.reply.data() + 0, &mode, 4);
+            std::memcpy(job.reply.data() + 4, &platform_id, 4);
         }
-    } else if (bridge_type_ == kTypeReset) {
-        const uint32_t cold_start = bridge_arg0_;
+    } else if (job.type == kTypeReset) {
+        const uint32_t cold_start = job.arg0;
         if (!computer) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             computer->reset(cold_start != 0);
         }
-    } else if (bridge_type_ == kTypeQuit) {
+    } else if (job.type == kTypeQuit) {
         // Force-quit: skip QuitModal / dirty-disk prompts, halt, exit process.
         // Do not SDL_PushEvent(QUIT) — that races with AppQuit when the debug
         // thread is still finishing the QUIT reply.
@@ -548,106 +997,103 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
         if (computer && computer->cpu) {
             computer->cpu->halt = HLT_USER;
         }
-    } else if (bridge_type_ == kTypeReadMem) {
-        const uint32_t domain = bridge_arg0_;
-        const uint32_t address = bridge_arg1_;
-        const uint32_t length = bridge_arg2_;
-        if (!read_domain_bytes(computer, domain, address, length, bridge_reply_, bridge_error_,
-                               bridge_megaii_platform_reject_, bridge_error_text_)) {
-            // bridge_error_ / flags already set
+    } else if (job.type == kTypeReadMem) {
+        const uint32_t domain = job.arg0;
+        const uint32_t address = job.arg1;
+        const uint32_t length = job.arg2;
+        if (!read_domain_bytes(computer, domain, address, length, job.reply, job.error,
+                               job.megaii_platform_reject, job.error_text)) {
+            // job.error / flags already set
         }
-    } else if (bridge_type_ == kTypeWriteMem) {
-        const uint32_t domain = bridge_arg0_;
-        const uint32_t address = bridge_arg1_;
-        const uint32_t length = bridge_arg2_;
+    } else if (job.type == kTypeWriteMem) {
+        const uint32_t domain = job.arg0;
+        const uint32_t address = job.arg1;
+        const uint32_t length = job.arg2;
 
         if (domain == kMemMain) {
             if (!computer || !computer->cpu || !computer->cpu->mmu) {
-                bridge_error_ = kEInternal;
-            } else if (bridge_request_.size() != length) {
-                bridge_error_ = kEInternal;
+                job.error = kEInternal;
+            } else if (job.request.size() != length) {
+                job.error = kEInternal;
             } else {
-                MMU *mmu = computer->cpu->mmu;
-                for (uint32_t i = 0; i < length; ++i) {
-                    mmu->write(address + i, bridge_request_[i]);
-                }
+                computer->cpu->mmu->write_block(address, job.request.data(), length);
             }
         } else if (domain == kMemMegaII) {
             if (!computer || !computer->platform
                 || !platform_is_iigs(computer->platform->id)) {
-                bridge_error_ = kEInternal;
-                bridge_megaii_platform_reject_ = true;
+                job.error = kEInternal;
+                job.megaii_platform_reject = true;
             } else if (!computer->mmu) {
-                bridge_error_ = kEInternal;
-            } else if (bridge_request_.size() != length) {
-                bridge_error_ = kEInternal;
+                job.error = kEInternal;
+            } else if (job.request.size() != length) {
+                job.error = kEInternal;
             } else {
                 MMU *mmu = computer->mmu;
                 for (uint32_t i = 0; i < length; ++i) {
-                    mmu->write(address + i, bridge_request_[i]);
+                    mmu->write(address + i, job.request[i]);
                 }
             }
         } else if (domain == kMemMainRaw) {
             if (!computer || !computer->cpu || !computer->cpu->mmu) {
-                bridge_error_ = kEInternal;
-            } else if (bridge_request_.size() != length) {
-                bridge_error_ = kEInternal;
+                job.error = kEInternal;
+            } else if (job.request.size() != length) {
+                job.error = kEInternal;
             } else {
                 MMU *mmu = computer->cpu->mmu;
                 uint8_t *base = mmu->get_memory_base();
                 uint32_t size = mmu->get_memory_size();
                 if (!base || size == 0) {
-                    bridge_error_ = kEInternal;
+                    job.error = kEInternal;
                 } else if (address > size || length > size - address) {
-                    bridge_error_ = kEBadLength;
+                    job.error = kEBadLength;
                 } else {
-                    std::memcpy(base + address, bridge_request_.data(), length);
+                    std::memcpy(base + address, job.request.data(), length);
                 }
             }
         } else if (domain == kMemMegaIIRaw) {
             if (!computer || !computer->platform
                 || !platform_is_iigs(computer->platform->id)) {
-                bridge_error_ = kEInternal;
-                bridge_megaii_platform_reject_ = true;
+                job.error = kEInternal;
+                job.megaii_platform_reject = true;
             } else if (!computer->mmu) {
-                bridge_error_ = kEInternal;
-            } else if (bridge_request_.size() != length) {
-                bridge_error_ = kEInternal;
+                job.error = kEInternal;
+            } else if (job.request.size() != length) {
+                job.error = kEInternal;
             } else {
                 MMU *mmu = computer->mmu;
                 uint8_t *base = mmu->get_memory_base();
                 uint32_t size = mmu->get_memory_size();
                 if (!base || size == 0) {
-                    bridge_error_ = kEInternal;
+                    job.error = kEInternal;
                 } else if (address > size || length > size - address) {
-                    bridge_error_ = kEBadLength;
+                    job.error = kEBadLength;
                 } else {
-                    std::memcpy(base + address, bridge_request_.data(), length);
+                    std::memcpy(base + address, job.request.data(), length);
                 }
             }
         } else if (domain == kMemEnsoniq) {
             if (!computer || !computer->platform
                 || computer->platform->id != PLATFORM_APPLE_IIGS) {
-                bridge_error_ = kEInternal;
-            } else if (bridge_request_.size() != length) {
-                bridge_error_ = kEInternal;
+                job.error = kEInternal;
+            } else if (job.request.size() != length) {
+                job.error = kEInternal;
             } else {
                 auto *st = static_cast<ensoniq_state_t *>(computer->module_store[MODULE_ENSONIQ]);
                 if (!st || !st->doc_ram) {
-                    bridge_error_ = kEInternal;
-                    bridge_error_text_ = "no ensoniq";
+                    job.error = kEInternal;
+                    job.error_text = "no ensoniq";
                 } else if (address > kDocRamSize || length > kDocRamSize - address) {
-                    bridge_error_ = kEBadLength;
+                    job.error = kEBadLength;
                 } else {
-                    std::memcpy(st->doc_ram + address, bridge_request_.data(), length);
+                    std::memcpy(st->doc_ram + address, job.request.data(), length);
                 }
             }
         } else {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         }
-    } else if (bridge_type_ == kTypePause) {
+    } else if (job.type == kTypePause) {
         if (!computer) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             const execution_modes_t prev = computer->execution_mode;
             computer->execution_mode = EXEC_PAUSED;
@@ -655,9 +1101,9 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
             emit_stopped_pause(computer);
             emit_run_state(static_cast<uint32_t>(EXEC_PAUSED), static_cast<uint32_t>(prev));
         }
-    } else if (bridge_type_ == kTypeContinue) {
+    } else if (job.type == kTypeContinue) {
         if (!computer) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             const execution_modes_t prev = computer->execution_mode;
             computer->execution_mode = EXEC_NORMAL;
@@ -669,25 +1115,27 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
             g_last_stop_reason = 0;
             emit_run_state(static_cast<uint32_t>(EXEC_NORMAL), static_cast<uint32_t>(prev));
         }
-    } else if (bridge_type_ == kTypeStepInto) {
+    } else if (job.type == kTypeStepInto) {
         if (!computer) {
-            bridge_error_ = kEInternal;
-        } else if (bridge_arg0_ == 0) {
-            bridge_error_ = kEBadLength;
-            bridge_error_text_ = "STEP_INTO count must be >= 1";
+            job.error = kEInternal;
+        } else if (job.arg0 == 0) {
+            job.error = kEBadLength;
+            job.error_text = "STEP_INTO count must be >= 1";
         } else {
             const execution_modes_t prev = computer->execution_mode;
             computer->execution_mode = EXEC_STEP_INTO;
-            computer->instructions_left = bridge_arg0_;
+            computer->instructions_left = job.arg0;
             g_last_stop_reason = 0;
             emit_run_state(static_cast<uint32_t>(EXEC_STEP_INTO), static_cast<uint32_t>(prev));
         }
-    } else if (bridge_type_ == kTypeGetTrace) {
+    } else if (job.type == kTypeGetTrace) {
+        // From here on the session keeps the traced core, so later reads see new history.
+        trace_session_ = client_session_.load();
         if (!computer || !computer->cpu || !computer->cpu->trace_buffer) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
-            const uint32_t ago = bridge_arg0_;
-            const uint32_t want = bridge_arg1_;
+            const uint32_t ago = job.arg0;
+            const uint32_t want = job.arg1;
             system_trace_buffer *tb = computer->cpu->trace_buffer;
             const uint32_t available = static_cast<uint32_t>(tb->count);
             uint32_t returned = 0;
@@ -695,13 +1143,13 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
                 const uint32_t max_from_ago = available - ago;
                 returned = want < max_from_ago ? want : max_from_ago;
             }
-            bridge_reply_.resize(8 + static_cast<size_t>(returned) * kTraceEntrySize);
-            std::memcpy(bridge_reply_.data() + 0, &available, 4);
-            std::memcpy(bridge_reply_.data() + 4, &returned, 4);
+            job.reply.resize(8 + static_cast<size_t>(returned) * kTraceEntrySize);
+            std::memcpy(job.reply.data() + 0, &available, 4);
+            std::memcpy(job.reply.data() + 4, &returned, 4);
             if (returned > 0) {
                 const size_t sz = tb->size;
                 size_t idx = (tb->head + sz - static_cast<size_t>(ago) - static_cast<size_t>(returned)) % sz;
-                uint8_t *out = bridge_reply_.data() + 8;
+                uint8_t *out = job.reply.data() + 8;
                 for (uint32_t i = 0; i < returned; ++i) {
                     std::memcpy(out + static_cast<size_t>(i) * kTraceEntrySize,
                                 &tb->entries[idx], kTraceEntrySize);
@@ -712,41 +1160,41 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
                 }
             }
         }
-    } else if (bridge_type_ == kTypeGetRegs) {
+    } else if (job.type == kTypeGetRegs) {
         if (!computer || !computer->cpu) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             system_trace_entry_t live{};
             fill_live_trace(computer, &live);
-            bridge_reply_.resize(kTraceEntrySize);
-            std::memcpy(bridge_reply_.data(), &live, kTraceEntrySize);
+            job.reply.resize(kTraceEntrySize);
+            std::memcpy(job.reply.data(), &live, kTraceEntrySize);
         }
-    } else if (bridge_type_ == kTypeSetRegs) {
+    } else if (job.type == kTypeSetRegs) {
         if (!computer || !computer->cpu) {
-            bridge_error_ = kEInternal;
-        } else if (bridge_request_.size() != kSetRegsPayloadSize) {
-            bridge_error_ = kEBadLength;
+            job.error = kEInternal;
+        } else if (job.request.size() != kSetRegsPayloadSize) {
+            job.error = kEBadLength;
         } else {
             uint32_t mask = 0;
             uint16_t pc = 0, a = 0, x = 0, y = 0, sp = 0, d = 0;
             uint8_t pb = 0, db = 0, p = 0, e = 0;
-            std::memcpy(&mask, bridge_request_.data() + 0, 4);
-            std::memcpy(&pc, bridge_request_.data() + 4, 2);
-            pb = bridge_request_[6];
-            db = bridge_request_[7];
-            std::memcpy(&a, bridge_request_.data() + 8, 2);
-            std::memcpy(&x, bridge_request_.data() + 10, 2);
-            std::memcpy(&y, bridge_request_.data() + 12, 2);
-            std::memcpy(&sp, bridge_request_.data() + 14, 2);
-            std::memcpy(&d, bridge_request_.data() + 16, 2);
-            p = bridge_request_[18];
-            e = bridge_request_[19];
+            std::memcpy(&mask, job.request.data() + 0, 4);
+            std::memcpy(&pc, job.request.data() + 4, 2);
+            pb = job.request[6];
+            db = job.request[7];
+            std::memcpy(&a, job.request.data() + 8, 2);
+            std::memcpy(&x, job.request.data() + 10, 2);
+            std::memcpy(&y, job.request.data() + 12, 2);
+            std::memcpy(&sp, job.request.data() + 14, 2);
+            std::memcpy(&d, job.request.data() + 16, 2);
+            p = job.request[18];
+            e = job.request[19];
             if ((mask & ~kRegMaskAll) != 0) {
-                bridge_error_ = kEBadLength;
-                bridge_error_text_ = "SET_REGS unknown mask bits";
+                job.error = kEBadLength;
+                job.error_text = "SET_REGS unknown mask bits";
             } else if ((mask & kRegE) && e > 1) {
-                bridge_error_ = kEBadLength;
-                bridge_error_text_ = "SET_REGS e must be 0 or 1";
+                job.error = kEBadLength;
+                job.error_text = "SET_REGS e must be 0 or 1";
             } else {
                 cpu_state *cpu = computer->cpu;
                 if (mask & kRegPc) {
@@ -781,30 +1229,30 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
                 }
             }
         }
-    } else if (bridge_type_ == kTypeFindMem) {
-        if (bridge_request_.size() < kFindMemHeaderSize) {
-            bridge_error_ = kEBadLength;
+    } else if (job.type == kTypeFindMem) {
+        if (job.request.size() < kFindMemHeaderSize) {
+            job.error = kEBadLength;
         } else {
             uint32_t domain = 0, address = 0, length = 0, max_hits = 0, pattern_len = 0, flags = 0;
-            std::memcpy(&domain, bridge_request_.data() + 0, 4);
-            std::memcpy(&address, bridge_request_.data() + 4, 4);
-            std::memcpy(&length, bridge_request_.data() + 8, 4);
-            std::memcpy(&max_hits, bridge_request_.data() + 12, 4);
-            std::memcpy(&pattern_len, bridge_request_.data() + 16, 4);
-            std::memcpy(&flags, bridge_request_.data() + 20, 4);
+            std::memcpy(&domain, job.request.data() + 0, 4);
+            std::memcpy(&address, job.request.data() + 4, 4);
+            std::memcpy(&length, job.request.data() + 8, 4);
+            std::memcpy(&max_hits, job.request.data() + 12, 4);
+            std::memcpy(&pattern_len, job.request.data() + 16, 4);
+            std::memcpy(&flags, job.request.data() + 20, 4);
             const bool has_mask = (flags & kFindMemHasMask) != 0;
             const size_t expect = kFindMemHeaderSize + pattern_len + (has_mask ? pattern_len : 0);
             if ((flags & ~kFindMemHasMask) != 0 || pattern_len == 0 || pattern_len > kMaxFindPattern
                 || max_hits == 0 || max_hits > kMaxFindHits || pattern_len > length
-                || bridge_request_.size() != expect) {
-                bridge_error_ = kEBadLength;
+                || job.request.size() != expect) {
+                job.error = kEBadLength;
             } else {
                 std::vector<uint8_t> window;
-                if (!read_domain_bytes(computer, domain, address, length, window, bridge_error_,
-                                       bridge_megaii_platform_reject_, bridge_error_text_)) {
+                if (!read_domain_bytes(computer, domain, address, length, window, job.error,
+                                       job.megaii_platform_reject, job.error_text)) {
                     // error already set
                 } else {
-                    const uint8_t *pattern = bridge_request_.data() + kFindMemHeaderSize;
+                    const uint8_t *pattern = job.request.data() + kFindMemHeaderSize;
                     const uint8_t *mask = has_mask ? pattern + pattern_len : nullptr;
                     std::vector<uint32_t> hits;
                     hits.reserve(max_hits);
@@ -823,103 +1271,103 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
                         }
                     }
                     const uint32_t hit_count = static_cast<uint32_t>(hits.size());
-                    bridge_reply_.resize(4 + hit_count * 4);
-                    std::memcpy(bridge_reply_.data(), &hit_count, 4);
+                    job.reply.resize(4 + hit_count * 4);
+                    std::memcpy(job.reply.data(), &hit_count, 4);
                     for (uint32_t i = 0; i < hit_count; ++i) {
-                        std::memcpy(bridge_reply_.data() + 4 + i * 4, &hits[i], 4);
+                        std::memcpy(job.reply.data() + 4 + i * 4, &hits[i], 4);
                     }
                 }
             }
         }
-    } else if (bridge_type_ == kTypeStateGet) {
+    } else if (job.type == kTypeStateGet) {
         if (!computer) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
-            const auto id = static_cast<device_id>(bridge_arg0_);
+            const auto id = static_cast<device_id>(job.arg0);
             std::string err;
-            if (!computer->call_device_debug(id, DEVOP_STATE_GET, bridge_request_, bridge_reply_, err)) {
-                bridge_error_ = kEInternal;
-                bridge_error_text_ = err.empty() ? "unknown device" : err;
+            if (!computer->call_device_debug(id, DEVOP_STATE_GET, job.request, job.reply, err)) {
+                job.error = kEInternal;
+                job.error_text = err.empty() ? "unknown device" : err;
             }
         }
-    } else if (bridge_type_ == kTypeStateSet) {
+    } else if (job.type == kTypeStateSet) {
         if (!computer) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
-            const auto id = static_cast<device_id>(bridge_arg0_);
+            const auto id = static_cast<device_id>(job.arg0);
             std::string err;
-            if (!computer->call_device_debug(id, DEVOP_STATE_SET, bridge_request_, bridge_reply_, err)) {
-                bridge_error_ = kEInternal;
-                bridge_error_text_ = err.empty() ? "unknown device" : err;
+            if (!computer->call_device_debug(id, DEVOP_STATE_SET, job.request, job.reply, err)) {
+                job.error = kEInternal;
+                job.error_text = err.empty() ? "unknown device" : err;
             }
         }
-    } else if (bridge_type_ == kTypeBpSet) {
+    } else if (job.type == kTypeBpSet) {
         if (!computer || !computer->breakpoints) {
-            bridge_error_ = kEInternal;
-        } else if (bridge_request_.size() != kBpSetPayloadSize) {
-            bridge_error_ = kEBadLength;
+            job.error = kEInternal;
+        } else if (job.request.size() != kBpSetPayloadSize) {
+            job.error = kEBadLength;
         } else {
             bp_entry_t req{};
-            if (!parse_bp_set_request(bridge_request_, req)) {
-                bridge_error_ = kEBadLength;
+            if (!parse_bp_set_request(job.request, req)) {
+                job.error = kEBadLength;
             } else {
                 const char *add_err = nullptr;
                 const uint32_t id = computer->breakpoints->add(req, &add_err);
                 if (id == 0) {
-                    bridge_error_ = map_bp_add_error(add_err);
+                    job.error = map_bp_add_error(add_err);
                     if (add_err) {
-                        bridge_error_text_ = add_err;
+                        job.error_text = add_err;
                     }
                 } else {
-                    bridge_reply_.resize(4);
-                    std::memcpy(bridge_reply_.data(), &id, 4);
+                    job.reply.resize(4);
+                    std::memcpy(job.reply.data(), &id, 4);
                 }
             }
         }
-    } else if (bridge_type_ == kTypeBpClear) {
+    } else if (job.type == kTypeBpClear) {
         if (!computer || !computer->breakpoints) {
-            bridge_error_ = kEInternal;
-        } else if (!computer->breakpoints->clear_id(bridge_arg0_)) {
-            bridge_error_ = kEInternal;
-            bridge_error_text_ = "unknown id";
+            job.error = kEInternal;
+        } else if (!computer->breakpoints->clear_id(job.arg0)) {
+            job.error = kEInternal;
+            job.error_text = "unknown id";
         }
-    } else if (bridge_type_ == kTypeBpClearAll) {
+    } else if (job.type == kTypeBpClearAll) {
         if (!computer || !computer->breakpoints) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             computer->breakpoints->clear_all();
         }
-    } else if (bridge_type_ == kTypeBpEnable) {
+    } else if (job.type == kTypeBpEnable) {
         if (!computer || !computer->breakpoints) {
-            bridge_error_ = kEInternal;
-        } else if (bridge_arg1_ != 0 && bridge_arg1_ != 1) {
-            bridge_error_ = kEBadLength;
-        } else if (!computer->breakpoints->set_enabled(bridge_arg0_, bridge_arg1_ != 0)) {
-            bridge_error_ = kEInternal;
-            bridge_error_text_ = "unknown id";
-        }
-    } else if (bridge_type_ == kTypeBpList) {
+            job.error = kEInternal;
+        } else if (job.arg1 != 0 && job.arg1 != 1) {
+            job.error = kEBadLength;
+        } else if (!computer->breakpoints->set_enabled(job.arg0, job.arg1 != 0)) {
+            job.error = kEInternal;
+            job.error_text = "unknown id";
+        }
+    } else if (job.type == kTypeBpList) {
         if (!computer || !computer->breakpoints) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             const auto &entries = computer->breakpoints->entries();
             const uint32_t count = static_cast<uint32_t>(entries.size());
-            bridge_reply_.resize(4 + count * kBpListRecordSize);
-            std::memcpy(bridge_reply_.data(), &count, 4);
+            job.reply.resize(4 + count * kBpListRecordSize);
+            std::memcpy(job.reply.data(), &count, 4);
             for (uint32_t i = 0; i < count; ++i) {
                 const bp_entry_t &e = entries[i];
-                uint8_t *rec = bridge_reply_.data() + 4 + i * kBpListRecordSize;
+                uint8_t *rec = job.reply.data() + 4 + i * kBpListRecordSize;
                 std::memcpy(rec + 0, &e.id, 4);
                 std::memcpy(rec + 4, &e.hit_count, 4);
                 pack_bp_fields(rec + 8, e);
             }
         }
-    } else if (bridge_type_ == kTypeVideoText) {
-        const uint32_t req_page = bridge_arg0_;
-        const uint32_t req_mode = bridge_arg1_;
+    } else if (job.type == kTypeVideoText) {
+        const uint32_t req_page = job.arg0;
+        const uint32_t req_mode = job.arg1;
         auto *ds = static_cast<display_state_t *>(computer ? computer->cached_display_state : nullptr);
         if (!computer || !ds) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             uint32_t flags = 0;
             if (ds->display_mode == TEXT_MODE) {
@@ -945,26 +1393,26 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
             if (page == kVideoPageCurrent) {
                 page = (ds->display_page_num == DISPLAY_PAGE_2) ? 2u : 1u;
             } else if (page != 1 && page != 2) {
-                bridge_error_ = kEBadLength;
-                bridge_error_text_ = "VIDEO_TEXT invalid page";
+                job.error = kEBadLength;
+                job.error_text = "VIDEO_TEXT invalid page";
             }
 
             uint32_t mode = req_mode;
-            if (bridge_error_ == 0) {
+            if (job.error == 0) {
                 if (mode == kVideoModeCurrent) {
                     if (ds->display_mode != TEXT_MODE) {
-                        bridge_error_ = kEInternal;
-                        bridge_error_text_ = "current mode is not text";
+                        job.error = kEInternal;
+                        job.error_text = "current mode is not text";
                     } else {
                         mode = ds->f_80col ? kVideoModeText80 : kVideoModeText40;
                     }
                 } else if (mode != kVideoModeText40 && mode != kVideoModeText80) {
-                    bridge_error_ = kEBadLength;
-                    bridge_error_text_ = "unsupported video mode";
+                    job.error = kEBadLength;
+                    job.error_text = "unsupported video mode";
                 }
             }
 
-            if (bridge_error_ == 0) {
+            if (job.error == 0) {
                 MMU *mmu = nullptr;
                 if (computer->platform && platform_is_iigs(computer->platform->id)) {
                     mmu = computer->mmu;
@@ -972,30 +1420,30 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
                     mmu = computer->cpu->mmu;
                 }
                 if (!mmu) {
-                    bridge_error_ = kEInternal;
+                    job.error = kEInternal;
                 } else {
                     uint8_t *base = mmu->get_memory_base();
                     const uint32_t mem_size = mmu->get_memory_size();
                     const uint16_t page_off = text_page::page_base(page);
                     const uint32_t need_main = static_cast<uint32_t>(page_off) + 0x400;
                     if (!base || mem_size < need_main) {
-                        bridge_error_ = kEInternal;
+                        job.error = kEInternal;
                     } else if (mode == kVideoModeText80
                                && mem_size < text_page::kAuxBankOffset + need_main) {
-                        bridge_error_ = kEInternal;
-                        bridge_error_text_ = "TEXT80 not available";
+                        job.error = kEInternal;
+                        job.error_text = "TEXT80 not available";
                     } else {
                         const uint32_t cols =
                             (mode == kVideoModeText80) ? text_page::kCols80 : text_page::kCols40;
                         const uint32_t rows = text_page::kRows;
                         const size_t chars_len = static_cast<size_t>(cols) * rows;
-                        bridge_reply_.resize(kVideoTextHeaderSize + chars_len);
-                        std::memcpy(bridge_reply_.data() + 0, &cols, 4);
-                        std::memcpy(bridge_reply_.data() + 4, &rows, 4);
-                        std::memcpy(bridge_reply_.data() + 8, &page, 4);
-                        std::memcpy(bridge_reply_.data() + 12, &mode, 4);
-                        std::memcpy(bridge_reply_.data() + 16, &flags, 4);
-                        uint8_t *chars = bridge_reply_.data() + kVideoTextHeaderSize;
+                        job.reply.resize(kVideoTextHeaderSize + chars_len);
+                        std::memcpy(job.reply.data() + 0, &cols, 4);
+                        std::memcpy(job.reply.data() + 4, &rows, 4);
+                        std::memcpy(job.reply.data() + 8, &page, 4);
+                        std::memcpy(job.reply.data() + 12, &mode, 4);
+                        std::memcpy(job.reply.data() + 16, &flags, 4);
+                        uint8_t *chars = job.reply.data() + kVideoTextHeaderSize;
                         if (mode == kVideoModeText80) {
                             text_page::linearize_text80(base, page, chars);
                         } else {
@@ -1005,13 +1453,13 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
                 }
             }
         }
-    } else if (bridge_type_ == kTypeMount) {
-        const uint32_t slot = bridge_arg0_;
-        const uint32_t unit = bridge_arg1_;
+    } else if (job.type == kTypeMount) {
+        const uint32_t slot = job.arg0;
+        const uint32_t unit = job.arg1;
         uint32_t status = kMediaOk;
         if (!computer || !computer->mounts) {
-            bridge_error_ = kEInternal;
-        } else if (bridge_request_.empty()) {
+            job.error = kEInternal;
+        } else if (job.request.empty()) {
             status = kMediaBadPath;
         } else {
             storage_key_t key;
@@ -1025,23 +1473,44 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
                 disk_mount_t dm{};
                 dm.slot = static_cast<uint16_t>(slot);
                 dm.drive = static_cast<uint16_t>(unit);
-                dm.filename.assign(reinterpret_cast<const char *>(bridge_request_.data()),
-                                   bridge_request_.size());
+                dm.filename.assign(reinterpret_cast<const char *>(job.request.data()),
+                                   job.request.size());
                 if (!computer->mounts->mount_media(dm)) {
                     status = kMediaMountFailed;
                 }
             }
         }
-        if (bridge_error_ == 0) {
-            bridge_reply_.resize(4);
-            std::memcpy(bridge_reply_.data(), &status, 4);
+        if (job.error == 0) {
+            job.reply.resize(4);
+            std::memcpy(job.reply.data(), &status, 4);
+        }
+    } else if (job.type == kTypeSnapSave || job.type == kTypeSnapLoad) {
+        uint32_t status = kSnapOk;
+        if (!computer || !computer->snapshots) {
+            job.error = kEInternal;
+        } else if (job.request.empty()) {
+            status = kSnapBadPath;
+        } else {
+            std::string path(reinterpret_cast<const char *>(job.request.data()), job.request.size());
+            std::string err;
+            bool ok = (job.type == kTypeSnapSave)
+                ? computer->save_snapshot(path, (job.arg0 & kSnapIncremental) != 0, err)
+                : computer->load_snapshot(path, err);
+            if (!ok) {
+                printf("Snapshot: %s\n", err.c_str());
+                status = kSnapFailed;
+            }
+        }
+        if (job.error == 0) {
+            job.reply.resize(4);
+            std::memcpy(job.reply.data(), &status, 4);
         }
-    } else if (bridge_type_ == kTypeUnmount) {
-        const uint32_t slot = bridge_arg0_;
-        const uint32_t unit = bridge_arg1_;
+    } else if (job.type == kTypeUnmount) {
+        const uint32_t slot = job.arg0;
+        const uint32_t unit = job.arg1;
         uint32_t status = kMediaOk;
         if (!computer || !computer->mounts) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else {
             storage_key_t key;
             key.slot = static_cast<uint16_t>(slot);
@@ -1054,85 +1523,153 @@ void DebugProtocolServer::process_main_thread(computer_t *computer) {
                 status = kMediaUnmountFailed;
             }
         }
-        if (bridge_error_ == 0) {
-            bridge_reply_.resize(4);
-            std::memcpy(bridge_reply_.data(), &status, 4);
+        if (job.error == 0) {
+            job.reply.resize(4);
+            std::memcpy(job.reply.data(), &status, 4);
         }
-    } else if (bridge_type_ == kTypePasteText) {
+    } else if (job.type == kTypePasteText) {
         if (!computer) {
-            bridge_error_ = kEInternal;
+            job.error = kEInternal;
         } else if (!computer->start_keyboard_paste(
-                       std::string(bridge_request_.begin(), bridge_request_.end()))) {
-            bridge_error_ = kEInternal;
-            bridge_error_text_ = "no keyboard";
+                       std::string(job.request.begin(), job.request.end()))) {
+            job.error = kEInternal;
+            job.error_text = "no keyboard";
+        }
+    } else if (job.type == kTypeMemShare) {
+        open_ram_share(computer, job);
+    } else if (job.type == kTypeSubscribe) {
+        subscribe(computer, job);
+    } else if (job.type == kTypeUnsubscribe) {
+        unsubscribe(job);
+    } else if (job.type == kTypePasteBasic) {
+        uint32_t lines = 0;
+        std::string err;
+        if (!computer) {
+            job.error = kEInternal;
+        } else if (!computer->inject_basic_program(
+                       std::string(job.request.begin(), job.request.end()), lines, err)) {
+            job.error = kEInternal;
+            job.error_text = err;
+        } else {
+            job.reply.resize(4);
+            std::memcpy(job.reply.data(), &lines, 4);
         }
     } else {
-        bridge_error_ = kEInternal;
+        job.error = kEInternal;
     }
 
-    bridge_done_ = true;
-    bridge_cv_.notify_one();
 }
 
-bool DebugProtocolServer::submit_and_wait(uint32_t type, uint32_t seq,
-                                          uint32_t arg0, uint32_t arg1, uint32_t arg2,
-                                          const std::vector<uint8_t> &request_payload,
-                                          std::vector<uint8_t> &reply_out, uint32_t &error_code_out,
-                                          int timeout_ms) {
-    std::unique_lock<std::mutex> lock(bridge_mu_);
-    if (bridge_pending_) {
-        error_code_out = kEBusy;
-        reply_out.clear();
-        return true;
+void DebugProtocolServer::submit_request(PendingRequest &req) {
+    std::vector<std::shared_ptr<BridgeJob>> jobs;
+    if (req.job) {
+        jobs.push_back(req.job);
+    }
+    bool frame_only = false;
+    for (const PendingRequest &part : req.parts) {
+        if (part.job) {
+            jobs.push_back(part.job);
+            frame_only = frame_only || part.job->frame_only;
+        }
+    }
+    if (jobs.empty()) {
+        return;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kMainThreadTimeoutMs);
+    std::lock_guard<std::mutex> lock(bridge_mu_);
+    for (const auto &job : jobs) {
+        // A BATCH is never split across a mid-frame service point.
+        job->frame_only = job->frame_only || frame_only;
+        job->deadline = deadline;
+        bridge_queue_.push_back(job);
     }
+    update_bridge_state_locked();
+}
 
-    bridge_pending_ = true;
-    bridge_done_ = false;
-    bridge_timed_out_ = false;
-    bridge_megaii_platform_reject_ = false;
-    bridge_error_text_.clear();
-    bridge_type_ = type;
-    bridge_seq_ = seq;
-    bridge_arg0_ = arg0;
-    bridge_arg1_ = arg1;
-    bridge_arg2_ = arg2;
-    bridge_error_ = 0;
-    bridge_request_ = request_payload;
-    bridge_reply_.clear();
-
-    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
-    while (!bridge_done_ && !stop_) {
-        if (bridge_cv_.wait_until(lock, deadline) == std::cv_status::timeout) {
-            bridge_pending_ = false;
-            bridge_done_ = false;
-            error_code_out = kEInternal;
-            bridge_timed_out_ = true;
-            reply_out.clear();
-            return true;
+void DebugProtocolServer::wait_request(PendingRequest &req, int timeout_ms) {
+    std::vector<BridgeJob *> jobs;
+    if (req.job) {
+        jobs.push_back(req.job.get());
+    }
+    for (PendingRequest &part : req.parts) {
+        if (part.job) {
+            jobs.push_back(part.job.get());
         }
     }
+    auto all_done = [&jobs]() {
+        for (BridgeJob *job : jobs) {
+            if (!job->done.load(std::memory_order_acquire)) {
+                return false;
+            }
+        }
+        return true;
+    };
 
-    if (stop_ && !bridge_done_) {
-        bridge_pending_ = false;
-        return false;
+    std::unique_lock<std::mutex> lock(bridge_mu_);
+    bridge_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&]() { return stop_ || all_done(); });
+
+    // The main thread is not running anything while we hold the lock: a job that is not
+    // done is still queued. Drop expired ones so they never run.
+    const auto now = std::chrono::steady_clock::now();
+    for (BridgeJob *job : jobs) {
+        if (job->done.load(std::memory_order_acquire) || now < job->deadline) {
+            continue;
+        }
+        auto it = std::find_if(bridge_queue_.begin(), bridge_queue_.end(),
+                               [job](const std::shared_ptr<BridgeJob> &q) { return q.get() == job; });
+        if (it != bridge_queue_.end()) {
+            bridge_queue_.erase(it);
+        }
+        job->error = kEInternal;
+        job->timed_out = true;
+        job->done.store(true, std::memory_order_release);
     }
+    update_bridge_state_locked();
+}
 
-    error_code_out = bridge_error_;
-    reply_out = std::move(bridge_reply_);
-    bridge_request_.clear();
-    bridge_pending_ = false;
-    bridge_done_ = false;
+bool DebugProtocolServer::run_and_wait(const std::shared_ptr<BridgeJob> &job) {
+    PendingRequest req;
+    req.job = job;
+    submit_request(req);
+    while (!job->done.load(std::memory_order_acquire)) {
+        if (stop_) {
+            return false;
+        }
+        wait_request(req, 50);
+    }
     return true;
 }
 
 void DebugProtocolServer::enqueue_event(uint32_t event_id, const std::vector<uint8_t> &data) {
-    std::vector<uint8_t> item(4 + data.size());
-    std::memcpy(item.data(), &event_id, 4);
+    QueuedEvent event;
+    event.data.resize(4 + data.size());
+    std::memcpy(event.data.data(), &event_id, 4);
     if (!data.empty()) {
-        std::memcpy(item.data() + 4, data.data(), data.size());
+        std::memcpy(event.data.data() + 4, data.data(), data.size());
+    }
+    push_event(std::move(event));
+}
+
+bool DebugProtocolServer::wants_trace() const {
+    // client_session_ is odd while a client is connected.
+    const uint32_t session = client_session_.load(std::memory_order_relaxed);
+    if ((session & 1) == 0) {
+        return false;
     }
+    if (trace_session_ == session) {
+        return true;
+    }
+    for (const auto &sub : subscriptions_) {
+        if (sub->kind == kSubTrace && sub->session == session) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DebugProtocolServer::push_event(QueuedEvent event) {
     std::lock_guard<std::mutex> lock(event_mu_);
-    event_queue_.push_back(std::move(item));
+    event_queue_.push_back(std::move(event));
 }
 
 void DebugProtocolServer::fill_live_trace(computer_t *computer, system_trace_entry_t *out) {
@@ -1189,6 +1726,10 @@ void DebugProtocolServer::emit_stopped(computer_t *computer, const StopHit &hit)
     system_trace_entry_t trace{};
     if (hit.reason == STOP_BP_EXEC || hit.reason == STOP_PAUSE) {
         fill_live_trace(computer, &trace);
+    } else if (hit.cycle != 0) {
+        // Watch trap: no trace entry to copy, but the access cycle is exact.
+        fill_live_trace(computer, &trace);
+        trace.cycle = hit.cycle;
     } else if (computer && computer->cpu) {
         trace = computer->cpu->trace_entry;
     }
@@ -1245,15 +1786,22 @@ void DebugProtocolServer::emit_run_state(uint32_t new_mode, uint32_t prev_mode)
 
 bool DebugProtocolServer::flush_events(DebugSocketHandle fd) {
 #if GS2_DEBUG_PROTO_UNIX
-    std::deque<std::vector<uint8_t>> pending;
+    std::deque<QueuedEvent> pending;
     {
         std::lock_guard<std::mutex> lock(event_mu_);
         pending.swap(event_queue_);
     }
+    const uint32_t session = client_session_.load();
     for (const auto &item : pending) {
-        if (!send_frame(fd, kTypeEvent, event_seq_++, item.data(), static_cast<uint32_t>(item.size()))) {
+        if (item.in_flight && item.session != session) {
+            continue;   // an update for a client that has gone
+        }
+        if (!send_frame(fd, kTypeEvent, event_seq_++, item.data.data(), static_cast<uint32_t>(item.data.size()))) {
             return false;
         }
+        if (item.in_flight) {
+            item.in_flight->store(false, std::memory_order_release);
+        }
     }
     return true;
 #else
@@ -1294,8 +1842,10 @@ void DebugProtocolServer::thread_main() {
         }
 
         client_fd_ = client_fd;
+        client_session_++;
         SDL_Log("DebugProtocolServer: client connected");
         serve_client(client_fd);
+        client_session_++;
         client_fd_ = kInvalidSocket;
         close_socket(client_fd);
         SDL_Log("DebugProtocolServer: client disconnected");
@@ -1475,9 +2025,50 @@ bool DebugProtocolServer::write_full(DebugSocketHandle fd, const void *buf, size
 }
 
 bool DebugProtocolServer::send_frame(DebugSocketHandle fd, uint32_t type, uint32_t seq,
-                                     const void *payload, uint32_t length) {
+                                     const void *payload, uint32_t length, const std::vector<int> *fds) {
     FrameHeader hdr{type, seq, length};
-    if (!write_full(fd, &hdr, sizeof(hdr))) {
+    size_t hdr_sent = 0;
+#if GS2_DEBUG_PROTO_UNIX && !defined(_WIN32)
+    if (fds && !fds->empty()) {
+        // The descriptors are attached to the first bytes of the header.
+        const size_t fds_len = sizeof(int) * fds->size();
+        std::vector<uint8_t> control(CMSG_SPACE(fds_len));
+        struct iovec iov{};
+        iov.iov_base = &hdr;
+        iov.iov_len = sizeof(hdr);
+        struct msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(fds_len);
+        std::memcpy(CMSG_DATA(cm), fds->data(), fds_len);
+        ssize_t w;
+        while ((w = ::sendmsg(fd, &msg, 0)) < 0) {
+            if (stop_) {
+                return false;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd{};
+                pfd.fd = fd;
+                pfd.events = POLLOUT;
+                poll(&pfd, 1, 50);
+                continue;
+            }
+            return false;
+        }
+        hdr_sent = static_cast<size_t>(w);
+    }
+#else
+    (void)fds;
+#endif
+    if (!write_full(fd, reinterpret_cast<const uint8_t *>(&hdr) + hdr_sent, sizeof(hdr) - hdr_sent)) {
         return false;
     }
     if (length == 0) {
@@ -1497,30 +2088,22 @@ bool DebugProtocolServer::send_error(DebugSocketHandle fd, uint32_t seq, uint32_
     return send_frame(fd, kTypeError, seq, payload.data(), static_cast<uint32_t>(payload.size()));
 }
 
-bool DebugProtocolServer::reject(DebugSocketHandle fd, uint32_t seq, uint32_t code,
-                                 const char *message) {
-    return !send_error(fd, seq, code, message);
-}
-
-const char *DebugProtocolServer::bridge_error_message(uint32_t err, uint32_t domain) {
+const char *DebugProtocolServer::bridge_error_message(const BridgeJob &job, uint32_t domain) {
+    const uint32_t err = job.error;
     if (err == kEBusy) {
         return "busy";
     }
-    if (err == kEBadLength || err == kEInternal) {
-        std::lock_guard<std::mutex> lock(bridge_mu_);
-        if (!bridge_error_text_.empty()) {
-            return bridge_error_text_.c_str();
-        }
+    if ((err == kEBadLength || err == kEInternal) && !job.error_text.empty()) {
+        return job.error_text.c_str();
     }
     if (err == kEBadLength) {
         return "out of range";
     }
     if (err == kEInternal) {
-        std::lock_guard<std::mutex> lock(bridge_mu_);
-        if (bridge_timed_out_) {
+        if (job.timed_out) {
             return "timeout waiting for main thread";
         }
-        if (bridge_megaii_platform_reject_) {
+        if (job.megaii_platform_reject) {
             return "MEGAII only on Apple IIgs";
         }
         if (domain != kMemMain && domain != kMemMegaII
@@ -1532,770 +2115,744 @@ const char *DebugProtocolServer::bridge_error_message(uint32_t err, uint32_t dom
     return "internal error";
 }
 
-void DebugProtocolServer::serve_client(DebugSocketHandle client_fd) {
-#if defined(_WIN32)
-    u_long nonblocking = 1;
-    ::ioctlsocket(native_socket(client_fd), FIONBIO, &nonblocking);
-#elif GS2_DEBUG_PROTO_UNIX
-    const int flags = fcntl(client_fd, F_GETFL, 0);
-    if (flags >= 0) {
-        fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
+bool DebugProtocolServer::bridge_reply_ok(const BridgeJob &job) {
+    const std::vector<uint8_t> &reply = job.reply;
+    uint32_t count = 0;
+    if (reply.size() >= 8) {
+        std::memcpy(&count, reply.data() + (job.type == kTypeGetTrace ? 4 : 0), 4);
+    } else if (reply.size() >= 4) {
+        std::memcpy(&count, reply.data(), 4);
     }
-#endif
-    bool handshaked = false;
+    switch (job.type) {
+    case kTypeGetStatus:
+        return reply.size() == 8;
+    case kTypeGetTrace:
+        return reply.size() >= 8 && reply.size() == 8 + static_cast<size_t>(count) * kTraceEntrySize;
+    case kTypeGetRegs:
+        return reply.size() == kTraceEntrySize;
+    case kTypeReadMem:
+        return reply.size() == job.arg2;
+    case kTypeFindMem: {
+        uint32_t max_hits = 0;
+        std::memcpy(&max_hits, job.request.data() + 12, 4);
+        return reply.size() >= 4 && count <= max_hits && reply.size() == 4 + static_cast<size_t>(count) * 4;
+    }
+    case kTypeBpList:
+        return reply.size() >= 4 && reply.size() == 4 + static_cast<size_t>(count) * kBpListRecordSize;
+    case kTypeVideoText: {
+        if (reply.size() < kVideoTextHeaderSize) {
+            return false;
+        }
+        uint32_t cols = 0, rows = 0;
+        std::memcpy(&cols, reply.data() + 0, 4);
+        std::memcpy(&rows, reply.data() + 4, 4);
+        return rows == text_page::kRows
+            && (cols == text_page::kCols40 || cols == text_page::kCols80)
+            && reply.size() == kVideoTextHeaderSize + static_cast<size_t>(cols) * rows;
+    }
+    case kTypeBpSet:
+    case kTypeMount:
+    case kTypeUnmount:
+    case kTypeSnapSave:
+    case kTypeSnapLoad:
+    case kTypePasteBasic:
+        return reply.size() == 4;
+    case kTypeStateGet:
+    case kTypeStateSet:
+        return true;
+    case kTypeMemShare:
+        return reply.size() == kMemShareReplySize && job.reply_fds.size() == 2;
+    case kTypeSubscribe:
+        return reply.size() == 4;
+    default:
+        return reply.empty();
+    }
+}
 
-    // Reject request with an error frame; disconnect on write failure, else next request.
-    // Use `continue` via a statement expression carefully: REJECT must continue the
-    // serve_client loop, not a do-while(0) wrapper (continue would bind to that).
-#define REJECT(...) do { if (reject(__VA_ARGS__)) return; goto next_request; } while (0)
-#define REPLY_OK(type, seq, payload_ptr, payload_len) do { \
-        if (!send_frame(client_fd, (type), (seq), (payload_ptr), (payload_len))) { \
-            return; \
-        } \
-        if (!flush_events(client_fd)) { \
-            return; \
-        } \
-    } while (0)
+void DebugProtocolServer::prepare_request(uint32_t type, uint32_t seq, const std::vector<uint8_t> &payload,
+                                          bool &handshaked, bool in_batch, PendingRequest &req) {
+    req.type = type;
+    req.seq = seq;
+    const size_t length = payload.size();
+
+    auto fail = [&req](uint32_t code, const char *message) {
+        const size_t msg_len = message ? std::strlen(message) : 0;
+        req.job.reset();
+        req.parts.clear();
+        req.reply_type = kTypeError;
+        req.reply.resize(4 + msg_len);
+        std::memcpy(req.reply.data(), &code, 4);
+        if (msg_len) {
+            std::memcpy(req.reply.data() + 4, message, msg_len);
+        }
+    };
+    auto answer = [&req](const void *data, size_t len) {
+        req.reply_type = req.type;
+        req.reply.assign(static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + len);
+    };
+    auto make_job = [&req](uint32_t arg0, uint32_t arg1, uint32_t arg2, std::vector<uint8_t> request) {
+        auto job = std::make_shared<BridgeJob>();
+        job->type = req.type;
+        job->arg0 = arg0;
+        job->arg1 = arg1;
+        job->arg2 = arg2;
+        job->request = std::move(request);
+        job->frame_only = frame_only_type(req.type);
+        return job;
+    };
+    auto bridge = [&](uint32_t arg0, uint32_t arg1, uint32_t arg2, std::vector<uint8_t> request,
+                      const char *bad_reply) {
+        req.job = make_job(arg0, arg1, arg2, std::move(request));
+        req.bad_reply = bad_reply;
+    };
+
+    if ((type & 0xFF000000u) != 0) {
+        return fail(kEUnknownType, "flags must be zero on requests");
+    }
+    if (!handshaked && type != kTypeHello) {
+        return fail(kENotHandshaked, "HELLO required first");
+    }
+    if (in_batch && (type == kTypeHello || type == kTypeQuit || type == kTypeKeyEvent || type == kTypeBatch
+                     || type == kTypeMemShare)) {
+        return fail(kEUnknownType, "not allowed in BATCH");
+    }
 
-    while (!stop_) {
-next_request:
-        if (!flush_events(client_fd)) {
-            return;
+    switch (type) {
+    case kTypeHello: {
+        if (length != 8) {
+            return fail(kEBadLength, "HELLO requires 8-byte payload");
+        }
+        uint32_t client_version = 0;
+        std::memcpy(&client_version, payload.data(), 4);
+        if (client_version != kProtoVersion) {
+            return fail(kEBadVersion, "unsupported protocol version");
+        }
+        uint8_t reply[12];
+        uint32_t version = kProtoVersion;
+        uint32_t flags = 0;
+        uint32_t max_payload = kMaxPayload;
+        std::memcpy(reply + 0, &version, 4);
+        std::memcpy(reply + 4, &flags, 4);
+        std::memcpy(reply + 8, &max_payload, 4);
+        answer(reply, 12);
+        handshaked = true;
+        return;
+    }
+    case kTypePing:
+        if (length != 0) {
+            return fail(kEBadLength, "PING requires empty payload");
+        }
+        return answer(nullptr, 0);
+    case kTypeQuit:
+        if (length != 0) {
+            return fail(kEBadLength, "QUIT requires empty payload");
+        }
+        // Reply before scheduling halt so the client gets ACK while the
+        // socket is still alive. AppQuit (same frame as halt) stops the
+        // protocol thread and would otherwise race the reply.
+        answer(nullptr, 0);
+        req.after_reply = make_job(0, 0, 0, {});
+        return;
+    case kTypeGetStatus:
+        if (length != 0) {
+            return fail(kEBadLength, "GET_STATUS requires empty payload");
         }
-
-#if defined(_WIN32)
-        WSAPOLLFD pfd{};
-        pfd.fd = native_socket(client_fd);
-        pfd.events = POLLRDNORM;
-        const int pr = ::WSAPoll(&pfd, 1, 50);
-        if (pr == SOCKET_ERROR) {
-            if (::WSAGetLastError() == WSAEINTR) {
-                continue;
-            }
-            return;
+        return bridge(0, 0, 0, {}, "bad status reply");
+    case kTypeReset: {
+        if (length != 4) {
+            return fail(kEBadLength, "RESET requires 4-byte payload");
         }
-        if (pr == 0) {
-            continue;
+        uint32_t cold_start = 0;
+        std::memcpy(&cold_start, payload.data(), 4);
+        if (cold_start != 0 && cold_start != 1) {
+            return fail(kEBadLength, "RESET cold_start must be 0 or 1");
         }
-        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
-            return;
+        return bridge(cold_start, 0, 0, {}, "bad reset reply");
+    }
+    case kTypePause:
+        if (length != 0) {
+            return fail(kEBadLength, "PAUSE requires empty payload");
+        }
+        return bridge(0, 0, 0, {}, "bad pause reply");
+    case kTypeContinue:
+        if (length != 0) {
+            return fail(kEBadLength, "CONTINUE requires empty payload");
+        }
+        return bridge(0, 0, 0, {}, "bad continue reply");
+    case kTypeStepInto: {
+        if (length != 4) {
+            return fail(kEBadLength, "STEP_INTO requires 4-byte payload");
+        }
+        uint32_t count = 0;
+        std::memcpy(&count, payload.data(), 4);
+        if (count == 0) {
+            return fail(kEBadLength, "STEP_INTO count must be >= 1");
+        }
+        return bridge(count, 0, 0, {}, "bad step_into reply");
+    }
+    case kTypeGetTrace: {
+        if (length != 8) {
+            return fail(kEBadLength, "GET_TRACE requires 8-byte payload");
         }
-        if (!(pfd.revents & POLLRDNORM)) {
-            continue;
+        uint32_t ago = 0, count = 0;
+        std::memcpy(&ago, payload.data() + 0, 4);
+        std::memcpy(&count, payload.data() + 4, 4);
+        if (count == 0) {
+            return fail(kEBadLength, "GET_TRACE count must be >= 1");
         }
-#elif GS2_DEBUG_PROTO_UNIX
-        struct pollfd pfd{};
-        pfd.fd = client_fd;
-        pfd.events = POLLIN;
-        const int pr = poll(&pfd, 1, 50);
-        if (pr < 0) {
-            if (errno == EINTR) {
-                continue;
-            }
-            return;
+        if (count > kMaxTraceRecords) {
+            return fail(kEBadLength, "GET_TRACE count out of range");
         }
-        if (pr == 0) {
-            continue;
+        return bridge(ago, count, 0, {}, "bad get_trace reply");
+    }
+    case kTypeGetRegs:
+        if (length != 0) {
+            return fail(kEBadLength, "GET_REGS requires empty payload");
         }
-        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
-            return;
+        return bridge(0, 0, 0, {}, "bad get_regs reply");
+    case kTypeSetRegs: {
+        if (length != kSetRegsPayloadSize) {
+            return fail(kEBadLength, "SET_REGS requires 24-byte payload");
         }
-        if (!(pfd.revents & POLLIN)) {
-            continue;
+        uint32_t mask = 0;
+        std::memcpy(&mask, payload.data() + 0, 4);
+        if ((mask & ~kRegMaskAll) != 0) {
+            return fail(kEBadLength, "SET_REGS unknown mask bits");
         }
-#endif
-
-        FrameHeader hdr{};
-        if (!read_full(client_fd, &hdr, sizeof(hdr))) {
-            return;
+        if ((mask & kRegE) && payload[19] > 1) {
+            return fail(kEBadLength, "SET_REGS e must be 0 or 1");
         }
-
-        if (hdr.length > kMaxPayload) {
-            send_error(client_fd, hdr.seq, kEBadLength, "payload too large");
-            return;
+        return bridge(0, 0, 0, payload, "bad set_regs reply");
+    }
+    case kTypeFindMem: {
+        if (length < kFindMemHeaderSize) {
+            return fail(kEBadLength, "FINDMEM payload too short");
+        }
+        uint32_t domain = 0, address = 0, mem_length = 0, max_hits = 0, pattern_len = 0, flags = 0;
+        std::memcpy(&domain, payload.data() + 0, 4);
+        std::memcpy(&address, payload.data() + 4, 4);
+        std::memcpy(&mem_length, payload.data() + 8, 4);
+        std::memcpy(&max_hits, payload.data() + 12, 4);
+        std::memcpy(&pattern_len, payload.data() + 16, 4);
+        std::memcpy(&flags, payload.data() + 20, 4);
+        if ((flags & ~kFindMemHasMask) != 0) {
+            return fail(kEBadLength, "FINDMEM unknown flags");
+        }
+        if (mem_length == 0 || mem_length > kMaxReadMem) {
+            return fail(kEBadLength, "FINDMEM length out of range");
+        }
+        if (address > std::numeric_limits<uint32_t>::max() - mem_length) {
+            return fail(kEBadLength, "FINDMEM address wrap");
+        }
+        if (pattern_len == 0 || pattern_len > kMaxFindPattern || pattern_len > mem_length) {
+            return fail(kEBadLength, "FINDMEM pattern_len out of range");
+        }
+        if (max_hits == 0 || max_hits > kMaxFindHits) {
+            return fail(kEBadLength, "FINDMEM max_hits out of range");
+        }
+        if (domain != kMemMain && domain != kMemMegaII && domain != kMemEnsoniq
+            && domain != kMemAdbMicro && domain != kMemMainRaw && domain != kMemMegaIIRaw) {
+            return fail(kEBadLength, "FINDMEM invalid domain");
+        }
+        const bool has_mask = (flags & kFindMemHasMask) != 0;
+        const size_t expect = kFindMemHeaderSize + pattern_len + (has_mask ? pattern_len : 0);
+        if (length != expect) {
+            return fail(kEBadLength, "FINDMEM payload length mismatch");
+        }
+        req.domain = domain;
+        return bridge(0, 0, 0, payload, "bad findmem reply");
+    }
+    case kTypeSubscribe: {
+        if (length != kSubscribePayloadSize) {
+            return fail(kEBadLength, "SUBSCRIBE requires 24-byte payload");
+        }
+        uint32_t kind = 0, flags = 0, arg0 = 0, arg1 = 0, arg2 = 0;
+        std::memcpy(&kind, payload.data() + 0, 4);
+        std::memcpy(&flags, payload.data() + 4, 4);
+        std::memcpy(&arg0, payload.data() + 12, 4);
+        std::memcpy(&arg1, payload.data() + 16, 4);
+        std::memcpy(&arg2, payload.data() + 20, 4);
+        if (flags != 0) {
+            return fail(kEBadLength, "SUBSCRIBE unknown flags");
+        }
+        if (kind == kSubMem) {
+            if (arg2 == 0 || arg2 > kMaxReadMem) {
+                return fail(kEBadLength, "SUBSCRIBE length out of range");
+            }
+            if (arg1 > std::numeric_limits<uint32_t>::max() - arg2) {
+                return fail(kEBadLength, "SUBSCRIBE address wrap");
+            }
+            if (arg0 != kMemMain && arg0 != kMemMegaII && arg0 != kMemEnsoniq
+                && arg0 != kMemAdbMicro && arg0 != kMemMainRaw && arg0 != kMemMegaIIRaw) {
+                return fail(kEBadLength, "SUBSCRIBE invalid domain");
+            }
+            req.domain = arg0;
+        } else if (kind == kSubTrace) {
+            if (arg0 == 0 || arg0 > kMaxTraceRecords) {
+                return fail(kEBadLength, "SUBSCRIBE max_entries out of range");
+            }
+        } else if (kind != kSubRegs) {
+            return fail(kEBadLength, "SUBSCRIBE unknown kind");
+        }
+        return bridge(arg0, arg1, arg2, payload, "bad subscribe reply");
+    }
+    case kTypeUnsubscribe: {
+        if (length != 4) {
+            return fail(kEBadLength, "UNSUBSCRIBE requires 4-byte payload");
         }
-
-        std::vector<uint8_t> payload(hdr.length);
-        if (hdr.length > 0) {
-            if (!read_full(client_fd, payload.data(), hdr.length)) {
-                return;
-            }
+        uint32_t id = 0;
+        std::memcpy(&id, payload.data(), 4);
+        return bridge(id, 0, 0, {}, "bad unsubscribe reply");
+    }
+    case kTypeMemShare: {
+        if (length != 8) {
+            return fail(kEBadLength, "MEMSHARE requires 8-byte payload");
         }
-
-        if ((hdr.type & 0xFF000000u) != 0) {
-            REJECT(client_fd, hdr.seq, kEUnknownType, "flags must be zero on requests");
+        uint32_t domain = 0, flags = 0;
+        std::memcpy(&domain, payload.data() + 0, 4);
+        std::memcpy(&flags, payload.data() + 4, 4);
+        if (domain != kMemMainRaw && domain != kMemMegaIIRaw) {
+            return fail(kEBadLength, "MEMSHARE invalid domain");
         }
-
-        if (!handshaked && hdr.type != kTypeHello) {
-            REJECT(client_fd, hdr.seq, kENotHandshaked, "HELLO required first");
+        if ((flags & ~kMemShareWritable) != 0) {
+            return fail(kEBadLength, "MEMSHARE unknown flags");
         }
-
-        switch (hdr.type) {
-        case kTypeHello: {
-            if (hdr.length != 8) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "HELLO requires 8-byte payload");
-            }
-            uint32_t client_version = 0;
-            std::memcpy(&client_version, payload.data(), 4);
-            if (client_version != kProtoVersion) {
-                REJECT(client_fd, hdr.seq, kEBadVersion, "unsupported protocol version");
-            }
-            uint8_t reply[12];
-            uint32_t version = kProtoVersion;
-            uint32_t flags = 0;
-            uint32_t max_payload = kMaxPayload;
-            std::memcpy(reply + 0, &version, 4);
-            std::memcpy(reply + 4, &flags, 4);
-            std::memcpy(reply + 8, &max_payload, 4);
-            REPLY_OK(kTypeHello, hdr.seq, reply, 12);
-            handshaked = true;
-            break;
+        req.domain = domain;
+        return bridge(domain, flags, 0, {}, "bad memshare reply");
+    }
+    case kTypeStateGet: {
+        if (length != 4) {
+            return fail(kEBadLength, "STATE_GET requires 4-byte payload");
         }
-        case kTypePing: {
-            if (hdr.length != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "PING requires empty payload");
-            }
-            REPLY_OK(kTypePing, hdr.seq, nullptr, 0);
-            break;
+        uint32_t device_id_u = 0;
+        std::memcpy(&device_id_u, payload.data(), 4);
+        return bridge(device_id_u, 0, 0, {}, nullptr);
+    }
+    case kTypeStateSet: {
+        if (length < 4) {
+            return fail(kEBadLength, "STATE_SET requires device_id + blob");
         }
-        case kTypeQuit: {
-            if (hdr.length != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "QUIT requires empty payload");
-            }
-            // Reply before scheduling halt so the client gets ACK while the
-            // socket is still alive. AppQuit (same frame as halt) stops the
-            // protocol thread and would otherwise race the reply.
-            REPLY_OK(kTypeQuit, hdr.seq, nullptr, 0);
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeQuit, hdr.seq, 0, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            // Ignore bridge errors after ACK — process may already be exiting.
-            break;
+        uint32_t device_id_u = 0;
+        std::memcpy(&device_id_u, payload.data(), 4);
+        return bridge(device_id_u, 0, 0, std::vector<uint8_t>(payload.begin() + 4, payload.end()), nullptr);
+    }
+    case kTypeReadMem: {
+        if (length != 12) {
+            return fail(kEBadLength, "READMEM requires 12-byte payload");
+        }
+        uint32_t domain = 0, address = 0, mem_length = 0;
+        std::memcpy(&domain, payload.data() + 0, 4);
+        std::memcpy(&address, payload.data() + 4, 4);
+        std::memcpy(&mem_length, payload.data() + 8, 4);
+        if (mem_length == 0 || mem_length > kMaxReadMem) {
+            return fail(kEBadLength, "READMEM length out of range");
+        }
+        if (address > std::numeric_limits<uint32_t>::max() - mem_length) {
+            return fail(kEBadLength, "READMEM address wrap");
+        }
+        if (domain != kMemMain && domain != kMemMegaII && domain != kMemEnsoniq
+            && domain != kMemAdbMicro && domain != kMemMainRaw && domain != kMemMegaIIRaw) {
+            return fail(kEBadLength, "READMEM invalid domain");
+        }
+        req.domain = domain;
+        return bridge(domain, address, mem_length, {}, "bad readmem reply");
+    }
+    case kTypeWriteMem: {
+        if (length < 12) {
+            return fail(kEBadLength, "WRITEMEM payload too short");
+        }
+        uint32_t domain = 0, address = 0, mem_length = 0;
+        std::memcpy(&domain, payload.data() + 0, 4);
+        std::memcpy(&address, payload.data() + 4, 4);
+        std::memcpy(&mem_length, payload.data() + 8, 4);
+        if (mem_length == 0 || mem_length > kMaxWriteMem) {
+            return fail(kEBadLength, "WRITEMEM length out of range");
+        }
+        if (length != 12 + static_cast<size_t>(mem_length)) {
+            return fail(kEBadLength, "WRITEMEM payload length mismatch");
+        }
+        if (address > std::numeric_limits<uint32_t>::max() - mem_length) {
+            return fail(kEBadLength, "WRITEMEM address wrap");
+        }
+        if (domain != kMemMain && domain != kMemMegaII && domain != kMemEnsoniq
+            && domain != kMemAdbMicro && domain != kMemMainRaw && domain != kMemMegaIIRaw) {
+            return fail(kEBadLength, "WRITEMEM invalid domain");
+        }
+        req.domain = domain;
+        return bridge(domain, address, mem_length, std::vector<uint8_t>(payload.begin() + 12, payload.end()),
+                      "bad writemem reply");
+    }
+    case kTypeBpSet:
+        if (length != kBpSetPayloadSize) {
+            return fail(kEBadLength, "BP_SET requires 32-byte payload");
+        }
+        return bridge(0, 0, 0, payload, "bad bp_set reply");
+    case kTypeBpClear: {
+        if (length != 4) {
+            return fail(kEBadLength, "BP_CLEAR requires 4-byte payload");
+        }
+        uint32_t id = 0;
+        std::memcpy(&id, payload.data(), 4);
+        return bridge(id, 0, 0, {}, "bad bp_clear reply");
+    }
+    case kTypeBpClearAll:
+        if (length != 0) {
+            return fail(kEBadLength, "BP_CLEAR_ALL requires empty payload");
+        }
+        return bridge(0, 0, 0, {}, "bad bp_clear_all reply");
+    case kTypeBpEnable: {
+        if (length != 8) {
+            return fail(kEBadLength, "BP_ENABLE requires 8-byte payload");
+        }
+        uint32_t id = 0;
+        uint32_t enabled = 0;
+        std::memcpy(&id, payload.data() + 0, 4);
+        std::memcpy(&enabled, payload.data() + 4, 4);
+        if (enabled != 0 && enabled != 1) {
+            return fail(kEBadLength, "BP_ENABLE enabled must be 0 or 1");
+        }
+        return bridge(id, enabled, 0, {}, "bad bp_enable reply");
+    }
+    case kTypeBpList:
+        if (length != 0) {
+            return fail(kEBadLength, "BP_LIST requires empty payload");
         }
-        case kTypeGetStatus: {
-            if (hdr.length != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "GET_STATUS requires empty payload");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeGetStatus, hdr.seq, 0, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (reply.size() != 8) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad status reply");
-            }
-            REPLY_OK(kTypeGetStatus, hdr.seq, reply.data(), 8);
-            break;
+        return bridge(0, 0, 0, {}, "bad bp_list reply");
+    case kTypeVideoText: {
+        if (length != kVideoTextReqSize) {
+            return fail(kEBadLength, "VIDEO_TEXT requires 8-byte payload");
         }
-        case kTypeReset: {
-            if (hdr.length != 4) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "RESET requires 4-byte payload");
-            }
-            uint32_t cold_start = 0;
-            std::memcpy(&cold_start, payload.data(), 4);
-            if (cold_start != 0 && cold_start != 1) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "RESET cold_start must be 0 or 1");
-            }
-
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeReset, hdr.seq, cold_start, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad reset reply");
-            }
-            REPLY_OK(kTypeReset, hdr.seq, nullptr, 0);
-            break;
+        uint32_t page = 0, mode = 0;
+        std::memcpy(&page, payload.data() + 0, 4);
+        std::memcpy(&mode, payload.data() + 4, 4);
+        if (page > 2) {
+            return fail(kEBadLength, "VIDEO_TEXT invalid page");
         }
-        case kTypePause: {
-            if (hdr.length != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "PAUSE requires empty payload");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypePause, hdr.seq, 0, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad pause reply");
-            }
-            REPLY_OK(kTypePause, hdr.seq, nullptr, 0);
-            break;
+        if (mode > 7) {
+            return fail(kEBadLength, "VIDEO_TEXT invalid mode");
         }
-        case kTypeContinue: {
-            if (hdr.length != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "CONTINUE requires empty payload");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeContinue, hdr.seq, 0, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad continue reply");
-            }
-            REPLY_OK(kTypeContinue, hdr.seq, nullptr, 0);
-            break;
+        if (mode >= 3) {
+            return fail(kEBadLength, "unsupported video mode");
         }
-        case kTypeStepInto: {
-            if (hdr.length != 4) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "STEP_INTO requires 4-byte payload");
-            }
-            uint32_t count = 0;
-            std::memcpy(&count, payload.data(), 4);
-            if (count == 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "STEP_INTO count must be >= 1");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeStepInto, hdr.seq, count, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad step_into reply");
-            }
-            REPLY_OK(kTypeStepInto, hdr.seq, nullptr, 0);
-            break;
+        return bridge(page, mode, 0, {}, "bad video_text reply");
+    }
+    case kTypeMount: {
+        if (length < 8) {
+            return fail(kEBadLength, "MOUNT payload too short");
         }
-        case kTypeGetTrace: {
-            if (hdr.length != 8) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "GET_TRACE requires 8-byte payload");
-            }
-            uint32_t ago = 0, count = 0;
-            std::memcpy(&ago, payload.data() + 0, 4);
-            std::memcpy(&count, payload.data() + 4, 4);
-            if (count == 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "GET_TRACE count must be >= 1");
-            }
-            if (count > kMaxTraceRecords) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "GET_TRACE count out of range");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeGetTrace, hdr.seq, ago, count, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (reply.size() < 8) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad get_trace reply");
-            }
-            uint32_t returned = 0;
-            std::memcpy(&returned, reply.data() + 4, 4);
-            if (reply.size() != 8 + static_cast<size_t>(returned) * kTraceEntrySize) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad get_trace reply");
-            }
-            REPLY_OK(kTypeGetTrace, hdr.seq, reply.data(), static_cast<uint32_t>(reply.size()));
-            break;
+        uint32_t slot = 0, unit = 0;
+        std::memcpy(&slot, payload.data() + 0, 4);
+        std::memcpy(&unit, payload.data() + 4, 4);
+        if (unit > kMaxMediaUnit) {
+            return fail(kEBadLength, "MOUNT unit out of range");
         }
-        case kTypeGetRegs: {
-            if (hdr.length != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "GET_REGS requires empty payload");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeGetRegs, hdr.seq, 0, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (reply.size() != kTraceEntrySize) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad get_regs reply");
-            }
-            REPLY_OK(kTypeGetRegs, hdr.seq, reply.data(), kTraceEntrySize);
-            break;
+        // An empty path still goes to the main thread, so the reply is MEDIA_BAD_PATH status (not ERROR).
+        if (length - 8 > kMaxMediaPathLen) {
+            return fail(kEBadLength, "MOUNT path too long");
         }
-        case kTypeSetRegs: {
-            if (hdr.length != kSetRegsPayloadSize) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "SET_REGS requires 24-byte payload");
-            }
-            uint32_t mask = 0;
-            std::memcpy(&mask, payload.data() + 0, 4);
-            if ((mask & ~kRegMaskAll) != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "SET_REGS unknown mask bits");
-            }
-            if ((mask & kRegE) && payload[19] > 1) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "SET_REGS e must be 0 or 1");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            if (!submit_and_wait(kTypeSetRegs, hdr.seq, 0, 0, 0, payload, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad set_regs reply");
-            }
-            REPLY_OK(kTypeSetRegs, hdr.seq, nullptr, 0);
-            break;
+        return bridge(slot, unit, 0, std::vector<uint8_t>(payload.begin() + 8, payload.end()), "bad mount reply");
+    }
+    case kTypeUnmount: {
+        if (length != 8) {
+            return fail(kEBadLength, "UNMOUNT requires 8-byte payload");
         }
-        case kTypeFindMem: {
-            if (hdr.length < kFindMemHeaderSize) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "FINDMEM payload too short");
-            }
-            uint32_t domain = 0, address = 0, length = 0, max_hits = 0, pattern_len = 0, flags = 0;
-            std::memcpy(&domain, payload.data() + 0, 4);
-            std::memcpy(&address, payload.data() + 4, 4);
-            std::memcpy(&length, payload.data() + 8, 4);
-            std::memcpy(&max_hits, payload.data() + 12, 4);
-            std::memcpy(&pattern_len, payload.data() + 16, 4);
-            std::memcpy(&flags, payload.data() + 20, 4);
-            if ((flags & ~kFindMemHasMask) != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "FINDMEM unknown flags");
-            }
-            if (length == 0 || length > kMaxReadMem) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "FINDMEM length out of range");
-            }
-            if (address > std::numeric_limits<uint32_t>::max() - length) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "FINDMEM address wrap");
-            }
-            if (pattern_len == 0 || pattern_len > kMaxFindPattern || pattern_len > length) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "FINDMEM pattern_len out of range");
-            }
-            if (max_hits == 0 || max_hits > kMaxFindHits) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "FINDMEM max_hits out of range");
-            }
-            if (domain != kMemMain && domain != kMemMegaII && domain != kMemEnsoniq
-                && domain != kMemAdbMicro && domain != kMemMainRaw && domain != kMemMegaIIRaw) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "FINDMEM invalid domain");
-            }
-            const bool has_mask = (flags & kFindMemHasMask) != 0;
-            const uint32_t expect = kFindMemHeaderSize + pattern_len + (has_mask ? pattern_len : 0);
-            if (hdr.length != expect) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "FINDMEM payload length mismatch");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            if (!submit_and_wait(kTypeFindMem, hdr.seq, 0, 0, 0, payload, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err, domain));
-            }
-            if (reply.size() < 4) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad findmem reply");
-            }
-            uint32_t hit_count = 0;
-            std::memcpy(&hit_count, reply.data(), 4);
-            if (hit_count > max_hits || reply.size() != 4 + static_cast<size_t>(hit_count) * 4) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad findmem reply");
-            }
-            REPLY_OK(kTypeFindMem, hdr.seq, reply.data(), static_cast<uint32_t>(reply.size()));
-            break;
+        uint32_t slot = 0, unit = 0;
+        std::memcpy(&slot, payload.data() + 0, 4);
+        std::memcpy(&unit, payload.data() + 4, 4);
+        if (unit > kMaxMediaUnit) {
+            return fail(kEBadLength, "UNMOUNT unit out of range");
         }
-        case kTypeStateGet: {
-            if (hdr.length != 4) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "STATE_GET requires 4-byte payload");
-            }
-            uint32_t device_id_u = 0;
-            std::memcpy(&device_id_u, payload.data(), 4);
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeStateGet, hdr.seq, device_id_u, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            REPLY_OK(kTypeStateGet, hdr.seq, reply.data(), static_cast<uint32_t>(reply.size()));
-            break;
+        return bridge(slot, unit, 0, {}, "bad unmount reply");
+    }
+    case kTypeSnapSave:
+    case kTypeSnapLoad: {
+        // SAVE: flags u32 + path; LOAD: path only.
+        const size_t path_off = (type == kTypeSnapSave) ? 4 : 0;
+        if (length < path_off) {
+            return fail(kEBadLength, "SNAPSHOT_SAVE payload too short");
+        }
+        if (length - path_off > kMaxMediaPathLen) {
+            return fail(kEBadLength, "SNAPSHOT path too long");
+        }
+        uint32_t flags = 0;
+        if (path_off) std::memcpy(&flags, payload.data(), 4);
+        return bridge(flags, 0, 0, std::vector<uint8_t>(payload.begin() + path_off, payload.end()),
+                      "bad snapshot reply");
+    }
+    case kTypeKeyEvent: {
+        if (length != 12) {
+            return fail(kEBadLength, "KEYEVENT requires 12-byte payload");
         }
-        case kTypeStateSet: {
-            if (hdr.length < 4) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "STATE_SET requires device_id + blob");
-            }
-            uint32_t device_id_u = 0;
-            std::memcpy(&device_id_u, payload.data(), 4);
-            std::vector<uint8_t> request_data(payload.begin() + 4, payload.end());
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            if (!submit_and_wait(kTypeStateSet, hdr.seq, device_id_u, 0, 0, request_data, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            REPLY_OK(kTypeStateSet, hdr.seq, reply.data(), static_cast<uint32_t>(reply.size()));
-            break;
+        uint32_t down = 0, scancode = 0, mod = 0;
+        std::memcpy(&down, payload.data() + 0, 4);
+        std::memcpy(&scancode, payload.data() + 4, 4);
+        std::memcpy(&mod, payload.data() + 8, 4);
+
+        if (down != 0 && down != 1) {
+            return fail(kEBadLength, "KEYEVENT down must be 0 or 1");
         }
-        case kTypeReadMem: {
-            if (hdr.length != 12) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "READMEM requires 12-byte payload");
-            }
-            uint32_t domain = 0, address = 0, length = 0;
-            std::memcpy(&domain, payload.data() + 0, 4);
-            std::memcpy(&address, payload.data() + 4, 4);
-            std::memcpy(&length, payload.data() + 8, 4);
 
-            if (length == 0 || length > kMaxReadMem) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "READMEM length out of range");
-            }
-            if (address > std::numeric_limits<uint32_t>::max() - length) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "READMEM address wrap");
-            }
-            if (domain != kMemMain && domain != kMemMegaII && domain != kMemEnsoniq
-                && domain != kMemAdbMicro && domain != kMemMainRaw && domain != kMemMegaIIRaw) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "READMEM invalid domain");
-            }
+        SDL_Event ev{};
+        ev.type = down ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+        ev.key.scancode = static_cast<SDL_Scancode>(scancode);
+        ev.key.mod = static_cast<SDL_Keymod>(mod);
+        ev.key.key = SDL_GetKeyFromScancode(ev.key.scancode, ev.key.mod, false);
+        ev.key.down = (down != 0);
+        ev.key.repeat = false;
 
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeReadMem, hdr.seq, domain, address, length, kEmptyRequest, reply,
-                                 err, kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err, domain));
-            }
-            if (reply.size() != length) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad readmem reply");
-            }
-            REPLY_OK(kTypeReadMem, hdr.seq, reply.data(), length);
-            break;
+        if (!SDL_PushEvent(&ev)) {
+            return fail(kEInternal, "SDL_PushEvent failed");
         }
-        case kTypeWriteMem: {
-            if (hdr.length < 12) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "WRITEMEM payload too short");
-            }
-            uint32_t domain = 0, address = 0, length = 0;
-            std::memcpy(&domain, payload.data() + 0, 4);
-            std::memcpy(&address, payload.data() + 4, 4);
-            std::memcpy(&length, payload.data() + 8, 4);
+        return answer(nullptr, 0);
+    }
+    case kTypePasteText:
+        return bridge(0, 0, 0, payload, "bad paste_text reply");
+    case kTypePasteBasic:
+        return bridge(0, 0, 0, payload, "bad paste_basic reply");
+    case kTypeBatch: {
+        // count u32, then count x { type u32, length u32, data[length] }.
+        if (length < 4) {
+            return fail(kEBadLength, "BATCH payload too short");
+        }
+        uint32_t count = 0;
+        std::memcpy(&count, payload.data(), 4);
+        if (count == 0 || count > kMaxBatchEntries) {
+            return fail(kEBadLength, "BATCH count out of range");
+        }
+        req.parts.resize(count);
+        size_t off = 4;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (length - off < 8) {
+                return fail(kEBadLength, "BATCH entry overruns payload");
+            }
+            uint32_t entry_type = 0, entry_len = 0;
+            std::memcpy(&entry_type, payload.data() + off, 4);
+            std::memcpy(&entry_len, payload.data() + off + 4, 4);
+            off += 8;
+            if (entry_len > length - off) {
+                return fail(kEBadLength, "BATCH entry overruns payload");
+            }
+            std::vector<uint8_t> entry(payload.begin() + off, payload.begin() + off + entry_len);
+            off += entry_len;
+            prepare_request(entry_type, seq, entry, handshaked, true, req.parts[i]);
+        }
+        if (off != length) {
+            return fail(kEBadLength, "BATCH payload length mismatch");
+        }
+        return;
+    }
+    default:
+        return fail(kEUnknownType, "unknown type");
+    }
+}
 
-            if (length == 0 || length > kMaxWriteMem) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "WRITEMEM length out of range");
-            }
-            if (hdr.length != 12 + length) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "WRITEMEM payload length mismatch");
-            }
-            if (address > std::numeric_limits<uint32_t>::max() - length) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "WRITEMEM address wrap");
-            }
-            if (domain != kMemMain && domain != kMemMegaII && domain != kMemEnsoniq
-                && domain != kMemAdbMicro && domain != kMemMainRaw && domain != kMemMegaIIRaw) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "WRITEMEM invalid domain");
+bool DebugProtocolServer::complete_request(PendingRequest &req) {
+    if (req.reply_type != 0) {
+        return true;
+    }
+    if (req.job) {
+        const BridgeJob &job = *req.job;
+        if (!job.done.load(std::memory_order_acquire)) {
+            return false;
+        }
+        const char *message = nullptr;
+        uint32_t code = job.error;
+        if (code != 0) {
+            message = bridge_error_message(job, req.domain);
+        } else if (!bridge_reply_ok(job)) {
+            code = kEInternal;
+            message = req.bad_reply;
+        }
+        if (code != 0) {
+            const size_t msg_len = message ? std::strlen(message) : 0;
+            req.reply_type = kTypeError;
+            req.reply.resize(4 + msg_len);
+            std::memcpy(req.reply.data(), &code, 4);
+            if (msg_len) {
+                std::memcpy(req.reply.data() + 4, message, msg_len);
             }
+        } else {
+            req.reply_type = req.type;
+            req.reply = std::move(req.job->reply);
+        }
+        if (req.job->hold_until_reply) {
+            req.release_after_reply.push_back(std::move(req.job->hold_until_reply));
+        }
+        if (req.job->reply_fds.empty() || code != 0) {
+            req.job.reset();    // else kept until send_answered() passes the descriptors on
+        }
+        return true;
+    }
 
-            std::vector<uint8_t> request_data(payload.begin() + 12, payload.end());
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            if (!submit_and_wait(kTypeWriteMem, hdr.seq, domain, address, length, request_data, reply,
-                                 err, kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err, domain));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad writemem reply");
-            }
-            REPLY_OK(kTypeWriteMem, hdr.seq, nullptr, 0);
-            break;
+    // BATCH: answered once every entry is.
+    for (PendingRequest &part : req.parts) {
+        if (!complete_request(part)) {
+            return false;
         }
-        case kTypeBpSet: {
-            if (hdr.length != kBpSetPayloadSize) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "BP_SET requires 32-byte payload");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            if (!submit_and_wait(kTypeBpSet, hdr.seq, 0, 0, 0, payload, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (reply.size() != 4) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad bp_set reply");
-            }
-            REPLY_OK(kTypeBpSet, hdr.seq, reply.data(), 4);
-            break;
+    }
+    for (PendingRequest &part : req.parts) {
+        for (auto &flag : part.release_after_reply) {
+            req.release_after_reply.push_back(std::move(flag));
         }
-        case kTypeBpClear: {
-            if (hdr.length != 4) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "BP_CLEAR requires 4-byte payload");
-            }
-            uint32_t id = 0;
-            std::memcpy(&id, payload.data(), 4);
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeBpClear, hdr.seq, id, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad bp_clear reply");
-            }
-            REPLY_OK(kTypeBpClear, hdr.seq, nullptr, 0);
-            break;
+    }
+    const uint32_t count = static_cast<uint32_t>(req.parts.size());
+    size_t total = 4;
+    for (const PendingRequest &part : req.parts) {
+        total += 8 + part.reply.size();
+    }
+    if (total > kMaxPayload) {
+        static const char kTooLarge[] = "BATCH reply too large";
+        const uint32_t code = kEBadLength;
+        req.reply_type = kTypeError;
+        req.reply.resize(4 + sizeof(kTooLarge) - 1);
+        std::memcpy(req.reply.data(), &code, 4);
+        std::memcpy(req.reply.data() + 4, kTooLarge, sizeof(kTooLarge) - 1);
+    } else {
+        req.reply_type = kTypeBatch;
+        req.reply.resize(total);
+        std::memcpy(req.reply.data(), &count, 4);
+        size_t off = 4;
+        for (const PendingRequest &part : req.parts) {
+            const uint32_t part_len = static_cast<uint32_t>(part.reply.size());
+            std::memcpy(req.reply.data() + off, &part.reply_type, 4);
+            std::memcpy(req.reply.data() + off + 4, &part_len, 4);
+            if (part_len) {
+                std::memcpy(req.reply.data() + off + 8, part.reply.data(), part_len);
+            }
+            off += 8 + part_len;
         }
-        case kTypeBpClearAll: {
-            if (hdr.length != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "BP_CLEAR_ALL requires empty payload");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeBpClearAll, hdr.seq, 0, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad bp_clear_all reply");
-            }
-            REPLY_OK(kTypeBpClearAll, hdr.seq, nullptr, 0);
-            break;
+    }
+    req.parts.clear();
+    return true;
+}
+
+bool DebugProtocolServer::send_answered(DebugSocketHandle fd, std::deque<PendingRequest> &pending) {
+    while (!pending.empty() && complete_request(pending.front())) {
+        PendingRequest &req = pending.front();
+        const std::vector<int> *fds = req.job ? &req.job->reply_fds : nullptr;
+        if (!send_frame(fd, req.reply_type, req.seq, req.reply.data(), static_cast<uint32_t>(req.reply.size()), fds)) {
+            return false;
         }
-        case kTypeBpEnable: {
-            if (hdr.length != 8) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "BP_ENABLE requires 8-byte payload");
-            }
-            uint32_t id = 0;
-            uint32_t enabled = 0;
-            std::memcpy(&id, payload.data() + 0, 4);
-            std::memcpy(&enabled, payload.data() + 4, 4);
-            if (enabled != 0 && enabled != 1) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "BP_ENABLE enabled must be 0 or 1");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeBpEnable, hdr.seq, id, enabled, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad bp_enable reply");
-            }
-            REPLY_OK(kTypeBpEnable, hdr.seq, nullptr, 0);
-            break;
+        req.job.reset();
+        for (const auto &flag : req.release_after_reply) {
+            flag->store(false, std::memory_order_release);
         }
-        case kTypeBpList: {
-            if (hdr.length != 0) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "BP_LIST requires empty payload");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeBpList, hdr.seq, 0, 0, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (reply.size() < 4) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad bp_list reply");
-            }
-            uint32_t count = 0;
-            std::memcpy(&count, reply.data(), 4);
-            if (reply.size() != 4 + count * kBpListRecordSize) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad bp_list reply");
-            }
-            REPLY_OK(kTypeBpList, hdr.seq, reply.data(), static_cast<uint32_t>(reply.size()));
-            break;
+        if (req.after_reply && !run_and_wait(req.after_reply)) {
+            return false;
         }
-        case kTypeVideoText: {
-            if (hdr.length != kVideoTextReqSize) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "VIDEO_TEXT requires 8-byte payload");
-            }
-            uint32_t page = 0, mode = 0;
-            std::memcpy(&page, payload.data() + 0, 4);
-            std::memcpy(&mode, payload.data() + 4, 4);
-            if (page > 2) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "VIDEO_TEXT invalid page");
-            }
-            if (mode > 7) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "VIDEO_TEXT invalid mode");
-            }
-            if (mode >= 3) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "unsupported video mode");
-            }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeVideoText, hdr.seq, page, mode, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (reply.size() < kVideoTextHeaderSize) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad video_text reply");
-            }
-            uint32_t cols = 0, rows = 0;
-            std::memcpy(&cols, reply.data() + 0, 4);
-            std::memcpy(&rows, reply.data() + 4, 4);
-            if (rows != text_page::kRows
-                || (cols != text_page::kCols40 && cols != text_page::kCols80)
-                || reply.size() != kVideoTextHeaderSize + static_cast<size_t>(cols) * rows) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad video_text reply");
-            }
-            REPLY_OK(kTypeVideoText, hdr.seq, reply.data(), static_cast<uint32_t>(reply.size()));
-            break;
+        pending.pop_front();
+        if (!flush_events(fd)) {
+            return false;
         }
-        case kTypeMount: {
-            if (hdr.length < 8) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "MOUNT payload too short");
-            }
-            uint32_t slot = 0, unit = 0;
-            std::memcpy(&slot, payload.data() + 0, 4);
-            std::memcpy(&unit, payload.data() + 4, 4);
-            if (unit > kMaxMediaUnit) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "MOUNT unit out of range");
-            }
-            const size_t path_len = payload.size() - 8;
-            if (path_len == 0) {
-                // Still bridge so reply is MEDIA_BAD_PATH status (not ERROR).
-            } else if (path_len > kMaxMediaPathLen) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "MOUNT path too long");
-            }
-            std::vector<uint8_t> path_bytes(payload.begin() + 8, payload.end());
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            if (!submit_and_wait(kTypeMount, hdr.seq, slot, unit, 0, path_bytes, reply, err,
-                                 kMainThreadTimeoutMs)) {
-                return;
-            }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (reply.size() != 4) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad mount reply");
-            }
-            REPLY_OK(kTypeMount, hdr.seq, reply.data(), 4);
-            break;
+    }
+    return true;
+}
+
+void DebugProtocolServer::serve_client(DebugSocketHandle client_fd) {
+#if defined(_WIN32)
+    u_long nonblocking = 1;
+    ::ioctlsocket(native_socket(client_fd), FIONBIO, &nonblocking);
+#elif GS2_DEBUG_PROTO_UNIX
+    const int flags = fcntl(client_fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
+    }
+#endif
+    bool handshaked = false;
+
+    // Requests in arrival order; replies leave from the front as they are answered.
+    // KEYEVENT and QUIT act on their own, so they wait (held) until everything
+    // before them has been answered.
+    std::deque<PendingRequest> pending;
+    bool held = false;
+    FrameHeader held_hdr{};
+    std::vector<uint8_t> held_payload;
+
+    while (!stop_) {
+        if (!flush_events(client_fd)) {
+            return;
         }
-        case kTypeUnmount: {
-            if (hdr.length != 8) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "UNMOUNT requires 8-byte payload");
-            }
-            uint32_t slot = 0, unit = 0;
-            std::memcpy(&slot, payload.data() + 0, 4);
-            std::memcpy(&unit, payload.data() + 4, 4);
-            if (unit > kMaxMediaUnit) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "UNMOUNT unit out of range");
+        if (!send_answered(client_fd, pending)) {
+            return;
+        }
+        if (held && pending.empty()) {
+            held = false;
+            pending.emplace_back();
+            prepare_request(held_hdr.type, held_hdr.seq, held_payload, handshaked, false, pending.back());
+            submit_request(pending.back());
+            continue;
+        }
+
+        // Read ahead while the client keeps sending; otherwise wait on the oldest request.
+        const bool can_read = !held && pending.size() < kMaxPendingRequests;
+        const int poll_ms = pending.empty() ? 50 : 0;
+        bool readable = false;
+        if (can_read) {
+#if defined(_WIN32)
+            WSAPOLLFD pfd{};
+            pfd.fd = native_socket(client_fd);
+            pfd.events = POLLRDNORM;
+            const int pr = ::WSAPoll(&pfd, 1, poll_ms);
+            if (pr == SOCKET_ERROR) {
+                if (::WSAGetLastError() == WSAEINTR) {
+                    continue;
+                }
+                return;
             }
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            static const std::vector<uint8_t> kEmptyRequest;
-            if (!submit_and_wait(kTypeUnmount, hdr.seq, slot, unit, 0, kEmptyRequest, reply, err,
-                                 kMainThreadTimeoutMs)) {
+            if (pr > 0 && !(pfd.revents & POLLRDNORM) && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
                 return;
             }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
+            readable = pr > 0 && (pfd.revents & POLLRDNORM);
+#elif GS2_DEBUG_PROTO_UNIX
+            struct pollfd pfd{};
+            pfd.fd = client_fd;
+            pfd.events = POLLIN;
+            const int pr = poll(&pfd, 1, poll_ms);
+            if (pr < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
             }
-            if (reply.size() != 4) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad unmount reply");
+            if (pr > 0 && !(pfd.revents & POLLIN) && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+                return;
             }
-            REPLY_OK(kTypeUnmount, hdr.seq, reply.data(), 4);
-            break;
+            readable = pr > 0 && (pfd.revents & POLLIN);
+#endif
         }
-        case kTypeKeyEvent: {
-            if (hdr.length != 12) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "KEYEVENT requires 12-byte payload");
-            }
-            uint32_t down = 0, scancode = 0, mod = 0;
-            std::memcpy(&down, payload.data() + 0, 4);
-            std::memcpy(&scancode, payload.data() + 4, 4);
-            std::memcpy(&mod, payload.data() + 8, 4);
-
-            if (down != 0 && down != 1) {
-                REJECT(client_fd, hdr.seq, kEBadLength, "KEYEVENT down must be 0 or 1");
+        if (!readable) {
+            if (!pending.empty()) {
+                wait_request(pending.front(), 1);
             }
+            continue;
+        }
 
-            SDL_Event ev{};
-            ev.type = down ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
-            ev.key.scancode = static_cast<SDL_Scancode>(scancode);
-            ev.key.mod = static_cast<SDL_Keymod>(mod);
-            ev.key.key = SDL_GetKeyFromScancode(ev.key.scancode, ev.key.mod, false);
-            ev.key.down = (down != 0);
-            ev.key.repeat = false;
+        FrameHeader hdr{};
+        if (!read_full(client_fd, &hdr, sizeof(hdr))) {
+            return;
+        }
 
-            if (!SDL_PushEvent(&ev)) {
-                REJECT(client_fd, hdr.seq, kEInternal, "SDL_PushEvent failed");
-            }
-            REPLY_OK(kTypeKeyEvent, hdr.seq, nullptr, 0);
-            break;
+        if (hdr.length > kMaxPayload) {
+            send_answered(client_fd, pending);
+            send_error(client_fd, hdr.seq, kEBadLength, "payload too large");
+            return;
         }
-        case kTypePasteText: {
-            std::vector<uint8_t> reply;
-            uint32_t err = 0;
-            if (!submit_and_wait(kTypePasteText, hdr.seq, 0, 0, 0, payload, reply, err,
-                                 kMainThreadTimeoutMs)) {
+
+        std::vector<uint8_t> payload(hdr.length);
+        if (hdr.length > 0) {
+            if (!read_full(client_fd, payload.data(), hdr.length)) {
                 return;
             }
-            if (err != 0) {
-                REJECT(client_fd, hdr.seq, err, bridge_error_message(err));
-            }
-            if (!reply.empty()) {
-                REJECT(client_fd, hdr.seq, kEInternal, "bad paste_text reply");
-            }
-            REPLY_OK(kTypePasteText, hdr.seq, nullptr, 0);
-            break;
-        }
-        default: {
-            REJECT(client_fd, hdr.seq, kEUnknownType, "unknown type");
         }
+
+        if ((hdr.type == kTypeKeyEvent || hdr.type == kTypeQuit) && !pending.empty()) {
+            held = true;
+            held_hdr = hdr;
+            held_payload = std::move(payload);
+            continue;
         }
+        pending.emplace_back();
+        prepare_request(hdr.type, hdr.seq, payload, handshaked, false, pending.back());
+        submit_request(pending.back());
     }
-
-#undef REPLY_OK
-#undef REJECT
 }
@@ -1,13 +1,17 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
+#include "util/SharedRam.hpp"
+
 #include <SDL3/SDL.h>
 
 #include "debugger/BreakpointTable.hpp"
@@ -21,7 +25,10 @@ using DebugSocketHandle = std::intptr_t;
 /**
  * External debug protocol driver (AF_UNIX).
  * HELLO / PING / KEYEVENT on the protocol thread; PASTE_TEXT and other cmds via main-thread bridge.
+ * Requests are pipelined: the protocol thread reads ahead and queues every bridged command, the
+ * main thread runs the whole queue at each service point, and replies go out in request order.
  * Unsolicited EVENT frames are enqueued from the main thread and flushed on the protocol thread.
+ * SUBSCRIBE registrations are checked once per frame; each has at most one update in flight.
  * See Docs/DebugProtocol.md.
  */
 class DebugProtocolServer {
@@ -35,9 +42,20 @@ public:
     bool start();
     void stop();
 
-    /** Non-blocking. Call once per frame from the main / SDL iterate thread. */
+    /** Non-blocking. Call once per frame from the main / SDL iterate thread. Runs every queued command. */
     void process_main_thread(computer_t *computer);
 
+    /**
+     * Mid-frame service point, between instruction blocks (--debug-service block). Runs queued
+     * commands up to the first one that waits for the frame boundary (run control, breakpoints,
+     * media, snapshots). One atomic load when there is nothing to do.
+     */
+    inline void process_mid_frame(computer_t *computer) {
+        if (bridge_mid_frame_work_.load(std::memory_order_relaxed)) {
+            drain_bridge(computer, true);
+        }
+    }
+
     /** Enqueue an unsolicited EVENT (main thread only; no socket I/O). */
     void enqueue_event(uint32_t event_id, const std::vector<uint8_t> &data);
 
@@ -47,37 +65,141 @@ public:
     void emit_stopped_step(computer_t *computer);
     void emit_run_state(uint32_t new_mode, uint32_t prev_mode);
 
+    /**
+     * Whether the connected client reads CPU trace: it has a TRACE subscription or has
+     * sent GET_TRACE this session. Main thread only.
+     */
+    bool wants_trace() const;
+
     const std::string& socket_path() const { return socket_path_; }
 
 private:
+    /** One main-thread command. Shared, so a command read before the client went away still runs. */
+    struct BridgeJob {
+        uint32_t type = 0;
+        uint32_t arg0 = 0;
+        uint32_t arg1 = 0;
+        uint32_t arg2 = 0;
+        std::vector<uint8_t> request;
+        bool frame_only = false;        // not run by process_mid_frame()
+        std::chrono::steady_clock::time_point deadline;
+
+        std::atomic<bool> done{false};  // results below are valid once set
+        uint32_t error = 0;
+        bool timed_out = false;
+        bool megaii_platform_reject = false;
+        std::string error_text;
+        std::vector<uint8_t> reply;
+        std::vector<int> reply_fds;     // descriptors sent with the reply (MEMSHARE); closed if never sent
+        std::shared_ptr<std::atomic<bool>> hold_until_reply;    // SUBSCRIBE: no update before the reply
+
+        BridgeJob() = default;
+        ~BridgeJob();
+    };
+
+    /** A MEMSHARE window (main thread only): the shared RAM block and its page generation table. */
+    struct RamShare {
+        uint32_t domain = 0;
+        uint32_t session = 0;                       // client_session_ when it was made
+        const SharedRam *block = nullptr;
+        const uint8_t *base = nullptr;
+        SharedRam table;                            // generation, page_count, page_size, 0, then page_gen[]
+        std::vector<uint8_t> shadow;                // RAM as of the last scan
+        uint32_t generation = 0;
+    };
+
+    /**
+     * A SUBSCRIBE registration (main thread only). Updates are deltas against the last one
+     * queued; while that one is unsent (in_flight) the subscription is skipped, so a slow
+     * client gets fewer, larger updates instead of a growing queue.
+     */
+    struct Subscription {
+        uint32_t id = 0;
+        uint32_t kind = 0;
+        uint32_t session = 0;                       // client_session_ when it was made
+        uint32_t period = 1;                        // frames between updates, at least
+        uint32_t frames_left = 0;
+        uint32_t domain = 0;                        // MEM
+        uint32_t address = 0;
+        uint32_t length = 0;
+        uint32_t max_entries = 0;                   // TRACE: per update
+        const system_trace_buffer *trace = nullptr;
+        uint64_t trace_total = 0;                   // trace entries already reported
+        bool primed = false;                        // the first (full) update went out
+        std::vector<uint8_t> sent;                  // MEM contents / REGS entry as last reported
+        std::shared_ptr<std::atomic<bool>> in_flight = std::make_shared<std::atomic<bool>>(false);
+    };
+
+    /** An outbound EVENT. A subscription update clears its in_flight flag once written. */
+    struct QueuedEvent {
+        std::vector<uint8_t> data;                  // event_id(u32 LE) + data
+        std::shared_ptr<std::atomic<bool>> in_flight;
+        uint32_t session = 0;                       // updates are dropped if the client changed
+    };
+
+    /** A request read from the socket; answered (reply_type != 0) in arrival order. */
+    struct PendingRequest {
+        uint32_t type = 0;
+        uint32_t seq = 0;
+        uint32_t domain = 0;                        // READMEM / WRITEMEM / FINDMEM / SUBSCRIBE, for error text
+        const char *bad_reply = nullptr;            // error text if the main thread's reply is malformed
+        std::shared_ptr<BridgeJob> job;             // outstanding main-thread command
+        std::shared_ptr<BridgeJob> after_reply;     // run once the reply is written (QUIT)
+        std::vector<PendingRequest> parts;          // BATCH entries
+        std::vector<std::shared_ptr<std::atomic<bool>>> release_after_reply;    // cleared once written
+        uint32_t reply_type = 0;
+        std::vector<uint8_t> reply;
+    };
+
     static int SDLCALL thread_entry(void *userdata);
     void thread_main();
     void serve_client(DebugSocketHandle client_fd);
     bool flush_events(DebugSocketHandle fd);
     bool read_full(DebugSocketHandle fd, void *buf, size_t n);
     bool write_full(DebugSocketHandle fd, const void *buf, size_t n);
+    /** fds (POSIX only) ride along with the header as SCM_RIGHTS. */
     bool send_frame(DebugSocketHandle fd, uint32_t type, uint32_t seq,
-                    const void *payload, uint32_t length);
+                    const void *payload, uint32_t length, const std::vector<int> *fds = nullptr);
     bool send_error(DebugSocketHandle fd, uint32_t seq, uint32_t code, const char *message);
 
-    /** Send a protocol error. Returns true if the connection is dead (caller should return). */
-    bool reject(DebugSocketHandle fd, uint32_t seq, uint32_t code, const char *message);
-
-    /** Map a bridge error code to a client-facing message. domain is for READMEM/WRITEMEM. */
-    const char *bridge_error_message(uint32_t err, uint32_t domain = 0);
+    /** Map a failed job's error code to a client-facing message. domain is for READMEM/WRITEMEM. */
+    static const char *bridge_error_message(const BridgeJob &job, uint32_t domain);
+    /** Sanity-check the main thread's reply payload for the job's type. */
+    static bool bridge_reply_ok(const BridgeJob &job);
 
     /**
-     * Submit a main-thread command and wait for reply.
-     * On success, error_code_out==0 and reply holds the payload.
-     * request_payload is copied into the bridge for commands that need inbound bytes (WRITEMEM / BP_SET).
-     * Returns false if the server is stopping.
+     * Validate one request. Answers it at once (errors, HELLO, PING, KEYEVENT) or attaches the
+     * main-thread job(s) to req; nothing is queued yet. in_batch: an entry of a BATCH.
      */
-    bool submit_and_wait(uint32_t type, uint32_t seq,
-                         uint32_t arg0, uint32_t arg1, uint32_t arg2,
-                         const std::vector<uint8_t> &request_payload,
-                         std::vector<uint8_t> &reply_out, uint32_t &error_code_out,
-                         int timeout_ms);
-
+    void prepare_request(uint32_t type, uint32_t seq, const std::vector<uint8_t> &payload,
+                         bool &handshaked, bool in_batch, PendingRequest &req);
+    /** Queue req's jobs (all BATCH entries together, so they run back to back). */
+    void submit_request(PendingRequest &req);
+    /** Fill in req's reply if all of its jobs are done. Returns true once answered. */
+    bool complete_request(PendingRequest &req);
+    /** Write every answered request at the front of pending. False if the connection is dead. */
+    bool send_answered(DebugSocketHandle fd, std::deque<PendingRequest> &pending);
+    /** Wait up to timeout_ms for req's jobs; expire any past their deadline. */
+    void wait_request(PendingRequest &req, int timeout_ms);
+    /** Queue one job and wait for it. Returns false if the server is stopping. */
+    bool run_and_wait(const std::shared_ptr<BridgeJob> &job);
+
+    /** Main thread: run queued jobs (mid_frame: up to the first frame_only one). */
+    void drain_bridge(computer_t *computer, bool mid_frame);
+    void run_job(computer_t *computer, BridgeJob &job);
+    void update_bridge_state_locked();
+    /** MEMSHARE: open a window on a raw RAM domain. */
+    void open_ram_share(computer_t *computer, BridgeJob &job);
+    /** Once a frame: stamp the pages that changed in each open window; close stale ones. */
+    void update_ram_shares(computer_t *computer);
+    /** SUBSCRIBE / UNSUBSCRIBE. */
+    void subscribe(computer_t *computer, BridgeJob &job);
+    void unsubscribe(BridgeJob &job);
+    /** Once a frame: queue an update for each subscription that changed; drop stale ones. */
+    void update_subscriptions(computer_t *computer);
+    /** Build sub's next update body into out; false if nothing changed. Sets closed if it can no longer run. */
+    bool poll_subscription(computer_t *computer, Subscription &sub, std::vector<uint8_t> &out, bool &closed);
+    void push_event(QueuedEvent event);
     void wake_bridge_locked();
 
     static void fill_live_trace(computer_t *computer, system_trace_entry_t *out);
@@ -91,25 +213,23 @@ private:
     SDL_Thread *thread_{nullptr};
     bool winsock_started_{false};
 
-    // Single-flight main-thread bridge
+    // Main-thread bridge: jobs in request order. The main thread holds bridge_mu_ while it runs them.
     std::mutex bridge_mu_;
     std::condition_variable bridge_cv_;
-    bool bridge_pending_{false};
-    bool bridge_done_{false};
-    uint32_t bridge_type_{0};
-    uint32_t bridge_seq_{0};
-    uint32_t bridge_arg0_{0};
-    uint32_t bridge_arg1_{0};
-    uint32_t bridge_arg2_{0};
-    uint32_t bridge_error_{0};
-    bool bridge_timed_out_{false};
-    bool bridge_megaii_platform_reject_{false};
-    std::string bridge_error_text_;
-    std::vector<uint8_t> bridge_request_;
-    std::vector<uint8_t> bridge_reply_;
+    std::deque<std::shared_ptr<BridgeJob>> bridge_queue_;
+    std::atomic<bool> bridge_mid_frame_work_{false};   // queue non-empty and front not frame_only
+
+    // MEMSHARE windows. A session is one client connection; windows of an earlier one are closed.
+    std::vector<std::unique_ptr<RamShare>> ram_shares_;
+    std::atomic<uint32_t> client_session_{0};
+
+    // SUBSCRIBE registrations (main thread only).
+    std::vector<std::unique_ptr<Subscription>> subscriptions_;
+    uint32_t next_subscription_id_ = 1;
+    uint32_t trace_session_ = 0;                   // client_session_ of the last GET_TRACE
 
     // Outbound EVENT queue (main enqueues; protocol thread drains)
     std::mutex event_mu_;
-    std::deque<std::vector<uint8_t>> event_queue_; // each: event_id(u32 LE) + data
+    std::deque<QueuedEvent> event_queue_;
     uint32_t event_seq_{1};
 };
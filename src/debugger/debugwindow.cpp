@@ -244,7 +244,10 @@ bool debug_window_t::check_post_breakpoint(cpu_state *cpu, system_trace_entry_t
     }
 
     if (computer && computer->breakpoints) {
-        auto hit = computer->breakpoints->check_post(cpu, entry);
+        auto hit = computer->breakpoints->take_watch_hit();
+        if (!hit) {
+            hit = computer->breakpoints->check_post(cpu, entry);
+        }
         if (hit) {
             if (hit_out) {
                 *hit_out = *hit;
@@ -262,7 +265,7 @@ bool debug_window_t::needs_breakpoint_checks() const {
     if (stepover_bp || step_out_active) {
         return true;
     }
-    if (computer && computer->breakpoints && computer->breakpoints->has_enabled()) {
+    if (computer && computer->breakpoints && computer->breakpoints->needs_instruction_checks()) {
         return true;
     }
     return false;
@@ -272,6 +275,7 @@ void debug_window_t::set_mmu(MMU *mmu) {
     this->mmu = mmu;
     monitor_.bind(mmu, &memory_watches, computer->breakpoints, disasm, &debug_displays,
                   cpu ? cpu->trace_buffer : nullptr, &video_views_);
+    computer->breakpoints->attach_mmu(mmu, computer->cpu, computer->clock);
 }
 
 void debug_window_t::execute_command(const std::string& command) {
@@ -217,6 +217,7 @@ void system_trace_buffer::add_entry(const system_trace_entry_t &entry) {
         }
     }
     count++;
+    total++;
 }
 
 void system_trace_buffer::save_to_file(const std::string &filename) {
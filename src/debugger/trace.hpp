@@ -71,6 +71,7 @@ struct system_trace_buffer {
     size_t head;
     size_t tail;
     size_t count;
+    uint64_t total = 0;     // entries ever added; a reader's cursor into the ring
     processor_type cpu_type;
     int16_t cpu_mask;
     std::unordered_map<uint32_t, std::string> labels;
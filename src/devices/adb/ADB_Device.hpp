@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "util/DebugFormatter.hpp"
+#include "util/Snapshot.hpp"
 
 struct ADB_Register 
 {
@@ -35,6 +36,15 @@ public:
     virtual ADB_Register talk(uint8_t command, uint8_t reg) = 0;
     virtual bool process_event(SDL_Event &event) = 0;
 
+    virtual void snapshot(SnapshotIO &io) {
+        io.field(id);
+        for (int i = 0; i < 4; i++) {
+            io.field(registers[i].size);
+            io.bytes(registers[i].data, sizeof(registers[i].data));
+            if (registers[i].size > sizeof(registers[i].data)) registers[i].size = sizeof(registers[i].data);
+        }
+    }
+
 
     virtual void debug_display(DebugFormatter *df) {
         df->addLine(" [%d] Regs: 0:%02X%02X 1:%02X%02X 2:%02X%02X 3:%02X%02X", 
@@ -67,6 +67,12 @@ class ADB_Host
         }
     }
 
+    void snapshot(SnapshotIO &io) {
+        for (auto &device : devices) {
+            device->snapshot(io);
+        }
+    }
+
     bool process_event(SDL_Event &event) {
         for (auto &device : devices) {
             if (device->process_event(event)) {
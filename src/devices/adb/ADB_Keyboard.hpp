@@ -435,6 +435,22 @@ class ADB_Keyboard : public ADB_Device
         sdl_to_adb_key_map[SDL_SCANCODE_NONUSBACKSLASH] = ADB_ISO_102;
     }
 
+    void snapshot(SnapshotIO &io) override {
+        ADB_Device::snapshot(io);
+        for (int i = 0; i < 16; i++) {
+            io.field(keyqueue[i].keycode);
+            io.field(keyqueue[i].status);
+        }
+        io.field(index_in);
+        io.field(index_out);
+        io.field(count);
+        if (io.loading()) {
+            index_in %= 16;
+            index_out %= 16;
+            if (count > 16) count = 16;
+        }
+    }
+
     void reset(uint8_t cmd, uint8_t reg) override { }
 
     void flush(uint8_t cmd, uint8_t reg) override { }
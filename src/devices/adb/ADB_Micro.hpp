@@ -163,6 +163,7 @@ class KeyGloo
 
         key_code_t key_latch;
         std::string paste_buffer;
+        size_t paste_pos = 0;           // next character of paste_buffer to inject
 
         uint8_t last_key_down = 0;
 
@@ -287,8 +288,47 @@ class KeyGloo
             ram[0x51] = 0;
         }
 
+        // Host-side input plumbing (paste, queued host mouse motion) is not machine state
+        // and starts empty after a load.
+        void snapshot(SnapshotIO &io) {
+            io.bytes(ram, sizeof(ram));
+            io.bytes(key_mods, sizeof(key_mods));
+            io.bytes(key_codes, sizeof(key_codes));
+            io.bytes(configuration_bytes, sizeof(configuration_bytes));
+            io.field(modes_byte);
+            io.bytes(cmd, sizeof(cmd));
+            io.field(cmd_index);
+            io.field(cmd_bytes);
+            io.bytes(response, sizeof(response));
+            io.field(response_bytes);
+            io.field(response_index);
+            io.field(error_byte);
+            io.field(key_latch.keycode);
+            io.field(key_latch.keymods.value);
+            io.field(last_key_down);
+            io.bytes(mouse_data, sizeof(mouse_data));
+            io.field(reset_counter);
+            io.field(send_data_register);
+            io.field(status);
+            io.field(datareg);
+            io.field(keysdown);
+            adb_host->snapshot(io);
+            if (io.loading()) {
+                if (cmd_index > sizeof(cmd)) cmd_index = 0;
+                if (response_bytes > sizeof(response)) response_bytes = 0;
+                if (response_index > response_bytes) response_index = 0;
+                paste_buffer.clear();
+                paste_pos = 0;
+                motion_queue.clear();
+                pending_dx = 0;
+                pending_dy = 0;
+                update_interrupt_status();
+            }
+        }
+
         void start_paste(std::string text) {
             paste_buffer = std::move(text);
+            paste_pos = 0;
         }
 
         void reset() {
@@ -313,6 +353,7 @@ class KeyGloo
             kb_register_full = false;
             mouse_data_full = false;
             paste_buffer.clear();
+            paste_pos = 0;
             update_interrupt_status();
         }
 
@@ -337,6 +378,7 @@ class KeyGloo
             keysdown = 0;
             data_register_full = false;
             paste_buffer.clear();
+            paste_pos = 0;
 
         }
 
@@ -346,6 +388,7 @@ class KeyGloo
             key_latch = {0,0};
             keysdown = 0;
             paste_buffer.clear();
+            paste_pos = 0;
         }
 
         void flush_key_queue() {
@@ -1066,13 +1109,16 @@ class KeyGloo
                     reset_control->assert_reset(RST_ID_KEYMICRO, false);
                 }
             }
-            if (!paste_buffer.empty() && !(key_latch.keycode & 0x80)) {
-                uint8_t key = static_cast<uint8_t>(paste_buffer[0]);
+            if (paste_pos < paste_buffer.size() && !(key_latch.keycode & 0x80)) {
+                uint8_t key = static_cast<uint8_t>(paste_buffer[paste_pos]);
                 if (key == '\n') {
                     key = '\r';
                 }
                 store_key_to_buffer(key, vars.currmod.value);
-                paste_buffer.erase(0, 1);
+                if (++paste_pos == paste_buffer.size()) {
+                    paste_buffer.clear();
+                    paste_pos = 0;
+                }
             }
         }
 
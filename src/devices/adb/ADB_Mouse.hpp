@@ -37,6 +37,14 @@ class ADB_Mouse : public ADB_Device
         registers[2].data[1] = 0x00;
     }
 
+    void snapshot(SnapshotIO &io) override {
+        ADB_Device::snapshot(io);
+        io.field(button_0_down);
+        io.field(button_1_down);
+        io.field(has_data);
+        io.field(handler);
+    }
+
     void reset(uint8_t cmd, uint8_t reg) override { }
     void flush(uint8_t cmd, uint8_t reg) override { }
     void listen(uint8_t command, uint8_t reg, ADB_Register &msg) override {
@@ -166,6 +166,11 @@ void init_slot_keygloo(computer_t *computer, SlotType_t slot) {
         }
     );
 
+    computer->register_state_handler("keygloo", [kb_state](SnapshotIO &io) {
+        kb_state->kg->snapshot(io);
+        if (io.loading()) keygloo_update_interrupt_status(kb_state, kb_state->kg);
+    });
+
     computer->register_reset_handler([kb_state](bool cold_start) {
         if (cold_start) {
             kb_state->kg->zero_0x51();
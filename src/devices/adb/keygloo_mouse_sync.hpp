@@ -123,7 +123,9 @@ inline void write_em_axis(keygloo_state_t *kb_state, uint32_t lo, uint32_t hi,
     uint8_t byte_lo = static_cast<uint8_t>(value & 0xFF);
     uint8_t byte_hi = static_cast<uint8_t>((value >> 8) & 0xFF);
     MMU_II *megaii = kb_state->mmu;
+    megaii->video_write_sync(megaii->get_memory_base() + (lo & 0x1FFFF));
     megaii->get_memory_base()[lo & 0x1FFFF] = byte_lo;
+    megaii->video_write_sync(megaii->get_memory_base() + (hi & 0x1FFFF));
     megaii->get_memory_base()[hi & 0x1FFFF] = byte_hi;
 
     MMU *fpi = kb_state->computer->cpu->mmu;
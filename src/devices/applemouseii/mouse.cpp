@@ -318,6 +318,26 @@ void init_mouse(computer_t *computer, SlotType_t slot) {
             return debug_mouse(ds);
         }
     );
+
+    // the VBL event itself is restored with the other pending events.
+    computer->register_state_handler("mouse" + std::to_string((int)slot),
+        [ds](SnapshotIO &io) {
+            io.field(ds->x_pos.value);
+            io.field(ds->y_pos.value);
+            io.field(ds->x_clamp_low.value);
+            io.field(ds->x_clamp_high.value);
+            io.field(ds->y_clamp_low.value);
+            io.field(ds->y_clamp_high.value);
+            io.field(ds->status.value);
+            io.field(ds->mode.value);
+            io.field(ds->button_last_read);
+            io.cycle_time(ds->vbl_cycle, ds->clock->get_c14m());
+            io.field(ds->last_x_pos);
+            io.field(ds->last_y_pos);
+            io.field(ds->motion_x);
+            io.field(ds->motion_y);
+            if (io.loading()) mouse_propagate_interrupt(ds);
+        });
     
     // schedule timer for vbl to start during vbl of next frame.
     ds->event_timer->scheduleEvent(computer->get_frame_start_cycle() /* + ds->vbl_offset */, mouse_vbl_interrupt, 0x10000000 | (slot << 8) | 0, ds);
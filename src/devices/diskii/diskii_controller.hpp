@@ -25,6 +25,7 @@
 #include "util/DebugFormatter.hpp"
 #include "util/media.hpp"
 #include "util/SoundEffectKeys.hpp"
+#include "util/Snapshot.hpp"
 #include "devices/floppy/Floppy525_woz.hpp"
 
 // Soft-switch offsets within the slot's I/O page (same as ndiskii.hpp)
@@ -112,6 +113,71 @@ class DiskII_WOZ_Controller : public StorageDevice {
     }
 
 public:
+    /**
+     * One READSHIFT bit cell (mirrors OpenEmulator's
+     * AppleDiskIIInterfaceCard::updateSequencer SEQUENCER_READSHIFT case):
+     * while QA (bit 7) is 0, shift incoming RP bits left into the data
+     * register so the CPU can observe partial-nibble accumulation (e.g. 1F,
+     * 3F, 7F, FF). Once QA goes high the byte holds for two more bit cells,
+     * then the LSS preloads `0x02 | bit` for the next nibble's leading bits.
+     */
+    static inline void readshift_step(uint8_t &data_register, bool &sequencer_state, uint8_t bit) {
+        if (data_register & 0x80) {
+            if (!sequencer_state) {
+                sequencer_state = bit;
+            } else {
+                sequencer_state = false;
+                data_register = 0x02 | bit;
+            }
+        } else {
+            data_register = (data_register << 1) | bit;
+        }
+    }
+
+    /**
+     * READSHIFT over eight bit cells at once: [sequencer_state][data_register][bits,
+     * first bit in bit 7] -> new data_register | new sequencer_state << 8.
+     */
+    struct ReadShiftTable {
+        uint16_t next[2][256][256];
+        ReadShiftTable() {
+            for (int s = 0; s < 2; s++) {
+                for (int d = 0; d < 256; d++) {
+                    for (int b = 0; b < 256; b++) {
+                        uint8_t dr = (uint8_t)d;
+                        bool ss = s;
+                        for (int i = 7; i >= 0; i--) readshift_step(dr, ss, (b >> i) & 1);
+                        next[s][d][b] = dr | (ss << 8);
+                    }
+                }
+            }
+        }
+    };
+    static const ReadShiftTable &readshift_table() {
+        static const ReadShiftTable table;
+        return table;
+    }
+
+    /**
+     * READSHIFT over `bits` bit cells of the drive: a byte of track per table
+     * lookup while read_byte_fast() takes one, bit by bit for anything it won't
+     * (end of track, a fake-bit zero run) and the remainder.
+     */
+    static void readshift(Floppy_woz &drive, uint8_t &data_register, bool &sequencer_state, uint64_t bits) {
+        const ReadShiftTable &lut = readshift_table();
+        uint64_t i = 0;
+        uint8_t raw;
+        while (bits - i >= 8 && drive.read_byte_fast(raw)) {
+            uint16_t next = lut.next[sequencer_state][data_register][raw];
+            data_register = (uint8_t)next;
+            sequencer_state = next >> 8;
+            i += 8;
+        }
+        for (; i < bits; i++) {
+            readshift_step(data_register, sequencer_state, drive.read_pulse());
+        }
+    }
+
     DiskII_WOZ_Controller(SoundEffect *sound_effect, NClockII *clock, EventTimer *event_timer,
                           uint16_t slot)
         : StorageDevice(),
@@ -143,6 +209,17 @@ public:
         drives[1].set_enable(false);
     }
 
+    void snapshot(SnapshotIO &io) {
+        io.bytes(switches, sizeof(switches));
+        io.field(motor_on);
+        io.cycle_time(mark_cycles_turnoff, clock->get_c14m());
+        io.field(data_register);
+        io.field(sequencer_state);
+        if (io.loading()) diskii_select &= 1;
+        drives[0].snapshot(io);
+        drives[1].snapshot(io);
+    }
+
     bool diskii_running_last = false;
     int  tracknumber_last    = 0;
 
@@ -185,6 +262,8 @@ public:
 
     void frameUpdate(bool soundEffects) {
         check_motor_off_timer();
+        drives[0].frame_flush();
+        drives[1].frame_flush();
 
         if (soundEffects) {
             soundeffects_update();
@@ -210,27 +289,13 @@ public:
         // this updates the sim and tells us how many bits to update through the LSS.
         uint64_t bits_to_sim = drives[diskii_select].fast_forward(/* now */);
 
+        if (diskii_q7 == 0 && diskii_q6 == 0) {
+            readshift(drives[diskii_select], data_register, sequencer_state, bits_to_sim);
+            return;
+        }
+
         for (uint64_t i = 0; i < bits_to_sim; i++) {
-            if (diskii_q7 == 0 && diskii_q6 == 0) {
-                // READSHIFT (mirrors OpenEmulator's
-                // AppleDiskIIInterfaceCard::updateSequencer SEQUENCER_READSHIFT
-                // case): while QA (bit 7) is 0, shift incoming RP bits left
-                // into the data register so the CPU can observe partial-nibble
-                // accumulation (e.g. 1F, 3F, 7F, FF).  Once QA goes high the
-                // byte holds for two more bit cells, then the LSS preloads
-                // `0x02 | bit` for the next nibble's leading bits.
-                uint8_t bit = drives[diskii_select].read_pulse();
-                if (data_register & 0x80) {
-                    if (!sequencer_state) {
-                        sequencer_state = bit;
-                    } else {
-                        sequencer_state = false;
-                        data_register = 0x02 | bit;
-                    }
-                } else {
-                    data_register = (data_register << 1) | bit;
-                }
-            } else if (diskii_q7 == 0 && diskii_q6 == 1) {
+            if (diskii_q7 == 0 && diskii_q6 == 1) {
                 // READLOAD (SEQUENCER_READLOAD): the LSS executes SR every step,
                 // shifting the write-protect sense bit right into bit 7 of the
                 // data register.  Repeated reads while LOAD is held therefore
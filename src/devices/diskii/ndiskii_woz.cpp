@@ -126,6 +126,10 @@ void init_slot_ndiskII_woz(computer_t *computer, SlotType_t slot) {
             return true;
         });
 
+    computer->register_state_handler("diskii" + std::to_string((int)slot), [diskII_d](SnapshotIO &io) {
+        diskII_d->dc->snapshot(io);
+    });
+
     computer->register_debug_display_handler(
         "diskii",
         DH_DISKII,
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 
+#include "frame/Frames.hpp"
+
 class ScanBuffer;
 class Render;
 
@@ -11,6 +13,8 @@ public:
     virtual ~VideoScanGeneratorIntf() = default;
 
     virtual void generate_frame(ScanBuffer *frame_scan) = 0;
+    /** Switch the output frame between calls to generate_frame (double buffering). */
+    virtual void set_frame(FrameVSG *frame) = 0;
 
     virtual void set_display_shift(bool enable) = 0;
     virtual void set_dhgr_mono_mode(bool mono) = 0;
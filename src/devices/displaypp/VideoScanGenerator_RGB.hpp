@@ -100,6 +100,7 @@ public:
     VideoScanGenerator_RGB(CharRom *charrom, bool border_enabled = false, FrameVSG *frame_vsg = nullptr);
 
     virtual void generate_frame(ScanBuffer *frame_scan);
+    virtual void set_frame(FrameVSG *frame) { frame_vsg = frame; frame_vsg->set_line_v(beam_v); }
     virtual void set_display_shift(bool enable) { display_shift_enabled = enable; }
     virtual void set_dhgr_mono_mode(bool mono) { dhgr_mono_mode = mono; }
     virtual bool get_dhgr_mono_mode() const { return dhgr_mono_mode; }
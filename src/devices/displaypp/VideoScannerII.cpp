@@ -3,6 +3,7 @@
 #include "cpu.hpp"
 #include "frame/Frames.hpp"
 #include "ScanBuffer.hpp"
+#include "util/Snapshot.hpp"
 
 void VideoScannerII::init_video_addresses()
 {
@@ -255,6 +256,9 @@ void VideoScannerII::cancel_pending_mode_change(vs_mode_switch_t sw)
 
 void VideoScannerII::queue_mode_change(vs_mode_switch_t sw, uint8_t value)
 {
+    // Cycles owed so far were scanned under the old mode.
+    sync();
+
     // LUT latency: 0 = same-cycle (retro-patch last Scan_t); 1 or 2 = apply at
     // scan_index + delay at the start of that video_cycle.
     const uint8_t delay = mode_change_delay(sw);
@@ -308,52 +312,157 @@ void VideoScannerII::drain_due_mode_changes()
 
 void VideoScannerII::video_cycle()
 {
-    apply_due_mode_changes();
-
-    scan_address_t &sa = video_addresses[scan_index];
-
-    uint16_t address = sa.addr;
+    pending++;
+    catch_up();
+}
 
-    video_byte = ram[address];
-    mmu->set_floating_bus(video_byte);
+void VideoScannerII::catch_up()
+{
+    uint32_t count = pending;
+    pending = 0;
+    scan_cycles(count);
+    pending_limit = segment_length();
+}
 
-    Scan_t scan;
-    if (sa.flags & SA_FLAG_BLANK) {
-        scan.mode = (uint8_t)VM_BLANK;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    } else {
-//    if (!(sa.flags & SA_FLAG_BLANK)) {
-        scan.mode = (uint8_t)video_mode;
-        scan.auxbyte = 0x00;
-        scan.mainbyte = video_byte;
-        scan.flags = mode_flags;
-        scan.shr_bytes = text_color;
-        frame_scan->push(scan);
+void VideoScannerII::snapshot(SnapshotIO &io)
+{
+    sync();
+    io.field(scan_index);
+    io.field(video_byte);
+    io.field(graf);
+    io.field(hires);
+    io.field(mixed);
+    io.field(page2);
+    io.field(sw80col);
+    io.field(altchrset);
+    io.field(dblres);
+    io.field(f_80store);
+    io.field(text_bg);
+    io.field(text_fg);
+    io.field(text_color);
+    io.field(border_color);
+    io.field(shr);
+    io.field(current_scb);
+    io.field(h_counter);
+    io.field(mode_q_head);
+    io.field(mode_q_tail);
+    io.field(mode_q_count);
+    for (mode_change_t &mc : mode_q) {
+        io.field(mc.apply_at);
+        io.field(mc.sw);
+        io.field(mc.value);
     }
-    if (sa.flags & SA_FLAG_VSYNC) {
-        scan.mode = (uint8_t)VM_VSYNC;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
+    if (io.loading()) {
+        mode_q_head &= MODE_Q_SIZE - 1;
+        mode_q_tail &= MODE_Q_SIZE - 1;
+        if (mode_q_count > MODE_Q_SIZE) mode_q_count = 0;
+        pending = 0;
+        pending_limit = 1; // scan_index moved; the next owed cycle recomputes the segment
+        set_video_mode();
     }
-    if (sa.flags & SA_FLAG_HSYNC) {
-        scan.mode = (uint8_t)VM_HSYNC;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
+}
+
+void VideoScannerII::video_sync_handler(void *context)
+{
+    ((VideoScannerII *)context)->sync();
+}
+
+// Flag every physical page a LUT entry can fetch from (main and aux), then hook the
+// MMU so writes there, and floating bus reads, bring the scanner up to date first.
+void VideoScannerII::watch_video_pages()
+{
+    auto mark = [this](uint32_t phys) {
+        if ((phys / GS2_PAGE_SIZE) < WATCH_PAGES) video_watch[phys / GS2_PAGE_SIZE] = 1;
+    };
+    scan_address_t *luts[] = { lores_p1, lores_p2, hires_p1, hires_p2, mixed_p1, mixed_p2, shr_p1 };
+    for (scan_address_t *lut : luts) {
+        if (lut == nullptr) continue;
+        for (uint32_t idx = 0; idx < cycles_per_frame; idx++) {
+            uint32_t addr = lut[idx].addr;
+            mark(addr);
+            mark(addr + 0x10000);
+            if (lut[idx].flags & (SA_FLAG_SHR | SA_FLAG_PALETTE)) {
+                // SHR / palette fetches: interleaved pairs, palettes offset by index * 16.
+                uint32_t span = (lut[idx].flags & SA_FLAG_PALETTE) ? 15 * 16 : 0;
+                for (uint32_t off = 0; off <= span; off += 16) {
+                    mark(0x10000 + addr + off + 1);
+                    mark(0x10000 + addr + off + 0x4000);
+                    mark(0x10000 + addr + off + 0x4001);
+                    mark(0x10000 + addr + off);
+                }
+            }
+        }
     }
-    if (++scan_index == 17030) {
-        scan_index = 0;
+    uint32_t pages = mmu->get_memory_size() / GS2_PAGE_SIZE;
+    mmu->set_video_sync({video_sync_handler, this}, video_watch, pages < WATCH_PAGES ? pages : WATCH_PAGES);
+}
+
+void VideoScannerII::scan_cycles(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        apply_due_mode_changes();
+
+        scan_address_t &sa = video_addresses[scan_index];
+
+        uint16_t address = sa.addr;
+
+        video_byte = ram[address];
+
+        Scan_t scan;
+        if (sa.flags & SA_FLAG_BLANK) {
+            scan.mode = (uint8_t)VM_BLANK;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        } else {
+    //    if (!(sa.flags & SA_FLAG_BLANK)) {
+            scan.mode = (uint8_t)video_mode;
+            scan.auxbyte = 0x00;
+            scan.mainbyte = video_byte;
+            scan.flags = mode_flags;
+            scan.shr_bytes = text_color;
+            frame_scan->push(scan);
+        }
+        if (sa.flags & SA_FLAG_VSYNC) {
+            scan.mode = (uint8_t)VM_VSYNC;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        }
+        if (sa.flags & SA_FLAG_HSYNC) {
+            scan.mode = (uint8_t)VM_HSYNC;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        }
+        if (++scan_index == 17030) {
+            scan_index = 0;
+        }
     }
+    mmu->set_floating_bus(video_byte);
 }
 
 ScanBuffer *VideoScannerII::get_frame_scan()
 {
+    sync();
     return frame_scan;
 }
 
+ScanBuffer *VideoScannerII::exchange_frame_scan(ScanBuffer *empty)
+{
+    sync();
+    ScanBuffer *filled = frame_scan;
+    empty->clear();
+    frame_scan = empty;
+    return filled;
+}
+
+void VideoScannerII::drop_frame_scan()
+{
+    sync();
+    frame_scan->clear();
+}
+
 VideoScannerII::VideoScannerII(MMU_II *mmu)
 {
 
@@ -410,6 +519,7 @@ VideoScannerII::VideoScannerII(MMU_II *mmu)
 }
 
 VideoScannerII::~VideoScannerII() {
+    mmu->set_video_sync({nullptr, nullptr}, nullptr, 0);
     delete frame_scan;
     if (lores_p1 != nullptr) delete[] lores_p1;
     if (lores_p2 != nullptr) delete[] lores_p2;
@@ -10,6 +10,7 @@
 class MMU_II;
 struct display_state_t;
 struct computer_t;
+class SnapshotIO;
 
 constexpr uint16_t SCANNER_LUT_SIZE = 65*262;
 
@@ -214,6 +215,23 @@ protected:
         }
     }
 
+    // Catch-up scanning: the clock only counts owed video cycles (pending); they are
+    // scanned in one batch when pending reaches pending_limit, or earlier when
+    // anything that can observe the scanner asks for sync().
+    static constexpr uint32_t WATCH_PAGES = 0x20000 / GS2_PAGE_SIZE; // main + aux
+    uint32_t pending = 0;
+    uint32_t pending_limit = 1;
+    uint8_t video_watch[WATCH_PAGES] = {0};
+
+    // Run count cycles starting at scan_index; floating bus is updated once at the end.
+    virtual void scan_cycles(uint32_t count);
+    // Cycles from scan_index through the next one that must run on time. Default:
+    // the rest of the scanline.
+    inline virtual uint32_t segment_length() { return 65 - (scan_index % 65); }
+    void catch_up();
+    void watch_video_pages();
+    static void video_sync_handler(void *context);
+
 public:
 //uint32_t  hcount;       // use separate hcount and vcount in order
 //uint32_t  vcount;       // to simplify IIgs scanline interrupts
@@ -222,25 +240,49 @@ public:
     virtual ~VideoScannerII();
 
     // Call this after construction to properly initialize video addresses
-    virtual void initialize() { init_video_addresses(); }
+    virtual void initialize() {
+        init_video_addresses();
+        set_video_mode(); // the constructor ran this before mode_table was filled
+        watch_video_pages();
+    }
     virtual void allocate();
 
     virtual void reset() {
+        sync();
         frame_scan->clear();
         scan_index = 0;
+        pending_limit = 1;
         clear_mode_change_queue();
     };
 
     virtual void video_cycle();
-    uint32_t get_scan_cycle() { return scan_index; }
+
+    // Called by the clock once per video cycle instead of video_cycle().
+    inline void owe_cycle() {
+        if (++pending >= pending_limit) {
+            catch_up();
+        }
+    }
+    // Bring the scanner up to the clock before its state is observed or changed.
+    inline void sync() {
+        if (pending) {
+            catch_up();
+        }
+    }
+
+    /** Beam position, softswitches and queued mode changes; settles owed cycles first. */
+    void snapshot(SnapshotIO &io);
+
+    uint32_t get_scan_cycle() { sync(); return scan_index; }
     virtual void init_video_addresses();
 
-    inline bool is_hbl()     { return (scan_index % 65) < 25;   }
-    inline bool is_vbl()     { return scan_index >= (192*65); }
-    inline uint16_t get_vcount() { return scan_index / 65; }
-    inline uint16_t get_hcount() { return scan_index % 65; }
+    inline bool is_hbl()     { sync(); return (scan_index % 65) < 25;   }
+    inline bool is_vbl()     { sync(); return scan_index >= (192*65); }
+    inline uint16_t get_vcount() { sync(); return scan_index / 65; }
+    inline uint16_t get_hcount() { sync(); return scan_index % 65; }
 
     inline uint16_t get_hcounter() {
+        sync();
         uint16_t hcounter;
         uint16_t horz = (scan_index % 65);
         if (horz == 0) hcounter = 0;
@@ -248,6 +290,7 @@ public:
         return hcounter;
     }
     inline uint16_t get_vcounter() { 
+        sync();
         uint16_t vcounter;
         uint16_t vert = scan_index / 65;
         if (vert < 192) vcounter = 0x100 + vert;
@@ -268,19 +311,19 @@ public:
     inline void set_80store(bool fl) { queue_mode_change(vs_mode_switch_t::STORE80, fl ? 1 : 0); }
     inline void set_shr() { queue_mode_change(vs_mode_switch_t::SHR, 1); }
 
-    inline bool is_page_1() { return !page2; }
-    inline bool is_page_2() { return  page2; }
-    inline bool is_full()   { return !mixed; }
-    inline bool is_mixed()  { return  mixed; }
-    inline bool is_lores()  { return !hires; }
-    inline bool is_hires()  { return  hires; }
-    inline bool is_text()   { return !graf;  }
-    inline bool is_graf()   { return  graf;  }
+    inline bool is_page_1() { sync(); return !page2; }
+    inline bool is_page_2() { sync(); return  page2; }
+    inline bool is_full()   { sync(); return !mixed; }
+    inline bool is_mixed()  { sync(); return  mixed; }
+    inline bool is_lores()  { sync(); return !hires; }
+    inline bool is_hires()  { sync(); return  hires; }
+    inline bool is_text()   { sync(); return !graf;  }
+    inline bool is_graf()   { sync(); return  graf;  }
 
-    inline bool is_80col()        { return sw80col;   }
-    inline bool is_altchrset()    { return altchrset; }
-    inline bool is_dblres()       { return dblres; }
-    inline bool is_80store()      { return f_80store; }
+    inline bool is_80col()        { sync(); return sw80col;   }
+    inline bool is_altchrset()    { sync(); return altchrset; }
+    inline bool is_dblres()       { sync(); return dblres; }
+    inline bool is_80store()      { sync(); return f_80store; }
 
     inline void set_80col()       { queue_mode_change(vs_mode_switch_t::COL80, 1); }
     inline void set_altchrset()   { queue_mode_change(vs_mode_switch_t::ALTCHAR, 1); }
@@ -294,13 +337,17 @@ public:
     inline void reset_dblres()    { queue_mode_change(vs_mode_switch_t::DBLRES, 0); }
     inline void reset_shr()       { queue_mode_change(vs_mode_switch_t::SHR, 0); }
 
-    inline void set_text_bg(uint16_t bg) { text_bg = bg; text_color = text_fg << 4 | text_bg; }
-    inline void set_text_fg(uint16_t fg) { text_fg = fg; text_color = text_fg << 4 | text_bg; }
-    inline void set_border_color(uint16_t color) { border_color = color; }
+    inline void set_text_bg(uint16_t bg) { sync(); text_bg = bg; text_color = text_fg << 4 | text_bg; }
+    inline void set_text_fg(uint16_t fg) { sync(); text_fg = fg; text_color = text_fg << 4 | text_bg; }
+    inline void set_border_color(uint16_t color) { sync(); border_color = color; }
 
     inline virtual void set_irq_handler(device_irq_handler_s irq_handler) { this->irq_handler = irq_handler; }
 
     ScanBuffer *get_frame_scan();
+    /** Install an empty buffer for the samples that follow and return the filled one. */
+    ScanBuffer *exchange_frame_scan(ScanBuffer *empty);
+    /** Discard the samples of a frame that will not be shown (Ludicrous frame skip). */
+    void drop_frame_scan();
 };
 
 void init_mb_video_scanner(computer_t *computer, SlotType_t slot);
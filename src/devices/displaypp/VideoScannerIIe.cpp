@@ -85,46 +85,48 @@ void VideoScannerIIe::init_video_addresses()
     }
 }
 
-void VideoScannerIIe::video_cycle()
+void VideoScannerIIe::scan_cycles(uint32_t count)
 {
-    apply_due_mode_changes();
-
-    scan_address_t &sa = video_addresses[scan_index];
-    uint16_t address = sa.addr;
-
-    video_byte = ram[address];
-    mmu->set_floating_bus(video_byte);
-
-    Scan_t scan;
-    if (sa.flags & SA_FLAG_BLANK) {
-        scan.mode = (uint8_t)VM_BLANK;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    } else {
-    //if (!(sa.flags & SA_FLAG_BLANK)) {
-        scan.mode = (uint8_t)video_mode;
-        scan.auxbyte = ram[address + 0x10000];
-        scan.mainbyte = video_byte;
-        scan.flags = mode_flags;
-        scan.shr_bytes = text_color;
-        frame_scan->push(scan);
-    }
-    if (sa.flags & SA_FLAG_VSYNC) {
-        scan.mode = (uint8_t)VM_VSYNC;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    }
-    if (sa.flags & SA_FLAG_HSYNC) {
-        scan.mode = (uint8_t)VM_HSYNC;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    }
-    if (++scan_index == 17030) {
-        scan_index = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        apply_due_mode_changes();
+
+        scan_address_t &sa = video_addresses[scan_index];
+        uint16_t address = sa.addr;
+
+        video_byte = ram[address];
+
+        Scan_t scan;
+        if (sa.flags & SA_FLAG_BLANK) {
+            scan.mode = (uint8_t)VM_BLANK;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        } else {
+        //if (!(sa.flags & SA_FLAG_BLANK)) {
+            scan.mode = (uint8_t)video_mode;
+            scan.auxbyte = ram[address + 0x10000];
+            scan.mainbyte = video_byte;
+            scan.flags = mode_flags;
+            scan.shr_bytes = text_color;
+            frame_scan->push(scan);
+        }
+        if (sa.flags & SA_FLAG_VSYNC) {
+            scan.mode = (uint8_t)VM_VSYNC;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        }
+        if (sa.flags & SA_FLAG_HSYNC) {
+            scan.mode = (uint8_t)VM_HSYNC;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        }
+        if (++scan_index == 17030) {
+            scan_index = 0;
+        }
     }
+    mmu->set_floating_bus(video_byte);
 }
 
 
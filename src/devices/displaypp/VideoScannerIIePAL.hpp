@@ -18,11 +18,11 @@ protected:
     inline uint8_t mode_change_delay(vs_mode_switch_t sw) const override {
         return delay_lut_iiepal[static_cast<uint8_t>(sw)];
     }
+    void scan_cycles(uint32_t count) override;
 
 public:
     VideoScannerIIePAL(MMU_II *mmu);
 
-    virtual void video_cycle() override;
     virtual void init_video_addresses() override;
 };
 
@@ -154,115 +154,117 @@ void VideoScannerIIgs::dump_cycles()
     fclose(f);
 }
 
-void VideoScannerIIgs::video_cycle()
+void VideoScannerIIgs::scan_cycles(uint32_t count)
 {
-    apply_due_mode_changes();
+    for (uint32_t i = 0; i < count; i++) {
+        apply_due_mode_changes();
 
-    scan_address_t &sa = video_addresses[scan_index];
-    uint16_t address = sa.addr;
+        scan_address_t &sa = video_addresses[scan_index];
+        uint16_t address = sa.addr;
 
-    video_byte = ram[address];
-    mmu->set_floating_bus(video_byte);
+        video_byte = ram[address];
 
-    Scan_t scan;
-    /* if (sa.flags & SA_FLAG_BORDER) {
-        scan.mode = (uint8_t)VM_BORDER_COLOR;
-        scan.mainbyte = border_color;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    } */
-    /* if (sa.flags & SA_FLAG_SHR) {
-        scan.mode = static_cast<uint8_t>(video_mode); // SHR_PIXEL, SHR_PALETTE, SHR_MODE
-        scan.shr_bytes = *((uint32_t *)(ram + 0x1'0000 + address));
-        frame_scan->push(scan);
-    }  else */ if (sa.flags & SA_FLAG_SCB) {
-        scan.mode = (uint8_t)VM_SHR_MODE;
-        // LUT addr is already physical (interleaved); single byte.
-        scan.mainbyte = ram[address + 0x10000];
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-        palette_index = (scan.mainbyte & 0x0F); // store palette index to control next palette read
-        current_scb = scan.mainbyte;
-    } else if (sa.flags & SA_FLAG_PALETTE) {
-        scan.mode = (uint8_t)VM_SHR_PALETTE;
-        // LUT addr = phys of linear $9E00+(hc-7)*4; +32 linear bytes ⇒ +16 phys in $2000 half.
-        uint16_t phys = address + (palette_index * 16);
-        uint8_t *aux = ram + 0x10000;
-        scan.shr_bytes =
-            aux[phys] |
-            (uint32_t(aux[phys + 0x4000]) << 8) |
-            (uint32_t(aux[phys + 1]) << 16) |
-            (uint32_t(aux[phys + 0x4001]) << 24);
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    } /* else */ 
-    if (sa.flags & SA_FLAG_BLANK) {
-        scan.mode = (uint8_t)VM_BLANK;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    } else if (sa.flags & SA_FLAG_BORDER) {
-        scan.mode = (uint8_t)VM_BORDER_COLOR;
-        scan.mainbyte = border_color;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    } else if (sa.flags & SA_FLAG_SHR) {
-        scan.mode = static_cast<uint8_t>(video_mode); // SHR_PIXEL, SHR_PALETTE, SHR_MODE
-        // LUT addr = physical of linear[0]; fetch interleaved linear L0..L3.
-        uint8_t *aux = ram + 0x10000;
-        scan.shr_bytes =
-            aux[address] |
-            (uint32_t(aux[address + 0x4000]) << 8) |
-            (uint32_t(aux[address + 1]) << 16) |
-            (uint32_t(aux[address + 0x4001]) << 24);
-        frame_scan->push(scan);
-    }  else {
-        scan.mode = static_cast<uint8_t>(video_mode); 
-        scan.auxbyte = ram[address + 0x10000];
-        scan.mainbyte = video_byte;
-        scan.flags = mode_flags;
-        scan.shr_bytes = text_color;
-        frame_scan->push(scan);
-    }
+        Scan_t scan;
+        /* if (sa.flags & SA_FLAG_BORDER) {
+            scan.mode = (uint8_t)VM_BORDER_COLOR;
+            scan.mainbyte = border_color;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        } */
+        /* if (sa.flags & SA_FLAG_SHR) {
+            scan.mode = static_cast<uint8_t>(video_mode); // SHR_PIXEL, SHR_PALETTE, SHR_MODE
+            scan.shr_bytes = *((uint32_t *)(ram + 0x1'0000 + address));
+            frame_scan->push(scan);
+        }  else */ if (sa.flags & SA_FLAG_SCB) {
+            scan.mode = (uint8_t)VM_SHR_MODE;
+            // LUT addr is already physical (interleaved); single byte.
+            scan.mainbyte = ram[address + 0x10000];
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+            palette_index = (scan.mainbyte & 0x0F); // store palette index to control next palette read
+            current_scb = scan.mainbyte;
+        } else if (sa.flags & SA_FLAG_PALETTE) {
+            scan.mode = (uint8_t)VM_SHR_PALETTE;
+            // LUT addr = phys of linear $9E00+(hc-7)*4; +32 linear bytes ⇒ +16 phys in $2000 half.
+            uint16_t phys = address + (palette_index * 16);
+            uint8_t *aux = ram + 0x10000;
+            scan.shr_bytes =
+                aux[phys] |
+                (uint32_t(aux[phys + 0x4000]) << 8) |
+                (uint32_t(aux[phys + 1]) << 16) |
+                (uint32_t(aux[phys + 0x4001]) << 24);
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        } /* else */ 
+        if (sa.flags & SA_FLAG_BLANK) {
+            scan.mode = (uint8_t)VM_BLANK;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        } else if (sa.flags & SA_FLAG_BORDER) {
+            scan.mode = (uint8_t)VM_BORDER_COLOR;
+            scan.mainbyte = border_color;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        } else if (sa.flags & SA_FLAG_SHR) {
+            scan.mode = static_cast<uint8_t>(video_mode); // SHR_PIXEL, SHR_PALETTE, SHR_MODE
+            // LUT addr = physical of linear[0]; fetch interleaved linear L0..L3.
+            uint8_t *aux = ram + 0x10000;
+            scan.shr_bytes =
+                aux[address] |
+                (uint32_t(aux[address + 0x4000]) << 8) |
+                (uint32_t(aux[address + 1]) << 16) |
+                (uint32_t(aux[address + 0x4001]) << 24);
+            frame_scan->push(scan);
+        }  else {
+            scan.mode = static_cast<uint8_t>(video_mode); 
+            scan.auxbyte = ram[address + 0x10000];
+            scan.mainbyte = video_byte;
+            scan.flags = mode_flags;
+            scan.shr_bytes = text_color;
+            frame_scan->push(scan);
+        }
 
-    if (sa.flags & SA_FLAG_VSYNC) {
-        scan.mode = (uint8_t)VM_VSYNC;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    }
-    if (sa.flags & SA_FLAG_HSYNC) {
-        scan.mode = (uint8_t)VM_HSYNC;
-        scan.mainbyte = 0;
-        scan.flags = mode_flags;
-        frame_scan->push(scan);
-    }
+        if (sa.flags & SA_FLAG_VSYNC) {
+            scan.mode = (uint8_t)VM_VSYNC;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        }
+        if (sa.flags & SA_FLAG_HSYNC) {
+            scan.mode = (uint8_t)VM_HSYNC;
+            scan.mainbyte = 0;
+            scan.flags = mode_flags;
+            frame_scan->push(scan);
+        }
 
-    // if in shr and this is cycle 64 of a scanline, and the SCB has bit 6 (interrupt) enabled, then assert scanline interrupt.
-    if (irq_handler.handler) {
-        // old code that fires at end of scanline 
-        /* if (shr && (h_counter == 64) && (current_scb & 0x40)) {
-            irq_handler.handler(irq_handler.context, VS_EVENT_SCB_INTERRUPT);
-        } */
-        // fire when the SCB is read for this scanline.
-        if (shr && (sa.flags & SA_FLAG_SCB) && (current_scb & 0x40)) {
-            irq_handler.handler(irq_handler.context, VS_EVENT_SCB_INTERRUPT);
+        // if in shr and this is cycle 64 of a scanline, and the SCB has bit 6 (interrupt) enabled, then assert scanline interrupt.
+        if (irq_handler.handler) {
+            // old code that fires at end of scanline 
+            /* if (shr && (h_counter == 64) && (current_scb & 0x40)) {
+                irq_handler.handler(irq_handler.context, VS_EVENT_SCB_INTERRUPT);
+            } */
+            // fire when the SCB is read for this scanline.
+            if (shr && (sa.flags & SA_FLAG_SCB) && (current_scb & 0x40)) {
+                irq_handler.handler(irq_handler.context, VS_EVENT_SCB_INTERRUPT);
+            }
+            // VBL IRQ triggers on scanline 192, always, regardless of video mode.
+            if (scan_index == (192*65)) {
+                irq_handler.handler(irq_handler.context, VS_EVENT_VBL);
+            }
+            // quarter-second IRQ triggers on scanline 256.
+            if (scan_index == (256*65)) {
+                irq_handler.handler(irq_handler.context, VS_EVENT_QTR);
+            }
         }
-        // VBL IRQ triggers on scanline 192, always, regardless of video mode.
-        if (scan_index == (192*65)) {
-            irq_handler.handler(irq_handler.context, VS_EVENT_VBL);
+        if (++scan_index == 17030) {
+            scan_index = 0;
         }
-        // quarter-second IRQ triggers on scanline 256.
-        if (scan_index == (256*65)) {
-            irq_handler.handler(irq_handler.context, VS_EVENT_QTR);
+        if (++h_counter == 65) {
+            h_counter = 0;
         }
     }
-    if (++scan_index == 17030) {
-        scan_index = 0;
-    }
-    if (++h_counter == 65) {
-        h_counter = 0;
-    }
+    mmu->set_floating_bus(video_byte);
 }
 
 
@@ -15,10 +15,19 @@ protected:
         return delay_lut_iigs[static_cast<uint8_t>(sw)];
     }
     uint8_t palette_index = 0;
+    void scan_cycles(uint32_t count) override;
+    // Segments also end on the SCB fetch (scanline IRQ) and on the VBL / QTR cycles.
+    inline uint32_t segment_length() override {
+        uint32_t h = scan_index % 65;
+        uint32_t v = scan_index / 65;
+        if (h == 0 && (v == 192 || v == 256)) return 1;
+        if (h <= 6 && v < 200) return 7 - h;
+        return 65 - h;
+    }
+
 public:
     VideoScannerIIgs(MMU_II *mmu);
 
-    virtual void video_cycle() override;
     virtual void init_video_addresses() override;
     virtual void dump_cycles() ;
 };
@@ -13,5 +13,6 @@ using FrameBorder = Frame<RGBA_t, 263, 53, SDLTextureStorage>;
 // shr texture
 using Frame640 = Frame<RGBA_t, 200, 640, SDLTextureStorage>;
 
-// new omnibus buffer
-using FrameVSG = Frame<RGBA_t, 263, 910, SDLTextureStorage>;
+// new omnibus buffer. Plain memory, so it can be generated off the render thread;
+// the display uploads it to its texture.
+using FrameVSG = Frame<RGBA_t, 263, 910>;
@@ -131,6 +131,9 @@ public:
         hloc += count;
     }
 
+    /** Current position in the line, for writers / readers that work on runs of pixels. */
+    inline bs_t *cursor() noexcept { return row + hloc; }
+
     inline bs_t pull() noexcept { 
         //return stream[scanline][hloc++];
         return row[hloc++];
@@ -270,13 +270,7 @@ class AppleII_Composite {
     AppleII_Context &ctx_;
 
     static void ensure_ntsc() {
-        static bool ready = false;
-        if (!ready) {
-            setupConfig();
-            generate_filters(NUM_TAPS);
-            init_hgr_LUT();
-            ready = true;
-        }
+        ntsc_init_shared();
     }
 
     void emit_mono(Frame560RGBA *out, const uint8_t *dots, uint8_t phase_offset, RGBA_t on) {
@@ -1,24 +1,171 @@
 #pragma once
 
+#include <cstring>
+
 #include "Render.hpp"
 #include "display/ntsc.hpp"
 #include "display/filters.hpp"
 
+// GCC / Clang on x86 build the AVX2 loop whatever -m flags the TU has and pick it at
+// run time; there is no baseline AVX2 build to rely on.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NTSC560_AVX2_DISPATCH 1
+#endif
+#if defined(__SSE2__) || defined(NTSC560_AVX2_DISPATCH)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 /** Generate a 'frame' (i.e., a group of 8 scanlines) of video output data using the lookup table.  */
 
 extern RGBA_t g_hgr_LUT[4][(1 << ((NUM_TAPS * 2) + 1))];
 
 class NTSC560 : public Render {
 
+    static constexpr uint32_t LUT_BITS = (NUM_TAPS * 2) + 1;
+    static constexpr uint32_t LUT_MASK = (1u << LUT_BITS) - 1;
+    static constexpr uint32_t MAX_WIDTH = Frame560::max_width();
+    // NUM_TAPS leading zero bits, the line, then room for the window to run off the end.
+    static constexpr uint32_t PACKED_WORDS = (NUM_TAPS + MAX_WIDTH + 63) / 64 + 1;
+
+    /**
+     * Pack a line of dots (any non-zero byte is on) into little-endian bits, NUM_TAPS
+     * bits in. Bits [x, x + LUT_BITS) are then the LUT index for pixel x - the same
+     * window the reference loop builds one shift at a time.
+     */
+    static inline void pack_line(const uint8_t *src, uint32_t width, uint64_t *packed) {
+        for (uint32_t i = 0; i < PACKED_WORDS; i++) packed[i] = 0;
+        uint32_t x = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 16 <= width; x += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(src + x));
+            uint64_t m = (~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))) & 0xFFFF;
+            packed[x >> 6] |= m << (x & 63);
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        const uint8x16_t w = vld1q_u8(weights);
+        for (; x + 16 <= width; x += 16) {
+            uint8x16_t v = vandq_u8(vtstq_u8(vld1q_u8(src + x), vld1q_u8(src + x)), w);
+            uint64_t m = (uint64_t)vaddv_u8(vget_low_u8(v)) | ((uint64_t)vaddv_u8(vget_high_u8(v)) << 8);
+            packed[x >> 6] |= m << (x & 63);
+        }
+#endif
+        for (; x < width; x++) {
+            if (src[x]) packed[x >> 6] |= 1ULL << (x & 63);
+        }
+        for (uint32_t i = PACKED_WORDS - 1; i > 0; i--) {
+            packed[i] = (packed[i] << NUM_TAPS) | (packed[i - 1] >> (64 - NUM_TAPS));
+        }
+        packed[0] <<= NUM_TAPS;
+    }
+
+    /** 64 bits of the packed line starting at bit x. */
+    static inline uint64_t window_at(const uint64_t *packed, uint32_t x) {
+        const uint32_t s = x & 63;
+        return (packed[x >> 6] >> s) | ((packed[(x >> 6) + 1] << 1) << (63 - s));
+    }
+
+#if defined(NTSC560_AVX2_DISPATCH)
+    static bool cpu_has_avx2() {
+        __builtin_cpu_init();   // may run from a static initializer
+        return __builtin_cpu_supports("avx2");
+    }
+
+    /** The leading multiple of 8 pixels of a color line; returns how many it did. Only call with use_avx2. */
+    __attribute__((target("avx2")))
+    static uint32_t render_color_avx2(const uint64_t *packed, uint32_t width, uint32_t phase_offset, RGBA_t *out) {
+        uint32_t x = 0;
+        // 8 pixels a step; their phases repeat every 4 so the gather offsets are fixed.
+        const __m256i shifts = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i mask = _mm256_set1_epi32(LUT_MASK);
+        const __m256i phase_base = _mm256_setr_epi32(
+            ((phase_offset + 0) & 3) << LUT_BITS, ((phase_offset + 1) & 3) << LUT_BITS,
+            ((phase_offset + 2) & 3) << LUT_BITS, ((phase_offset + 3) & 3) << LUT_BITS,
+            ((phase_offset + 0) & 3) << LUT_BITS, ((phase_offset + 1) & 3) << LUT_BITS,
+            ((phase_offset + 2) & 3) << LUT_BITS, ((phase_offset + 3) & 3) << LUT_BITS);
+        const int *lut = (const int *)&g_hgr_LUT[0][0];
+        for (; x + 8 <= width; x += 8) {
+            const uint32_t w = (uint32_t)window_at(packed, x);
+            __m256i idx = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)w), shifts), mask);
+            idx = _mm256_add_epi32(idx, phase_base);
+            _mm256_storeu_si256((__m256i *)(out + x), _mm256_i32gather_epi32(lut, idx, 4));
+        }
+        return x;
+    }
+#endif
+
+    /** One color line: each pixel is g_hgr_LUT[phase][window]. */
+    static inline void render_color_line(const uint64_t *packed, uint32_t width, uint32_t phase_offset, RGBA_t *out) {
+        uint32_t x = 0;
+#if defined(NTSC560_AVX2_DISPATCH)
+        if (use_avx2) x = render_color_avx2(packed, width, phase_offset, out);
+#endif
+        // No gather elsewhere: 4 pixels a step, one LUT row per phase, no modulo.
+        const RGBA_t *lut0 = g_hgr_LUT[(phase_offset + 0) & 3];
+        const RGBA_t *lut1 = g_hgr_LUT[(phase_offset + 1) & 3];
+        const RGBA_t *lut2 = g_hgr_LUT[(phase_offset + 2) & 3];
+        const RGBA_t *lut3 = g_hgr_LUT[(phase_offset + 3) & 3];
+        for (; x + 4 <= width; x += 4) {
+            const uint64_t w = window_at(packed, x);
+            out[x + 0] = lut0[(w >> 0) & LUT_MASK];
+            out[x + 1] = lut1[(w >> 1) & LUT_MASK];
+            out[x + 2] = lut2[(w >> 2) & LUT_MASK];
+            out[x + 3] = lut3[(w >> 3) & LUT_MASK];
+        }
+        for (; x < width; x++) {
+            out[x] = g_hgr_LUT[(phase_offset + x) & 3][window_at(packed, x) & LUT_MASK];
+        }
+    }
+
 public:
+#if defined(NTSC560_AVX2_DISPATCH)
+    /** Run the AVX2 gather loop. Set from the host CPU; ntsctest clears it to check the other path. */
+    static inline bool use_avx2 = cpu_has_avx2();
+#endif
+
     NTSC560(bool shift_enabled = true) : Render(shift_enabled) {
-        setupConfig();
-        generate_filters(NUM_TAPS);
-        init_hgr_LUT();
+        ntsc_init_shared();
     };
     ~NTSC560() {};
 
     virtual void render(Frame560 *frame_byte, FrameVSG *frame_rgba) override {
+        const uint32_t framewidth = frame_byte->width();
+        uint64_t packed[PACKED_WORDS];
+
+        for (uint16_t y = 0; y < 192; y++)
+        {
+            color_mode_t color_mode = frame_byte->get_color_mode(y); // get color mode for this frame (based on scanline 0)
+            uint16_t phase_offset = color_mode.phase_offset;
+            frame_byte->set_line(y);
+            frame_rgba->set_line(y+35);
+            frame_rgba->advance(168-7*shift_enabled);
+
+            if (phase_offset == 0 && shift_enabled) {
+                frame_rgba->push_n(black, 7);
+            }
+            const uint8_t *src = frame_byte->cursor();
+            RGBA_t *out = frame_rgba->cursor();
+            if (color_mode.colorburst == 0) {
+                for (uint32_t x = 0; x < framewidth; x++) {
+                    out[x] = src[x] ? mono_color : black;
+                }
+            } else {
+                pack_line(src, framewidth, packed);
+                render_color_line(packed, framewidth, phase_offset, out);
+            }
+            frame_rgba->advance(framewidth);
+            if (phase_offset == 1 && shift_enabled) {
+                frame_rgba->push_n(black, 7);
+            }
+        }
+    }
+
+    /** The original one-pixel-at-a-time LUT walk, kept as the reference for ntsctest. */
+    void render_reference(Frame560 *frame_byte, FrameVSG *frame_rgba) {
         // Process each scanline
         uint16_t framewidth = frame_byte->width();
 
@@ -43,9 +190,9 @@ public:
             } else {
                 // do color burst
 
-                // for x = 0, we need bits preloaded with the first NUM_TAPS+1 bits in 
+                // for x = 0, we need bits preloaded with the first NUM_TAPS+1 bits in
                 // 16-8, and 0's in 0-7.
-                // if num_taps = 6, 
+                // if num_taps = 6,
                 // 11111 1X000000
                 //bool transparent_start = frame_byte->peek() & 0b10 ? 1 : 0;
                 for (uint16_t i = 0; i < NUM_TAPS; i++)
@@ -54,7 +201,7 @@ public:
                     if (frame_byte->pull())
                         bits = bits | (1 << ((NUM_TAPS*2)));
                 }
-                
+
                 // Process the scanline
                 for (uint16_t x = 0; x < framewidth; x++)
                 {
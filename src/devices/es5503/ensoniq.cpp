@@ -4,9 +4,17 @@
 #include <cstring>
 #include <cassert>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "devices/speaker/speaker.hpp"
 #include "util/DebugHandlerIDs.hpp"
 #include "device_irq_id.hpp"
+#include "util/Snapshot.hpp"
 
 // Useful constants from MAME implementation
 static constexpr uint16_t wavesizes[8] = { 256, 512, 1024, 2048, 4096, 8192, 16384, 32768 };
@@ -79,6 +87,30 @@ void ES5503::reset() {
     update_sdl_stream_rate();
 }
 
+void ES5503::snapshot(SnapshotIO &io) {
+    io.field(m_oscsenabled);
+    io.field(m_channel_strobe);
+    io.field(m_rege0);
+    io.field(m_rege1);
+    for (auto &osc : m_oscillators) {
+        io.field(osc.freq);
+        io.field(osc.wtsize);
+        io.field(osc.control);
+        io.field(osc.vol);
+        io.field(osc.data);
+        io.field(osc.wavetblpointer);
+        io.field(osc.wavetblsize);
+        io.field(osc.resolution);
+        io.field(osc.accumulator);
+        io.field(osc.irqpend);
+    }
+    if (io.loading()) {
+        if (m_oscsenabled < 1 || m_oscsenabled > 32) m_oscsenabled = 1;
+        update_irq_status();
+        update_sdl_stream_rate();
+    }
+}
+
 uint8_t ES5503::read_wave_byte(uint32_t address) {
     if (m_wave_memory) {
         // Mask to 64KB - addresses wrap around in Apple IIgs hardware
@@ -148,6 +180,134 @@ void ES5503::halt_osc(int onum, int type, uint32_t *accumulator, int resshift, u
     }
 }
 
+/*
+ * Render one oscillator into its channel of the mix buffer (every m_output_channels-th
+ * slot from mixp). Most samples neither hit a zero byte nor reach the end of the table,
+ * so those runs are found up front - the wrap point from the accumulator, the next zero
+ * byte with memchr over the bytes the run will read - and mixed in a tight loop. The
+ * sample that stops a run takes the step-by-step path below, which is the MAME loop as
+ * it always was.
+ */
+void ES5503::render_osc(int onum, int32_t *mixp, int num_samples) {
+    Oscillator *pOsc = &m_oscillators[onum];
+    const int stride = m_output_channels;
+    const uint32_t wtptr = pOsc->wavetblpointer & wavemasks[pOsc->wavetblsize];
+    uint32_t acc = pOsc->accumulator;
+    const uint16_t wtsize = pOsc->wtsize - 1;
+    uint8_t ctrl = pOsc->control;
+    const uint16_t freq = pOsc->freq;
+    const int16_t vol = pOsc->vol;
+    int8_t data = -128;
+    const int resshift = resshifts[pOsc->resolution] - pOsc->wavetblsize;
+    const uint32_t sizemask = accmasks[pOsc->wavetblsize];
+    const int mode = (pOsc->control >> 1) & 3;
+
+    // The odd oscillator of a sync/AM pair modulates the next one up instead of playing.
+    // The highest enabled oscillator is mixed three times (volume glitch).
+    const bool modulates = (mode == MODE_SYNCAM) && (onum & 1);
+    const int32_t gain = modulates ? 0 : vol * ((onum == m_oscsenabled - 1) ? 3 : 1);
+    Oscillator *pModulated = (modulates && onum < 31) ? &m_oscillators[onum + 1] : nullptr;
+
+    // Runs need table positions that index wave memory directly (ramptr == altram).
+    const bool spans = (uint32_t)wtsize <= sizemask + 1;
+    const uint32_t wrap_acc = (uint32_t)wtsize << resshift;  // first accumulator value that wraps
+
+    // Samples from here whose table position is below 'limit'.
+    auto samples_below = [&](uint32_t limit) -> uint64_t {
+        const uint64_t limit_acc = (uint64_t)limit << resshift;
+        if (acc >= limit_acc) return 0;
+        if (freq == 0) return UINT64_MAX;
+        return (limit_acc - acc + freq - 1) / freq;
+    };
+
+    if (num_samples > 0) {
+        // Set channel strobe for banking
+        m_channel_strobe = (ctrl >> 4) & 0xf;
+    }
+
+    int snum = 0;
+    while (snum < num_samples) {
+        uint64_t run = 0;
+        if (spans && acc < wrap_acc) {
+            run = std::min<uint64_t>(num_samples - snum, samples_below(wtsize));
+            const uint32_t first = acc >> resshift;
+            const uint32_t last = (uint32_t)((acc + (run - 1) * freq) >> resshift);
+            const uint32_t base = (wtptr + first) & 0xFFFF;
+            // Bytes the run reads, up to the end of wave memory; stop short of the next zero.
+            const uint32_t len = std::min<uint32_t>(last - first + 1, 0x10000 - base);
+            const void *zero = std::memchr(m_wave_memory + base, 0, len);
+            const uint32_t stop = zero ? (uint32_t)((const uint8_t *)zero - (m_wave_memory + base)) : len;
+            if (zero || len < last - first + 1) {
+                run = std::min(run, samples_below(first + stop));
+            }
+            if (run > 0) {
+                const uint8_t *wave = m_wave_memory + base;
+                const int n = (int)run;
+                if (gain) {
+                    for (int i = 0; i < n; i++) {
+                        data = (int8_t)(wave[(acc >> resshift) - first] ^ 0x80);
+                        *mixp += data * gain;
+                        mixp += stride;
+                        acc += freq;
+                    }
+                } else {
+                    // Nothing to mix: only the last byte matters.
+                    const uint32_t last_acc = acc + (uint32_t)(n - 1) * freq;
+                    data = (int8_t)(wave[(last_acc >> resshift) - first] ^ 0x80);
+                    mixp += (size_t)n * stride;
+                    acc = last_acc + freq;
+                }
+                if (pModulated && !(pModulated->control & 1)) {
+                    pModulated->vol = data ^ 0x80;
+                }
+                snum += n;
+                continue;
+            }
+        }
+
+        uint32_t altram = acc >> resshift;
+        uint32_t ramptr = altram & sizemask;
+
+        acc += freq;
+
+        const uint8_t byte = read_wave_byte(ramptr + wtptr);
+        data = (int8_t)(byte ^ 0x80);
+
+        if (byte == 0x00) {
+            halt_osc(onum, 1, &acc, resshift, pOsc->control);
+            // Update ctrl from pOsc->control since halt_osc may have modified it
+            ctrl = pOsc->control;
+        } else {
+            if (modulates) {
+                if (pModulated && !(pModulated->control & 1)) {
+                    pModulated->vol = data ^ 0x80;
+                }
+            } else {
+                *mixp += data * gain;
+            }
+            mixp += stride;
+
+            // MAME: wrap/halt when pre-increment position reaches end
+            // (wtsize here is already pOsc->wtsize - 1).
+            if (altram >= wtsize) {
+                halt_osc(onum, 0, &acc, resshift, pOsc->control);
+                ctrl = pOsc->control;
+            }
+        }
+        snum++;
+
+        // If oscillator halted, no more samples to generate
+        if (pOsc->control & 1) {
+            ctrl = pOsc->control;
+            break;
+        }
+    }
+
+    pOsc->control = ctrl;
+    pOsc->accumulator = acc;
+    pOsc->data = data ^ 0x80;
+}
+
 void ES5503::generate_samples(int16_t *buffer, int num_samples) {
     if (!m_wave_memory) {
         // No wave memory, output silence
@@ -158,101 +318,55 @@ void ES5503::generate_samples(int16_t *buffer, int num_samples) {
     // Clear mix buffer
     std::fill_n(&m_mix_buffer[0], num_samples * m_output_channels, 0);
 
-    // Generate samples for each channel
+    // Each oscillator is rendered once, into its channel. They still run channel by
+    // channel, in oscillator order within a channel: one can start (swap) or modulate
+    // (AM) another, and that order decides whether it takes effect this buffer.
+    // Channel select is control[7:4] (CA0–CA3). With 2 host outputs we decode CA0
+    // only. Apple TN #19 stereo cards: odd → left, even → right (interleaved [L,R]),
+    // so flip CA0 when mapping to the mix index.
+    int assigned[32];
+    for (int osc = 0; osc < m_oscsenabled; osc++) {
+        assigned[osc] = (m_oscillators[osc].control >> 4) & (m_output_channels - 1);
+        if (m_output_channels == 2) {
+            assigned[osc] ^= 1;
+        }
+    }
     for (int chan = 0; chan < m_output_channels; chan++) {
         for (int osc = 0; osc < m_oscsenabled; osc++) {
-            Oscillator *pOsc = &m_oscillators[osc];
-
-            // Channel select is control[7:4] (CA0–CA3). With 2 host outputs we
-            // decode CA0 only. Apple TN #19 stereo cards: odd → left, even → right
-            // (interleaved [L,R]), so flip CA0 when mapping to the mix index.
-            int assigned = (pOsc->control >> 4) & (m_output_channels - 1);
-            if (m_output_channels == 2) {
-                assigned ^= 1;
-            }
-            if (!(pOsc->control & 1) && assigned == chan) {
-                uint32_t wtptr = pOsc->wavetblpointer & wavemasks[pOsc->wavetblsize];
-                uint32_t acc = pOsc->accumulator;
-                const uint16_t wtsize = pOsc->wtsize - 1;
-                uint8_t ctrl = pOsc->control;
-                const uint16_t freq = pOsc->freq;
-                int16_t vol = pOsc->vol;
-                int8_t data = -128;
-                const int resshift = resshifts[pOsc->resolution] - pOsc->wavetblsize;
-                const uint32_t sizemask = accmasks[pOsc->wavetblsize];
-                const int mode = (pOsc->control >> 1) & 3;
-                int32_t *mixp = &m_mix_buffer[0] + chan;
-
-                for (int snum = 0; snum < num_samples; snum++) {
-                    uint32_t altram = acc >> resshift;
-                    uint32_t ramptr = altram & sizemask;
-
-                    acc += freq;
-
-                    // Set channel strobe for banking
-                    m_channel_strobe = (ctrl >> 4) & 0xf;
-                    data = (int32_t)read_wave_byte(ramptr + wtptr) ^ 0x80;
-
-                    if (read_wave_byte(ramptr + wtptr) == 0x00) {
-                        halt_osc(osc, 1, &acc, resshift, pOsc->control);
-                        // Update ctrl from pOsc->control since halt_osc may have modified it
-                        ctrl = pOsc->control;
-                    } else {
-                        if (mode != MODE_SYNCAM) {
-                            *mixp += data * vol;
-                            // Volume glitch for highest enabled oscillator
-                            if (osc == (m_oscsenabled - 1)) {
-                                *mixp += data * vol;
-                                *mixp += data * vol;
-                            }
-                        } else {
-                            // Sync/AM mode
-                            if (osc & 1) {
-                                // Odd oscillator modulates the next one up
-                                if (osc < 31) {
-                                    if (!(m_oscillators[osc + 1].control & 1)) {
-                                        m_oscillators[osc + 1].vol = data ^ 0x80;
-                                    }
-                                }
-                            } else {
-                                // Even oscillator plays normally
-                                *mixp += data * vol;
-                                if (osc == (m_oscsenabled - 1)) {
-                                    *mixp += data * vol;
-                                    *mixp += data * vol;
-                                }
-                            }
-                        }
-                        mixp += m_output_channels;
-
-                        // MAME: wrap/halt when pre-increment position reaches end
-                        // (wtsize here is already pOsc->wtsize - 1).
-                        if (altram >= wtsize) {
-                            halt_osc(osc, 0, &acc, resshift, pOsc->control);
-                            // Update ctrl from pOsc->control since halt_osc may have modified it
-                            ctrl = pOsc->control;
-                        }
-                    }
-
-                    // If oscillator halted, no more samples to generate
-                    // Check pOsc->control directly to ensure we see the latest state
-                    if (pOsc->control & 1) {
-                        ctrl = pOsc->control;
-                        break;
-                    }
-                }
-
-                pOsc->control = ctrl;
-                pOsc->accumulator = acc;
-                pOsc->data = data ^ 0x80;
+            if (assigned[osc] == chan && !(m_oscillators[osc].control & 1)) {
+                render_osc(osc, &m_mix_buffer[0] + chan, num_samples);
             }
         }
     }
 
-    // Convert mix buffer to output buffer
-    int32_t *mixp = &m_mix_buffer[0];
-    for (int i = 0; i < num_samples * m_output_channels; i++) {
-        int32_t sample = *mixp++ / 8;  // Scale down
+    // Convert mix buffer to output buffer: scale down by 8 (rounding toward zero)
+    // and clamp to 16 bits.
+    const int total = num_samples * m_output_channels;
+    const int32_t *mixp = &m_mix_buffer[0];
+    int i = 0;
+#if defined(__SSE2__)
+    // packs saturates to int16, which is the clamp; adding 7 to negatives makes the
+    // arithmetic shift round toward zero like the division.
+    const __m128i seven = _mm_set1_epi32(7);
+    for (; i + 8 <= total; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(mixp + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(mixp + i + 4));
+        a = _mm_srai_epi32(_mm_add_epi32(a, _mm_and_si128(_mm_srai_epi32(a, 31), seven)), 3);
+        b = _mm_srai_epi32(_mm_add_epi32(b, _mm_and_si128(_mm_srai_epi32(b, 31), seven)), 3);
+        _mm_storeu_si128((__m128i *)(buffer + i), _mm_packs_epi32(a, b));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const int32x4_t seven = vdupq_n_s32(7);
+    for (; i + 8 <= total; i += 8) {
+        int32x4_t a = vld1q_s32(mixp + i);
+        int32x4_t b = vld1q_s32(mixp + i + 4);
+        a = vshrq_n_s32(vaddq_s32(a, vandq_s32(vshrq_n_s32(a, 31), seven)), 3);
+        b = vshrq_n_s32(vaddq_s32(b, vandq_s32(vshrq_n_s32(b, 31), seven)), 3);
+        vst1q_s16(buffer + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#endif
+    for (; i < total; i++) {
+        int32_t sample = mixp[i] / 8;  // Scale down
         if (sample > 32767) sample = 32767;
         if (sample < -32768) sample = -32768;
         buffer[i] = (int16_t)sample;
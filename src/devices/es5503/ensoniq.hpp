@@ -8,6 +8,7 @@
 
 // Forward declarations
 struct computer_t;
+class SnapshotIO;
 
 // Oscillator structure
 struct Oscillator {
@@ -35,6 +36,9 @@ public:
     
     // Reset the chip to initial state
     void reset();
+
+    // Registers and oscillator state; the wave RAM is saved by the Sound GLU.
+    void snapshot(SnapshotIO &io);
     
     // Register read/write
     uint8_t read(uint8_t offset);
@@ -98,6 +102,7 @@ public:
     
     // Helper methods
     void halt_osc(int onum, int type, uint32_t *accumulator, int resshift, uint8_t newCtrl);
+    void render_osc(int onum, int32_t *mixp, int num_samples);
     uint8_t read_wave_byte(uint32_t address);
     void update_sdl_stream_rate();
     int update_irq_status();
@@ -584,4 +584,22 @@ void init_ensoniq_slot(computer_t *computer, SlotType_t slot) {
         st->c14m_accum = 0;
         return true;
     });
+
+    computer->register_ram_region("docram", st->doc_ram, 0x10000);
+    computer->register_state_handler("soundglu", [st](SnapshotIO &io) {
+        io.field(st->soundctl);
+        io.field(st->sounddata);
+        io.field(st->soundadrl);
+        io.field(st->soundadrh);
+        io.field(st->doc_read_latched_addr);
+        io.cycle_time(st->doc_read_complete_time, st->clock->get_c14m());
+        st->chip->snapshot(io);
+        if (io.loading()) {
+            // Audio picks up from the load point, with nothing staged from before it.
+            st->last_catchup_c14m = st->clock->get_c14m();
+            st->c14m_accum = 0;
+            st->sdl_staging_count = 0;
+            st->resample_pos = 0.0;
+        }
+    });
 }
\ No newline at end of file
@@ -20,6 +20,8 @@
 
 #include "Floppy35_woz.hpp"
 #include "util/woz_nibblizer_35.hpp"
+#include "util/EventTimer.hpp"
+#include "util/Snapshot.hpp"
 
 // ─── Mount policy (3.5 = WOZ-only in Phase 1) ──────────────────────────────
 
@@ -65,12 +67,42 @@ bool Floppy35_woz::unmount(uint64_t key) {
     disk_in_place = false;
     motor_on      = false;
     disk_switched = true;
+    spindle_was_on = false;     // an unmount isn't an idle: discarding must not flush
 
     update_spinning();
     refresh_sense();
     return Floppy_woz::unmount(key);
 }
 
+void Floppy35_woz::snapshot(SnapshotIO &io) {
+    const uint64_t now = clock->get_vid_cycles();
+    io.field(ca0);
+    io.field(ca1);
+    io.field(ca2);
+    io.field(hdsel);
+    io.field(lstrb);
+    io.field(track_num);
+    io.field(side);
+    io.field(step_dir);
+    io.field(motor_on);
+    io.field(disk_switched);
+    io.cycle_time(ready_cycles_end, now);
+    io.field(disk_ready);
+    io.cycle_time(stepping_cycles_end, now);
+    io.field(disk_stepping);
+    if (io.loading()) {
+        if (track_num < 0 || track_num > 79) track_num = 0;
+        side &= double_sided ? 1 : 0;
+    }
+    // schedule_motor_off() runs on 14M time.
+    event_timer->snapshot_event(io, clock->get_c14m(), instanceID, motor_off_callback, this);
+    Floppy_woz::snapshot(io);
+    if (io.loading()) {
+        update_spinning();
+        refresh_sense();
+    }
+}
+
 // status is different because there is a separate motor_on status
 drive_status_t Floppy35_woz::status() {
     if (is_mounted) {
@@ -282,9 +314,10 @@ void Floppy35_woz::track_side_changed() {
     update_track_ptr();
 }
 
-// TODO: eliminate this, it literally does nothing.
 void Floppy35_woz::update_spinning() {
-    
+    if (spindle_was_on && !motor_on) flush_idle();
+    spindle_was_on = motor_on;
+
     /* const bool should_spin = enable && motor_on && disk_in_place;
     // Go through the base Floppy_woz::set_enable() so the cycle baseline
     // is reset on spin-up — otherwise the first fast_forward() would
@@ -54,6 +54,7 @@ class Floppy35_woz : public Floppy_woz {
     int     side           = 0;     // 0 = lower, 1 = upper
     uint8_t step_dir       = 0;     // 0 = inward (toward higher tracks), 1 = outward
     bool    motor_on       = false; // spindle motor (CONT35 $4/$C)
+    bool    spindle_was_on = false; // motor_on at the last update_spinning(), to catch it stopping
     bool    disk_in_place  = false; // true after a successful mount()
     bool    disk_switched  = false; // set by eject control, cleared by reset-flag control
     bool    double_sided   = true;  // 3.5 WOZs in this emu are all 2-sided
@@ -98,6 +99,7 @@ class Floppy35_woz : public Floppy_woz {
     // Recompute whether the shared Floppy_woz::enable latch (which gates
     // fast_forward/read_pulse/write_pulse) should be on. 3.5 spins only
     // when the drive is selected AND the spindle motor is commanded on.
+    // The spindle stopping is when the drive idles and flushes its writes.
     void update_spinning();
     FILE *dbglog = nullptr;
 
@@ -186,6 +188,7 @@ public:
     virtual bool mount(uint64_t key, media_descriptor *media) override;
     virtual bool unmount(uint64_t key) override;
     virtual drive_status_t status() override;
+    void snapshot(SnapshotIO &io) override;
 
     static constexpr const char *statusNames[16] = {
         "stepDirection",
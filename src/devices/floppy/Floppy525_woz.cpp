@@ -22,6 +22,7 @@
 #include "util/media.hpp"
 #include "util/woz_nibblizer_525.hpp"
 #include "util/EventTimer.hpp"
+#include "util/Snapshot.hpp"
 
 // ─── Mount / head range ─────────────────────────────────────────────────────
 
@@ -69,6 +70,19 @@ bool Floppy525_woz::unmount(uint64_t key) {
     return Floppy_woz::unmount(key);
 }
 
+void Floppy525_woz::snapshot(SnapshotIO &io) {
+    io.field(rw_mode);
+    io.field(phase0);
+    io.field(phase1);
+    io.field(phase2);
+    io.field(phase3);
+    io.field(track);
+    if (io.loading() && (track < 0 || track > max_tracks)) track = 0;
+    // set_phase() schedules against CPU cycles.
+    event_timer->snapshot_event(io, clock->get_cycles(), instanceID, phase_change_callback, this);
+    Floppy_woz::snapshot(io);
+}
+
 // ─── Phase-line handling (5.25-specific stepper) ────────────────────────────
 
 void Floppy525_woz::set_phase(uint8_t phase, uint8_t onoff) {
@@ -71,6 +71,7 @@ public:
 
     bool mount(uint64_t key, media_descriptor *media) override;
     bool unmount(uint64_t key) override;
+    void snapshot(SnapshotIO &io) override;
 
     virtual Woz_Nibblizer* make_nibblizer(media_descriptor *media) override;
 
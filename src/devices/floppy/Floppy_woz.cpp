@@ -24,6 +24,7 @@
 //#include "devices/diskii/diskii_fmt.hpp"
 #include "util/SoundEffectKeys.hpp"
 #include "util/woz_nibblizer.hpp"
+#include "util/Snapshot.hpp"
 
 // ───────────────────────────── mount/unmount/writeback ─────────────────────────
 
@@ -58,6 +59,10 @@ bool Floppy_woz::mount(uint64_t key, media_descriptor *media_in) {
 
     update_track_ptr();
 
+    if (media_in->media_type == MEDIA_WOZ && woz.is_read_only() && !media_in->write_protected) {
+        std::cout << "Floppy_woz: " << media_in->filestub << " is read-only, mounting write-protected" << std::endl;
+        media_in->write_protected = true;
+    }
     write_protect = media_in->write_protected;
     is_mounted    = true;
     media_d       = media_in;
@@ -73,6 +78,15 @@ bool Floppy_woz::mount(uint64_t key, media_descriptor *media_in) {
 
 bool Floppy_woz::unmount(uint64_t key) {
     //(void)key;
+    // An idle flush still waiting for its frame happened before the unmount;
+    // then the file gets back the CRC the idle flushes cleared.
+    if (flush_pending && woz.write_tracks() == 0) modified = false;
+    flush_pending = false;
+    if (woz.write_crc() != 0) {
+        fprintf(stderr, "Floppy_woz: CRC update failed for '%s'\n",
+                media_d ? media_d->filename.c_str() : "");
+    }
+
     // Reset WOZ image to a clean blank state.
     woz = Woz{};
     cur_track_ptr = nullptr;
@@ -98,8 +112,8 @@ bool Floppy_woz::writeback() {
 
     // MEDIA_NYBBLE means the mount source was a 143K block image
     // (.do/.po/.dsk): decode the in-memory WOZ bit stream back into a raw
-    // disk_image_t and rewrite the file in place. For native WOZ images
-    // just save as WOZ2.
+    // disk_image_t and rewrite the file in place. Native WOZ images write
+    // back just the tracks the guest wrote (WOZ1 is resaved as WOZ2).
     // TODO: we should dealloc the nibblizer here on exit
     std::cout << "Floppy_woz: writing back disk image " << media_d->filename
               << " (media_type=" << media_d->media_type << ")" << std::endl;
@@ -133,7 +147,7 @@ bool Floppy_woz::writeback() {
 #endif    
     } else {
         std::cout << "Floppy_woz: writing back WOZ disk image" << std::endl;
-        int rc = woz.save(media_d->filename);
+        int rc = woz.writeback();
         if (rc != 0) {
             fprintf(stderr, "Floppy_woz: writeback failed for '%s'\n",
                     media_d->filename.c_str());
@@ -145,6 +159,29 @@ bool Floppy_woz::writeback() {
     return true;
 }
 
+// The spindle just stopped. A WOZ2 image has the tracks written while it
+// spun patched into its file at the next frame, so they survive a crash or
+// a killed emulator; unmounting without saving then only drops what was
+// written since. Block images and WOZ1 files are rewritten whole, so they
+// are still only written by writeback().
+void Floppy_woz::flush_idle() {
+    if (!modified || !media_d || media_d->media_type != MEDIA_WOZ || !woz.writes_in_place()) return;
+    flush_pending = true;
+}
+
+// No CRC pass or sync here (see Woz::write_tracks): with the file mapped this
+// is a copy of the dirty tracks into the page cache. The CRC goes back on
+// writeback() or unmount.
+void Floppy_woz::frame_flush() {
+    if (!flush_pending || lss_disk_spinning()) return;
+    flush_pending = false;
+    if (woz.write_tracks() == 0) {
+        modified = false;
+    } else {
+        fprintf(stderr, "Floppy_woz: idle flush failed for '%s'\n", media_d->filename.c_str());
+    }
+}
+
 // ───────────────────────────── status / reset ─────────────────────────────────
 
 drive_status_t Floppy_woz::status() {
@@ -180,6 +217,25 @@ void Floppy_woz::update_track_ptr() {
     read_position = head_position;
 }
 
+void Floppy_woz::snapshot(SnapshotIO &io) {
+    io.cycle_time(last_cycle, get_current_time());
+    io.field(read_position);
+    io.field(head_position);
+    io.field(advance_per_cycle);
+    io.field(enable);
+    io.field(random_bits);
+    io.field(windowBits);
+    if (!io.loading()) return;
+
+    // Not update_track_ptr(): the saved positions are already on the saved track.
+    cur_track_ptr = woz.get_track_ptr(current_tmap_index());
+    if (cur_track_ptr && cur_track_ptr->bit_count) {
+        head_position %= cur_track_ptr->bit_count * POSITION_FP_MUL;
+        read_position %= cur_track_ptr->bit_count * POSITION_FP_MUL;
+    }
+    if (is_mounted) advance_per_cycle = head_advance_per_cycle();
+}
+
 uint64_t Floppy_woz::fast_forward(/* uint64_t now */) {
     uint64_t now = get_current_time(); // use our own clock.
     uint64_t elapsed = now - last_cycle;
@@ -306,6 +362,7 @@ void Floppy_woz::write_pulse(uint8_t bit) {
             uint8_t mask = static_cast<uint8_t>(1u << (7 - static_cast<int>(bit_in_byte)));
             if (bit & 1) cur_track_ptr->bits[byte_idx] |= mask;
             else         cur_track_ptr->bits[byte_idx] &= static_cast<uint8_t>(~mask);
+            cur_track_ptr->dirty = true;
             modified = true;
         }
     }
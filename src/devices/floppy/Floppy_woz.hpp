@@ -29,6 +29,7 @@
 
 class EventTimer;
 class Woz_Nibblizer;
+class SnapshotIO;
 
 // Abstract base for floppy drives backed by a WOZ in-memory bit stream.
 //
@@ -118,9 +119,16 @@ protected:
     void note_spinning_inputs_changed(bool was_spinning) {
         if (!was_spinning && lss_disk_spinning()) {
             last_cycle = get_current_time();
+        } else if (was_spinning && !lss_disk_spinning()) {
+            flush_idle();
         }
     }
 
+    // The disk stopped spinning: have frame_flush() write what the guest wrote
+    // during the spin back to the image file, where that can be done in place.
+    void flush_idle();
+    bool flush_pending = false;
+
 public:
     Floppy_woz(SoundEffect *sound_effect, NClockII *clock, EventTimer *event_timer)
         : sound_effect(sound_effect), clock(clock), event_timer(event_timer) {}
@@ -134,12 +142,45 @@ public:
     virtual bool mount(uint64_t key, media_descriptor *media);
     virtual bool unmount(uint64_t key);
     virtual bool writeback();
+    // Once per frame, from the controller: do the write flush_idle() asked for,
+    // away from the soft switch that stopped the motor.
+    void frame_flush();
     virtual drive_status_t status();
     virtual void reset();
 
+    // Mechanism and bit-stream position only; the disk image itself is whatever is
+    // mounted in the loading machine. Subclasses save their own state first and then
+    // call this, which re-selects the track buffer from it.
+    virtual void snapshot(SnapshotIO &io);
+
     virtual uint8_t read_pulse();
     virtual void    write_pulse(uint8_t bit);
 
+    // Eight read_pulse()s at once, for an LSS that can take a byte per step.
+    // Only when they would be plain track bits: the disk is spinning, the
+    // eight bits stop short of the end of the track, and no run of four
+    // zeros (which read_pulse would replace with a random bit) ends among
+    // them. Returns false without consuming anything otherwise; fall back
+    // to read_pulse().
+    inline bool read_byte_fast(uint8_t &raw) {
+        if (!lss_disk_spinning() || !cur_track_ptr) return false;
+        const uint64_t track_bits = cur_track_ptr->bit_count;
+        const uint64_t bi = read_position >> POSITION_FP_SHIFT;
+        if (bi + 8 >= track_bits) return false;
+
+        const uint8_t *p = &cur_track_ptr->bits[bi >> 3];
+        const uint32_t shift = bi & 7;
+        raw = shift ? (uint8_t)((((uint32_t)p[0] << 8) | p[1]) >> (8 - shift)) : p[0];
+
+        // Inverted window: bit i of the AND is set when the 4 bits ending at i are all zero.
+        const uint32_t w = ~(((windowBits & 0x7) << 8) | raw);
+        if ((w & (w >> 1) & (w >> 2) & (w >> 3)) & 0xFF) return false;
+
+        windowBits = (windowBits << 8) | raw;
+        read_position += 8 * POSITION_FP_MUL;
+        return true;
+    }
+
     virtual void set_phase(uint8_t phase, uint8_t onoff) = 0;
 
     virtual int get_track() = 0;
@@ -55,6 +55,9 @@ void host_fst(void);
 /** Re-bind host_root to g_cfg_host_path; close host-side open files/cookies. */
 void host_fst_remount(void);
 
+/** Close host-side open files/cookies and release host_root. */
+void host_fst_unmount(void);
+
 #ifdef __cplusplus
 }
 #endif
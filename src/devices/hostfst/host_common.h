@@ -48,6 +48,10 @@ void afp_synchronize(struct AFP_Info *info, int preference);
 
 #endif
 
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
 #ifdef _WIN32
 typedef FILETIME host_time_t;
 typedef struct AFP_Info host_finder_info_t;
@@ -129,6 +133,29 @@ extern char *host_root;
 unsigned host_startup(void);
 void host_shutdown(void);
 
+/*
+ * What the engine keeps between calls for one machine: the mounted root and the
+ * open files with their cookies. Each machine owns one (zeroed = not mounted) and
+ * swaps it in around its calls with host_fst_swap_context(), under gs2's engine lock.
+ */
+struct fd_entry;
+struct host_fst_context {
+  char *host_root;
+#ifdef _WIN32
+  DWORD root_file_id[3];
+#else
+  ino_t root_ino;
+  dev_t root_dev;
+#endif
+  word32 cookies[32];
+  struct fd_entry *fd_head;
+};
+
+/* Exchange ctx with the engine's live state. */
+void host_fst_swap_context(struct host_fst_context *ctx);
+/* The host_root / root id part of host_fst_swap_context(). */
+void host_swap_root(struct host_fst_context *ctx);
+
 #ifdef _WIN32
 int host_is_root(const BY_HANDLE_FILE_INFORMATION *info);
 #else
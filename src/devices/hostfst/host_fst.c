@@ -446,7 +446,20 @@ static word32 fst_startup(void) {
 
 }
 
-void host_fst_remount(void) {
+void host_fst_swap_context(struct host_fst_context *ctx) {
+  word32 tmp[32];
+  memcpy(tmp, cookies, sizeof(cookies));
+  memcpy(cookies, ctx->cookies, sizeof(cookies));
+  memcpy(ctx->cookies, tmp, sizeof(cookies));
+
+  struct fd_entry *head = fd_head;
+  fd_head = ctx->fd_head;
+  ctx->fd_head = head;
+
+  host_swap_root(ctx);
+}
+
+void host_fst_unmount(void) {
   /* Same host-side teardown as fst_startup, without waiting for GS/OS $8001. */
   struct fd_entry *head = fd_head;
   while (head) {
@@ -457,6 +470,10 @@ void host_fst_remount(void) {
   fd_head = NULL;
   memset(&cookies, 0, sizeof(cookies));
   host_shutdown();
+}
+
+void host_fst_remount(void) {
+  host_fst_unmount();
 
   word32 rv = host_startup();
   if (rv) {
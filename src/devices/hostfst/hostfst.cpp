@@ -17,6 +17,7 @@
 #include "util/SystemSettings.hpp"
 
 #include <cstdio>
+#include <mutex>
 #include <string>
 
 #if defined(__EMSCRIPTEN__)
@@ -45,8 +46,10 @@ void init_hostfst(computer_t * /*computer*/, SlotType_t /*slot*/) {
 
 #include <SDL3/SDL.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
+#include <vector>
 
 namespace {
 
@@ -106,9 +109,32 @@ struct hostfst_state_t {
     SpscRing<HostFstRequest, kRequestRingDepth> requests;
     SpscRing<HostFstReply, kReplyRingDepth> replies;
     std::atomic<bool> running{false};
+    host_fst_context engine_ctx{};      // this machine's mount and open files while another has the engine
 };
 
-hostfst_state_t *g_hostfst = nullptr;
+/*
+ * The FST engine works on globals, so machines in one process take turns: a turn
+ * holds hostfst_engine_mutex and has the machine's engine_ctx swapped in. The
+ * registers, bound CPU and host path are set fresh at the start of every call.
+ * g_hostfst lists the live machines; it is guarded by the same mutex.
+ */
+std::mutex hostfst_engine_mutex;
+std::vector<hostfst_state_t *> g_hostfst;
+
+/** Swaps st's engine state in for its lifetime. Hold hostfst_engine_mutex. */
+class EngineTurn {
+    hostfst_state_t *st_;
+
+public:
+    explicit EngineTurn(hostfst_state_t *st) : st_(st) {
+        host_fst_swap_context(&st_->engine_ctx);
+    }
+    ~EngineTurn() {
+        host_fst_swap_context(&st_->engine_ctx);
+    }
+    EngineTurn(const EngineTurn &) = delete;
+    EngineTurn &operator=(const EngineTurn &) = delete;
+};
 
 std::string resolve_host_dir() {
     const std::string &configured = SystemSettings::instance().host_fst_dir();
@@ -176,6 +202,8 @@ void hostfst_wdm(cpu_state *cpu, void *context) {
         return;
     }
 
+    std::lock_guard<std::mutex> lock(hostfst_engine_mutex);
+    EngineTurn turn(st);
     apply_resolved_path_to_cfg(false);
     hostfst_bind_cpu(cpu);
     hostfst_sync_engine_from_cpu(cpu);
@@ -195,13 +223,13 @@ std::string hostfst_resolved_dir() {
 
 void hostfst_apply_dir(const std::string &path) {
     SystemSettings::instance().set_host_fst_dir(path);
+    std::lock_guard<std::mutex> lock(hostfst_engine_mutex);
     apply_resolved_path_to_cfg(true);
     // Previous code only host_shutdown()'d, leaving host_root NULL so every
     // subsequent WDM call returned networkError until GS/OS reloaded the FST.
-    if (g_hostfst != nullptr) {
-        hostfst_submit(g_hostfst, HostFstMsg::Remount);
-    } else {
-        host_fst_remount();
+    for (hostfst_state_t *st : g_hostfst) {
+        EngineTurn turn(st);
+        hostfst_submit(st, HostFstMsg::Remount);
     }
 }
 
@@ -220,8 +248,11 @@ void init_hostfst(computer_t *computer, SlotType_t /*slot*/) {
         return;
     }
 
-    g_hostfst = st;
-    apply_resolved_path_to_cfg(true);
+    {
+        std::lock_guard<std::mutex> lock(hostfst_engine_mutex);
+        g_hostfst.push_back(st);
+        apply_resolved_path_to_cfg(true);
+    }
 
     computer->cpu->set_wdm_handler(0xFF, {hostfst_wdm, st});
 
@@ -231,12 +262,16 @@ void init_hostfst(computer_t *computer, SlotType_t /*slot*/) {
         st->requests.send(req);
         SDL_SignalSemaphore(st->wake);
         SDL_WaitThread(st->worker, nullptr);
-        host_shutdown();
+        {
+            std::lock_guard<std::mutex> lock(hostfst_engine_mutex);
+            {
+                EngineTurn turn(st);
+                host_fst_unmount();
+            }
+            g_hostfst.erase(std::remove(g_hostfst.begin(), g_hostfst.end(), st), g_hostfst.end());
+        }
         SDL_DestroySemaphore(st->wake);
         SDL_DestroySemaphore(st->done);
-        if (g_hostfst == st) {
-            g_hostfst = nullptr;
-        }
         delete st;
         return true;
     });
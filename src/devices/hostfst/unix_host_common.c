@@ -81,6 +81,20 @@ void host_shutdown(void) {
   root_dev = 0;
 }
 
+void host_swap_root(struct host_fst_context *ctx) {
+  char *root = host_root;
+  host_root = ctx->host_root;
+  ctx->host_root = root;
+
+  ino_t ino = root_ino;
+  root_ino = ctx->root_ino;
+  ctx->root_ino = ino;
+
+  dev_t dev = root_dev;
+  root_dev = ctx->root_dev;
+  ctx->root_dev = dev;
+}
+
 int host_is_root(struct stat *st) {
   return st->st_ino == root_ino && st->st_dev == root_dev;
 }
@@ -118,6 +118,17 @@ void host_shutdown(void) {
   memset(root_file_id, 0, sizeof(root_file_id));
 }
 
+void host_swap_root(struct host_fst_context *ctx) {
+  char *root = host_root;
+  host_root = ctx->host_root;
+  ctx->host_root = root;
+
+  DWORD id[3];
+  memcpy(id, root_file_id, sizeof(root_file_id));
+  memcpy(root_file_id, ctx->root_file_id, sizeof(root_file_id));
+  memcpy(ctx->root_file_id, id, sizeof(root_file_id));
+}
+
 int host_is_root(const BY_HANDLE_FILE_INFORMATION *info) {
   DWORD id[3] = { info->dwVolumeSerialNumber, info->nFileIndexHigh, info->nFileIndexLow };
 
@@ -497,6 +497,23 @@ void init_iiememory(computer_t *computer, SlotType_t slot) {
             return true;
         });
 
+    // m_* describe the live map, so they are left alone and compose_map moves only what differs.
+    computer->register_state_handler("iiememory", [iiememory_d](SnapshotIO &io) {
+        io.field(iiememory_d->f_80store);
+        io.field(iiememory_d->f_ramrd);
+        io.field(iiememory_d->f_ramwrt);
+        io.field(iiememory_d->f_altzp);
+        io.field(iiememory_d->s_hires);
+        io.field(iiememory_d->s_page2);
+        io.field(iiememory_d->s_text);
+        io.field(iiememory_d->s_mixed);
+        iiememory_d->ll.snapshot(io);
+        if (io.loading()) {
+            bsr_map_memory(iiememory_d);
+            iiememory_compose_map(iiememory_d);
+        }
+    });
+
     computer->register_debug_display_handler(
         "iiememory",
         DH_IIEMEMORY, // unique ID for this, need to have in a header.
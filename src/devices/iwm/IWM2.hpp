@@ -8,6 +8,7 @@
 #include "devices/floppy/Floppy35_woz.hpp"
 
 #include "util/SoundEffectKeys.hpp"
+#include "util/Snapshot.hpp"
 #include "debug.hpp"
 
 
@@ -299,6 +300,36 @@ class IWM : public StorageDevice {
             }
         }
 
+        // Idle flushes of the four drives' WOZ images, at frame time.
+        void frame_flush() {
+            for (int fam = 0; fam < 2; fam++) {
+                for (int unit = 0; unit < 2; unit++) drives[fam][unit]->frame_flush();
+            }
+        }
+
+        void snapshot(SnapshotIO &io) {
+            io.bytes(switches, sizeof(switches));
+            io.cycle_time(mark_cycles_turnoff, clock->get_c14m());
+            io.field(sense_input);
+            io.field(disk_register);
+            io.field(reg_mode);
+            io.field(reg_handshake);
+            io.field(data_register);
+            io.field(internal_data_register);
+            io.field(async_shift_reg);
+            io.field(async_bits_remaining);
+            io.field(async_buffer_register);
+            io.field(async_buffer_valid);
+            io.field(sequencer_state);
+            for (int fam = 0; fam < 2; fam++) {
+                for (int unit = 0; unit < 2; unit++) drives[fam][unit]->snapshot(io);
+            }
+            if (io.loading()) {
+                iwm_select &= 1;
+                sync_drive_enables();
+            }
+        }
+
         /* Floppy525_woz *get_drive_525(int index) {
             return drives_525[index];
         } */
@@ -67,6 +67,9 @@ void init_iwm_slot(computer_t *computer, SlotType_t slot) {
             st->iwm->reset();
             return true;
         });
+    computer->register_state_handler("iwm", [st](SnapshotIO &io) {
+        st->iwm->snapshot(io);
+    });
 
     // Register both pairs of drives with the Mounts subsystem. The IWM
     // routes slot 6 to drives_525[] and slot 5 to drives_35[] internally.
@@ -88,6 +91,7 @@ void init_iwm_slot(computer_t *computer, SlotType_t slot) {
         [st]() {
             // motor off timer check. WAY easier to do here than in the drive.
             st->iwm->check_motor_off_timer();
+            st->iwm->frame_flush();
 
             if (st->computer->execution_mode == EXEC_NORMAL) {
                 if (st->iwm->get_motor()) {
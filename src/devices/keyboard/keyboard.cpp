@@ -55,14 +55,17 @@ uint8_t kb_read_C00X(void *context, uint32_t address) {
     keyboard_state_t *kb_state = (keyboard_state_t *)context;
 
     if ((kb_state->kb_key_strobe & 0x80) == 0) { // if keyboard does not already have a buffered character.. 
-        if (kb_state->paste_buffer.length() > 0) { // if there is a paste buffer, use it.
-            uint8_t key = kb_state->paste_buffer[0];
+        if (kb_state->paste_pos < kb_state->paste_buffer.length()) { // if there is a paste buffer, use it.
+            uint8_t key = kb_state->paste_buffer[kb_state->paste_pos];
             if (key == '\n') {
                 key = '\r'; // apple 2's like \r :)
             }
             // TODO: do we need to handle Windows-style \r\n?
             kb_key_pressed(kb_state, key);
-            kb_state->paste_buffer = kb_state->paste_buffer.substr(1);
+            if (++kb_state->paste_pos == kb_state->paste_buffer.length()) {
+                kb_state->paste_buffer.clear();
+                kb_state->paste_pos = 0;
+            }
         }
     }
     uint8_t key = kb_state->kb_key_strobe;
@@ -128,6 +131,7 @@ void handle_paste(keyboard_state_t *kb_state, const SDL_Event &event) {
     if (clipboardText) {
         fprintf(stdout, "clipboardText: %s\n", clipboardText);
         kb_state->paste_buffer = std::string(clipboardText);
+        kb_state->paste_pos = 0;
         SDL_free(clipboardText);
     }
 }
@@ -188,6 +192,19 @@ void handle_keyup(const SDL_Event &event, keyboard_state_t *kb_state) {
     }
 }    
 
+// The strobe is all the machine sees; a paste in progress is host-side and isn't saved.
+static void register_keyboard_state(computer_t *computer, keyboard_state_t *kb_state) {
+    computer->register_state_handler("keyboard", [kb_state](SnapshotIO &io) {
+        io.field(kb_state->kb_key_strobe);
+        io.field(kb_state->key_down_count);
+        if (io.loading()) {
+            kb_state->paste_buffer.clear();
+            kb_state->paste_pos = 0;
+            if (kb_state->mk) kb_state->mk->last_key_val = kb_state->kb_key_strobe;
+        }
+    });
+}
+
 void init_mb_iiplus_keyboard(computer_t *computer, SlotType_t slot) {
     if (DEBUG(DEBUG_KEYBOARD)) fprintf(stdout, "init_keyboard\n");
     keyboard_state_t *kb_state = new keyboard_state_t;
@@ -219,6 +236,7 @@ void init_mb_iiplus_keyboard(computer_t *computer, SlotType_t slot) {
         } else handle_keyup(event, kb_state);
         return false;
     });
+    register_keyboard_state(computer, kb_state);
 }
 
 void handle_keydown_iie(const SDL_Event &event, keyboard_state_t *kb_state) {
@@ -311,6 +329,7 @@ void init_mb_iie_keyboard(computer_t *computer, SlotType_t slot) {
         } else handle_keyup(event, kb_state);
         return false;
     });
+    register_keyboard_state(computer, kb_state);
     computer->register_debug_display_handler(
         "keyboard",
         DH_KEYBOARD,
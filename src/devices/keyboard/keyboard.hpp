@@ -29,6 +29,7 @@
 struct keyboard_state_t {
     uint8_t kb_key_strobe = 0x41; 
     std::string paste_buffer;
+    size_t paste_pos = 0;       // next character of paste_buffer to inject
     message_keyboard_t *mk = nullptr;
     MMU_II *mmu = nullptr;
     ResetController *reset_control = nullptr;
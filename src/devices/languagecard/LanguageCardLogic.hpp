@@ -28,6 +28,7 @@
 
 #include <cstdio>
 #include "debug.hpp"
+#include "util/Snapshot.hpp"
 
 #define LANG_A3             0b00001000
 #define LANG_A0A1           0b00000011
@@ -146,5 +147,13 @@ public:
         FF_PRE_WRITE = 0;
         _FF_WRITE_ENABLE = 0; // UtA2 Pg 5-29, "enabled for writing". UtA2e Pg 5-23: "on reset, disabled for reading and enabled for writing".
     }
+
+    /* Caller remaps after a load, same as after read() / write(). */
+    void snapshot(SnapshotIO &io) {
+        io.field(FF_BANK_1);
+        io.field(FF_READ_ENABLE);
+        io.field(FF_PRE_WRITE);
+        io.field(_FF_WRITE_ENABLE);
+    }
  
 };
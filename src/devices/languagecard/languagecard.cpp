@@ -128,4 +128,10 @@ void init_slot_languagecard(computer_t *computer, SlotType_t slot) {
             reset_languagecard(lc);
             return true;
         });
+
+    computer->register_ram_region("languagecard", lc->ram_bank, 0x4000);
+    computer->register_state_handler("languagecard", [lc](SnapshotIO &io) {
+        lc->ll.snapshot(io);
+        if (io.loading()) set_memory_pages_based_on_flags(lc);
+    });
 }
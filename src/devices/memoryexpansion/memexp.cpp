@@ -143,4 +143,10 @@ void init_slot_memexp(computer_t *computer, SlotType_t slot) {
     computer->mmu->set_slot_rom(slot, rom_data+(slot * 0x0100), "MEMX_ROM");
 
     computer->mmu->set_C8xx_handler(slot, map_rom_memexp, memexp_d);
+
+    std::string snap_name = "memexp" + std::to_string((int)slot);
+    computer->register_ram_region(snap_name, memexp_d->data, MEMEXP_SIZE);
+    computer->register_state_handler(snap_name, [memexp_d](SnapshotIO &io) {
+        io.field(memexp_d->addr);
+    });
 }
\ No newline at end of file
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <deque>
 #include <vector>
 #include "debug.hpp"
 #include "util/EventTimer.hpp"
+#include "util/Snapshot.hpp"
 #include "util/InterruptController.hpp"
 #include "util/AudioSystem.hpp"
 #include "NClock.hpp"
@@ -54,14 +56,14 @@ constexpr uint32_t SAMPLES_PER_FRAME_INT = 740;
 
 // Event to represent register changes with timestamps
 struct RegisterEvent {
-    double timestamp;      // Time in seconds when this event occurs
+    uint64_t cycle;        // Bus cycle (clock->get_vid_cycles()) when this event occurs
     uint8_t chip_index;    // Which AY chip (0 or 1)
     uint8_t register_num;  // Which register (0-13)
     uint8_t value;         // New value for the register
     
     // For sorting events by timestamp
     bool operator<(const RegisterEvent& other) const {
-        return timestamp < other.timestamp;
+        return cycle < other.cycle;
     }
 };
 
@@ -88,13 +90,12 @@ static const float normalized_levels[16] = {
 #endif
 
 #if 1
-// Add a static array for the normalized volume levels
-static const float normalized_levels[16] = {
-    0x0000 / 65535.0f * 0.25f, 0x0385 / 65535.0f * 0.25f, 0x053D / 65535.0f * 0.25f, 0x0770 / 65535.0f * 0.25f,
-    0x0AD7 / 65535.0f * 0.25f, 0x0FD5 / 65535.0f * 0.25f, 0x15B0 / 65535.0f * 0.25f, 0x230C / 65535.0f * 0.25f,
-    0x2B4C / 65535.0f * 0.25f, 0x43C1 / 65535.0f * 0.25f, 0x5A4B / 65535.0f * 0.25f, 0x732F / 65535.0f * 0.25f,
-    0x9204 / 65535.0f * 0.25f, 0xAFF1 / 65535.0f * 0.25f, 0xD921 / 65535.0f * 0.25f, 0xFFFF / 65535.0f * 0.25f
+// DAC output for each volume setting; 0xFFFF plays at 0.25 full scale.
+static const uint16_t ay_levels[16] = {
+    0x0000, 0x0385, 0x053D, 0x0770, 0x0AD7, 0x0FD5, 0x15B0, 0x230C,
+    0x2B4C, 0x43C1, 0x5A4B, 0x732F, 0x9204, 0xAFF1, 0xD921, 0xFFFF
 };
+static constexpr float AY_LEVEL_SCALE = 0.25f / 65535.0f;
 
 // Add a static array for the normalized volume levels
 /* static const float normalized_levels[16] = {
@@ -106,22 +107,110 @@ static const float normalized_levels[16] = {
  */
 #endif
 
+/*
+ * Band-limited steps (the blip_buf approach). The chip output is a staircase: it holds
+ * a level and jumps at known bus cycles. Each jump is added to the output as a
+ * windowed-sinc step, taken from a table by where the jump falls within its output
+ * sample, and the output is the running sum. That is a polyphase FIR low-pass ahead of
+ * the decimation to the output rate, with work only where the signal changes.
+ *
+ * Taps are integers scaled by 1 << KERNEL_BITS, and each phase's taps sum to exactly
+ * that, so the running sum holds the level with no drift. The output lags the chip by
+ * WIDTH / 2 samples (~0.36ms at 44.1kHz).
+ */
+class BandLimitedSteps {
+    public:
+        static constexpr int WIDTH = 32;            // output samples a step is spread over
+        static constexpr int PHASES = 512;          // step positions within one output sample
+        static constexpr int KERNEL_BITS = 15;
+        static constexpr double CUTOFF = 0.40;      // of the output rate: 17.6kHz at 44.1kHz
+
+        // Add a jump of delta, phase/PHASES of the way into the sample being built.
+        void add_step(int phase, int32_t delta) {
+            const int32_t *taps = kernel().taps[phase];
+            for (int j = 0; j < WIDTH; j++) {
+                ring[(index + j) & RING_MASK] += (int64_t)delta * taps[j];
+            }
+        }
+
+        // Finish the sample being built and return it, in level units << KERNEL_BITS.
+        int64_t read() {
+            sum += ring[index & RING_MASK];
+            ring[index & RING_MASK] = 0;
+            index++;
+            return sum;
+        }
+
+        // Drop steps in flight and hold 'level' from here.
+        void restart(int32_t level) {
+            for (int64_t &r : ring) r = 0;
+            sum = (int64_t)level << KERNEL_BITS;
+        }
+
+    private:
+        static constexpr int RING_SIZE = 64;        // power of 2 > WIDTH
+        static constexpr uint32_t RING_MASK = RING_SIZE - 1;
+
+        struct Kernel {
+            int32_t taps[PHASES][WIDTH];
+
+            // Tap j of phase p is the rise of the step response over output sample
+            // j, for a jump (PHASES - p)/PHASES of a sample before the end of the
+            // sample it lands in; the response is centred WIDTH / 2 samples later.
+            Kernel() {
+                constexpr int SUB = 4;                  // integration steps per phase
+                constexpr int N = WIDTH * PHASES * SUB;
+                std::vector<double> rise(WIDTH * PHASES + 1, 0.0);
+                double total = 0.0;
+                for (int k = 0; k < N; k++) {
+                    const double t = (k + 0.5) / (PHASES * SUB) - WIDTH / 2.0;   // in samples
+                    const double x = 2.0 * M_PI * CUTOFF * t;
+                    const double sinc = (t == 0.0) ? 1.0 : std::sin(x) / x;
+                    const double w = 2.0 * M_PI * (k + 0.5) / N;
+                    const double blackman = 0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+                    total += sinc * blackman;
+                    if ((k + 1) % SUB == 0) rise[(k + 1) / SUB] = total;
+                }
+                for (int p = 0; p < PHASES; p++) {
+                    int32_t prev = 0;
+                    for (int j = 0; j < WIDTH; j++) {
+                        const int at = (j + 1) * PHASES - p;
+                        const int32_t scaled = (j == WIDTH - 1) ? (1 << KERNEL_BITS)
+                            : (int32_t)std::lround(rise[at] / total * (1 << KERNEL_BITS));
+                        taps[p][j] = scaled - prev;
+                        prev = scaled;
+                    }
+                }
+            }
+        };
+
+        static const Kernel &kernel() {
+            static const Kernel k;
+            return k;
+        }
+
+        int64_t ring[RING_SIZE] = {0};
+        int64_t sum = 0;
+        uint32_t index = 0;
+};
+
  class AY8910s {
     private:
         // Constants
-        static constexpr double MASTER_CLOCK = /* 1020500.0 */ 1020484.0; // 1MHz
+        // The chips run off the 1.0205MHz bus clock. Tone and noise generators step
+        // once every CLOCK_DIVIDER bus cycles (a "tick"), the envelope once every
+        // ENVELOPE_CLOCK_DIVIDER.
         static constexpr int CLOCK_DIVIDER = 16;
-        static constexpr double CHIP_FREQUENCY = MASTER_CLOCK / CLOCK_DIVIDER; // 62.5kHz
         static constexpr int ENVELOPE_CLOCK_DIVIDER = 256;  // First stage divider for envelope
+        static constexpr int TICKS_PER_ENVELOPE = ENVELOPE_CLOCK_DIVIDER / CLOCK_DIVIDER;
+        // Longest run of ticks skipped at once, so quiet stretches don't pile up work.
+        static constexpr uint64_t MAX_RUN_TICKS = 4096;
         static constexpr float FILTER_CUTOFF = 0.3f; // Filter coefficient (0-1) (lower is more aggressive)
-        
-        float get_volume(uint8_t volsetting) {
-            return normalized_levels[volsetting]; /*  * 0.25f */;
-        }
 
     public:
-        AY8910s(std::vector<float>* buffer, EventTimer *event_timer,  NClock *clock, AudioSystem *audio_system /* , InterruptController *irq_control, uint8_t slot */) 
-            : current_time(0.0), time_accumulator(0.0), envelope_time_accumulator(0.0), audio_buffer(buffer), audio_system(audio_system) {
+        AY8910s(std::vector<float>* buffer, EventTimer *event_timer,  NClock *clock, AudioSystem *audio_system /* , InterruptController *irq_control, uint8_t slot */,
+                uint32_t output_rate = OUTPUT_SAMPLE_RATE_INT)
+            : bus_rate(clock->get_vid_cycles_per_second()), output_rate(output_rate), audio_buffer(buffer), audio_system(audio_system) {
             // Initialize per-chip bus address latch to "invalid / no register
             // selected" so writes without a preceding LATCH are ignored
             // (matches AY8913 power-on/reset behavior; audited by mb-audit
@@ -142,7 +231,7 @@ static const float normalized_levels[16] = {
                     //chips[c].tone_channels[i].counter = 0; // TODO: was 1, for testing claude suggestion.
                     chips[c].tone_channels[i].counter = 1;
                     chips[c].tone_channels[i].output = false;
-                    chips[c].tone_channels[i].volume = 0;
+                    chips[c].tone_channels[i].level = 0;
                     chips[c].tone_channels[i].use_envelope = false;
                 }
                 
@@ -158,8 +247,7 @@ static const float normalized_levels[16] = {
                 chips[c].envelope_output = 0;
                 chips[c].envelope_hold = false;
                 chips[c].envelope_attack = false;
-                chips[c].current_envelope_level = 0.0f;
-                chips[c].target_envelope_level = 0.0f;
+                mix_level[c] = 0;
             }
             for (int i = 0; i < 7; i++) {
                 filters[i].last_sample = 0.0f;
@@ -188,6 +276,8 @@ static const float normalized_levels[16] = {
                 // constructor comment). Any value >= AY_8913_REGISTER_COUNT
                 // serves as the sentinel for "no register selected".
                 reg_num[c] = 0xFF;
+                mix_level[c] = mixLevel(chips[c]);
+                steps[c].restart(mix_level[c]);
             }
             // Zero the R-channel decorrelation delay line so reset produces
             // a clean output with no residual samples from the previous run.
@@ -207,7 +297,7 @@ static const float normalized_levels[16] = {
         //
         // Returns { drove_data=true, data } on read cycles so the board
         // can latch the byte into the matching VIA IRA.
-        AyBusResult busCycle(uint8_t chip_index, uint8_t pa, uint8_t pb, double time_seconds) {
+        AyBusResult busCycle(uint8_t chip_index, uint8_t pa, uint8_t pb, uint64_t cycle) {
             if (chip_index > 1) return { false, 0 };
 
             // ~RESET asserted: zero all 16 registers at this timestamp and
@@ -216,7 +306,7 @@ static const float normalized_levels[16] = {
             // (no data driven onto Port A).
             if ((pb & 0b100) == 0) {
                 for (uint8_t r = 0; r < AY_8913_REGISTER_COUNT; r++) {
-                    queueRegisterChange(time_seconds, chip_index, r, 0);
+                    queueRegisterChange(cycle, chip_index, r, 0);
                 }
                 reg_num[chip_index] = 0xFF;
                 return { false, 0 };
@@ -234,8 +324,8 @@ static const float normalized_levels[16] = {
                     return { false, 0 };
                 case 0b10: // write
                     if (reg_num[chip_index] < AY_8913_REGISTER_COUNT) {
-                        queueRegisterChange(time_seconds, chip_index, reg_num[chip_index], pa);
-                        if (DEBUG(DEBUG_MOCKINGBOARD)) printf("AY busCycle: write [%lf] chip %u reg %02x val %02x\n", time_seconds, chip_index, reg_num[chip_index], pa);
+                        queueRegisterChange(cycle, chip_index, reg_num[chip_index], pa);
+                        if (DEBUG(DEBUG_MOCKINGBOARD)) printf("AY busCycle: write [%llu] chip %u reg %02x val %02x\n", (unsigned long long)cycle, chip_index, reg_num[chip_index], pa);
                     } else {
                         if (DEBUG(DEBUG_MOCKINGBOARD)) printf("AY busCycle: write ignored (unlatched) chip %u latch=%02x val %02x\n", chip_index, reg_num[chip_index], pa);
                     }
@@ -259,9 +349,9 @@ static const float normalized_levels[16] = {
         }
     
         // Add a register change event
-        void queueRegisterChange(double timestamp, uint8_t chip_index, uint8_t reg, uint8_t value) {
+        void queueRegisterChange(uint64_t cycle, uint8_t chip_index, uint8_t reg, uint8_t value) {
             RegisterEvent event;
-            event.timestamp = timestamp;
+            event.cycle = cycle;
             event.chip_index = chip_index;
             event.register_num = reg;
             event.value = value;
@@ -274,11 +364,12 @@ static const float normalized_levels[16] = {
             chip.live_registers[event.register_num] = event.value;
     
             // for debugging, store the timestamp of event and current emulated time.
-            dbg_last_event = event.timestamp;
-            dbg_last_time = current_time;
+            dbg_last_event = event.cycle;
+            dbg_last_time = position / output_rate;
     
-            if (dbg_last_event < current_time) {
-                printf("[Current Time: %12.6f] Event timestamp is in the past: %12.6f\n", current_time, dbg_last_event);
+            if (dbg_last_event < dbg_last_time) {
+                printf("[Current Cycle: %12llu] Event timestamp is in the past: %12llu\n",
+                    (unsigned long long)dbg_last_time, (unsigned long long)dbg_last_event);
             }
         }
         
@@ -291,7 +382,7 @@ static const float normalized_levels[16] = {
             AY3_8910& chip = chips[event.chip_index];
             chip.registers[event.register_num] = event.value;
             
-            //debug_register_change(current_time, event.chip_index, event.register_num, event.value);
+            //debug_register_change(event.cycle, event.chip_index, event.register_num, event.value);
             if (DEBUG(DEBUG_MOCKINGBOARD)) display_registers();
             
             // Update internal state based on register change
@@ -340,7 +431,6 @@ static const float normalized_levels[16] = {
                     chip.envelope_attack = (chip.envelope_shape & 0x04) != 0;
                     // Set initial output value based on attack/decay
                     chip.envelope_output = chip.envelope_attack ? 0 : 15;
-                    chip.target_envelope_level = get_volume(chip.envelope_output);
                     break;
                     
                 case Ampl_A: // Channel A volume
@@ -350,186 +440,21 @@ static const float normalized_levels[16] = {
                         int channel = event.register_num - Ampl_A;
                         uint16_t volsetting = event.value & 0x0F;
                         // Check if envelope is enabled (bit 4)
-#if 0
                         chip.tone_channels[channel].use_envelope = (event.value & 0x10) != 0;
-                        chip.tone_channels[channel].volume = normalized_levels[volsetting];
-                        //printf("%12.4f|chip %d channel %d use_envelope %d volume %d/%f\n", event.timestamp, event.chip_index, channel, chip.tone_channels[channel].use_envelope, volsetting, chip.tone_channels[channel].volume);
-#endif
-#if 1
-                        if (event.value & 0x10) {
-                            chip.tone_channels[channel].use_envelope = true;
-                            // Set initial volume from current envelope output, normalized to 0-1
-                            chip.tone_channels[channel].volume = normalized_levels[chip.envelope_output];
-                        } else {
-                            chip.tone_channels[channel].use_envelope = false;
-                            // Convert direct volume to 0-1 range
-                            chip.tone_channels[channel].volume = normalized_levels[event.value & 0x0F];
-                        }
-#endif
+                        chip.tone_channels[channel].level = volsetting;
                     }
                     break;
             }
         }
         
-        // Process a single chip clock cycle
-        void processChipCycle(double cycle_time) {
-            // Process any pending register changes that should happen by this time
-            while (!pending_events.empty() && pending_events.front().timestamp <= cycle_time) {
-                processRegisterChange(pending_events.front());
-                pending_events.pop_front();
-            }
-            
-            // Process both chips
-            for (int c = 0; c < 2; c++) {
-                AY3_8910& chip = chips[c];
-#if 1                
-                // Process tone generators
-                for (int i = 0; i < 3; i++) {
-                    ToneChannel& channel = chip.tone_channels[i];
-
-                    // If period is 0 (e.g. right after reset, before the CPU
-                    // has programmed the tone period), do NOT toggle every
-                    // cycle. Toggling at chip_freq while the two chips wait
-                    // for period-register writes to arrive at slightly
-                    // different times would desynchronize them by a large,
-                    // random phase offset on startup.
-                    if (channel.period == 0) {
-                        continue;
-                    }
-
-                    if (channel.counter > 0) {
-                        channel.counter--;
-                        // Check for half period
-                        if (channel.counter == channel.period / 2) {
-                            channel.output = !channel.output;
-                        }
-                    } else {
-                        // Reset counter and toggle output
-                        channel.counter = channel.period;
-                        channel.output = !channel.output;
-                    }
-                }
-#endif            
-#if 0    
-                for (int i = 0; i < 3; i++) {
-                    ToneChannel& ch = chip.tone_channels[i];
-                    ch.counter++;
-                    if (ch.counter >= ch.period/2) {
-                        ch.counter = 0;
-                        ch.output = !ch.output;
-                    }
-                }
-#endif
-                // Process noise generator (simplified)
-                chip.noise_counter--;
-                if (chip.noise_counter <= 0) {
-                    chip.noise_counter = chip.noise_period;
-                    
-                    // Update noise RNG (simplified LFSR)
-                    uint32_t bit0 = chip.noise_rng & 1;
-                    uint32_t bit3 = (chip.noise_rng >> 3) & 1;
-                    uint32_t new_bit = bit0 ^ bit3;
-                    chip.noise_rng = (chip.noise_rng >> 1) | (new_bit << 16);
-                    chip.noise_output = (chip.noise_rng & 1) != 0;  // Use LSB of RNG as noise output
-                }
-            }
-        }
-        
-        // Process envelope generator at correct rate
-        void processEnvelope(double time_step) {
-            for (int c = 0; c < 2; c++) {
-                AY3_8910& chip = chips[c];
-                
-                if (chip.envelope_period > 0) {
-                    // Update envelope counter at the correct rate
-                    chip.envelope_counter++;
-                    if (chip.envelope_counter >= (chip.envelope_period / 16)) {
-                        chip.envelope_counter = 0;
-                        
-                        // Extract control bits
-                        bool hold = (chip.envelope_shape & 0x01) != 0;      // Bit 0 (inverted in hardware)
-                        bool alternate = (chip.envelope_shape & 0x02) != 0; // Bit 1
-                        bool attack = (chip.envelope_shape & 0x04) != 0;    // Bit 2
-                        bool cont = (chip.envelope_shape & 0x08) != 0;      // Bit 3
-                        
-                        // State machine logic
-                        if (chip.envelope_hold) {
-                            // Do nothing when in hold state
-                            return;
-                        }
-                        
-                        if (chip.envelope_attack) {
-                            // In attack (rising) phase
-                            if (chip.envelope_output < 15) {
-                                // Still rising
-                                chip.envelope_output++;
-                                chip.target_envelope_level = get_volume(chip.envelope_output);
-                            } else {
-                                // Reached peak, determine next state
-                                // If continue and hold are both set, determine held value by (attack XOR alternate)
-                                if (cont && hold) {
-                                    bool held_at_15 = attack != alternate; // XOR operation
-                                    chip.envelope_output = held_at_15 ? 15 : 0;
-                                    chip.target_envelope_level = get_volume(chip.envelope_output);
-                                    chip.envelope_hold = true;
-                                }
-                                // Regular processing for other cases
-                                else if (hold) {
-                                    chip.envelope_hold = true;
-                                } else if (!cont) {
-                                    chip.envelope_output = 0;
-                                    chip.target_envelope_level = 0;
-                                    chip.envelope_hold = true;
-                                } else if (alternate) {
-                                    chip.envelope_attack = false; // Switch to decay
-                                } else {
-                                    // Reset to start of phase
-                                    chip.envelope_output = attack ? 0 : 15;
-                                    chip.target_envelope_level = get_volume(chip.envelope_output);
-                                }
-                            }
-                        } else {
-                            // In decay (falling) phase
-                            if (chip.envelope_output > 0) {
-                                // Still falling
-                                chip.envelope_output--;
-                                chip.target_envelope_level = get_volume(chip.envelope_output);
-                            } else {
-                                // Reached zero, determine next state
-                                // If continue and hold are both set, determine held value by (attack XOR alternate)
-                                if (cont && hold) {
-                                    bool held_at_15 = attack != alternate; // XOR operation
-                                    chip.envelope_output = held_at_15 ? 15 : 0;
-                                    chip.target_envelope_level = get_volume(chip.envelope_output);
-                                    chip.envelope_hold = true;
-                                }
-                                // Regular processing for other cases
-                                else if (hold) {
-                                    chip.envelope_hold = true;
-                                } else if (!cont) {
-                                    chip.envelope_hold = true;
-                                } else if (alternate) {
-                                    chip.envelope_attack = true; // Switch to attack
-                                } else {
-                                    // Reset to start of phase
-                                    chip.envelope_output = attack ? 0 : 15;
-                                    chip.target_envelope_level = get_volume(chip.envelope_output);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        
-        // Generate audio samples at 44.1kHz
+        // Generate audio samples at output_rate
         void generateSamples(int num_samples) {
             if (!audio_buffer) {
                 return;  // No buffer to write to
             }
             
             // Debug output for envelope level at start of each call
-            if (0 && DEBUG(DEBUG_MOCKINGBOARD)) std::cout << "[" << current_time << "] Envelope status - Level: " << static_cast<int>(chips[0].envelope_output) 
+            if (0 && DEBUG(DEBUG_MOCKINGBOARD)) std::cout << "[" << tick << "] Envelope status - Level: " << static_cast<int>(chips[0].envelope_output) 
                       << " (counter: " << static_cast<int>(chips[0].envelope_counter) 
                       << "/" << static_cast<int>(chips[0].envelope_period) 
                       << ", shape: " << static_cast<int>(chips[0].envelope_shape)
@@ -537,111 +462,31 @@ static const float normalized_levels[16] = {
                       << ", hold: " << (chips[0].envelope_hold ? "true" : "false")
                       << ")" << std::endl;
             
-            const double output_time_step = 1.0f / OUTPUT_SAMPLE_RATE_INT;
-            const double chip_time_step = 1.0 / CHIP_FREQUENCY;
-            const double envelope_base_frequency = MASTER_CLOCK / ENVELOPE_CLOCK_DIVIDER;
-            const double envelope_base_time_step = 1.0 / envelope_base_frequency;
-            
+            // Every change in a chip's output goes in as a band-limited step at the bus
+            // cycle it happens (see BandLimitedSteps), so edges between sample points
+            // land where they belong instead of aliasing.
+            const uint64_t tick_span = (uint64_t)CLOCK_DIVIDER * output_rate;
+            const float scale = AY_LEVEL_SCALE / (float)(1 << BandLimitedSteps::KERNEL_BITS);
+            uint64_t change = nextChangeTick();
+
             for (int i = 0; i < num_samples; i++) {
-                // Track current time based on the sample index and output time step
-                double sample_time = current_time + (i * output_time_step);
-                time_accumulator += output_time_step;
-                envelope_time_accumulator += output_time_step;
-                
-                // Process all chip cycles that should occur during this output sample
-                while (time_accumulator >= chip_time_step) {
-                    double cycle_time = sample_time - time_accumulator;
-                    processChipCycle(cycle_time);
-                    time_accumulator -= chip_time_step;
-                }
-                
-                // Process envelope at the correct rate (master_clock / 256)
-                while (envelope_time_accumulator >= envelope_base_time_step) {
-                    processEnvelope(envelope_base_time_step);
-                    envelope_time_accumulator -= envelope_base_time_step;
-                }
-                
-                // Do envelope interpolation at audio rate. This makes changes to envelope levels transition smoothly on a per-sample basis.
-                for (int c = 0; c < 2; c++) {
-                    AY3_8910& chip = chips[c];
-                    
-                    // Base the interpolation speed on the envelope period
-                    // Shorter periods need faster interpolation
-                    float base_speed = 0.0003f;  // Our known good value for the test case
-                    float period_factor = 1.0f;
-                    if (chip.envelope_period > 0) {
-                        // Scale interpolation speed inversely with period
-                        // The larger the period, the slower the interpolation should be
-                        period_factor = static_cast<float>(0x3000) / chip.envelope_period;  // 0x3000 is a reference period
-                    }
-                    float interpolation_speed = base_speed * period_factor;
-                    
-                    chip.current_envelope_level += (chip.target_envelope_level - chip.current_envelope_level) * interpolation_speed;
-                    
-                    // Update channel volumes with interpolated value
-                    for (int i = 0; i < 3; i++) {
-                        if (chip.tone_channels[i].use_envelope) {
-                            // Keep as float, divide by 15 here to normalize to 0-1 range
-                            chip.tone_channels[i].volume = chip.current_envelope_level; // target_envelope_level is already normalized to 0-1
-                        }
-                    }
-                }
-                
-                // Mix output from 3 channels of each chip separately.
-                float mixed_output[2] = {0.0f, 0.0f};
-    
-                for (int c = 0; c < 2; c++) {
-    
-                    const AY3_8910& chip = chips[c];
-#if 0
-                    for (int channel = 0; channel < 3; channel++) {
-                        const ToneChannel& tone = chip.tone_channels[channel];
-                        bool tone_dis  = (chip.mixer_control >> channel) & 1;       // 1 = disabled
-                        bool noise_dis = (chip.mixer_control >> (channel + 3)) & 1; // 1 = disabled
-                    
-                        bool tone_gate  = tone.output  || tone_dis;   // disabled = forced open
-                        bool noise_gate = chip.noise_output || noise_dis;
-                    
-                        bool gate = tone_gate && noise_gate;           // AND logic
-                    
-                        float channel_output = gate ? tone.volume : 0.0f;
-                        mixed_output[c] += channel_output;
-                    }
-#endif
-#if 1
-                    for (int channel = 0; channel < 3; channel++) {
-                        const ToneChannel& tone = chip.tone_channels[channel];
-                        bool tone_enabled = !(chip.mixer_control & (1 << channel));
-                        bool noise_enabled = !(chip.mixer_control & (1 << (channel + 3)));
-    
-                        // Only process if the channel has volume
-                        // If either tone or noise is enabled for this channel
-                        bool is_tone = tone_enabled && tone.period > 0 && (chip.registers[Ampl_A + channel] > 0);
-                        bool is_noise = noise_enabled;
-    
-                        if (is_tone || is_noise) {
-                            // For tone: true = +volume, false = -volume
-                            float tone_contribution = tone.output ? tone.volume : 0 /* -tone.volume */;
-                            
-                            // For noise: true = +volume, false = -volume
-                            float noise_contribution = (chip.noise_output ? tone.volume : 0 /* -tone.volume */) /* * 0.6f */;
-                            float channel_output;
-    
-                            // If both are enabled, average them
-                            if (is_tone && is_noise) {
-                                channel_output = (tone_contribution + noise_contribution) /* * 0.5f */;
-                            } else if (is_tone) {
-                                channel_output = tone_contribution;
-                            } else if (is_noise) {
-                                channel_output = noise_contribution;
-                            }
-                            //channel_output = applyLowPassFilter(channel_output, c, channel);
-                            mixed_output[c] += channel_output;
-                        }
+                const uint64_t start = position;
+                const uint64_t end = position + bus_rate;
+
+                while (change * tick_span < end) {
+                    const int phase = (int)((change * tick_span - start) * BandLimitedSteps::PHASES / bus_rate);
+                    const int32_t was[2] = { mix_level[0], mix_level[1] };
+                    skipTicks(change - tick);
+                    runTick();
+                    for (int c = 0; c < 2; c++) {
+                        if (mix_level[c] != was[c]) steps[c].add_step(phase, mix_level[c] - was[c]);
                     }
-#endif
-                    
+                    change = nextChangeTick();
                 }
+                position = end;
+
+                float mixed_output[2] = { (float)steps[0].read() * scale, (float)steps[1].read() * scale };
+
                 // TODO: add checks here to detect overdriving/exceeding -1.0/1.0.
                 // Append the mixed samples to the buffer.
                 //
@@ -668,9 +513,10 @@ static const float normalized_levels[16] = {
                     audio_buffer->push_back(mixed_output[1]);
                 }
             }
-            
-            // Update current_time for the next call
-            current_time += num_samples * output_time_step;
+
+            // Catch the generators up to the present, so register changes queued
+            // before the next call are measured from here.
+            skipTicks((position + tick_span - 1) / tick_span - tick);
         }
         
         // Write audio samples to a WAV file
@@ -765,6 +611,75 @@ static const float normalized_levels[16] = {
         }
     
     
+        // Save / restore. Bus-cycle times (position, tick, queued writes) are shifted onto
+        // the loading machine's clock by whole envelope steps, so every generator keeps its
+        // phase. The output filters and the decorrelation delay just restart.
+        void snapshot(SnapshotIO &io, uint64_t now) {
+            uint64_t saved_now = now;
+            io.field(saved_now);
+            for (AY3_8910 &chip : chips) {
+                for (ToneChannel &t : chip.tone_channels) {
+                    io.field(t.period);
+                    io.field(t.counter);
+                    io.field(t.output);
+                    io.field(t.level);
+                    io.field(t.use_envelope);
+                }
+                io.field(chip.noise_period);
+                io.field(chip.noise_counter);
+                io.field(chip.noise_rng);
+                io.field(chip.noise_output);
+                io.field(chip.mixer_control);
+                io.field(chip.envelope_period);
+                io.field(chip.envelope_shape);
+                io.field(chip.envelope_counter);
+                io.field(chip.envelope_output);
+                io.field(chip.envelope_hold);
+                io.field(chip.envelope_attack);
+                io.bytes(chip.registers, sizeof(chip.registers));
+                io.bytes(chip.live_registers, sizeof(chip.live_registers));
+            }
+            io.bytes(reg_num, sizeof(reg_num));
+            io.field(position);
+            io.field(tick);
+
+            uint32_t count = (uint32_t)pending_events.size();
+            io.field(count);
+            if (!io.loading()) {
+                for (RegisterEvent &e : pending_events) {
+                    io.field(e.cycle);
+                    io.field(e.chip_index);
+                    io.field(e.register_num);
+                    io.field(e.value);
+                }
+                return;
+            }
+
+            int64_t shift = (int64_t)(now - saved_now);
+            shift -= shift % ENVELOPE_CLOCK_DIVIDER;
+            pending_events.clear();
+            for (uint32_t i = 0; i < count && io.ok(); i++) {
+                RegisterEvent e;
+                io.field(e.cycle);
+                io.field(e.chip_index);
+                io.field(e.register_num);
+                io.field(e.value);
+                if (e.chip_index > 1 || e.register_num >= AY_8913_REGISTER_COUNT) continue;
+                e.cycle += shift;
+                pending_events.push_back(e);
+            }
+            position += (uint64_t)shift * output_rate;
+            tick += shift / CLOCK_DIVIDER;
+            for (int c = 0; c < 2; c++) {
+                AY3_8910 &chip = chips[c];
+                if (chip.noise_period == 0) chip.noise_period = 1;
+                mix_level[c] = mixLevel(chip);
+                steps[c].restart(mix_level[c]);
+            }
+            for (size_t i = 0; i < MONO_DECORR_DELAY; i++) r_delay_buf[i] = 0.0f;
+            r_delay_idx = 0;
+        }
+
     private:
         // Filter state
         filter_state filters[7] = {0.0f}; // One state per channel, and one for the mixed output
@@ -774,7 +689,7 @@ static const float normalized_levels[16] = {
             uint16_t period;     // Tone period (12 bits, 0-4095)
             uint16_t counter;    // Current counter value
             bool output;         // Current output state
-            float volume;        // Volume (0-1)
+            uint8_t level;       // Fixed volume setting (0-15)
             bool use_envelope;   // Whether to use envelope generator
         };
         
@@ -792,8 +707,6 @@ static const float normalized_levels[16] = {
             uint8_t envelope_output;   // Current envelope value (0-15) integer.
             bool envelope_hold;        // Whether envelope is holding
             bool envelope_attack;      // Whether envelope is in attack phase
-            float current_envelope_level;  // Interpolated envelope level
-            float target_envelope_level;   // Target level we're interpolating towards
             uint8_t registers[AY_8913_REGISTER_COUNT];  // register states during playback
             uint8_t live_registers[AY_8913_REGISTER_COUNT];  // Live register values as the 6502 sees them
         };
@@ -802,13 +715,19 @@ static const float normalized_levels[16] = {
     public:
         AY3_8910 chips[2];
     
-        double dbg_last_event =0.0f;
-        double dbg_last_time =0.0f;
+        uint64_t dbg_last_event = 0;    // bus cycles
+        uint64_t dbg_last_time = 0;
 
     private:
-        double current_time;
-        double time_accumulator;
-        double envelope_time_accumulator;  // New accumulator for envelope timing
+        // Emulated time is kept in units of 1/output_rate bus cycle, so one output sample
+        // is exactly bus_rate units and one tick CLOCK_DIVIDER * output_rate: no rounding,
+        // no drift.
+        uint64_t bus_rate;                 // bus cycles per second
+        uint32_t output_rate;              // output samples per second
+        uint64_t position = 0;             // end of the last generated sample
+        uint64_t tick = 0;                 // next tick to run; it happens at bus cycle tick * CLOCK_DIVIDER
+        int32_t mix_level[2];              // each chip's output since its last change, in ay_levels units
+        BandLimitedSteps steps[2];         // each chip's output, band-limited to output_rate
         std::deque<RegisterEvent> pending_events;
         std::vector<float>* audio_buffer;  // Pointer to external audio buffer
         AudioSystem *audio_system = nullptr;  // Shared audio settings (decorrelation, etc.)
@@ -836,6 +755,254 @@ static const float normalized_levels[16] = {
         uint8_t reg_num[2];
     
     
+        // Run one tick: apply register changes that are due, step tone and noise
+        // generators, and every TICKS_PER_ENVELOPE ticks the envelope.
+        void runTick() {
+            // Process any pending register changes that should happen by this time
+            const uint64_t cycle = tick * CLOCK_DIVIDER;
+            while (!pending_events.empty() && pending_events.front().cycle <= cycle) {
+                processRegisterChange(pending_events.front());
+                pending_events.pop_front();
+            }
+            
+            // Process both chips
+            for (int c = 0; c < 2; c++) {
+                AY3_8910& chip = chips[c];
+                // Process tone generators
+                for (int i = 0; i < 3; i++) {
+                    ToneChannel& channel = chip.tone_channels[i];
+
+                    // If period is 0 (e.g. right after reset, before the CPU
+                    // has programmed the tone period), do NOT toggle every
+                    // cycle. Toggling at chip_freq while the two chips wait
+                    // for period-register writes to arrive at slightly
+                    // different times would desynchronize them by a large,
+                    // random phase offset on startup.
+                    if (channel.period == 0) {
+                        continue;
+                    }
+
+                    if (channel.counter > 0) {
+                        channel.counter--;
+                        // Check for half period
+                        if (channel.counter == channel.period / 2) {
+                            channel.output = !channel.output;
+                        }
+                    } else {
+                        // Reset counter and toggle output
+                        channel.counter = channel.period;
+                        channel.output = !channel.output;
+                    }
+                }
+
+                // Process noise generator (simplified)
+                chip.noise_counter--;
+                if (chip.noise_counter == 0) {
+                    chip.noise_counter = chip.noise_period;
+                    stepNoise(chip);
+                }
+
+                if ((tick % TICKS_PER_ENVELOPE) == 0 && chip.envelope_period > 0) {
+                    // Update envelope counter at the correct rate
+                    chip.envelope_counter++;
+                    if (chip.envelope_counter >= (chip.envelope_period / 16)) {
+                        chip.envelope_counter = 0;
+                        stepEnvelope(chip);
+                    }
+                }
+                mix_level[c] = mixLevel(chip);
+            }
+            tick++;
+        }
+
+        // Update noise RNG (simplified LFSR)
+        static void stepNoise(AY3_8910& chip) {
+            uint32_t bit0 = chip.noise_rng & 1;
+            uint32_t bit3 = (chip.noise_rng >> 3) & 1;
+            uint32_t new_bit = bit0 ^ bit3;
+            chip.noise_rng = (chip.noise_rng >> 1) | (new_bit << 16);
+            chip.noise_output = (chip.noise_rng & 1) != 0;  // Use LSB of RNG as noise output
+        }
+
+        // Move the envelope one step along its shape.
+        static void stepEnvelope(AY3_8910& chip) {
+            // Extract control bits
+            bool hold = (chip.envelope_shape & 0x01) != 0;      // Bit 0 (inverted in hardware)
+            bool alternate = (chip.envelope_shape & 0x02) != 0; // Bit 1
+            bool attack = (chip.envelope_shape & 0x04) != 0;    // Bit 2
+            bool cont = (chip.envelope_shape & 0x08) != 0;      // Bit 3
+            
+            // State machine logic
+            if (chip.envelope_hold) {
+                // Do nothing when in hold state
+                return;
+            }
+            
+            if (chip.envelope_attack) {
+                // In attack (rising) phase
+                if (chip.envelope_output < 15) {
+                    // Still rising
+                    chip.envelope_output++;
+                } else {
+                    // Reached peak, determine next state
+                    // If continue and hold are both set, determine held value by (attack XOR alternate)
+                    if (cont && hold) {
+                        bool held_at_15 = attack != alternate; // XOR operation
+                        chip.envelope_output = held_at_15 ? 15 : 0;
+                        chip.envelope_hold = true;
+                    }
+                    // Regular processing for other cases
+                    else if (hold) {
+                        chip.envelope_hold = true;
+                    } else if (!cont) {
+                        chip.envelope_output = 0;
+                        chip.envelope_hold = true;
+                    } else if (alternate) {
+                        chip.envelope_attack = false; // Switch to decay
+                    } else {
+                        // Reset to start of phase
+                        chip.envelope_output = attack ? 0 : 15;
+                    }
+                }
+            } else {
+                // In decay (falling) phase
+                if (chip.envelope_output > 0) {
+                    // Still falling
+                    chip.envelope_output--;
+                } else {
+                    // Reached zero, determine next state
+                    // If continue and hold are both set, determine held value by (attack XOR alternate)
+                    if (cont && hold) {
+                        bool held_at_15 = attack != alternate; // XOR operation
+                        chip.envelope_output = held_at_15 ? 15 : 0;
+                        chip.envelope_hold = true;
+                    }
+                    // Regular processing for other cases
+                    else if (hold) {
+                        chip.envelope_hold = true;
+                    } else if (!cont) {
+                        chip.envelope_hold = true;
+                    } else if (alternate) {
+                        chip.envelope_attack = true; // Switch to attack
+                    } else {
+                        // Reset to start of phase
+                        chip.envelope_output = attack ? 0 : 15;
+                    }
+                }
+            }
+        }
+
+        // Mix the 3 channels of a chip as they stand.
+        int32_t mixLevel(const AY3_8910& chip) const {
+            int32_t output = 0;
+            for (int channel = 0; channel < 3; channel++) {
+                const ToneChannel& tone = chip.tone_channels[channel];
+                bool tone_enabled = !(chip.mixer_control & (1 << channel));
+                bool noise_enabled = !(chip.mixer_control & (1 << (channel + 3)));
+                // A tone is only heard with a period and a non-zero amplitude register;
+                // tone and noise add when both are enabled.
+                bool is_tone = tone_enabled && tone.period > 0 && (chip.registers[Ampl_A + channel] > 0);
+                // The envelope plays its steps as they are, like the chip's 16-level DAC.
+                // The old engine eased toward each step with a one-pole whose rate scaled
+                // with 0x3000 / period (a 75ms time constant at period $3000), so fades
+                // lagged and short-period envelopes used as waveforms lost their shape.
+                // It hid the staircase aliasing of point sampling; BandLimitedSteps
+                // takes care of that now.
+                int32_t level = ay_levels[tone.use_envelope ? chip.envelope_output : tone.level];
+
+                if (is_tone && tone.output) output += level;
+                if (noise_enabled && chip.noise_output) output += level;
+            }
+            return output;
+        }
+
+        // Ticks from the next one to run up to and including the first that can change
+        // this chip's output: a tone edge, a noise step while noise is mixed in, or an
+        // envelope step while a channel follows the envelope.
+        uint64_t ticksUntilChange(const AY3_8910& chip) const {
+            uint64_t ticks = MAX_RUN_TICKS;
+            bool noise_heard = false;
+            bool envelope_heard = false;
+            for (int i = 0; i < 3; i++) {
+                const ToneChannel& tone = chip.tone_channels[i];
+                if (tone.period != 0) {
+                    const uint16_t half = tone.period / 2;
+                    if (tone.counter == 0) ticks = 1;
+                    else if (tone.counter > half) ticks = std::min<uint64_t>(ticks, tone.counter - half);
+                    else ticks = std::min<uint64_t>(ticks, tone.counter + 1);
+                }
+                noise_heard |= !(chip.mixer_control & (1 << (i + 3)));
+                envelope_heard |= tone.use_envelope;
+            }
+            if (noise_heard) {
+                ticks = std::min<uint64_t>(ticks, chip.noise_counter);
+            }
+            if (envelope_heard && chip.envelope_period > 0 && !chip.envelope_hold) {
+                const uint16_t step_at = chip.envelope_period / 16;
+                const uint64_t steps = (chip.envelope_counter + 1 >= step_at) ? 1 : step_at - chip.envelope_counter;
+                const uint64_t first = (tick + TICKS_PER_ENVELOPE - 1) / TICKS_PER_ENVELOPE * TICKS_PER_ENVELOPE;
+                ticks = std::min(ticks, first + (steps - 1) * TICKS_PER_ENVELOPE - tick + 1);
+            }
+            return ticks;
+        }
+
+        // The next tick that can change the output: see ticksUntilChange, plus the tick
+        // the next register change is due at.
+        uint64_t nextChangeTick() const {
+            uint64_t ticks = std::min(ticksUntilChange(chips[0]), ticksUntilChange(chips[1]));
+            if (!pending_events.empty()) {
+                const uint64_t due = (pending_events.front().cycle + CLOCK_DIVIDER - 1) / CLOCK_DIVIDER;
+                ticks = std::min(ticks, due > tick ? due - tick + 1 : 1);
+            }
+            return tick + ticks - 1;
+        }
+
+        // Advance over count ticks that leave the output as it is. Tone and audible
+        // noise and envelope generators only count down; noise and envelope nobody
+        // hears still step, so they are where they should be when unmuted.
+        void skipTicks(uint64_t count) {
+            if (count == 0) return;
+            const uint64_t envelope_ticks = (tick + count + TICKS_PER_ENVELOPE - 1) / TICKS_PER_ENVELOPE -
+                                            (tick + TICKS_PER_ENVELOPE - 1) / TICKS_PER_ENVELOPE;
+            for (int c = 0; c < 2; c++) {
+                AY3_8910& chip = chips[c];
+                for (int i = 0; i < 3; i++) {
+                    if (chip.tone_channels[i].period != 0) {
+                        chip.tone_channels[i].counter -= (uint16_t)count;
+                    }
+                }
+
+                uint64_t left = count;
+                while (left >= chip.noise_counter) {
+                    left -= chip.noise_counter;
+                    chip.noise_counter = chip.noise_period;
+                    stepNoise(chip);
+                }
+                chip.noise_counter -= (uint16_t)left;
+
+                if (chip.envelope_period > 0) {
+                    const uint16_t step_at = std::max(chip.envelope_period / 16, 1);
+                    left = envelope_ticks;
+                    while (left > 0) {
+                        const uint64_t steps = (chip.envelope_counter + 1 >= step_at) ? 1 : step_at - chip.envelope_counter;
+                        if (left < steps) {
+                            chip.envelope_counter += (uint16_t)left;
+                            break;
+                        }
+                        left -= steps;
+                        chip.envelope_counter = 0;
+                        if (chip.envelope_hold) {
+                            // Further steps change nothing; only the counter moves.
+                            chip.envelope_counter = (uint16_t)(left % step_at);
+                            break;
+                        }
+                        stepEnvelope(chip);
+                    }
+                }
+            }
+            tick += count;
+        }
+
         // Helper function to write a 16-bit value to a file
         void write16(std::ofstream& file, uint16_t value) {
             file.write(reinterpret_cast<const char*>(&value), sizeof(value));
@@ -23,6 +23,7 @@
 #include "debug.hpp"
 #include "util/DebugFormatter.hpp"
 #include "util/InterruptController.hpp"
+#include "util/Snapshot.hpp"
 #include "regs.hpp"
 
 #define MB_6522_1 0x00
@@ -180,6 +181,31 @@ public:
     inline uint8_t get_ddra() const { return ddra; }
     inline uint8_t get_ddrb() const { return ddrb; }
 
+    void snapshot(SnapshotIO &io) {
+        io.field(ora);
+        io.field(ira);
+        io.field(orb);
+        io.field(irb);
+        io.field(ddra);
+        io.field(ddrb);
+        io.field(sr);
+        io.field(acr);
+        io.field(pcr);
+        io.field(ifr.value);
+        io.field(ier.value);
+        io.field(t1_latch);
+        io.field(t1_counter);
+        io.field(t2_latch);
+        io.field(t2_counter);
+        io.field(t1_oneshot_pending);
+        io.field(t2_oneshot_pending);
+        io.field(t1_rollover);
+        io.field(t2_rollover);
+        io.field(t1_skip_next_decrement);
+        io.field(t2_skip_next_decrement);
+        if (io.loading()) update_interrupt();
+    }
+
     void update_interrupt() {
         // for each chip, calculate the IFR bit 7.
 
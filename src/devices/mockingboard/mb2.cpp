@@ -119,7 +119,6 @@ private:
     float samples_per_frame;
     uint32_t samples_per_frame_int;
     float samples_per_frame_remainder;
-    uint64_t vid_cycles_rate;
 
     NClock *clock;
 
@@ -159,7 +158,6 @@ public:
         samples_per_frame = (float)OUTPUT_SAMPLE_RATE_INT / frame_rate;
         samples_per_frame_int = (int32_t)samples_per_frame;
         samples_per_frame_remainder = samples_per_frame - samples_per_frame_int;
-        vid_cycles_rate = clock->get_vid_cycles_per_second();
 
         stream = audio_system->create_stream(OUTPUT_SAMPLE_RATE_INT, 2, SDL_AUDIO_F32LE, false);
 
@@ -194,8 +192,7 @@ public:
         if (reg == MB_6522_ORB) {
             uint8_t pa = n6522[chip]->get_ora() & n6522[chip]->get_ddra();
             uint8_t pb = n6522[chip]->get_orb() & n6522[chip]->get_ddrb();
-            double  t  = (double)clock->get_vid_cycles() / (double)vid_cycles_rate;
-            AyBusResult r = ay8910s->busCycle(chip, pa, pb, t);
+            AyBusResult r = ay8910s->busCycle(chip, pa, pb, clock->get_vid_cycles());
             if (r.drove_data) {
                 n6522[chip]->set_ira(r.data);
             } else {
@@ -263,6 +260,13 @@ public:
         n6522[1]->set_ira(0xFF);
     }
 
+    void snapshot(SnapshotIO &io) {
+        n6522[0]->snapshot(io);
+        n6522[1]->snapshot(io);
+        ay8910s->snapshot(io, clock->get_vid_cycles());
+        if (io.loading()) last_cycle = clock->get_vid_cycles();
+    }
+
     DebugFormatter *debug() {
         DebugFormatter *df = new DebugFormatter();
         n6522[0]->debug(df);
@@ -310,6 +314,11 @@ void init_slot_mockingboard(computer_t *computer, SlotType_t slot) {
             return true;
         });
 
+    computer->register_state_handler("mockingboard" + std::to_string((int)slot),
+        [mb_d](SnapshotIO &io) {
+            mb_d->mockingboard->snapshot(io);
+        });
+
     // this can move to the class
     // register a frame processor for the mockingboard.
     computer->device_frame_dispatcher->registerHandler([mb_d,computer]() {
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstdio>
 #include "util/media.hpp"
+#include "util/BlockImage.hpp"
 #include "SlotData.hpp"
 #include "util/StorageDevice.hpp"
 
@@ -29,7 +30,7 @@ using packed24 = packed_uint<3>;
 using packed32 = packed_uint<4>;
 
 struct media_t {
-    FILE *file;
+    BlockImage *file;
     media_descriptor *media;
     storage_key_t key;
     int last_block_accessed;
@@ -67,59 +67,53 @@ uint8_t pdblock2_status(pdblock2_data *pdblock_d, uint8_t drive) {
 /**
  * These two routines read and write a block to the media.
  * They take into account the media descriptor and the data offset.
- * They read and write memory to the MMU using the MMU functions
- * that take into account the memory map, so, we can write data into
- * any bank selected as the CPU (or a 'DMA' device like us) would see it.
+ * They move the data with the MMU's DMA block transfers, which take
+ * into account the memory map, so, we can write data into any bank
+ * selected as the CPU (or a 'DMA' device like us) would see it,
+ * without burning CPU cycles.
  * slot and drive here might be virtual as one physical slot can map drives
  * to a different virtual slot.
  */
 void pdblock2_read_block(pdblock2_data *pdblock_d, uint8_t drive, uint16_t block, uint16_t addr) {
 
-    // TODO: read the block into the address.
-    /* static */ uint8_t block_buffer[512]; // uhh, no!
-    FILE *fp = pdblock_d->drives[drive].file;
+    uint8_t block_buffer[512];
+    BlockImage *image = pdblock_d->drives[drive].file;
     
     media_descriptor *media = pdblock_d->drives[drive].media;
-
-    if (fseek(fp, media->data_offset + (block * media->block_size), SEEK_SET) < 0) {
+    if (media->block_size == 0 || media->block_size > sizeof(block_buffer)) {
         pdblock_d->cmd_buffer.error = PD_ERROR_IO;
+        return;
     }
-    size_t bytes_read = fread(block_buffer, 1, media->block_size, fp);
-    if (bytes_read != media->block_size) {
+
+    if (!image->read(media->data_offset + ((uint64_t)block * media->block_size), block_buffer, media->block_size)) {
         pdblock_d->cmd_buffer.error = PD_ERROR_IO;
+        memset(block_buffer, 0, media->block_size);
     }
-    for (int i = 0; i < media->block_size; i++) {
-        // TODO: for dma we want to simulate the memory map but do not want to burn cycles.
-        // the CPU would halt during a DMA and not tick cycles even though the rest of the bus
-        // is following the system clock.
-        // TODO: So we need a dma_write_memory and dma_read_memory set of routines that do that.
-        //write_memory(cpu, addr + i, block_buffer[i]); 
-        // oops, this is writing into the megaii.
-        pdblock_d->mmu->write(addr + i, block_buffer[i]); 
-    }
+    // oops, this is writing into the megaii.
+    pdblock_d->mmu->write_block(addr, block_buffer, media->block_size);
     pdblock_d->drives[drive].last_block_accessed = block;
     pdblock_d->drives[drive].last_block_access_time = SDL_GetTicksNS();
 }
 
 void pdblock2_write_block(pdblock2_data *pdblock_d, uint8_t drive, uint16_t block, uint16_t addr) {
 
-    // TODO: read the block into the address.
-    /* static */ uint8_t block_buffer[512];
-    FILE *fp = pdblock_d->drives[drive].file;
+    uint8_t block_buffer[512];
+    BlockImage *image = pdblock_d->drives[drive].file;
     media_descriptor *media = pdblock_d->drives[drive].media;
 
     if (media->write_protected) {
         pdblock_d->cmd_buffer.error = PD_ERROR_WRITE_PROTECTED;
         return;
     }
+    if (media->block_size == 0 || media->block_size > sizeof(block_buffer)) {
+        pdblock_d->cmd_buffer.error = PD_ERROR_IO;
+        return;
+    }
 
-    for (int i = 0; i < media->block_size; i++) {
-        // TODO: for dma we want to simulate the memory map but do not want to burn cycles.
-        //block_buffer[i] = read_memory(cpu, addr + i); 
-        block_buffer[i] = pdblock_d->mmu->read(addr + i); 
+    pdblock_d->mmu->read_block(addr, block_buffer, media->block_size);
+    if (!image->write(media->data_offset + ((uint64_t)block * media->block_size), block_buffer, media->block_size)) {
+        pdblock_d->cmd_buffer.error = PD_ERROR_IO;
     }
-    fseek(fp, media->data_offset + (block * media->block_size), SEEK_SET);
-    fwrite(block_buffer, 1, media->block_size, fp);
     pdblock_d->drives[drive].last_block_accessed = block;
     pdblock_d->drives[drive].last_block_access_time = SDL_GetTicksNS();
 }
@@ -199,13 +193,14 @@ bool mount_pdblock2(pdblock2_data *pdblock_d, uint8_t drive, media_descriptor *m
     //if (DEBUG(DEBUG_PD_BLOCK)) printf("Mounting ProDOS block device %s slot %d drive %d\n", media->filename, slot, drive);
     if (DEBUG(DEBUG_PD_BLOCK)) std::cout << "Mounting ProDOS block device " << media->filename << " slot: " << pdblock_d->_slot << " drive " << drive << std::endl;
 
-    const char *mode = media->write_protected ? "rb" : "r+b";
-    FILE *fp = fopen(media->filename.c_str(), mode);
-    if (fp == nullptr) {
+    BlockImage *image = new BlockImage();
+    if (!image->open(media->filename, media->write_protected)) {
         std::cerr << "Could not open ProDOS block device file: " << media->filename << std::endl;
+        delete image;
         return false;
     }
-    pdblock_d->drives[drive].file = fp;
+    image->set_sync_writes(gs2_app_values.sync_block_writes);
+    pdblock_d->drives[drive].file = image;
     pdblock_d->drives[drive].media = media;
     return true;
 }
@@ -214,7 +209,7 @@ bool unmount_pdblock2(pdblock2_data *pdblock_d, storage_key_t key) {
     uint8_t drive = key.drive;
 
     if (pdblock_d->drives[drive].file) {
-        fclose(pdblock_d->drives[drive].file);
+        delete pdblock_d->drives[drive].file;
         pdblock_d->drives[drive].file = nullptr;
         pdblock_d->drives[drive].media = nullptr;
     }
@@ -272,6 +267,7 @@ void init_pdblock2(computer_t *computer, SlotType_t slot)
     pdblock_d->cmd_buffer.error = 0x00;
     pdblock_d->cmd_buffer.status1 = 0x00;
     pdblock_d->cmd_buffer.status2 = 0x00;
+    // DMA goes through the CPU's MMU (MMU_IIgs on the IIgs), so watch traps see it.
     pdblock_d->mmu = computer->cpu->mmu;
     pdblock_d->_slot = slot;
 
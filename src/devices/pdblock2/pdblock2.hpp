@@ -76,7 +76,8 @@ class PDBlockThunk : public StorageDevice {
             return unmount_pdblock2(pdblock_d, key);
         }
         bool writeback(storage_key_t key) override {
-            return true;
+            BlockImage *image = pdblock_d->drives[key.drive].file;
+            return image ? image->flush() : true;
         }
         drive_status_t status(storage_key_t key) override {
             return pdblock2_osd_status(pdblock_d, key);
@@ -57,37 +57,40 @@ private:
     std::unordered_map<storage_key_t, key_info_t> key_info;
 
     struct open_file_t {
-        FILE *fp = nullptr;
+        BlockImage *image = nullptr;
         int refs = 0;
     };
     std::unordered_map<std::string, open_file_t> open_files;
 
-    FILE *acquire_file(const std::string& filename, bool write_protected) {
+    BlockImage *acquire_file(const std::string& filename, bool write_protected) {
         auto it = open_files.find(filename);
-        if (it != open_files.end() && it->second.fp) {
+        if (it != open_files.end() && it->second.image) {
             it->second.refs++;
-            return it->second.fp;
+            return it->second.image;
         }
-        const char *mode = write_protected ? "rb" : "r+b";
-        FILE *fp = fopen(filename.c_str(), mode);
-        if (fp == nullptr) return nullptr;
-        open_files[filename] = {fp, 1};
-        return fp;
+        BlockImage *image = new BlockImage();
+        if (!image->open(filename, write_protected)) {
+            delete image;
+            return nullptr;
+        }
+        image->set_sync_writes(gs2_app_values.sync_block_writes);
+        open_files[filename] = {image, 1};
+        return image;
     }
 
-    void release_file(FILE *fp) {
-        if (fp == nullptr) return;
+    void release_file(BlockImage *image) {
+        if (image == nullptr) return;
         for (auto it = open_files.begin(); it != open_files.end(); ++it) {
-            if (it->second.fp == fp) {
+            if (it->second.image == image) {
                 it->second.refs--;
                 if (it->second.refs <= 0) {
-                    fclose(fp);
+                    delete image;
                     open_files.erase(it);
                 }
                 return;
             }
         }
-        fclose(fp);
+        delete image;
     }
 
 public:
@@ -121,15 +124,11 @@ public:
     }
 
     void read_from_memory(uint32_t addr, uint8_t *cb, uint8_t size) {
-        for (int i = 0; i < size; i++) {
-            cb[i] = mmu->read(addr + i);
-        }
+        mmu->read_block(addr, cb, size);
     }
 
     void write_to_memory(uint32_t addr, uint8_t *data, uint8_t size) {
-        for (int i = 0; i < size; i++) {
-            mmu->write(addr + i, data[i]);
-        }
+        mmu->write_block(addr, data, size);
     }
 
     uint8_t internal_status(uint8_t drive) {
@@ -144,9 +143,9 @@ public:
     /**
     * These two routines read and write a block to the media.
     * They take into account the media descriptor and the data offset.
-    * They read and write memory to the MMU using the MMU functions
-    * that take into account the memory map, so, we can write data into
-    * any bank selected as the CPU (or a 'DMA' device like us) would see it.
+    * They move the data with the MMU's DMA block transfers, which take
+    * into account the memory map, so, we can write data into any bank
+    * selected as the CPU (or a 'DMA' device like us) would see it.
     * slot and drive here might be virtual as one physical slot can map drives
     * to a different virtual slot.
     */
@@ -158,7 +157,7 @@ public:
 
         key_info[drives[drive].key].last_active_unit = drive; // mark this as the last active unit for this key
 
-        FILE *fp = drives[drive].file;
+        BlockImage *image = drives[drive].file;
         media_descriptor *media = drives[drive].media;
 
         if (media->block_size == 0 || media->block_size > 512) {
@@ -169,16 +168,11 @@ public:
             cmd_buffer.error = PD_ERROR_IO;
             return;
         }
-        if (fseek(fp, media->data_offset + (block * media->block_size), SEEK_SET) < 0) {
-            cmd_buffer.error = PD_ERROR_IO;
-        }
-        size_t bytes_read = fread(block_buffer, 1, media->block_size, fp);
-        if (bytes_read != media->block_size) {
+        if (!image->read(media->data_offset + ((uint64_t)block * media->block_size), block_buffer, media->block_size)) {
             cmd_buffer.error = PD_ERROR_IO;
+            memset(block_buffer, 0, media->block_size);
         }
-        for (int i = 0; i < media->block_size; i++) {
-            mmu->write(addr + i, block_buffer[i]); 
-        }
+        mmu->write_block(addr, block_buffer, media->block_size);
         drives[drive].last_block_accessed = block;
         drives[drive].last_block_access_time = SDL_GetTicksNS();
     }
@@ -191,7 +185,7 @@ public:
 
         key_info[drives[drive].key].last_active_unit = drive; // mark this as the last active unit for this key
 
-        FILE *fp = drives[drive].file;
+        BlockImage *image = drives[drive].file;
         media_descriptor *media = drives[drive].media;
 
         if (media->block_size == 0 || media->block_size > 512) {
@@ -208,11 +202,10 @@ public:
             return;
         }
 
-        for (int i = 0; i < media->block_size; i++) {
-            block_buffer[i] = mmu->read(addr + i); 
+        mmu->read_block(addr, block_buffer, media->block_size);
+        if (!image->write(media->data_offset + ((uint64_t)block * media->block_size), block_buffer, media->block_size)) {
+            cmd_buffer.error = PD_ERROR_IO;
         }
-        fseek(fp, media->data_offset + (block * media->block_size), SEEK_SET);
-        fwrite(block_buffer, 1, media->block_size, fp);
         drives[drive].last_block_accessed = block;
         drives[drive].last_block_access_time = SDL_GetTicksNS();
     }
@@ -443,12 +436,12 @@ public:
         //if (DEBUG(DEBUG_PD_BLOCK)) printf("Mounting ProDOS block device %s slot %d drive %d\n", media->filename, slot, drive);
         if (DEBUG(DEBUG_PD_BLOCK)) std::cout << "Mounting PDB3 device " << media->filename << " slot: " << _slot << " drive " << key.drive << std::endl;
         
-        FILE *fp = acquire_file(media->filename, media->write_protected);
-        if (fp == nullptr) {
+        BlockImage *image = acquire_file(media->filename, media->write_protected);
+        if (image == nullptr) {
             std::cerr << "Could not open PDB3 device file: " << media->filename << std::endl;
             return false;
         }
-        drives[key.drive].file = fp;
+        drives[key.drive].file = image;
         drives[key.drive].media = media;
         disk_switched[key.drive] = true;
         return true;
@@ -545,8 +538,8 @@ public:
             //if (DEBUG(DEBUG_PD_BLOCK)) printf("Mounting ProDOS block device %s slot %d drive %d\n", media->filename, slot, drive);
             if (DEBUG(DEBUG_PD_BLOCK)) std::cout << "Mounting PDB3 device " << media->filename << " slot: " << _slot << " drive " << key.drive << std::endl;
             
-            FILE *fp = acquire_file(media->filename, media->write_protected);
-            if (fp == nullptr) {
+            BlockImage *image = acquire_file(media->filename, media->write_protected);
+            if (image == nullptr) {
                 std::cerr << "Could not open PDB3 device file: " << media->filename << std::endl;
                 for (int u : assigned) {
                     release_file(drives[u].file);
@@ -557,7 +550,7 @@ public:
                 key_info[key].tooltip.resize(tooltip_before);
                 return false;
             }
-            drives[unused_unit].file = fp;
+            drives[unused_unit].file = image;
             drives[unused_unit].media = media;
             drives[unused_unit].key = key;  // mark this as being mounted on this key
             disk_switched[unused_unit] = true;
@@ -611,7 +604,11 @@ public:
     }
 
     bool writeback(storage_key_t key) {
-        return true;
+        bool ok = true;
+        for (auto &[name, open_file] : open_files) {
+            if (open_file.image && !open_file.image->flush()) ok = false;
+        }
+        return ok;
     }
 
     drive_status_t statuso(storage_key_t key) {
@@ -775,6 +772,7 @@ void init_pdblock3(computer_t *computer, SlotType_t slot)
     pdblock3_data * pdblock_d = new pdblock3_data;
     pdblock_d->id = DEVICE_ID_PD_BLOCK2;
     
+    // DMA goes through the CPU's MMU (MMU_IIgs on the IIgs), so watch traps see it.
     pdblock_d->mmu = computer->cpu->mmu;
     pdblock_d->megaii = computer->mmu; // these could be the same (iie) or different (iigs)
     pdblock_d->_slot = slot;
@@ -7,6 +7,7 @@
 #include <string>
 
 #include "util/DebugFormatter.hpp"
+#include "util/Snapshot.hpp"
 #include "debug.hpp"
 
 #define RTC_START_TRANS 0b100
@@ -77,6 +78,18 @@ public:
         save_bram_to_file(bram_filename.c_str());
     };
 
+    // The clock itself follows host time and isn't saved.
+    void snapshot(SnapshotIO &io) {
+        io.field(ctl_reg_byte);
+        io.bytes(command_reg, sizeof(command_reg));
+        io.field(data_reg);
+        io.field(test_reg);
+        io.bytes(bram, sizeof(bram));
+        io.field(transaction_step_count);
+        io.field(state);
+        if (io.loading() && state > RTC_STATE_AWAIT_DATA) state = RTC_STATE_AWAIT_COMMAND;
+    }
+
     inline uint8_t get_bram_value(uint8_t address) {
         return bram[address];
     }
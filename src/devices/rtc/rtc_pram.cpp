@@ -75,6 +75,10 @@ void init_slot_rtc_pram(computer_t *computer, SlotType_t slot) {
     computer->mmu->set_C0XX_write_handler(0xC034, { rtc_pram_write_C034, st });
     computer->mmu->set_C0XX_read_handler(0xC034, { rtc_pram_read_C034, st });
     
+    computer->register_state_handler("rtc", [st](SnapshotIO &io) {
+        st->rtc->snapshot(io);
+    });
+
     computer->register_shutdown_handler([st]() {
         delete st->rtc;
         delete st;
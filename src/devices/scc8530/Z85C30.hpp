@@ -5,6 +5,7 @@
 #include "util/DebugFormatter.hpp"
 #include "util/InterruptController.hpp"
 #include "util/EventTimer.hpp"
+#include "util/Snapshot.hpp"
 #include "NClock.hpp"
 #include "serial_devices/SerialDevice.hpp"
 
@@ -587,6 +588,35 @@ class Z85C30 {
 
         ~Z85C30() {}
 
+        void snapshot(SnapshotIO &io) {
+            for (int ch = 0; ch < SCC_CHANNEL_COUNT; ch++) {
+                scc_channel_state_t &r = registers[ch];
+                io.field(r.char_rx);
+                io.field(r.char_tx);
+                io.field(r.tx_in_progress);
+                io.field(r.rx_in_progress);
+                io.field(r.r_reg_0);
+                io.field(r.r_reg_1);
+                io.field(r.r_reg_3);
+                io.field(r.r_reg_10);
+                io.field(r.tx_irq_condition);
+                io.bytes(r.w_regs, sizeof(r.w_regs));
+                io.field(reg_select[ch]);
+            }
+            if (io.loading()) {
+                update_timing_sources(SCC_CHANNEL_A);
+                update_timing_sources(SCC_CHANNEL_B);
+            }
+            // characters in flight
+            if (event_timer && clock) {
+                const uint64_t now = clock->get_c14m();
+                for (int ch = 0; ch < SCC_CHANNEL_COUNT; ch++) {
+                    event_timer->snapshot_event(io, now, tx_timer_id[ch], tx_complete_callback, this);
+                    event_timer->snapshot_event(io, now, rx_timer_id[ch], rx_complete_callback, this);
+                }
+            }
+        }
+
        /*  void set_data_file(scc_channel_t channel, FILE *data_file) {
             this->data_files[channel] = data_file;
         } */
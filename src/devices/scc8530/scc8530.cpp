@@ -117,4 +117,7 @@ void init_scc8530_slot(computer_t *computer, SlotType_t slot) {
         st->scc->reset();
         return true;
     });
+    computer->register_state_handler("scc", [st](SnapshotIO &io) {
+        st->scc->snapshot(io);
+    });
 }
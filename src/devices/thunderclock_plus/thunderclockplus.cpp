@@ -50,12 +50,6 @@ https://retrocomputing.stackexchange.com/questions/5512/is-the-apple-ii-no-slot-
 #define HZ256 256
 #define HZ1024 1024
 
-uint8_t thunderclock_command_register = 0;
-uint64_t thunderclock_time_register = 0;
-uint8_t thunderclock_interrupt_asserted = 0;
-uint8_t thunderblock_interrupt_rate = HZ64;
-
-
 // Returns 40 bits of time data in Thunderclock Plus format
 // the LSB of our 40-bit register is the LSB of the seconds-units field.
 uint64_t get_thunderclock_time() {
@@ -91,10 +85,10 @@ uint64_t get_thunderclock_time() {
 uint8_t thunderclock_read_register(void *context, uint32_t address) {
     thunderclock_state * thunderclock_d = (thunderclock_state *)context;
 
-    fprintf(stderr, "Thunderclock Plus read register %04X => %02X\n", address, thunderclock_command_register);
+    fprintf(stderr, "Thunderclock Plus read register %04X => %02X\n", address, thunderclock_d->command_register);
     
-    uint8_t bit = (thunderclock_time_register & 0x01) << 7;
-    uint8_t reg = thunderclock_command_register;
+    uint8_t bit = (thunderclock_d->time_register & 0x01) << 7;
+    uint8_t reg = thunderclock_d->command_register;
     reg = (reg & (~TCP_OUT)) | bit;
     return reg;
 }
@@ -103,21 +97,21 @@ void thunderclock_write_register(void *context, uint32_t address, uint8_t value)
     thunderclock_state * thunderclock_d = (thunderclock_state *)context;
     fprintf(stderr, "Thunderclock Plus write register %X value %X\n", address, value);
     // check for strobe HI to LO transition. Then perform commmand.
-    if ((thunderclock_command_register & TCP_STB) && ((value & TCP_STB) == 0)) {
+    if ((thunderclock_d->command_register & TCP_STB) && ((value & TCP_STB) == 0)) {
         // read the command register.
         if ((value & TCP_CMD) == TCP_CMD_READ_TIME) {
-            thunderclock_time_register = get_thunderclock_time();
-            fprintf(stderr, "Thunderclock Plus read time: %llX\n", u64_t(thunderclock_time_register));
+            thunderclock_d->time_register = get_thunderclock_time();
+            fprintf(stderr, "Thunderclock Plus read time: %llX\n", u64_t(thunderclock_d->time_register));
         }
     }
-    if ((thunderclock_command_register & TCP_CLK) && ((value & TCP_CLK) == 0)) {
+    if ((thunderclock_d->command_register & TCP_CLK) && ((value & TCP_CLK) == 0)) {
         // shift the time register right on a 1 to 0 transition of the clock bit.
         fprintf(stderr, "Thunderclock Plus CLK tick - shift time right\n");
-        thunderclock_time_register >>= 1;
+        thunderclock_d->time_register >>= 1;
     }
 
     // remember the value.
-    thunderclock_command_register = value;
+    thunderclock_d->command_register = value;
 
 }
 
@@ -29,6 +29,7 @@
 #include "util/dialog.hpp"
 
 #include "display/ntsc.hpp"
+#include "display/render_pipeline.hpp"
 
 #include "videosystem.hpp"
 #include "devices/displaypp/CharRom.hpp"
@@ -71,13 +72,13 @@ constexpr SDL_FRect content_rec_vsg2[4][2] = {
     { { 168.0-42, 35.0-19, 560+42+42, 192.0+19+29 }, { 192.0-48.0, 35.0-19.0, 640.0+48+48, 200+19+21.0 } },
 };
 
-bool update_display_apple2_cycle(display_state_t *ds) {
+/*
+ * Pick the generator and renderer for the color engine and push the settings the
+ * softswitches have recorded into it. Only called while the render worker is idle.
+ */
+static void prepare_vsg(display_state_t *ds) {
     video_system_t *vs = ds->video_system;
 
-    ScanBuffer *scanbuf = ds->video_scanner->get_frame_scan();
-
-    // TODO: This stuff takes basically no time, but it might make more sense to encap this in a helper routine somewhere else
-
     switch (vs->display_color_engine) {
         case DM_ENGINE_MONO:
             ds->vsg = ds->vsgc;
@@ -96,9 +97,36 @@ bool update_display_apple2_cycle(display_state_t *ds) {
             assert(false && "Invalid display color engine");
     }
 
-    ds->frame_vsg->open();
-    ds->vsg->generate_frame(scanbuf);
-    ds->frame_vsg->close();
+    if (ds->vsg->get_mono_mode() != ds->vsg_mono) ds->vsg->set_mono_mode(ds->vsg_mono);
+    ds->vsg->set_dhgr_mono_mode(ds->vsg_dhgr_mono);
+    ds->vsg->set_char_set((ds->f_langsel & 0xE0) >> 5);
+    if (ds->vsg_dump_next) {
+        ds->vsg->setDumpNextFrame(true);
+        ds->vsg_dump_next = false;
+    }
+}
+
+/**
+ * Present the Apple II frame. Normally (async) the frame just emulated goes to the
+ * render worker and the one it finished last time is shown; forced and step frames
+ * (async false) are generated here so they show what is in memory right now.
+ */
+static bool display_render_apple2(display_state_t *ds, bool async) {
+    computer_t *computer = ds->computer;
+    RenderPipeline *pipeline = ds->pipeline;
+
+    FrameVSG *frame = pipeline->finish();
+    prepare_vsg(ds);
+    if (async) {
+        ScanBuffer *filled = ds->video_scanner->exchange_frame_scan(pipeline->spare_scan());
+        pipeline->submit(filled);
+    } else {
+        frame = pipeline->run_now(ds->video_scanner->get_frame_scan());
+    }
+    if (frame) {
+        MEASURE(computer->video_upload_times,
+            SDL_UpdateTexture(ds->vsg_texture, nullptr, frame->data(), FrameVSG::max_width() * sizeof(RGBA_t)));
+    }
 
     SDL_FRect ii_frame_src;
     ii_frame_src = content_rec_vsg2[ds->video_scanner_type][(ds->new_video & 0x80) ? 1 : 0];
@@ -118,20 +146,23 @@ bool update_display_apple2_cycle(display_state_t *ds) {
     const SDL_FRect &content_inset =
         (ds->new_video & 0x80) ? shr_content_inset : ii_content_inset;
 
-    ds->video_system->render_frame(ds->frame_vsg->get_texture(), &ii_frame_src, nullptr, true,
+    ds->video_system->render_frame(ds->vsg_texture, &ii_frame_src, nullptr, true,
         &content_inset);
 
     return true;
 }
 
+bool update_display_apple2_cycle(display_state_t *ds) {
+    return display_render_apple2(ds, true);
+}
+
 /**
  * Frame-based Apple II blit. Scanner advance for LS / step lives in
  * frame_video_update() so VBL still runs when another processor owns the frame.
  */
 
 bool update_display_apple2(display_state_t *ds) {
-    update_display_apple2_cycle(ds);
-    return true;
+    return display_render_apple2(ds, false);
 }
 
 void set_display_mode(display_state_t *ds, display_mode_t mode) {
@@ -300,6 +331,8 @@ display_state_t::display_state_t() {
 }
 
 display_state_t::~display_state_t() {
+    delete pipeline; // joins the render worker before the generators and scanner go away
+    if (vsg_texture) SDL_DestroyTexture(vsg_texture);
     delete vsg;
     delete video_scanner;
     delete char_rom;
@@ -321,6 +354,7 @@ bool handle_display_event(display_state_t *ds, const SDL_Event &event) {
             if (config.videoSaturation < 0.0f) config.videoSaturation = 0.0f;
             if (config.videoSaturation > 1.0f) config.videoSaturation = 1.0f;
         }
+        ds->pipeline->finish(); // the worker reads the LUT
         init_hgr_LUT();
         static char msgbuf[256];
         snprintf(msgbuf, sizeof(msgbuf), "Hue set to: %f, Saturation to: %f\n", config.videoHue, config.videoSaturation);
@@ -343,7 +377,7 @@ bool handle_display_event(display_state_t *ds, const SDL_Event &event) {
     }
 #endif
     if (key == SDLK_F8) {
-        ds->vsg->setDumpNextFrame(true);
+        ds->vsg_dump_next = true;
         return true;
     }
     return false;
@@ -379,11 +413,7 @@ void set_new_video(display_state_t *ds, uint8_t value) {
         ds->video_scanner->reset_shr();
         /* // TODO: ds->a2_display->reset_shr(); */
     }
-    if (ds->new_video & 0x20) {
-        ds->vsg->set_dhgr_mono_mode(true);
-    } else {
-        ds->vsg->set_dhgr_mono_mode(false);
-    }
+    ds->vsg_dhgr_mono = (ds->new_video & 0x20) != 0;
 }
 
 void display_write_C029(void *context, uint32_t address, uint8_t value) {
@@ -399,13 +429,8 @@ void display_write_C029(void *context, uint32_t address, uint8_t value) {
 
 void display_write_C021(void *context, uint32_t address, uint8_t value) {
     display_state_t *ds = (display_state_t *)context;
-    if (value & 0x80) { 
-        // enable mono
-        ds->vsg->set_mono_mode(true);
-    } else {
-        ds->vsg->set_mono_mode(false);
-    }
-    
+    ds->vsg_mono = (value & 0x80) != 0; // applied to the generator at the next frame
+
 }
 
 /**
@@ -587,8 +612,8 @@ uint8_t display_read_C046(void *context, uint32_t address) {
 void set_langsel(display_state_t *ds, uint8_t value) {
     ds->f_langsel = value & 0b1111'1000;
     
-    // set language for display. Only values 0-7 are valid.
-    ds->vsg->set_char_set((ds->f_langsel & 0xE0) >> 5); // set LS scanner.
+    // set language for display. Only values 0-7 are valid. prepare_vsg() hands it to
+    // the generator at the next frame.
     
     // TODO: set video mode timing ntsc vs pal.
     // TODO: implement LANGUAGE switch (if 0, use lang 0. Otherwise use whatever lang selected.)
@@ -843,9 +868,13 @@ void init_mb_device_display_common(computer_t *computer, SlotType_t slot, bool c
     }
 
     // Initialize the VideoScanGenerators with the CharRom, and frame.
-    ds->frame_vsg = new(std::align_val_t(64)) FrameVSG(910, 263, vs->renderer, PIXEL_FORMAT);
-    ds->vsgr = new VideoScanGenerator_RGB(charrom, true, ds->frame_vsg);
-    ds->vsgc = new VideoScanGenerator_Comp(charrom, false, ds->frame_vsg);
+    ds->pipeline = new RenderPipeline([ds](ScanBuffer *scan, FrameVSG *out) {
+        ds->vsg->set_frame(out);
+        ds->vsg->generate_frame(scan);
+    }, &computer->video_generate_times);
+    ds->vsg_texture = SDL_CreateTexture(vs->renderer, PIXEL_FORMAT, SDL_TEXTUREACCESS_STREAMING, 910, 263);
+    ds->vsgr = new VideoScanGenerator_RGB(charrom, true, ds->pipeline->get_back_frame());
+    ds->vsgc = new VideoScanGenerator_Comp(charrom, false, ds->pipeline->get_back_frame());
     ds->vsgc->set_render(&ds->mon_ntsc);
 
     if (computer->platform->id == PLATFORM_APPLE_IIE_65816
@@ -859,7 +888,7 @@ void init_mb_device_display_common(computer_t *computer, SlotType_t slot, bool c
  
     // LINEAR gets us appropriately blurred pixels, NEAREST gets us sharp pixels, PIXELART is sharper pixels that are more accurate
     // linear/pixelart are set in vs->render_frame.
-    SDL_SetTextureBlendMode(ds->frame_vsg->get_texture(), SDL_BLENDMODE_NONE);
+    SDL_SetTextureBlendMode(ds->vsg_texture, SDL_BLENDMODE_NONE);
 
     // set in CPU so we can reference later
     computer->set_module_state(MODULE_DISPLAY, ds);
@@ -1034,6 +1063,33 @@ void init_mb_device_display_common(computer_t *computer, SlotType_t slot, bool c
             return display_debug(ds);
         }
     );
+
+    // Soft switches and VGC / Mega II interrupt state. The scanner saves its own modes
+    // (core "video" handler); the 1 sec interrupt is carried by the event queue.
+    computer->register_state_handler("display", [ds](SnapshotIO &io) {
+        io.field(ds->display_mode);
+        io.field(ds->display_split_mode);
+        io.field(ds->display_graphics_mode);
+        io.field(ds->display_page_num);
+        io.field(ds->f_altcharset);
+        io.field(ds->f_80col);
+        io.field(ds->f_double_graphics);
+        io.field(ds->f_INTEN);
+        io.field(ds->f_VGCINT);
+        io.field(ds->f_INTFLAG);
+        io.field(ds->onesec_counter);
+        io.field(ds->quartersec_counter);
+        io.field(ds->f_langsel);
+        io.field(ds->vsg_mono);
+        io.field(ds->vsg_dhgr_mono);
+        io.field(ds->new_video);
+        io.field(ds->text_color);
+        io.field(ds->border_color);
+        if (io.loading()) {
+            set_tbcolor(ds, ds->text_color);
+            set_bordercolor(ds, ds->border_color);
+        }
+    });
 }
 
 void init_mb_device_display(computer_t *computer, SlotType_t slot) {
@@ -36,6 +36,7 @@ class VideoScanGeneratorIntf;
 class VideoScanGenerator_Comp;
 class VideoScanGenerator_RGB;
 class CharRom;
+class RenderPipeline;
 
 // Graphics vs Text, C050 / C051
 typedef enum {
@@ -166,7 +167,8 @@ public:
     bool framebased = true;
     CharRom *char_rom = nullptr;
 
-    FrameVSG     *frame_vsg = nullptr;
+    RenderPipeline *pipeline = nullptr;    // runs vsg into RGBA frames, see render_pipeline.hpp
+    SDL_Texture *vsg_texture = nullptr;    // the finished frame, uploaded for render_frame
     VideoScanGeneratorIntf *vsg = nullptr; // current VideoGenerator
     VideoScanGenerator_Comp *vsgc = nullptr;
     VideoScanGenerator_RGB *vsgr = nullptr;
@@ -183,6 +185,11 @@ public:
     //GSRGB560 mon_rgb;
     MessageBus *mbus;
 
+    // generator settings from softswitches and keys, applied between frames by prepare_vsg()
+    bool vsg_mono = false;
+    bool vsg_dhgr_mono = false;
+    bool vsg_dump_next = false;
+
     // IIGS specific
     uint8_t new_video = 0x01;
     uint8_t text_color = 0x0F0;
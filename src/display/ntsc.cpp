@@ -23,12 +23,14 @@
 #include <cmath>
 #include <cstdint>
 #include <algorithm>
+#include <mutex>
 //#include <chrono>
 #include <stdio.h>
 #include "display.hpp"
 #include "Matrix3x3.hpp"
 #include "display/types.hpp"
 #include "display/ntsc.hpp"
+#include "display/filters.hpp"
 #include "devices/displaypp/RGBA.hpp"
 
 ntsc_config config ;
@@ -265,6 +267,16 @@ void init_hgr_LUT()
     }
 }
 
+void ntsc_init_shared()
+{
+    static std::once_flag once;
+    std::call_once(once, []() {
+        setupConfig();
+        generate_filters(NUM_TAPS);
+        init_hgr_LUT();
+    });
+}
+
 /** Generate a 'frame' (i.e., a group of 8 scanlines) of video output data using the lookup table.  */
 void processAppleIIFrame_LUT (
     uint8_t* frameData,         // 560x192 bytes - gray bitstream data
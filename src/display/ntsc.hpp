@@ -63,5 +63,7 @@ extern ntsc_config config ;
 
 void setupConfig();
 void init_hgr_LUT();
+/* setupConfig + generate_filters + init_hgr_LUT, done once per process; the tables are shared by every machine. */
+void ntsc_init_shared();
 void processAppleIIFrame_LUT(uint8_t* frameData, RGBA_t * outputImage, int y_start, int y_end);
 void processAppleIIFrame_Mono(uint8_t* frameData, RGBA_t * outputImage, int y_start, int y_end, RGBA_t color_value);
\ No newline at end of file
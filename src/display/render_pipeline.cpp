@@ -0,0 +1,98 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+
+#include "display/render_pipeline.hpp"
+
+RenderPipeline::RenderPipeline(Stage stage, Metrics *stage_times) : stage(std::move(stage)), stage_times(stage_times) {
+    for (int i = 0; i < 2; i++) {
+        frames[i] = new FrameVSG(910, 263);
+        frames[i]->clear(RGBA_t::make(0x00, 0x00, 0x00, 0xFF));
+    }
+    held_scan = new ScanBuffer;
+
+#ifndef __EMSCRIPTEN__
+    work = SDL_CreateSemaphore(0);
+    done = SDL_CreateSemaphore(0);
+    if (work && done) {
+        worker = SDL_CreateThread(worker_main, "render", this);
+    }
+    if (!worker) {
+        fprintf(stderr, "Render pipeline: no worker thread (%s), rendering inline\n", SDL_GetError());
+    }
+#endif
+}
+
+RenderPipeline::~RenderPipeline() {
+    finish();
+    if (worker) {
+        stopping = true;
+        SDL_SignalSemaphore(work);
+        SDL_WaitThread(worker, nullptr);
+    }
+    if (work) SDL_DestroySemaphore(work);
+    if (done) SDL_DestroySemaphore(done);
+    delete held_scan;
+    delete frames[0];
+    delete frames[1];
+}
+
+int RenderPipeline::worker_main(void *userdata) {
+    auto *p = static_cast<RenderPipeline *>(userdata);
+    for (;;) {
+        SDL_WaitSemaphore(p->work);
+        if (p->stopping) break;
+        p->run_stage(p->held_scan);
+        SDL_SignalSemaphore(p->done);
+    }
+    return 0;
+}
+
+void RenderPipeline::run_stage(ScanBuffer *scan) {
+    MEASURE((*stage_times), stage(scan, frames[back]));
+}
+
+FrameVSG *RenderPipeline::finish() {
+    if (busy) {
+        SDL_WaitSemaphore(done);
+        busy = false;
+        latest = frames[back];
+        back ^= 1;
+    }
+    return latest;
+}
+
+void RenderPipeline::submit(ScanBuffer *filled) {
+    held_scan = filled;
+    if (!worker) {
+        run_stage(held_scan);
+        latest = frames[back];
+        back ^= 1;
+        return;
+    }
+    busy = true;
+    SDL_SignalSemaphore(work);
+}
+
+FrameVSG *RenderPipeline::run_now(ScanBuffer *scan) {
+    finish();
+    run_stage(scan);
+    latest = frames[back];
+    back ^= 1;
+    return latest;
+}
@@ -0,0 +1,76 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <SDL3/SDL.h>
+
+#include "devices/displaypp/frame/Frames.hpp"
+#include "devices/displaypp/ScanBuffer.hpp"
+#include "util/Metrics.hpp"
+
+/**
+ * Double-buffered frame generation (VideoScanGenerator + Render) on a worker thread.
+ *
+ * At the end of an emulated frame the display swaps the scanner's filled ScanBuffer
+ * for spare_scan(), hands the filled one to submit() and goes back to emulating. The
+ * worker turns it into RGBA in one FrameVSG while the display uploads the other, so
+ * what is shown is one emulated frame behind. finish() joins the frame in flight;
+ * anything that touches the generators (mode, render, char set) must happen after it.
+ *
+ * Without threads (Emscripten, or if the thread can't be created) submit() runs the
+ * stage inline.
+ */
+class RenderPipeline {
+public:
+    using Stage = std::function<void (ScanBuffer *scan, FrameVSG *out)>;
+
+    RenderPipeline(Stage stage, Metrics *stage_times);
+    ~RenderPipeline();
+
+    /** Wait for the frame in flight. Returns the newest finished frame (nullptr before the first). */
+    FrameVSG *finish();
+    /** The empty buffer to give the scanner; valid after finish(). */
+    inline ScanBuffer *spare_scan() { return held_scan; }
+    /** Start the stage on filled, which the pipeline now owns. Call finish() first. */
+    void submit(ScanBuffer *filled);
+    /** Run the stage on this thread (forced and step frames) and return its frame. */
+    FrameVSG *run_now(ScanBuffer *scan);
+
+    /** The frame the next stage will write; for handing to the generators at setup. */
+    inline FrameVSG *get_back_frame() { return frames[back]; }
+
+private:
+    static int worker_main(void *userdata);
+    void run_stage(ScanBuffer *scan);
+
+    Stage stage;
+    Metrics *stage_times;
+
+    FrameVSG *frames[2];
+    int back = 0;                   // frame the next stage writes
+    FrameVSG *latest = nullptr;     // newest finished frame
+    ScanBuffer *held_scan;          // spare when idle, being consumed while busy
+    bool busy = false;
+
+    SDL_Thread *worker = nullptr;
+    SDL_Semaphore *work = nullptr;
+    SDL_Semaphore *done = nullptr;
+    bool stopping = false;
+};
@@ -38,6 +38,7 @@
 #include "util/Connections.hpp"
 #include "util/SystemConfig.hpp"
 #include "util/SystemSettings.hpp"
+#include "util/SharedRam.hpp"
 #include "ui/OSD.hpp"
 #if defined(__EMSCRIPTEN__)
 #include "platform-specific/emscripten/web_file_dialog.hpp"
@@ -49,6 +50,7 @@
 #include "debugger/DebugProtocolServer.hpp"
 #include "debugger/BreakpointTable.hpp"
 #include "computer.hpp"
+#include "machine.hpp"
 #include "mmus/mmu_ii.hpp"
 #include "mmus/mmu_iie.hpp"
 #include "mmus/mmu_iigs.hpp"
@@ -225,6 +227,19 @@ void frame_video_update(computer_t *computer, bool force_full_frame = false) {
 
     computer->debug_window->render();
     vs->present();
+    computer->frames_presented++;
+    computer->last_present_ns = SDL_GetTicksNS();
+}
+
+/*
+ * A frame Ludicrous does not show. The scanner has run every cycle, so VBL and the
+ * scanline IRQs were exact; its samples are just dropped without being generated.
+ */
+void frame_video_skip(computer_t *computer) {
+    display_state_t *ds = (display_state_t *)computer->cached_display_state;
+    if (ds && ds->video_scanner) {
+        ds->video_scanner->drop_frame_scan();
+    }
 }
 
 void frame_sleep(computer_t *computer, uint64_t last_cycle_time, uint64_t ns_per_frame)
@@ -276,47 +291,6 @@ DebugFormatter *debug_clock(computer_t *computer) {
 }
 #endif
 
-void register_clock_debug(computer_t *computer) {
-
-    computer->register_debug_display_handler(
-        "clock",
-        DH_CLOCK, // unique ID for this, need to have in a header.
-        [computer]() -> DebugFormatter * {
-            DebugFormatter *f = computer->clock->debug();
-            if (computer->clock->get_clock_mode() == CLOCK_FREE_RUN) {
-                const char *cal = "idle";
-                switch (computer->ludicrous_cal_state) {
-                    case LS_CAL_PROBE: cal = "probe"; break;
-                    case LS_CAL_DROPPING: cal = "calibrating"; break;
-                    case LS_CAL_LOCKED: cal = "locked"; break;
-                    default: break;
-                }
-                f->addLine("Ludicrous Cal: %s", cal);
-            }
-            return f;
-        }
-    );
-
-}
-
-
-DebugFormatter *debug_mmu_iigs(MMU_IIgs *mmu_iigs) {
-    DebugFormatter *f = new DebugFormatter();
-    mmu_iigs->debug_dump(f);
-    return f;
-}
-
-/*
-Initialize emulation state before the first frame.
-Called from transition_to_emulation() when a system is selected.
-*/
-void run_cpus_init(computer_t *computer) {
-    computer->last_cycle_time = SDL_GetTicksNS();
-    computer->last_start_frame_c14m = 0;
-    computer->cached_speaker_state = computer->get_module_state(MODULE_SPEAKER);
-    computer->cached_display_state = computer->get_module_state(MODULE_DISPLAY);
-}
-
 /*
 Execute one frame of emulation. Returns true if emulation should continue,
 false if the user requested a halt.
@@ -334,6 +308,14 @@ bool run_one_frame(computer_t *computer) {
         return true;
     }
 
+    // Run the trace-free core unless something consumes trace data this frame: the
+    // debugger (open window, breakpoints, step over/out), single stepping, or a protocol
+    // client that reads trace. cpu->trace only says whether the traced core records history.
+    // check_post_breakpoint relies on eaddr/data/flags that only the traced core fills.
+    cpu->set_traced(computer->execution_mode == EXEC_STEP_INTO ||
+                    computer->debug_window->needs_breakpoint_checks() ||
+                    (computer->debug_protocol && computer->debug_protocol->wants_trace()));
+
     if (computer->speed_shift) {
         computer->speed_shift = false;
 
@@ -348,21 +330,15 @@ bool run_one_frame(computer_t *computer) {
         }
         display_update_video_scanner(ds);
     }
+    // Clock mode, Ludicrous N or the frame may have changed since the deadline was worked out.
+    computer->event_deadline_c14m = 0;
 
     if (computer->execution_mode == EXEC_STEP_INTO) {
 
         /* This will run about 60fps, primarily waiting on user input in the debugger window. */
         const bool had_work = computer->instructions_left > 0;
         while (computer->instructions_left) {
-            if (computer->event_timer->isEventPassed(clock->get_c14m())) {
-                computer->event_timer->processEvents(clock->get_c14m());
-            }
-            if (computer->vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
-                computer->vid_event_timer->processEvents(clock->get_vid_cycles());
-            }
-            if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
-                computer->cpu_event_timer->processEvents(clock->get_cycles());
-            }
+            computer->poll_events();
             (cpu->cpun->execute_next)(cpu);
             computer->instructions_left--;
         }
@@ -421,24 +397,10 @@ bool run_one_frame(computer_t *computer) {
 
             if (computer->debug_window->needs_breakpoint_checks()) {
                 while (SDL_GetTicksNS() < deadline) {
-                    if (computer->event_timer->isEventPassed(clock->get_c14m())) {
-                        computer->event_timer->processEvents(clock->get_c14m());
-                    }
-                    if (computer->vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
-                        computer->vid_event_timer->processEvents(clock->get_vid_cycles());
-                    }
-                    if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
-                        computer->cpu_event_timer->processEvents(clock->get_cycles());
-                    }
+                    computer->poll_events();
                     StopHit hit{};
                     if (computer->debug_window->check_pre_breakpoint(cpu, &hit)) {
-                        uint32_t prev = computer->execution_mode;
-                        computer->execution_mode = EXEC_STEP_INTO;
-                        computer->instructions_left = 0;
-                        if (computer->debug_protocol) {
-                            computer->debug_protocol->emit_stopped(computer, hit);
-                            computer->debug_protocol->emit_run_state(EXEC_STEP_INTO, prev);
-                        }
+                        computer->enter_step_mode(&hit);
                         break;
                     }
                     uint32_t pc_before = cpu->full_pc;
@@ -447,18 +409,11 @@ bool run_one_frame(computer_t *computer) {
                         computer->breakpoints->on_instruction_retired(pc_before);
                     }
                     if (computer->debug_window->check_post_breakpoint(cpu, &cpu->trace_entry, &hit)) {
-                        uint32_t prev = computer->execution_mode;
-                        computer->execution_mode = EXEC_STEP_INTO;
-                        computer->instructions_left = 0;
-                        if (computer->debug_protocol) {
-                            computer->debug_protocol->emit_stopped(computer, hit);
-                            computer->debug_protocol->emit_run_state(EXEC_STEP_INTO, prev);
-                        }
+                        computer->enter_step_mode(&hit);
                         break;
                     }
                     if (cpu->trace_entry.opcode == 0x00) {
-                        computer->execution_mode = EXEC_STEP_INTO;
-                        computer->instructions_left = 0;
+                        computer->enter_step_mode(nullptr);
                         break;
                     }
                     // Keep frame counters aligned if we run past end during probe.
@@ -468,15 +423,7 @@ bool run_one_frame(computer_t *computer) {
                 }
             } else {
                 while (SDL_GetTicksNS() < deadline) {
-                    if (computer->event_timer->isEventPassed(clock->get_c14m())) {
-                        computer->event_timer->processEvents(clock->get_c14m());
-                    }
-                    if (computer->vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
-                        computer->vid_event_timer->processEvents(clock->get_vid_cycles());
-                    }
-                    if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
-                        computer->cpu_event_timer->processEvents(clock->get_cycles());
-                    }
+                    computer->poll_events();
                     (cpu->cpun->execute_next)(cpu);
                     if (clock->get_c14m() >= clock->get_frame_end_c14M()) {
                         clock->next_frame();
@@ -516,66 +463,7 @@ bool run_one_frame(computer_t *computer) {
         }
 #endif
 
-        if (computer->debug_window->needs_breakpoint_checks()) {
-            while (clock->get_c14m() < clock->get_frame_end_c14M()) { // 1/60th second.
-                if (computer->event_timer->isEventPassed(clock->get_c14m())) {
-                    computer->event_timer->processEvents(clock->get_c14m());
-                }
-                if (computer->vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
-                    computer->vid_event_timer->processEvents(clock->get_vid_cycles());
-                }
-                if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
-                    computer->cpu_event_timer->processEvents(clock->get_cycles());
-                }
-                StopHit hit{};
-                if (computer->debug_window->check_pre_breakpoint(cpu, &hit)) {
-                    uint32_t prev = computer->execution_mode;
-                    computer->execution_mode = EXEC_STEP_INTO;
-                    computer->instructions_left = 0;
-                    if (computer->debug_protocol) {
-                        computer->debug_protocol->emit_stopped(computer, hit);
-                        computer->debug_protocol->emit_run_state(EXEC_STEP_INTO, prev);
-                    }
-                    break;
-                }
-
-                uint32_t pc_before = cpu->full_pc;
-                (cpu->cpun->execute_next)(cpu);
-                if (computer->breakpoints) {
-                    computer->breakpoints->on_instruction_retired(pc_before);
-                }
-
-                if (computer->debug_window->check_post_breakpoint(cpu, &cpu->trace_entry, &hit)) {
-                    uint32_t prev = computer->execution_mode;
-                    computer->execution_mode = EXEC_STEP_INTO;
-                    computer->instructions_left = 0;
-                    if (computer->debug_protocol) {
-                        computer->debug_protocol->emit_stopped(computer, hit);
-                        computer->debug_protocol->emit_run_state(EXEC_STEP_INTO, prev);
-                    }
-                    break;
-                }
-                if (cpu->trace_entry.opcode == 0x00) { // catch a BRK and stop execution.
-                    computer->execution_mode = EXEC_STEP_INTO;
-                    computer->instructions_left = 0;
-                    break;
-                }
-
-            }
-        } else { // skip all debug checks if debug window is not open - this may seem repetitious but it saves all kinds of cycles where every cycle counts 
-            while (clock->get_c14m() < clock->get_frame_end_c14M()) {
-                if (computer->event_timer->isEventPassed(clock->get_c14m())) {
-                    computer->event_timer->processEvents(clock->get_c14m());
-                }
-                if (computer->vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
-                    computer->vid_event_timer->processEvents(clock->get_vid_cycles());
-                }
-                if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
-                    computer->cpu_event_timer->processEvents(clock->get_cycles());
-                }
-                (cpu->cpun->execute_next)(cpu);
-            }
-        }
+        computer->run_frame_instructions();
 
         /* Process Events */
         MEASURE(computer->event_times, frame_event(computer, cpu));
@@ -586,14 +474,20 @@ bool run_one_frame(computer_t *computer) {
         /* Execute Device Frames - 60 fps */
         MEASURE(computer->device_times, computer->device_frame_dispatcher->dispatch());
 
+        // calculate what sleep-until time should be.
+        uint64_t frame_length_ns = (computer->frame_count & 1) ? clock->get_us_per_frame_odd() : clock->get_us_per_frame_even();
+
         /* Emit Video Frame */
         if (computer->execution_mode != EXEC_STEP_INTO) {
-            MEASURE(computer->display_times, frame_video_update(computer));
+            bool ui_active = osd->requires_host_cursor() || computer->debug_window->is_open();
+            if (computer->should_present_frame(ui_active, SDL_GetTicksNS(),
+                    computer->video_system->host_refresh_ns(), frame_length_ns)) {
+                MEASURE(computer->display_times, frame_video_update(computer));
+            } else {
+                frame_video_skip(computer);
+            }
         }
         
-        // calculate what sleep-until time should be.
-        uint64_t frame_length_ns = (computer->frame_count & 1) ? clock->get_us_per_frame_odd() : clock->get_us_per_frame_even();
-        
         // update frame status; calculate stats; move these variables into computer;
         computer->frame_status_update();
 
@@ -618,6 +512,7 @@ bool run_one_frame(computer_t *computer) {
         computer->update_ludicrous_calibration(
             gs2_app_values.modal_tracking,
             clock->get_cycles() - frame_cpu_start);
+        computer->update_disk_accelerator();
         computer->last_cycle_time = SDL_GetTicksNS(); 
 
     }
@@ -666,9 +561,7 @@ struct GS2AppState {
     std::unique_ptr<DebugProtocolServer> debug_protocol;
 
     // MMU pointers tracked for cleanup
-    MMU_II *mmu_ii = nullptr;
-    MMU_IIe *mmu_iie = nullptr;
-    MMU_IIgs *mmu_iigs = nullptr;
+    machine_mmus_t mmus;
 };
 
 void transition_to_emulation(GS2AppState *state, const SystemConfig_t *system_config, int builtin_system_id);
@@ -784,170 +677,12 @@ void transition_to_emulation(GS2AppState *state, const SystemConfig_t *system_co
 
     state->platform_id = system_config->platform_id;
 
-    platform_info* platform = get_platform(state->platform_id);
-    print_platform_info(platform);
-
-    // TODO: This is a little disjointed. the clock abstraction should probably program all the things that need the clock.
-    // the initial setting here is 1MHz, except for platform which has the right starting clock?
-    //select_system_clock(system_config->clock_set);
-    //computer->set_clock(&system_clock_mode_info[computer->speed_new]);
-    //set_clock_mode(computer->cpu, platform->default_clock_mode);
-
-    computer->cpu->set_processor(platform->cpu_type);
-    // important to do this before setting up the rest of the computer.
-    NClockII *nclock = NClockFactory::create_clock(platform->id, system_config->clock_set);
-    computer->set_clock(nclock);
     getMenuInterface()->setComputer(computer);
-
-    //computer->set_cpu(new cpu_state(platform->cpu_type));
-
-    computer->set_platform(platform);
-    computer->set_video_scanner(system_config->scanner_type);
-    if (state->loaded_config) {
-        computer->set_system_id(-1);
-        computer->set_system_config(&state->loaded_config->config());
-        computer->set_machine_id(state->loaded_config->id());
-    } else {
-        computer->set_system_id(builtin_system_id);
-        computer->set_system_config(nullptr);
-        computer->set_machine_id(system_config->id ? system_config->id : "");
-    }
-    
-    // TODO: load platform roms - this info should get stored in the 'computer'
-    rom_data *rd = load_platform_roms(platform);
-    if (!rd) {
-        system_failure("Failed to load platform roms, exiting.");
-        return;
-    }
-
-    // we will ALWAYS have a 256 page map. because it's a 6502 and all is addressible in a II.
-    // II can have 4k, 8k, 12k; or 16k, 32k, 48k.
-    // II Plus can have 16k, 32K, or 48k RAM. 16K more BUT IN THE LANGUAGE CARD MODULE.
-    // always 12k rom, but not necessarily always the same ROM.
-    state->mmu_ii = nullptr;
-    state->mmu_iie = nullptr;
-    state->mmu_iigs = nullptr;
-
-    switch (platform->mmu_type) {
-        case MMU_MMU_II:
-            state->mmu_ii = new MMU_II(256, 48*1024, (uint8_t *) rd->main_rom_data);
-            computer->cpu->set_mmu(state->mmu_ii);
-            computer->set_mmu(state->mmu_ii);
-            computer->debug_window->set_mmu(state->mmu_ii);
-            break;
-        case MMU_MMU_IIE:
-            state->mmu_iie = new MMU_IIe(256, 128*1024, (uint8_t *) rd->main_rom_data);
-            computer->cpu->set_mmu(state->mmu_iie);
-            computer->set_mmu(state->mmu_iie);
-            computer->debug_window->set_mmu(state->mmu_iie);
-            break;
-        case MMU_MMU_IIGS:
-        {
-            // Bank $FF (the IIe-compatibility ROM the emulation-mode 6502
-            // core runs, and the source for the LC-area/IOLC ROM overlay
-            // reads inside MMU_IIgs) is always the *last* 64K bank of the
-            // ROM image, wherever that falls for the actual ROM size --
-            // NOT a hardcoded 128KB-ROM (ROM01) assumption. ROM01 is 128KB
-            // (bank $FF at file offset 0x10000); ROM03 is 256KB (0x30000).
-            // Previously hardcoded to 0x1'C000 / 128*1024, which silently
-            // only worked for a 128KB ROM01 image and scrambled the bank
-            // layout (and the emulation-mode reset vector) for ROM03.
-            const size_t main_rom_size = rd->main_rom_file->size();
-            const size_t rom_bank_ff_offset = main_rom_size - 65536;
-            // Contiguous FPI RAM = motherboard base (ROM-dependent) + 8MB expansion
-            // card, hard-capped at bank $7F (FPI decodes 23 RAM address bits).
-            const size_t mobo_ram = iigs_memory::mobo_ram_bytes(main_rom_size);
-            const size_t exp_ram = iigs_memory::kDefaultExpBytes;
-            const size_t fast_ram = iigs_memory::fast_ram_bytes(main_rom_size, exp_ram);
-            const uint32_t last_bank = iigs_memory::last_ram_bank(fast_ram);
-            printf("IIgs RAM: %s mobo %zuKB + exp %zuMB = %zu bytes (banks $00–$%02X)\n",
-                   iigs_memory::is_rom03(main_rom_size) ? "ROM03" : "ROM01",
-                   mobo_ram / 1024,
-                   exp_ram / (1024 * 1024),
-                   fast_ram,
-                   last_bank);
-            state->mmu_iie = new MMU_IIe(256, 128*1024, /* (uint8_t *) */rd->main_rom_data + rom_bank_ff_offset + 0xC000);
-            state->mmu_iigs = new MMU_IIgs(256, (int)fast_ram, (uint32_t) main_rom_size, /* (uint8_t *) */rd->main_rom_data, state->mmu_iie);
-        }
-            state->mmu_iigs->init_map();
-            computer->cpu->set_mmu(state->mmu_iigs); // cpu gets FPI
-            computer->set_mmu(state->mmu_iie); // everything else gets the Mega II
-            computer->debug_window->set_mmu(state->mmu_iigs);
-            state->mmu_iigs->set_clock((NClockII *)nclock);
-
-            break;
-        default:
-            printf("Unknown MMU type: %d\n", platform->mmu_type);
-            break;
-    }
-    // need to tell the MMU about our ROM somehow.
-    // need a function in MMU to "reset page to default".
-    computer->cpu->cpun = createCPU(platform->cpu_type, (NClock *)nclock);
-
-    computer->cpu->core = computer->cpu->cpun.get(); // set the core. Probably need a better set cpu for cpu_state.
-    //computer->cpu->core->set_clock(nclock);
-
-    // Initialize the slot manager.
-    //SlotManager_t *slot_manager = new SlotManager_t();
-
-
-    //init_display_font(rd);
-
-
-    // Iterate through Platform Devices and create/register/initialize the devices.
-    for (int i = 0; platform->mb_devices[i] != DEVICE_ID_END; i++) {
-        Device_t *device = get_device(platform->mb_devices[i]);
-        if (device->power_on == nullptr) {
-            printf("Device has no poweron, not found: %d", platform->mb_devices[i]);
-            continue;
-        }
-        device->power_on(computer, SLOT_NONE);
-    }
-
-    std::string slot_error;
-    if (!validate_slot_devices(*system_config, slot_error)) {
-        printf("Invalid slot configuration: %s\n", slot_error.c_str());
-        system_failure(slot_error.c_str());
+    if (!machine_build(computer, system_config, state->loaded_config.get(), builtin_system_id,
+            state->disks_to_mount, state->mmus)) {
         return;
     }
 
-    // Iterate through SystemConfig Slot Devices and create/register/initialize the devices.
-    for (int i = 0; i < NUM_SLOTS; i++) {
-        device_id id = system_config->slot_devices[i];
-        if (id == DEVICE_ID_NONE) continue;
-
-        Device_t *device = get_device(id);
-        if (device->power_on == nullptr) {
-            printf("Slot Device has no poweron handler: %d", id);
-            continue;
-        } 
-        device->power_on(computer, (SlotType_t)i);
-
-        computer->slot_manager->register_slot(device, (SlotType_t)i);
-    }
-
-    register_clock_debug(computer);
-
-    computer->cpu->reset();
-
-    // mount disks - AFTER device init.
-    for (const auto& disk_mount : state->disks_to_mount) {
-        computer->mounts->mount_media(disk_mount);
-    }
-
-    // Apply serial/parallel [[connections]] after ports register during device init.
-    if (state->loaded_config) {
-        for (const auto& conn : state->loaded_config->connections()) {
-            const connection_key_t key = normalize_connection_key(conn.slot, conn.port);
-            const connection_device_type_t dtype = connection_device_type_from_string(conn.device);
-            if (!computer->connections->attach(key, dtype)) {
-                printf("Warning: connection slot %d device=%s not applied (port not registered?)\n",
-                       key.slot, conn.device.c_str());
-            }
-        }
-    }
-    computer->connections->apply_defaults();
-
     osd = new OSD(computer, vs->renderer, vs->window, computer->slot_manager, 1120, 768, state->aa);
 
     // TODO: this should be handled differently. have osd save/restore?
@@ -960,30 +695,6 @@ void transition_to_emulation(GS2AppState *state, const SystemConfig_t *system_co
     
     computer->video_system->update_display(); // check for events 60 times per second.
 
-    if (platform->mmu_type == MMU_MMU_IIGS) {
-        //mmu_iigs->set_cpu(computer->cpu); // not needed any more, clock handles it.
-        
-        //computer->debug_window->set_open();
-        //computer->cpu->execution_mode = EXEC_STEP_INTO;
-        
-        computer->register_debug_display_handler(
-            "mmugs",
-            DH_MMUGS, // unique ID for this, need to have in a header.
-            [state]() -> DebugFormatter * {
-                return debug_mmu_iigs(state->mmu_iigs);
-            }
-        );
-
-
-        computer->cpu->trace_buffer->set_cpu_type(PROCESSOR_65816);
-        computer->video_system->set_display_engine(DM_ENGINE_RGB);
-
-        computer->register_reset_handler([state](bool cold_start) {
-            state->mmu_iigs->reset(cold_start);
-            return true;
-        });
-    }
-
     run_cpus_init(computer);
     vs->set_crt_shader_enabled(false, false);
     if (gs2_app_values.crt_shader_at_boot) {
@@ -1014,21 +725,7 @@ void transition_to_shutdown(GS2AppState *state) {
     delete computer;
     state->computer = nullptr;
 
-    switch (platform->mmu_type) {
-        case MMU_MMU_II:
-            delete state->mmu_ii;
-            break;
-        case MMU_MMU_IIE:
-            delete state->mmu_iie;
-            break;
-        case MMU_MMU_IIGS:
-            delete state->mmu_iigs;
-            delete state->mmu_iie;
-            break;
-    }
-    state->mmu_ii = nullptr;
-    state->mmu_iie = nullptr;
-    state->mmu_iigs = nullptr;
+    machine_free_mmus(platform, state->mmus);
 
     delete state->select_system;
     state->select_system = nullptr;
@@ -1113,10 +810,13 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
     // elsewhere; without this, scripted launches (no TTY) would ignore --debug / -p / etc.
     if (gs2_app_values.console_mode || argc > 1) {
         // parse command line options
-        enum { OPT_NO_QUIT_CONFIRM = 1000 };
+        enum { OPT_NO_QUIT_CONFIRM = 1000, OPT_DISK_ACCEL, OPT_SYNC_WRITES, OPT_DEBUG_SERVICE };
         static struct option long_options[] = {
             {"debug", required_argument, nullptr, 'D'},
             {"no-quit-confirm", no_argument, nullptr, OPT_NO_QUIT_CONFIRM},
+            {"disk-accel", required_argument, nullptr, OPT_DISK_ACCEL},
+            {"sync-writes", no_argument, nullptr, OPT_SYNC_WRITES},
+            {"debug-service", required_argument, nullptr, OPT_DEBUG_SERVICE},
             {nullptr, 0, nullptr, 0}
         };
         while ((opt = getopt_long(argc, argv, "sxgp:d:D:", long_options, nullptr)) != -1) {
@@ -1142,9 +842,23 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
                         }
                     }
                     break;
-                /* case 'x':
+                case 'x':
                     gs2_app_values.disk_accelerator = true;
-                    break; */
+                    break;
+                case OPT_DISK_ACCEL:
+                    {
+                        std::string speed(optarg);
+                        gs2_app_values.disk_accelerator = true;
+                        if (speed == "max") gs2_app_values.disk_accelerator_speed = CLOCK_FREE_RUN;
+                        else if (speed == "14.3") gs2_app_values.disk_accelerator_speed = CLOCK_14_3MHZ;
+                        else if (speed == "7.1") gs2_app_values.disk_accelerator_speed = CLOCK_7_159MHZ;
+                        else if (speed == "2.8") gs2_app_values.disk_accelerator_speed = CLOCK_2_8MHZ;
+                        else {
+                            std::cerr << "--disk-accel: unknown speed '" << speed << "' (max, 14.3, 7.1, 2.8)\n";
+                            return SDL_APP_FAILURE;
+                        }
+                    }
+                    break;
                 case 's':
                     gs2_app_values.sleep_mode = true;
                     break;
@@ -1154,12 +868,28 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
                 case 'D':
                     debug_socket_path = optarg;
                     std::cerr << "Debug protocol socket: " << debug_socket_path << "\n";
+                    // Guest RAM is allocated shareable, for MEMSHARE.
+                    SharedRam::set_enabled(true);
                     break;
                 case OPT_NO_QUIT_CONFIRM:
                     gs2_app_values.no_quit_confirm = true;
                     break;
+                case OPT_SYNC_WRITES:
+                    gs2_app_values.sync_block_writes = true;
+                    break;
+                case OPT_DEBUG_SERVICE:
+                    {
+                        std::string when(optarg);
+                        if (when == "frame") gs2_app_values.debug_service_blocks = false;
+                        else if (when == "block") gs2_app_values.debug_service_blocks = true;
+                        else {
+                            std::cerr << "--debug-service: unknown value '" << when << "' (frame, block)\n";
+                            return SDL_APP_FAILURE;
+                        }
+                    }
+                    break;
                 default:
-                    std::cerr << "Usage: " << argv[0] << " [file.gs2|*Settings.txt] [-p platform] [-dsXdY=filename] [-s] [-g] [--debug PATH] [--no-quit-confirm]\n";
+                    std::cerr << "Usage: " << argv[0] << " [file.gs2|*Settings.txt] [-p platform] [-dsXdY=filename] [-s] [-x] [--disk-accel SPEED] [-g] [--debug PATH] [--debug-service frame|block] [--no-quit-confirm] [--sync-writes]\n";
                     std::cerr << "  file.gs2|*Settings.txt: load system configuration from a .gs2 TOML file\n";
                     std::cerr << "        or Neil Profiles Settings.txt file, skip the system-selector UI,\n";
                     std::cerr << "        and auto-launch that system.\n";
@@ -1177,12 +907,20 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
                     std::cerr << "        first drive of the controller in slot 6.\n";
                     std::cerr << "        Overrides a [[storage]] entry from the config file for the same slot/drive.\n";
                     std::cerr << "  -s: sleep mode (don't busy-wait, sleep)\n";
+                    std::cerr << "  -x: disk accelerator: run at full speed while a floppy\n";
+                    std::cerr << "        drive motor is on, then return to the selected speed.\n";
+                    std::cerr << "  --disk-accel SPEED: disk accelerator at SPEED instead\n";
+                    std::cerr << "        (max, 14.3, 7.1 or 2.8 MHz).\n";
                     std::cerr << "  -g: enable CRT post-process shader when guest emulation\n";
                     std::cerr << "        starts (same as pressing F7 with shader off).\n";
                     std::cerr << "  -D PATH, --debug PATH: listen for external debug protocol on\n";
                     std::cerr << "        Unix-domain socket PATH (see Docs/DebugProtocol.md).\n";
+                    std::cerr << "  --debug-service frame|block: run queued debug protocol commands\n";
+                    std::cerr << "        once per frame (default), or also between instruction blocks.\n";
                     std::cerr << "  --no-quit-confirm: skip QuitModal / dirty-disk prompts on\n";
                     std::cerr << "        SDL_EVENT_QUIT (useful for tests that SIGTERM/kill the process).\n";
+                    std::cerr << "  --sync-writes: flush block device images to disk after every\n";
+                    std::cerr << "        block written, instead of on unmount.\n";
                     return SDL_APP_FAILURE;
             }
         }
@@ -1488,9 +1226,9 @@ void SDL_AppQuit(void *appstate, SDL_AppResult result) {
     }
 
     // Clean up MMUs if they exist (e.g., quit during emulation)
-    delete state->mmu_ii;
-    delete state->mmu_iie;
-    delete state->mmu_iigs;
+    delete state->mmus.mmu_ii;
+    delete state->mmus.mmu_iie;
+    delete state->mmus.mmu_iigs;
 
     delete state->edit_system;
     delete state->select_system;
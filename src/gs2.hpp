@@ -33,7 +33,13 @@ typedef struct gs2_app_t {
     std::string base_path;
     std::string pref_path;
     bool console_mode = false;
-   /*  bool disk_accelerator = false; */
+    bool disk_accelerator = false;
+    /** clock_mode_t the disk accelerator runs at while a floppy motor is on (0 = CLOCK_FREE_RUN). */
+    int disk_accelerator_speed = 0;
+    /** Block devices fsync their image after every write (--sync-writes); else on unmount / writeback. */
+    bool sync_block_writes = false;
+    /** --debug-service block: also run queued debug protocol commands between instruction blocks, not just once a frame. */
+    bool debug_service_blocks = false;
     bool sleep_mode = false;
     // When true, enable the CRT post-process shader when guest emulation starts
     // (same effect as pressing F7 with the shader off).
@@ -45,6 +51,8 @@ typedef struct gs2_app_t {
     bool force_app_exit = false;
     uint32_t menu_event_type = 0;
     bool modal_tracking = false;  // true while macOS menu/resize modal loop owns the run loop
+    /** gs2headless: hidden offscreen window, no presents, no audio device, no message boxes. */
+    bool headless = false;
 } gs2_app_t;
 
 extern gs2_app_t gs2_app_values;
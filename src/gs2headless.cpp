@@ -0,0 +1,673 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * gs2headless
+ *
+ * Batch runner for CI and regression farms. Builds a machine from a .gs2 config
+ * (or -p platform) with no visible window and no audio device, runs it unthrottled
+ * for N frames or until the PC or a memory byte hits a target, then dumps the text
+ * screen, a screenshot, memory ranges and/or the CPU trace.
+ *
+ * With --jobs FILE, each line of FILE describes one machine and the lines run in
+ * one process on a pool of worker threads, sharing the platform ROM images and the
+ * NTSC tables instead of loading and building them per run.
+ *
+ * Exit status: 0 when the stop condition was met (or the frames ran out and there
+ * was no condition), 2 when a condition was given but never met, 1 on error. For
+ * --jobs it is the worst status of any job.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "gs2.hpp"
+#include "paths.hpp"
+#include "cpu.hpp"
+#include "computer.hpp"
+#include "machine.hpp"
+#include "videosystem.hpp"
+#include "display/display.hpp"
+#include "display/text_page_layout.hpp"
+#include "util/Event.hpp"
+#include "util/EventTimer.hpp"
+#include "util/SystemConfig.hpp"
+#include "util/SystemSettings.hpp"
+#include "util/printf_helper.hpp"
+
+gs2_app_t gs2_app_values;
+
+namespace {
+
+struct mem_dump_t {
+    uint32_t address;
+    uint32_t length;
+    std::string path;
+};
+
+struct headless_options_t {
+    uint64_t max_frames = 600;
+    std::optional<uint32_t> until_pc;
+    std::optional<uint32_t> until_mem_address;
+    uint8_t until_mem_value = 0;
+    std::string text_path;
+    std::string screen_path;
+    std::string trace_path;
+    std::vector<mem_dump_t> mem_dumps;
+};
+
+enum frame_result_t {
+    FRAME_DONE,
+    FRAME_HIT_PC,
+    FRAME_QUIT,
+};
+
+void print_usage(const char *progname) {
+    fprintf(stderr, "Usage: %s [file.gs2] [-p platform] [-dsXdY=filename] [options]\n", progname);
+    fprintf(stderr, "  -f N, --frames N          run at most N frames (default 600)\n");
+    fprintf(stderr, "  --until-pc ADDR           stop before the CPU executes ADDR (hex)\n");
+    fprintf(stderr, "  --until-mem ADDR=VAL      stop at the end of the frame where ADDR (hex, CPU view) reads VAL (hex)\n");
+    fprintf(stderr, "  --dump-text PATH          write the text screen to PATH (- for stdout)\n");
+    fprintf(stderr, "  --dump-screen PATH        write the final frame to PATH as PNG\n");
+    fprintf(stderr, "  --dump-mem ADDR:LEN:PATH  write LEN bytes from ADDR (hex, CPU view) to PATH; repeatable\n");
+    fprintf(stderr, "  --trace PATH              record a CPU trace and save it to PATH\n");
+    fprintf(stderr, "  --jobs FILE               run one machine per line of FILE (same options), in parallel\n");
+    fprintf(stderr, "  -j N, --threads N         worker threads for --jobs (default: one per core)\n");
+}
+
+bool parse_hex(const char *s, uint32_t &out) {
+    char *end = nullptr;
+    if (*s == '$') s++;
+    unsigned long v = strtoul(s, &end, 16);
+    if (end == s || *end != '\0') return false;
+    out = (uint32_t)v;
+    return true;
+}
+
+/* Like frame_appevent, minus the OSD: messages go to stdout. */
+void drain_app_events(computer_t *computer) {
+    while (Event *event = computer->event_queue->getNextEvent()) {
+        switch (event->getEventType()) {
+            case EVENT_QUIT:
+                computer->cpu->halt = HLT_USER;
+                break;
+            case EVENT_SHOW_MESSAGE:
+                printf("Message: %s\n", (const char *)event->getEventData());
+                break;
+        }
+        delete event;
+    }
+}
+
+/*
+ * One frame of emulation with no pacing, no rendering and no audio output. The
+ * scan buffer and audio streams are emptied each frame instead of consumed.
+ */
+frame_result_t run_headless_frame(computer_t *computer, const std::optional<uint32_t> &until_pc) {
+    cpu_state *cpu = computer->cpu;
+    NClock *clock = computer->clock;
+    display_state_t *ds = (display_state_t *)computer->cached_display_state;
+    frame_result_t result = FRAME_DONE;
+
+    computer->set_frame_start_cycle();
+    computer->event_deadline_c14m = 0;
+    if (computer->run_frame_instructions(until_pc) == computer_t::FRAME_STOP_PC) {
+        result = FRAME_HIT_PC;
+    }
+
+    // Only the main thread may pump; with --jobs the frame loops run on workers.
+    if (SDL_IsMainThread()) SDL_PumpEvents();
+    SDL_FlushEvents(SDL_EVENT_FIRST, SDL_EVENT_LAST);
+    drain_app_events(computer);
+    computer->device_frame_dispatcher->dispatch();
+    computer->audio_system->clear_all_streams();
+    if (ds && ds->video_scanner) {
+        ds->video_scanner->get_frame_scan()->clear();
+    }
+
+    if (clock->get_c14m() >= clock->get_frame_end_c14M()) {
+        clock->next_frame();
+        computer->last_start_frame_c14m = clock->get_frame_start_c14M();
+    }
+    if (cpu->halt == HLT_USER) {
+        result = FRAME_QUIT;
+    }
+    return result;
+}
+
+/* Screen codes to printable ASCII: inverse / flashing upper case and normal text alike. */
+inline char screen_char(uint8_t c) {
+    uint8_t a = c & 0x7F;
+    if (c < 0x80) a = c & 0x3F;
+    if (a < 0x20) a += 0x40;
+    return (a == 0x7F) ? ' ' : (char)a;
+}
+
+bool dump_text(computer_t *computer, const std::string &path) {
+    display_state_t *ds = (display_state_t *)computer->cached_display_state;
+    // On the IIgs the text pages live in the Mega II's RAM.
+    MMU *mmu = (computer->platform && platform_is_iigs(computer->platform->id)) ? computer->mmu : computer->cpu->mmu;
+    if (!ds || !mmu) return false;
+
+    const uint32_t page = (ds->display_page_num == DISPLAY_PAGE_2) ? 2 : 1;
+    const bool text80 = ds->f_80col && mmu->get_memory_size() >= text_page::kAuxBankOffset + 0x0C00;
+    const uint32_t cols = text80 ? text_page::kCols80 : text_page::kCols40;
+    uint8_t chars[text_page::kRows * text_page::kCols80];
+    if (text80) {
+        text_page::linearize_text80(mmu->get_memory_base(), page, chars);
+    } else {
+        text_page::linearize_text40(mmu->get_memory_base(), page, chars);
+    }
+
+    FILE *fp = (path == "-") ? stdout : fopen(path.c_str(), "w");
+    if (!fp) return false;
+    for (uint32_t row = 0; row < text_page::kRows; row++) {
+        char line[text_page::kCols80 + 1];
+        for (uint32_t col = 0; col < cols; col++) {
+            line[col] = screen_char(chars[row * cols + col]);
+        }
+        line[cols] = '\0';
+        fprintf(fp, "%s\n", line);
+    }
+    if (fp != stdout) fclose(fp);
+    return true;
+}
+
+/*
+ * Scan one whole frame from current memory (as step mode does) and render it,
+ * then write it out through the screenshot worker.
+ */
+bool dump_screen(computer_t *computer, const std::string &path) {
+    display_state_t *ds = (display_state_t *)computer->cached_display_state;
+    video_system_t *vs = computer->video_system;
+    if (ds && ds->video_scanner) {
+        ds->video_scanner->get_frame_scan()->clear();
+        const int n = (int)computer->clock->get_vid_cycles_per_frame();
+        for (int i = 0; i < n; i++) {
+            ds->video_scanner->video_cycle();
+        }
+    }
+    vs->update_display(true);
+    if (!vs->save_screenshot(path)) return false;
+    while (vs->screenshot_writer->is_pending()) {
+        SDL_Delay(1);
+    }
+    return true;
+}
+
+/*
+ * $C000-$CFFF where the CPU sees I/O: banks $00/$01/$E0/$E1 (all of memory on a II / IIe).
+ * Reading there can flip soft switches, strobe devices or switch slot expansion ROMs, so
+ * the memory options leave it alone. (read_raw() is no help: on the IIgs banks $00/$01
+ * are all behind read handlers.)
+ */
+inline bool is_io_address(uint32_t address) {
+    const uint32_t bank = address >> 16;
+    if (bank != 0x00 && bank != 0x01 && bank != 0xE0 && bank != 0xE1) return false;
+    return (address & 0xF000) == 0xC000;
+}
+
+bool dump_memory(computer_t *computer, const mem_dump_t &dump) {
+    FILE *fp = fopen(dump.path.c_str(), "wb");
+    if (!fp) return false;
+    MMU *mmu = computer->cpu->mmu;
+    std::vector<uint8_t> buf(dump.length);
+    for (uint32_t i = 0; i < dump.length; i++) {
+        const uint32_t address = dump.address + i;
+        buf[i] = is_io_address(address) ? 0x00 : mmu->read(address);
+    }
+    bool ok = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+    fclose(fp);
+    return ok;
+}
+
+struct headless_job_t {
+    headless_options_t opts;
+    int platform_id = -1;
+    std::string config_path;
+    std::vector<disk_mount_t> cli_mounts;
+    std::string label; // "" for a single run; "N" (the jobs file line) otherwise
+};
+
+/*
+ * Machine build and teardown create SDL windows, renderers and audio streams, load
+ * slot ROMs and touch the few devices that still keep process-wide state, so jobs
+ * take turns at them. Only the frame loop runs in parallel.
+ */
+SDL_Mutex *machine_mutex = nullptr;
+
+struct machine_lock_t {
+    machine_lock_t() { if (machine_mutex) SDL_LockMutex(machine_mutex); }
+    ~machine_lock_t() { if (machine_mutex) SDL_UnlockMutex(machine_mutex); }
+};
+
+/*
+ * Parse one machine's options. main() passes threads / jobs_path to accept -j and
+ * --jobs; lines of a jobs file pass nullptr and may not nest them.
+ */
+bool parse_job_args(int argc, char *argv[], headless_job_t &job, int *threads, std::string *jobs_path) {
+    headless_options_t &opts = job.opts;
+    enum {
+        OPT_UNTIL_PC = 1000,
+        OPT_UNTIL_MEM,
+        OPT_DUMP_TEXT,
+        OPT_DUMP_SCREEN,
+        OPT_DUMP_MEM,
+        OPT_TRACE,
+        OPT_JOBS,
+    };
+    static struct option long_options[] = {
+        {"frames", required_argument, nullptr, 'f'},
+        {"until-pc", required_argument, nullptr, OPT_UNTIL_PC},
+        {"until-mem", required_argument, nullptr, OPT_UNTIL_MEM},
+        {"dump-text", required_argument, nullptr, OPT_DUMP_TEXT},
+        {"dump-screen", required_argument, nullptr, OPT_DUMP_SCREEN},
+        {"dump-mem", required_argument, nullptr, OPT_DUMP_MEM},
+        {"trace", required_argument, nullptr, OPT_TRACE},
+        {"jobs", required_argument, nullptr, OPT_JOBS},
+        {"threads", required_argument, nullptr, 'j'},
+        {nullptr, 0, nullptr, 0}
+    };
+    optind = 0; // full reset: getopt_long is run once per jobs file line
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:p:d:j:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'f':
+                opts.max_frames = strtoull(optarg, nullptr, 10);
+                break;
+            case 'p':
+                job.platform_id = atoi(optarg);
+                break;
+            case 'd': {
+                std::regex disk_pattern("s([0-9]+)d([0-9]+)=(.+)");
+                std::smatch matches;
+                std::string arg_str(optarg);
+                if (!std::regex_match(arg_str, matches, disk_pattern)) {
+                    fprintf(stderr, "Bad disk argument: %s\n", optarg);
+                    return false;
+                }
+                job.cli_mounts.push_back({ (uint16_t)std::stoi(matches[1]), (uint16_t)(std::stoi(matches[2]) - 1), matches[3] });
+                break;
+            }
+            case OPT_UNTIL_PC: {
+                uint32_t pc;
+                if (!parse_hex(optarg, pc)) {
+                    fprintf(stderr, "Bad --until-pc address: %s\n", optarg);
+                    return false;
+                }
+                opts.until_pc = pc;
+                break;
+            }
+            case OPT_UNTIL_MEM: {
+                std::string arg(optarg);
+                size_t eq = arg.find('=');
+                uint32_t address, value;
+                if (eq == std::string::npos || !parse_hex(arg.substr(0, eq).c_str(), address)
+                    || !parse_hex(arg.substr(eq + 1).c_str(), value) || value > 0xFF) {
+                    fprintf(stderr, "Bad --until-mem condition: %s\n", optarg);
+                    return false;
+                }
+                if (is_io_address(address)) {
+                    fprintf(stderr, "--until-mem can't watch I/O space: %s\n", optarg);
+                    return false;
+                }
+                opts.until_mem_address = address;
+                opts.until_mem_value = (uint8_t)value;
+                break;
+            }
+            case OPT_DUMP_TEXT:
+                opts.text_path = optarg;
+                break;
+            case OPT_DUMP_SCREEN:
+                opts.screen_path = optarg;
+                break;
+            case OPT_DUMP_MEM: {
+                std::string arg(optarg);
+                size_t c1 = arg.find(':');
+                size_t c2 = (c1 == std::string::npos) ? c1 : arg.find(':', c1 + 1);
+                mem_dump_t dump;
+                if (c2 == std::string::npos || !parse_hex(arg.substr(0, c1).c_str(), dump.address)
+                    || !parse_hex(arg.substr(c1 + 1, c2 - c1 - 1).c_str(), dump.length) || c2 + 1 >= arg.size()) {
+                    fprintf(stderr, "Bad --dump-mem argument: %s\n", optarg);
+                    return false;
+                }
+                dump.path = arg.substr(c2 + 1);
+                opts.mem_dumps.push_back(dump);
+                break;
+            }
+            case OPT_TRACE:
+                opts.trace_path = optarg;
+                break;
+            case OPT_JOBS:
+                if (!jobs_path) {
+                    fprintf(stderr, "--jobs is not allowed inside a jobs file\n");
+                    return false;
+                }
+                *jobs_path = optarg;
+                break;
+            case 'j':
+                if (!threads) {
+                    fprintf(stderr, "-j is not allowed inside a jobs file\n");
+                    return false;
+                }
+                *threads = atoi(optarg);
+                break;
+            default:
+                return false;
+        }
+    }
+    if (optind < argc) {
+        job.config_path = argv[optind];
+    }
+    return true;
+}
+
+/* Split a jobs file line into arguments; double quotes group words with spaces. */
+std::vector<std::string> split_job_line(const std::string &line) {
+    std::vector<std::string> args;
+    std::string cur;
+    bool quoted = false, have = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            have = true;
+        } else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+            if (have) args.push_back(cur);
+            cur.clear();
+            have = false;
+        } else {
+            cur += c;
+            have = true;
+        }
+    }
+    if (have) args.push_back(cur);
+    return args;
+}
+
+/* One job per line, in the same syntax as the command line; blank lines and # comments are skipped. */
+bool load_jobs_file(const std::string &path, std::vector<headless_job_t> &jobs) {
+    FILE *fp = fopen(path.c_str(), "r");
+    if (!fp) {
+        fprintf(stderr, "Failed to open jobs file %s\n", path.c_str());
+        return false;
+    }
+    bool ok = true;
+    char buf[4096];
+    int line_num = 0;
+    while (fgets(buf, sizeof(buf), fp)) {
+        line_num++;
+        std::string line(buf);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+        std::vector<std::string> args = split_job_line(line);
+        if (args.empty() || args[0][0] == '#') continue;
+
+        std::vector<char *> argv;
+        argv.push_back(const_cast<char *>("gs2headless"));
+        for (std::string &a : args) argv.push_back(a.data());
+        argv.push_back(nullptr);
+
+        headless_job_t job;
+        job.label = std::to_string(line_num);
+        if (!parse_job_args((int)argv.size() - 1, argv.data(), job, nullptr, nullptr)) {
+            fprintf(stderr, "%s:%d: bad job\n", path.c_str(), line_num);
+            ok = false;
+            continue;
+        }
+        jobs.push_back(std::move(job));
+    }
+    fclose(fp);
+    return ok;
+}
+
+/* Errors outrank unmet conditions, which outrank success. */
+inline int worse_status(int a, int b) {
+    if (a == 1 || b == 1) return 1;
+    return (a == 2 || b == 2) ? 2 : 0;
+}
+
+/* Build, run, dump and tear down one machine. Returns the job's exit status. */
+int run_job(const headless_job_t &job) {
+    const headless_options_t &opts = job.opts;
+    const std::string tag = job.label.empty() ? "gs2headless" : "gs2headless[" + job.label + "]";
+
+    std::unique_ptr<SystemConfig> loaded_config;
+    const SystemConfig_t *system_config = nullptr;
+    int builtin_system_id = -1;
+    std::vector<disk_mount_t> disks_to_mount;
+    if (!job.config_path.empty()) {
+        std::string error;
+        loaded_config = std::make_unique<SystemConfig>();
+        if (!loaded_config->load(job.config_path, error)) {
+            fprintf(stderr, "%s: failed to load system config '%s':\n%s\n", tag.c_str(), job.config_path.c_str(), error.c_str());
+            return 1;
+        }
+        system_config = &loaded_config->config();
+        disks_to_mount = loaded_config->mounts();
+    } else if (job.platform_id >= 0) {
+        builtin_system_id = find_first_system_for_platform(job.platform_id);
+        if (builtin_system_id < 0) {
+            fprintf(stderr, "%s: no system config matches platform_id=%d\n", tag.c_str(), job.platform_id);
+            return 1;
+        }
+        system_config = get_system_config(builtin_system_id);
+    } else {
+        fprintf(stderr, "%s: no .gs2 config or -p platform given\n", tag.c_str());
+        return 1;
+    }
+    for (const auto& mount : job.cli_mounts) {
+        bool replaced = false;
+        for (auto& existing : disks_to_mount) {
+            if (existing.slot == mount.slot && existing.drive == mount.drive) {
+                existing = mount;
+                replaced = true;
+            }
+        }
+        if (!replaced) disks_to_mount.push_back(mount);
+    }
+
+    computer_t *computer = nullptr;
+    machine_mmus_t mmus;
+    {
+        machine_lock_t lock;
+        computer = new computer_t(nullptr);
+        if (!machine_build(computer, system_config, loaded_config.get(), builtin_system_id, disks_to_mount, mmus)) {
+            return 1;
+        }
+        run_cpus_init(computer);
+    }
+
+    // Nothing reads trace history in a batch run unless --trace asks for it.
+    computer->cpu->trace = !opts.trace_path.empty();
+    computer->cpu->set_traced(computer->cpu->trace);
+
+    const bool has_condition = opts.until_pc || opts.until_mem_address;
+    const char *stop_reason = "frames";
+    bool condition_met = false;
+    uint64_t frames = 0;
+    const uint64_t start_ns = SDL_GetTicksNS();
+    const uint64_t start_cycles = computer->clock->get_cycles();
+
+    while (frames < opts.max_frames) {
+        frame_result_t result = run_headless_frame(computer, opts.until_pc);
+        frames++;
+        if (result == FRAME_HIT_PC) {
+            stop_reason = "pc";
+            condition_met = true;
+            break;
+        }
+        if (opts.until_mem_address && computer->cpu->mmu->read(*opts.until_mem_address) == opts.until_mem_value) {
+            stop_reason = "mem";
+            condition_met = true;
+            break;
+        }
+        if (result == FRAME_QUIT) {
+            stop_reason = "quit";
+            break;
+        }
+    }
+
+    const uint64_t elapsed_ns = SDL_GetTicksNS() - start_ns;
+    const uint64_t cycles = computer->clock->get_cycles() - start_cycles;
+    printf("%s: stopped (%s) after %llu frames, %llu cycles, PC %06X, %.1f ms (%.2f MHz effective)\n",
+           tag.c_str(), stop_reason, u64_t(frames), u64_t(cycles), computer->cpu->full_pc, elapsed_ns / 1e6,
+           elapsed_ns ? (double)cycles * 1000.0 / (double)elapsed_ns : 0.0);
+
+    int status = (has_condition && !condition_met) ? 2 : 0;
+    if (!opts.text_path.empty() && !dump_text(computer, opts.text_path)) {
+        fprintf(stderr, "%s: failed to write text screen to %s\n", tag.c_str(), opts.text_path.c_str());
+        status = 1;
+    }
+    if (!opts.screen_path.empty()) {
+        machine_lock_t lock;
+        if (!dump_screen(computer, opts.screen_path)) {
+            fprintf(stderr, "%s: failed to write screenshot to %s\n", tag.c_str(), opts.screen_path.c_str());
+            status = 1;
+        }
+    }
+    for (const mem_dump_t &dump : opts.mem_dumps) {
+        if (!dump_memory(computer, dump)) {
+            fprintf(stderr, "%s: failed to write memory dump to %s\n", tag.c_str(), dump.path.c_str());
+            status = 1;
+        }
+    }
+    if (!opts.trace_path.empty()) {
+        computer->cpu->trace_buffer->save_to_file(opts.trace_path);
+    }
+
+    {
+        machine_lock_t lock;
+        platform_info *platform = computer->platform;
+        computer->set_system_config(nullptr);
+        delete computer;
+        machine_free_mmus(platform, mmus);
+    }
+    return status;
+}
+
+struct job_pool_t {
+    std::vector<headless_job_t> *jobs;
+    std::vector<int> status;
+    std::atomic<size_t> next{0};
+};
+
+/* Workers claim the next unstarted job until none are left, so long boots don't hold up short ones. */
+int job_worker_main(void *userdata) {
+    auto *pool = static_cast<job_pool_t *>(userdata);
+    for (;;) {
+        size_t i = pool->next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= pool->jobs->size()) break;
+        pool->status[i] = run_job((*pool->jobs)[i]);
+    }
+    return 0;
+}
+
+int run_jobs(std::vector<headless_job_t> &jobs, int threads) {
+    if (threads <= 0) threads = SDL_GetNumLogicalCPUCores();
+    if (threads > (int)jobs.size()) threads = (int)jobs.size();
+
+    job_pool_t pool;
+    pool.jobs = &jobs;
+    pool.status.assign(jobs.size(), 1);
+
+    // Video and audio have to be initialized on the main thread; the machines' own
+    // SDL_Init calls then only take references.
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
+    machine_mutex = SDL_CreateMutex();
+    const uint64_t start_ns = SDL_GetTicksNS();
+
+    std::vector<SDL_Thread *> workers;
+    for (int i = 0; i < threads; i++) {
+        SDL_Thread *t = SDL_CreateThread(job_worker_main, "gs2headless-job", &pool);
+        if (!t) {
+            fprintf(stderr, "Failed to create worker thread: %s\n", SDL_GetError());
+            break;
+        }
+        workers.push_back(t);
+    }
+    if (workers.empty()) {
+        job_worker_main(&pool);
+    }
+    for (SDL_Thread *t : workers) {
+        SDL_WaitThread(t, nullptr);
+    }
+
+    SDL_DestroyMutex(machine_mutex);
+    machine_mutex = nullptr;
+
+    int status = 0, passed = 0, unmet = 0, failed = 0;
+    for (int s : pool.status) {
+        status = worse_status(status, s);
+        if (s == 0) passed++;
+        else if (s == 2) unmet++;
+        else failed++;
+    }
+    printf("gs2headless: %zu jobs on %zu threads in %.1f ms: %d ok, %d condition not met, %d failed\n",
+           jobs.size(), workers.empty() ? (size_t)1 : workers.size(), (SDL_GetTicksNS() - start_ns) / 1e6,
+           passed, unmet, failed);
+    return status;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    SDL_SetMainReady();
+
+    // Null sinks: nothing is shown or played, and no display or sound server is needed.
+    gs2_app_values.headless = true;
+    gs2_app_values.console_mode = true;
+    gs2_app_values.no_quit_confirm = true;
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen,dummy");
+    SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+
+    headless_job_t job;
+    int threads = 0;
+    std::string jobs_path;
+    if (!parse_job_args(argc, argv, job, &threads, &jobs_path)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    Paths::initialize(gs2_app_values.console_mode);
+    gs2_app_values.base_path = get_base_path(gs2_app_values.console_mode);
+    gs2_app_values.pref_path = get_pref_path();
+    SystemSettings::instance().load();
+
+    int status;
+    if (!jobs_path.empty()) {
+        std::vector<headless_job_t> jobs;
+        if (!load_jobs_file(jobs_path, jobs)) {
+            return 1;
+        }
+        status = jobs.empty() ? 0 : run_jobs(jobs, threads);
+    } else if (job.config_path.empty() && job.platform_id < 0) {
+        print_usage(argv[0]);
+        return 1;
+    } else {
+        status = run_job(job);
+    }
+    SDL_Quit();
+    return status;
+}
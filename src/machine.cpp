@@ -0,0 +1,305 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "machine.hpp"
+#include "cpu.hpp"
+#include "devices.hpp"
+#include "platforms.hpp"
+#include "slots.hpp"
+#include "videosystem.hpp"
+#include "debugger/debugwindow.hpp"
+#include "mmus/mmu_ii.hpp"
+#include "mmus/mmu_iie.hpp"
+#include "mmus/mmu_iigs.hpp"
+#include "mmus/iigs_memory.hpp"
+#include "cpus/cpu_implementations.hpp"
+#include "util/dialog.hpp"
+#include "util/mount.hpp"
+#include "util/Connections.hpp"
+#include "util/SystemConfig.hpp"
+#include "util/DebugHandlerIDs.hpp"
+
+static void register_clock_debug(computer_t *computer) {
+
+    computer->register_debug_display_handler(
+        "clock",
+        DH_CLOCK, // unique ID for this, need to have in a header.
+        [computer]() -> DebugFormatter * {
+            DebugFormatter *f = computer->clock->debug();
+            if (computer->clock->get_clock_mode() == CLOCK_FREE_RUN) {
+                const char *cal = "idle";
+                switch (computer->ludicrous_cal_state) {
+                    case LS_CAL_PROBE: cal = "probe"; break;
+                    case LS_CAL_DROPPING: cal = "calibrating"; break;
+                    case LS_CAL_LOCKED: cal = "locked"; break;
+                    default: break;
+                }
+                f->addLine("Ludicrous Cal: %s", cal);
+            }
+            return f;
+        }
+    );
+
+}
+
+static DebugFormatter *debug_mmu_iigs(MMU_IIgs *mmu_iigs) {
+    DebugFormatter *f = new DebugFormatter();
+    mmu_iigs->debug_dump(f);
+    return f;
+}
+
+bool machine_build(computer_t *computer, const SystemConfig_t *system_config, const SystemConfig *loaded_config,
+    int builtin_system_id, const std::vector<disk_mount_t> &disks_to_mount, machine_mmus_t &mmus) {
+
+    platform_info* platform = get_platform(system_config->platform_id);
+    print_platform_info(platform);
+
+    // TODO: This is a little disjointed. the clock abstraction should probably program all the things that need the clock.
+    // the initial setting here is 1MHz, except for platform which has the right starting clock?
+    //select_system_clock(system_config->clock_set);
+    //computer->set_clock(&system_clock_mode_info[computer->speed_new]);
+    //set_clock_mode(computer->cpu, platform->default_clock_mode);
+
+    computer->cpu->set_processor(platform->cpu_type);
+    // important to do this before setting up the rest of the computer.
+    NClockII *nclock = NClockFactory::create_clock(platform->id, system_config->clock_set);
+    computer->set_clock(nclock);
+
+    //computer->set_cpu(new cpu_state(platform->cpu_type));
+
+    computer->set_platform(platform);
+    computer->set_video_scanner(system_config->scanner_type);
+    if (loaded_config) {
+        computer->set_system_id(-1);
+        computer->set_system_config(&loaded_config->config());
+        computer->set_machine_id(loaded_config->id());
+    } else {
+        computer->set_system_id(builtin_system_id);
+        computer->set_system_config(nullptr);
+        computer->set_machine_id(system_config->id ? system_config->id : "");
+    }
+
+    // TODO: load platform roms - this info should get stored in the 'computer'
+    rom_data *rd = load_platform_roms(platform);
+    if (!rd) {
+        system_failure("Failed to load platform roms, exiting.");
+        return false;
+    }
+
+    // we will ALWAYS have a 256 page map. because it's a 6502 and all is addressible in a II.
+    // II can have 4k, 8k, 12k; or 16k, 32k, 48k.
+    // II Plus can have 16k, 32K, or 48k RAM. 16K more BUT IN THE LANGUAGE CARD MODULE.
+    // always 12k rom, but not necessarily always the same ROM.
+    mmus = machine_mmus_t{};
+
+    switch (platform->mmu_type) {
+        case MMU_MMU_II:
+            mmus.mmu_ii = new MMU_II(256, 48*1024, (uint8_t *) rd->main_rom_data);
+            computer->cpu->set_mmu(mmus.mmu_ii);
+            computer->set_mmu(mmus.mmu_ii);
+            computer->debug_window->set_mmu(mmus.mmu_ii);
+            break;
+        case MMU_MMU_IIE:
+            mmus.mmu_iie = new MMU_IIe(256, 128*1024, (uint8_t *) rd->main_rom_data);
+            computer->cpu->set_mmu(mmus.mmu_iie);
+            computer->set_mmu(mmus.mmu_iie);
+            computer->debug_window->set_mmu(mmus.mmu_iie);
+            break;
+        case MMU_MMU_IIGS:
+        {
+            // Bank $FF (the IIe-compatibility ROM the emulation-mode 6502
+            // core runs, and the source for the LC-area/IOLC ROM overlay
+            // reads inside MMU_IIgs) is always the *last* 64K bank of the
+            // ROM image, wherever that falls for the actual ROM size --
+            // NOT a hardcoded 128KB-ROM (ROM01) assumption. ROM01 is 128KB
+            // (bank $FF at file offset 0x10000); ROM03 is 256KB (0x30000).
+            // Previously hardcoded to 0x1'C000 / 128*1024, which silently
+            // only worked for a 128KB ROM01 image and scrambled the bank
+            // layout (and the emulation-mode reset vector) for ROM03.
+            const size_t main_rom_size = rd->main_rom_file->size();
+            const size_t rom_bank_ff_offset = main_rom_size - 65536;
+            // Contiguous FPI RAM = motherboard base (ROM-dependent) + 8MB expansion
+            // card, hard-capped at bank $7F (FPI decodes 23 RAM address bits).
+            const size_t mobo_ram = iigs_memory::mobo_ram_bytes(main_rom_size);
+            const size_t exp_ram = iigs_memory::kDefaultExpBytes;
+            const size_t fast_ram = iigs_memory::fast_ram_bytes(main_rom_size, exp_ram);
+            const uint32_t last_bank = iigs_memory::last_ram_bank(fast_ram);
+            printf("IIgs RAM: %s mobo %zuKB + exp %zuMB = %zu bytes (banks $00–$%02X)\n",
+                   iigs_memory::is_rom03(main_rom_size) ? "ROM03" : "ROM01",
+                   mobo_ram / 1024,
+                   exp_ram / (1024 * 1024),
+                   fast_ram,
+                   last_bank);
+            mmus.mmu_iie = new MMU_IIe(256, 128*1024, /* (uint8_t *) */rd->main_rom_data + rom_bank_ff_offset + 0xC000);
+            mmus.mmu_iigs = new MMU_IIgs(256, (int)fast_ram, (uint32_t) main_rom_size, /* (uint8_t *) */rd->main_rom_data, mmus.mmu_iie);
+        }
+            mmus.mmu_iigs->init_map();
+            computer->cpu->set_mmu(mmus.mmu_iigs); // cpu gets FPI
+            computer->set_mmu(mmus.mmu_iie); // everything else gets the Mega II
+            computer->debug_window->set_mmu(mmus.mmu_iigs);
+            mmus.mmu_iigs->set_clock((NClockII *)nclock);
+
+            break;
+        default:
+            printf("Unknown MMU type: %d\n", platform->mmu_type);
+            break;
+    }
+    // RAM that snapshots carry. On the IIgs computer->mmu is the Mega II (banks $E0/$E1).
+    if (computer->mmu) {
+        computer->register_ram_region("main", computer->mmu->get_memory_base(), computer->mmu->get_memory_size());
+    }
+    if (mmus.mmu_iigs) {
+        computer->register_ram_region("fpi", mmus.mmu_iigs->get_memory_base(), mmus.mmu_iigs->get_memory_size());
+    }
+
+    // need to tell the MMU about our ROM somehow.
+    // need a function in MMU to "reset page to default".
+    // Build both a traced and a trace-free core; run_one_frame picks one each frame.
+    computer->cpu->set_cores(createCPU(platform->cpu_type, (NClock *)nclock, true),
+                             createCPU(platform->cpu_type, (NClock *)nclock, false));
+    //computer->cpu->core->set_clock(nclock);
+
+    // Initialize the slot manager.
+    //SlotManager_t *slot_manager = new SlotManager_t();
+
+
+    //init_display_font(rd);
+
+
+    // Iterate through Platform Devices and create/register/initialize the devices.
+    for (int i = 0; platform->mb_devices[i] != DEVICE_ID_END; i++) {
+        Device_t *device = get_device(platform->mb_devices[i]);
+        if (device->power_on == nullptr) {
+            printf("Device has no poweron, not found: %d", platform->mb_devices[i]);
+            continue;
+        }
+        device->power_on(computer, SLOT_NONE);
+    }
+
+    std::string slot_error;
+    if (!validate_slot_devices(*system_config, slot_error)) {
+        printf("Invalid slot configuration: %s\n", slot_error.c_str());
+        system_failure(slot_error.c_str());
+        return false;
+    }
+
+    // Iterate through SystemConfig Slot Devices and create/register/initialize the devices.
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        device_id id = system_config->slot_devices[i];
+        if (id == DEVICE_ID_NONE) continue;
+
+        Device_t *device = get_device(id);
+        if (device->power_on == nullptr) {
+            printf("Slot Device has no poweron handler: %d", id);
+            continue;
+        }
+        device->power_on(computer, (SlotType_t)i);
+
+        computer->slot_manager->register_slot(device, (SlotType_t)i);
+    }
+
+    register_clock_debug(computer);
+
+    computer->cpu->reset();
+
+    // mount disks - AFTER device init.
+    for (const auto& disk_mount : disks_to_mount) {
+        computer->mounts->mount_media(disk_mount);
+    }
+
+    // Apply serial/parallel [[connections]] after ports register during device init.
+    if (loaded_config) {
+        for (const auto& conn : loaded_config->connections()) {
+            const connection_key_t key = normalize_connection_key(conn.slot, conn.port);
+            const connection_device_type_t dtype = connection_device_type_from_string(conn.device);
+            if (!computer->connections->attach(key, dtype)) {
+                printf("Warning: connection slot %d device=%s not applied (port not registered?)\n",
+                       key.slot, conn.device.c_str());
+            }
+        }
+    }
+    computer->connections->apply_defaults();
+
+    if (platform->mmu_type == MMU_MMU_IIGS) {
+        //mmu_iigs->set_cpu(computer->cpu); // not needed any more, clock handles it.
+
+        //computer->debug_window->set_open();
+        //computer->cpu->execution_mode = EXEC_STEP_INTO;
+        MMU_IIgs *mmu_iigs = mmus.mmu_iigs;
+
+        computer->register_debug_display_handler(
+            "mmugs",
+            DH_MMUGS, // unique ID for this, need to have in a header.
+            [mmu_iigs]() -> DebugFormatter * {
+                return debug_mmu_iigs(mmu_iigs);
+            }
+        );
+
+
+        computer->cpu->trace_buffer->set_cpu_type(PROCESSOR_65816);
+        computer->video_system->set_display_engine(DM_ENGINE_RGB);
+
+        computer->register_reset_handler([mmu_iigs](bool cold_start) {
+            mmu_iigs->reset(cold_start);
+            return true;
+        });
+        computer->register_state_handler("mmu_iigs", [mmu_iigs](SnapshotIO &io) {
+            mmu_iigs->snapshot(io);
+        });
+    }
+
+    // Pending timer events. Registered last so it is also loaded last: by then every
+    // device has restored its state and re-armed any event of its own, and the saved
+    // queues replace whatever power-on scheduled.
+    computer->register_state_handler("events", [computer](SnapshotIO &io) {
+        NClockII *clock = computer->clock;
+        computer->event_timer->snapshot(io, clock->get_c14m());
+        computer->vid_event_timer->snapshot(io, clock->get_vid_cycles());
+        computer->cpu_event_timer->snapshot(io, clock->get_cycles());
+    });
+    return true;
+}
+
+void machine_free_mmus(platform_info *platform, machine_mmus_t &mmus) {
+    switch (platform->mmu_type) {
+        case MMU_MMU_II:
+            delete mmus.mmu_ii;
+            break;
+        case MMU_MMU_IIE:
+            delete mmus.mmu_iie;
+            break;
+        case MMU_MMU_IIGS:
+            delete mmus.mmu_iigs;
+            delete mmus.mmu_iie;
+            break;
+    }
+    mmus = machine_mmus_t{};
+}
+
+/*
+Initialize emulation state before the first frame.
+Called from transition_to_emulation() when a system is selected.
+*/
+void run_cpus_init(computer_t *computer) {
+    computer->last_cycle_time = SDL_GetTicksNS();
+    computer->last_start_frame_c14m = 0;
+    computer->cached_speaker_state = computer->get_module_state(MODULE_SPEAKER);
+    computer->cached_display_state = computer->get_module_state(MODULE_DISPLAY);
+}
@@ -0,0 +1,52 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "computer.hpp"
+#include "systemconfig.hpp"
+#include "util/mount.hpp"
+
+class SystemConfig;
+class MMU_II;
+class MMU_IIe;
+class MMU_IIgs;
+
+/* The MMUs a machine was built with; the caller owns them and frees them after the computer. */
+struct machine_mmus_t {
+    MMU_II *mmu_ii = nullptr;
+    MMU_IIe *mmu_iie = nullptr;
+    MMU_IIgs *mmu_iigs = nullptr;
+};
+
+/**
+ * Build the machine described by system_config into computer: clock, MMUs, CPU cores,
+ * motherboard and slot devices, then reset, mount disks and apply connections.
+ * Shared by the GUI (transition_to_emulation) and gs2headless; anything that needs a
+ * window or the OSD is left to the caller. loaded_config is null for builtin systems.
+ * Returns false after system_failure() if the machine can't be built.
+ */
+bool machine_build(computer_t *computer, const SystemConfig_t *system_config, const SystemConfig *loaded_config,
+    int builtin_system_id, const std::vector<disk_mount_t> &disks_to_mount, machine_mmus_t &mmus);
+
+/* Free the MMUs machine_build() created. Call after the computer has been deleted. */
+void machine_free_mmus(platform_info *platform, machine_mmus_t &mmus);
+
+/* Initialize emulation state before the first frame. */
+void run_cpus_init(computer_t *computer);
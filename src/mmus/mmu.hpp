@@ -1,11 +1,14 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <assert.h>
 
 #include "util/DebugFormatter.hpp"
 #include "memoryspecs.hpp"      // not used here but used by lots of stuff that includes this.
 
+class SharedRam;
+
 #define C0X0_BASE 0xC000
 #define C0X0_SIZE 0x100
 
@@ -41,6 +44,26 @@ struct write_handler_pair_t {
     write_handler_t hs[2];
 };
 
+// Lets a lazily-run video scanner catch up before its inputs change.
+typedef void (*video_sync_func)(void *context);
+
+struct video_sync_handler_t {
+    video_sync_func sync;
+    void *context;
+};
+
+// Watchpoint traps: called after a trapped access completes, with the byte moved.
+typedef void (*memory_watch_func)(void *context, uint32_t address, uint8_t value, bool is_write);
+
+struct memory_watch_handler_t {
+    memory_watch_func hit;
+    void *context;
+};
+
+// Access kinds for watch_range(); the same values as BP_ACCESS_R / BP_ACCESS_W.
+constexpr uint8_t WATCH_READ = 1;
+constexpr uint8_t WATCH_WRITE = 2;
+
 struct page_table_entry_t {
     page_ref read_p; // pointer to uint8_t pointers
     page_ref write_p;
@@ -49,12 +72,18 @@ struct page_table_entry_t {
     write_handler_t shadow_h;
     const char *read_d;
     const char *write_d;
+    bool video_watch = false;   // write_p is a page the video scanner fetches from
 };
 
 class MMU {
     protected:
         //cpu_state *cpu;
         int num_pages = 0;
+
+        // Whether write_block / read_block may copy this page straight from the page
+        // table; false where the subclass's read() / write() do more than that.
+        virtual bool dma_direct_page(uint32_t page) { return true; }
+
         // this is an array of info about each page.
         page_table_entry_t *page_table;
         uint8_t floating_bus_val = 0xEE;
@@ -62,6 +91,68 @@ class MMU {
         uint32_t page_size_bits = 0;
         uint32_t page_size_mask = 0;
 
+        // Video scanner catch-up: run before the floating bus is sampled, and before
+        // a write lands in a physical RAM page flagged in video_watch.
+        video_sync_handler_t video_sync_h = {nullptr, nullptr};
+        const uint8_t *video_watch = nullptr;
+        const uint8_t *video_watch_base = nullptr;
+        uint32_t video_watch_pages = 0;
+
+        // Watchpoints. A trapped page's live entry sends the watched access kinds to
+        // watch_trap_read / watch_trap_write; the real mapping lives in trap_saved, and
+        // the map_* / set_page_* calls update it there so bank switching keeps the trap.
+        page_table_entry_t *trap_saved = nullptr;
+        uint8_t *trap_access = nullptr;     // WATCH_* per page, allocated on first watch
+        memory_watch_handler_t watch_h = {nullptr, nullptr};
+
+        /** The entry map_* changes apply to: the saved one while the page is trapped. */
+        inline page_table_entry_t *map_entry(page_t page) {
+            return (trap_access && trap_access[page]) ? &trap_saved[page] : &page_table[page];
+        }
+        /** Re-derive the video flag, and a trapped page's live entry, after map_entry(page) changed. */
+        inline void map_entry_changed(page_t page) {
+            page_table_entry_t *pte = map_entry(page);
+            pte->video_watch = watches_video(pte->write_p);
+            if (trap_access && trap_access[page]) apply_trap(page);
+        }
+        void apply_trap(page_t page) {
+            page_table_entry_t *live = &page_table[page];
+            *live = trap_saved[page];
+            if (trap_access[page] & WATCH_READ) {
+                live->read_p = nullptr;
+                live->read_h = {watch_trap_read, this};
+            }
+            if (trap_access[page] & WATCH_WRITE) {
+                live->write_p = nullptr;
+                live->write_h = {watch_trap_write, this};
+                live->shadow_h = {nullptr, nullptr};
+            }
+        }
+
+        // The same page-level dispatch as read() / write(), through the saved entry.
+        static uint8_t watch_trap_read(void *context, uint32_t address) {
+            MMU *mmu = (MMU *)context;
+            const page_table_entry_t *pte = &mmu->trap_saved[address >> mmu->page_size_bits];
+            uint8_t value;
+            if (pte->read_p != nullptr) value = pte->read_p[address & mmu->page_size_mask];
+            else if (pte->read_h.read != nullptr) value = pte->read_h.read(pte->read_h.context, address);
+            else value = mmu->floating_bus_read();
+            if (mmu->watch_h.hit) mmu->watch_h.hit(mmu->watch_h.context, address, value, false);
+            return value;
+        }
+
+        static void watch_trap_write(void *context, uint32_t address, uint8_t value) {
+            MMU *mmu = (MMU *)context;
+            const page_table_entry_t *pte = &mmu->trap_saved[address >> mmu->page_size_bits];
+            if (pte->write_h.write != nullptr) pte->write_h.write(pte->write_h.context, address, value);
+            else if (pte->write_p) {
+                if (pte->video_watch) mmu->video_sync();
+                pte->write_p[address & mmu->page_size_mask] = value;
+            }
+            if (pte->shadow_h.write != nullptr) pte->shadow_h.write(pte->shadow_h.context, address, value);
+            if (mmu->watch_h.hit) mmu->watch_h.hit(mmu->watch_h.context, address, value, true);
+        }
+
         /* static constexpr uint32_t PAGE_SIZE_BITS = __builtin_ctz(PAGE_SIZE);
         static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1; */
             
@@ -97,18 +188,22 @@ class MMU {
 
         virtual ~MMU() {
             delete[] page_table;
+            delete[] trap_saved;
+            delete[] trap_access;
         }
 
         /** Contiguous RAM allocation, if any. Linear offsets for MAIN_RAW / MEGAII_RAW. */
         virtual uint8_t *get_memory_base() { return nullptr; }
         virtual uint32_t get_memory_size() { return 0; }
+        /** The allocation behind get_memory_base(), for sharing it with debug clients. */
+        virtual const SharedRam *get_memory_block() { return nullptr; }
 
         // Raw. Do not trigger cycles or do the IO bus stuff
         uint8_t read_raw(uint32_t address) {
             uint16_t page = address >> page_size_bits; // / GS2_PAGE_SIZE;
             uint16_t offset = address & page_size_mask; // % GS2_PAGE_SIZE;
             if (page > num_pages) return floating_bus_read();
-            page_table_entry_t *pte = &page_table[page];
+            page_table_entry_t *pte = map_entry(page);
             if (pte->read_p == nullptr) return floating_bus_read();
             return pte->read_p[offset];
         }
@@ -119,8 +214,9 @@ class MMU {
             uint16_t page = address >> page_size_bits; // / GS2_PAGE_SIZE;
             uint16_t offset = address & page_size_mask; // % GS2_PAGE_SIZE;
             if (page > num_pages) return;
-            page_table_entry_t *pte = &page_table[page];
+            page_table_entry_t *pte = map_entry(page);
             if (pte->read_p == nullptr) return;
+            video_write_sync(pte->write_p + offset);
             pte->write_p[offset] = value;
         }
 
@@ -161,13 +257,60 @@ class MMU {
             
             // if there is a write handler, call it instead of writing directly.
             if (pte->write_h.write != nullptr) pte->write_h.write(pte->write_h.context, address, value);
-            else if (pte->write_p) pte->write_p[offset] = value;
+            else if (pte->write_p) {
+                if (pte->video_watch) video_sync();
+                pte->write_p[offset] = value;
+            }
 
             if (pte->shadow_h.write != nullptr) pte->shadow_h.write(pte->shadow_h.context, address, value);
 
             // if none of those things were set, silently do nothing.
         }
 
+        /**
+         * DMA transfers (block devices): len bytes to / from the CPU's view of memory
+         * starting at address, without burning CPU cycles. Spans of plain RAM pages
+         * (write_p / read_p, no handler, no shadow) are copied with memcpy; anything
+         * else - I/O, shadowed or trapped pages - goes through write() / read() a
+         * byte at a time, exactly as the CPU would see it.
+         */
+        virtual void write_block(uint32_t address, const uint8_t *src, uint32_t len) {
+            while (len) {
+                uint32_t page = address >> page_size_bits;
+                uint32_t offset = address & page_size_mask;
+                uint32_t n = page_size - offset;
+                if (n > len) n = len;
+                page_table_entry_t *pte = (page < (uint32_t)num_pages) ? &page_table[page] : nullptr;
+                if (pte && pte->write_p && !pte->write_h.write && !pte->shadow_h.write && dma_direct_page(page)) {
+                    if (pte->video_watch) video_sync();
+                    memcpy(pte->write_p + offset, src, n);
+                } else {
+                    for (uint32_t i = 0; i < n; i++) write(address + i, src[i]);
+                }
+                address += n;
+                src += n;
+                len -= n;
+            }
+        }
+
+        virtual void read_block(uint32_t address, uint8_t *dst, uint32_t len) {
+            while (len) {
+                uint32_t page = address >> page_size_bits;
+                uint32_t offset = address & page_size_mask;
+                uint32_t n = page_size - offset;
+                if (n > len) n = len;
+                page_table_entry_t *pte = (page < (uint32_t)num_pages) ? &page_table[page] : nullptr;
+                if (pte && pte->read_p && dma_direct_page(page)) {
+                    memcpy(dst, pte->read_p + offset, n);
+                } else {
+                    for (uint32_t i = 0; i < n; i++) dst[i] = read(address + i);
+                }
+                address += n;
+                dst += n;
+                len -= n;
+            }
+        }
+
         // By default, this is the same as read.
         inline virtual uint8_t vp_read(uint32_t address) {
             return read(address);
@@ -175,18 +318,85 @@ class MMU {
 
         void set_floating_bus(uint8_t val) { floating_bus_val = val; }
     
-        uint8_t floating_bus_read() { return floating_bus_val; }
+        uint8_t floating_bus_read() {
+            video_sync();
+            return floating_bus_val;
+        }
+
+        /**
+         * Install the scanner catch-up hook. watch has one flag per physical page of
+         * get_memory_base() (pages covered: watch_pages); a write to a flagged page
+         * calls the hook first, so deferred video cycles still see the old byte.
+         */
+        void set_video_sync(video_sync_handler_t handler, const uint8_t *watch, uint32_t watch_pages) {
+            video_sync_h = handler;
+            video_watch = watch;
+            video_watch_base = get_memory_base();
+            video_watch_pages = watch ? watch_pages : 0;
+            for (int page = 0; page < num_pages; page++) {
+                page_table[page].video_watch = watches_video(page_table[page].write_p);
+                if (trap_saved) trap_saved[page].video_watch = watches_video(trap_saved[page].write_p);
+            }
+        }
+
+        // Whether a store through host pointer p lands in a watched physical page.
+        inline bool watches_video(const uint8_t *p) const {
+            if (!video_watch || !p) return false;
+            uintptr_t page = ((uintptr_t)p - (uintptr_t)video_watch_base) >> page_size_bits;
+            return page < video_watch_pages && video_watch[page];
+        }
+
+        inline void video_sync() {
+            if (video_sync_h.sync) video_sync_h.sync(video_sync_h.context);
+        }
+
+        // p is the host pointer about to be stored through.
+        inline void video_write_sync(const uint8_t *p) {
+            if (video_sync_h.sync && watches_video(p)) video_sync_h.sync(video_sync_h.context);
+        }
+
+        /**
+         * Watchpoints: trap the WATCH_* accesses to every page overlapping [start, end]
+         * and report each to the watch handler. Pages with no watch keep their plain
+         * entries and cost nothing. Debugger peeks through read_raw() are not reported.
+         */
+        void set_watch_handler(memory_watch_handler_t handler) { watch_h = handler; }
+
+        virtual void watch_range(uint32_t start, uint32_t end, uint8_t access) {
+            if (!trap_access) {
+                trap_saved = new page_table_entry_t[num_pages];
+                trap_access = new uint8_t[num_pages]();
+            }
+            uint32_t first = start >> page_size_bits;
+            uint32_t last = end >> page_size_bits;
+            if (last >= (uint32_t)num_pages) last = num_pages - 1;
+            for (uint32_t page = first; page <= last && first < (uint32_t)num_pages; page++) {
+                if (!trap_access[page]) trap_saved[page] = page_table[page];
+                trap_access[page] |= access & (WATCH_READ | WATCH_WRITE);
+                apply_trap(page);
+            }
+        }
+
+        virtual void clear_watches() {
+            if (!trap_access) return;
+            for (int page = 0; page < num_pages; page++) {
+                if (trap_access[page]) {
+                    page_table[page] = trap_saved[page];
+                    trap_access[page] = 0;
+                }
+            }
+        }
     
 
         uint8_t *get_page_base_address(page_t page) {
-            return page_table[page].read_p;
+            return map_entry(page)->read_p;
         }
 
         void map_page_both(page_t page, uint8_t *data, const char *read_d) {
             if (page > num_pages) {
                 return;
             }
-            page_table_entry_t *pte = &page_table[page];
+            page_table_entry_t *pte = map_entry(page);
 
             pte->read_p = data;
             pte->write_p = data;
@@ -194,6 +404,7 @@ class MMU {
             pte->write_h = {nullptr, nullptr};
             pte->read_d = read_d;
             pte->write_d = read_d;
+            map_entry_changed(page);
         }
 
         // map page to read only
@@ -201,45 +412,51 @@ class MMU {
             if (page > num_pages) {
                 return;
             }
-            page_table_entry_t *pte = &page_table[page];
+            page_table_entry_t *pte = map_entry(page);
 
             pte->read_p = data;
             pte->write_p = nullptr;
             pte->read_d = read_d;
             pte->write_d = nullptr;
+            map_entry_changed(page);
         }
 
         void map_page_read(page_t page, uint8_t *data, const char *read_d) {
             if (page > num_pages) {
                 return;
             }
-            page_table_entry_t *pte = &page_table[page];
+            page_table_entry_t *pte = map_entry(page);
             pte->read_p = data;
             pte->read_d = read_d;
+            map_entry_changed(page);
         }
 
         void map_page_write(page_t page, uint8_t *data, const char *write_d) {
             if (page > num_pages) {
                 return;
             }
-            page_table_entry_t *pte = &page_table[page];
+            page_table_entry_t *pte = map_entry(page);
             
             pte->write_p = data;
             pte->write_d = write_d;
+            map_entry_changed(page);
         }
 
         void set_page_shadow(page_t page, write_handler_t handler) {
-            page_table[page].shadow_h = handler;
+            map_entry(page)->shadow_h = handler;
+            map_entry_changed(page);
         }
 
         void set_page_read_h(page_t page, read_handler_t handler, const char *read_d) {
-            page_table[page].read_h = handler;
-            page_table[page].read_d = read_d;
+            map_entry(page)->read_h = handler;
+            map_entry(page)->read_d = read_d;
+            map_entry_changed(page);
         }
 
         void set_page_write_h(page_t page, write_handler_t handler, const char *write_d) {
-            page_table[page].write_h = handler;
-            page_table[page].write_d = write_d;
+            map_entry(page)->write_h = handler;
+            map_entry(page)->write_d = write_d;
+            map_entry_changed(page);
         }
 
         void dump_page_table(page_t start_page, page_t end_page) {
@@ -297,19 +514,20 @@ class MMU {
         virtual bool is_aux_linear() { return false; }
 
         const char *get_read_d(page_t page) {
-            return page_table[page].read_d;
+            return map_entry(page)->read_d;
         }
 
         const char *get_write_d(page_t page) {
-            return page_table[page].write_d;
+            return map_entry(page)->write_d;
         }
 
         void get_page_table_entry(page_t page, page_table_entry_t *pte) {
-            *pte = page_table[page];
+            *pte = *map_entry(page);
         }
 
         void set_page_table_entry(page_t page, page_table_entry_t *pte) {
-            page_table[page] = *pte;
+            *map_entry(page) = *pte;
+            map_entry_changed(page);
         }
 
 };
@@ -1,4 +1,5 @@
 #include "mmu_ii.hpp"
+#include "util/Snapshot.hpp"
 
 /**
  * Sets base memory map without any specificity for various devices.
@@ -35,7 +36,7 @@ MMU_II::MMU_II(int page_table_size, int ram_amount, uint8_t *rom_pointer) : MMU(
     //ram_pages = ram_amount / GS2_PAGE_SIZE;
     ram_pages = (48 * 1024) / GS2_PAGE_SIZE; // should be 48k worth of pages or 192 pages.
     ram_size_ = static_cast<uint32_t>(ram_amount);
-    main_ram = new uint8_t[ram_amount];
+    main_ram = ram_block.allocate(ram_amount);
     power_on_randomize(main_ram, ram_amount);
     
     //main_io_4 = new uint8_t[IO_KB]; // TODO: we're not using this..
@@ -55,8 +56,7 @@ MMU_II::MMU_II(int page_table_size, int ram_amount, uint8_t *rom_pointer) : MMU(
 }
 
 MMU_II::~MMU_II() {
-    // free up memory areas.
-    delete[] main_ram;
+    // free up memory areas (ram_block frees main_ram).
     // TODO: we did not allocate, so we should not deallocate this. 
     //delete[] main_rom_D0;
 }
@@ -156,7 +156,7 @@ void MMU_II::call_C8xx_handler(SlotType_t slot) {
 void MMU_II::compose_c1cf() {
     // only thing we do is set based on this. IIe expands on this.
     for (int i = 0; i < 15; i++) {
-        page_table[0xC1 + i] = slot_rom_ptable[i];
+        set_page_table_entry(0xC1 + i, &slot_rom_ptable[i]);
     }
 }
 
@@ -248,7 +248,10 @@ void MMU_II::write(uint32_t address, uint8_t value) {
     // if there is a write handler, call it instead of writing directly.
     page_table_entry_t *pte = &page_table[page];
     if (pte->write_h.write != nullptr) pte->write_h.write(pte->write_h.context, eaddress, value);
-    else if (pte->write_p) pte->write_p[eaddress & 0xFF] = value;
+    else if (pte->write_p) {
+        if (pte->video_watch) video_sync();
+        pte->write_p[eaddress & 0xFF] = value;
+    }
     if (pte->shadow_h.write != nullptr) pte->shadow_h.write(pte->shadow_h.context, eaddress, value);
 
     /* MMU::write(address, value); */
@@ -322,4 +325,14 @@ void MMU_II::dump_C0XX_handlers() {
             printf("C0%02X: %p\n", i, C0xx_memory_read_handlers[i].hs[1].read);
         } */
     }
-}
\ No newline at end of file
+}
+
+void MMU_II::snapshot(SnapshotIO &io) {
+    int8_t slot = C8xx_slot;
+    io.field(f_intcxrom);
+    io.field(slot);
+    if (io.loading()) {
+        if (slot >= 0 && slot < 8) call_C8xx_handler((SlotType_t)slot);
+        else set_default_C8xx_map();
+    }
+}
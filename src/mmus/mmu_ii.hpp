@@ -3,7 +3,9 @@
 #include "gs2.hpp"
 #include "mmu.hpp"
 #include "mmu_ii.hpp"
+#include "util/SharedRam.hpp"
 
+class SnapshotIO;
 
 struct C8XX_handler_t {
     void (*handler)(void *context, SlotType_t slot);
@@ -14,6 +16,7 @@ class MMU_II : public MMU {
     protected:
         int ram_pages;
         uint32_t ram_size_ = 0;
+        SharedRam ram_block;
         uint8_t *main_ram = nullptr;
         //uint8_t *main_io_4 = nullptr;
         uint8_t *main_rom_D0 = nullptr;
@@ -26,6 +29,9 @@ class MMU_II : public MMU {
         page_table_entry_t slot_rom_ptable[15]; // handle C1-CF
 
         virtual void power_on_randomize(uint8_t *ram, int ram_size);
+
+        // $C000-$CFFF reads and writes switch soft switches and the C8xx slot ROM.
+        bool dma_direct_page(uint32_t page) override { return (page & 0xF0) != 0xC0; }
         
     public:
         bool f_intcxrom = false;
@@ -46,12 +52,15 @@ class MMU_II : public MMU {
         virtual uint8_t *get_rom_base();
         uint8_t *get_memory_base() override { return main_ram; }
         uint32_t get_memory_size() override { return ram_size_; }
+        const SharedRam *get_memory_block() override { return &ram_block; }
         virtual void init_map();
         virtual void set_default_C8xx_map();
         virtual void set_slot_rom(SlotType_t slot, uint8_t *rom, const char *name);
         virtual int get_C8xx_slot() { return C8xx_slot; };
         virtual void reset(bool cold_start = false) override;
         virtual void dump_C0XX_handlers();
+        /** Slot ROM switches; on load the C1-CF map is recomposed from them. */
+        virtual void snapshot(SnapshotIO &io);
         /* Handlers for "Slot ROM" area C1 - CF */
         virtual void compose_c1cf();
         virtual void map_c1cf_page_both(uint8_t page, uint8_t *data, const char *read_d);
@@ -1,4 +1,5 @@
 #include "mmu_iie.hpp"
+#include "util/Snapshot.hpp"
 
 /**
  * Sets base memory map without any specificity for various devices.
@@ -44,22 +45,22 @@ void MMU_IIe::compose_c1cf() {
     if (!f_intcxrom) { // INTCXROM off - C1-CF is for cards, with possible exception for C3 if SLOTC3ROM is on.
         // the C8 routines put this here. this is correct.
         for (int i = 8; i < 16; i++) {
-            page_table[0xC0 + i] = slot_rom_ptable[i-1];
+            set_page_table_entry(0xC0 + i, &slot_rom_ptable[i-1]);
         }
-        page_table[0xC1] = reg_slot & 0x02 ? slot_rom_ptable[0] : int_rom_ptable[0];
-        page_table[0xC2] = reg_slot & 0x04 ? slot_rom_ptable[1] : int_rom_ptable[1];
-        page_table[0xC3] = (f_slotc3rom) ? slot_rom_ptable[2] : int_rom_ptable[2]; // different flag here.
-        page_table[0xC4] = reg_slot & 0x10 ? slot_rom_ptable[3] : int_rom_ptable[3];
-        page_table[0xC5] = reg_slot & 0x20 ? slot_rom_ptable[4] : int_rom_ptable[4];
-        page_table[0xC6] = reg_slot & 0x40 ? slot_rom_ptable[5] : int_rom_ptable[5];
-        page_table[0xC7] = reg_slot & 0x80 ? slot_rom_ptable[6] : int_rom_ptable[6];
+        set_page_table_entry(0xC1, &(reg_slot & 0x02 ? slot_rom_ptable[0] : int_rom_ptable[0]));
+        set_page_table_entry(0xC2, &(reg_slot & 0x04 ? slot_rom_ptable[1] : int_rom_ptable[1]));
+        set_page_table_entry(0xC3, &((f_slotc3rom) ? slot_rom_ptable[2] : int_rom_ptable[2])); // different flag here.
+        set_page_table_entry(0xC4, &(reg_slot & 0x10 ? slot_rom_ptable[3] : int_rom_ptable[3]));
+        set_page_table_entry(0xC5, &(reg_slot & 0x20 ? slot_rom_ptable[4] : int_rom_ptable[4]));
+        set_page_table_entry(0xC6, &(reg_slot & 0x40 ? slot_rom_ptable[5] : int_rom_ptable[5]));
+        set_page_table_entry(0xC7, &(reg_slot & 0x80 ? slot_rom_ptable[6] : int_rom_ptable[6]));
         
         /* if (!f_slotc3rom) { // this has effect in A2Ts only if intcxrom is off.
             map_page_read_only(0xC3, main_rom_D0 + 0x0300, "SYS_ROM");
         } */
     } else { // INTCXROM is on - C1-CF is all ROM.
         for (int i = 1; i < 16; i++) {
-            page_table[0xC0 + i] = int_rom_ptable[i-1];
+            set_page_table_entry(0xC0 + i, &int_rom_ptable[i-1]);
             //map_page_read_only(0xC0 + i, main_rom_D0 + i * GS2_PAGE_SIZE, "SYS_ROM");
         }
     }
@@ -184,7 +185,10 @@ void MMU_IIe::write(uint32_t address, uint8_t value) {
     // if there is a write handler, call it instead of writing directly.
     page_table_entry_t *pte = &page_table[page];
     if (pte->write_h.write != nullptr) pte->write_h.write(pte->write_h.context, address, value);
-    else if (pte->write_p) pte->write_p[address & 0xFF] = value;
+    else if (pte->write_p) {
+        if (pte->video_watch) video_sync();
+        pte->write_p[address & 0xFF] = value;
+    }
     if (pte->shadow_h.write != nullptr) pte->shadow_h.write(pte->shadow_h.context, address, value);
 
     /* MMU::write(address, value); */
@@ -308,3 +312,11 @@ MMU_IIe::~MMU_IIe() {
     //delete[] main_io_4;
     //delete[] main_rom_D0;
 }
+
+void MMU_IIe::snapshot(SnapshotIO &io) {
+    io.field(f_intcxrom);
+    io.field(f_slotc3rom);
+    io.field(reg_slot);
+    MMU_II::snapshot(io);
+    if (io.loading()) compose_c1cf();
+}
@@ -27,6 +27,7 @@ class MMU_IIe : public MMU_II {
 
         void init_map() override;
         void reset(bool cold_start = false) override;
+        void snapshot(SnapshotIO &io) override;
 };
 
 void iie_mmu_handle_C00X_write(void *context, uint16_t address, uint8_t value);
@@ -3,6 +3,9 @@
 #include "devices/languagecard/languagecard.hpp"
 #include "mmus/mmu.hpp"
 #include "memoryspecs.hpp"
+#include "util/Snapshot.hpp"
+
+#include <cstring>
 
 uint8_t float_area_read(void *context, uint32_t address) {
     if (DEBUG(DEBUG_MMUGS)) printf("Float area read at address %06X\n", address);
@@ -64,8 +67,9 @@ inline void bank_e1_write(void *context, uint32_t address, uint8_t value) {
     {
         uint16_t a16 = (uint16_t)address;
         if (a16 >= 0xD000 && !mmu_iigs->is_lc_write_enable()) return; // LC write protected
-        uint8_t *ram = mmu_iigs->megaii->get_memory_base();
-        ram[mmu_iigs->e1_aux_index(a16)] = value;
+        uint8_t *ram = mmu_iigs->megaii->get_memory_base() + mmu_iigs->e1_aux_index(a16);
+        mmu_iigs->megaii->video_write_sync(ram);
+        *ram = value;
     }
 }
 
@@ -331,6 +335,7 @@ void MMU_IIgs::megaii_compose_map() {
     m_hires1_w = n_hires1_w;
     m_all_r = n_all_r;
     m_all_w = n_all_w;
+    invalidate_fast_map();
 }
 
 void MMU_IIgs::bsr_map_memory() {
@@ -388,6 +393,7 @@ void MMU_IIgs::bsr_map_memory() {
         lc->mmu->dump_page_table(0xD0, 0xD0);
         lc->mmu->dump_page_table(0xE0, 0xE0);
     } */
+    invalidate_fast_map();
 }
 
 uint8_t g_bsr_read_C0xx(void *context, uint32_t address) {
@@ -646,6 +652,182 @@ uint8_t iolc_rom_read(void *context, uint32_t address) {
 
 read_handler_t float_read_handler = { (memory_read_func)float_area_read, nullptr };
 
+void MMU_IIgs::invalidate_fast_map() {
+    if (++fast_gen == 0) { // wrapped: make sure no stale entry can match again
+        for (iigs_fast_page_t &fp : fast_map) fp.gen = 0;
+        fast_gen = 1;
+    }
+}
+
+void MMU_IIgs::watch_range(uint32_t start, uint32_t end, uint8_t access) {
+    MMU::watch_range(start, end, access);
+    for (uint32_t page = start >> 8; page <= (end >> 8) && page <= 0xFFFF; page++) {
+        int slot = fast_slot(page >> 8);
+        if (slot >= 0) fast_watch[(slot << 8) | (page & 0xFF)] |= access;
+    }
+    invalidate_fast_map();
+}
+
+void MMU_IIgs::clear_watches() {
+    MMU::clear_watches();
+    memset(fast_watch, 0, sizeof(fast_watch));
+    invalidate_fast_map();
+}
+
+void MMU_IIgs::write_block(uint32_t address, const uint8_t *src, uint32_t len) {
+    while (len) {
+        int slot = fast_slot(address >> 16);
+        if (slot < 0) {
+            // Rest of this bank: plain 64K page (fast RAM) or byte-wise.
+            uint32_t n = 0x10000 - (address & 0xFFFF);
+            if (n > len) n = len;
+            MMU::write_block(address, src, n);
+            address += n;
+            src += n;
+            len -= n;
+            continue;
+        }
+        uint32_t offset = address & 0xFF;
+        uint32_t n = 0x100 - offset;
+        if (n > len) n = len;
+        iigs_fast_page_t *fp = fast_page(slot, address);
+        if (fp->fast_write) {
+            if (fp->mega_p) {
+                megaii->video_write_sync(fp->mega_p + offset);
+                memcpy(fp->mega_p + offset, src, n);
+            }
+            if (fp->write_p) memcpy(fp->write_p + offset, src, n);
+        } else {
+            for (uint32_t i = 0; i < n; i++) write(address + i, src[i]);
+        }
+        address += n;
+        src += n;
+        len -= n;
+    }
+}
+
+void MMU_IIgs::read_block(uint32_t address, uint8_t *dst, uint32_t len) {
+    while (len) {
+        int slot = fast_slot(address >> 16);
+        if (slot < 0) {
+            uint32_t n = 0x10000 - (address & 0xFFFF);
+            if (n > len) n = len;
+            MMU::read_block(address, dst, n);
+            address += n;
+            dst += n;
+            len -= n;
+            continue;
+        }
+        uint32_t offset = address & 0xFF;
+        uint32_t n = 0x100 - offset;
+        if (n > len) n = len;
+        iigs_fast_page_t *fp = fast_page(slot, address);
+        if (fp->read_p) {
+            memcpy(dst, fp->read_p + offset, n);
+        } else {
+            for (uint32_t i = 0; i < n; i++) dst[i] = read(address + i);
+        }
+        address += n;
+        dst += n;
+        len -= n;
+    }
+}
+
+/* Host pointer for a Mega II write to page (0-$BF) if it is plain RAM there, else
+   nullptr. Mirrors MMU_IIe::write for pages with no handlers. */
+uint8_t *MMU_IIgs::megaii_write_page(uint32_t page) {
+    page_table_entry_t pte;
+    megaii->get_page_table_entry(page, &pte);
+    if (pte.write_h.write || pte.shadow_h.write) return nullptr;
+    return pte.write_p;
+}
+
+/* Rebuild one fast_map entry. Watched pages give up the fast path for the watched
+   kind of access so it goes through the (trapped) bank handler. */
+void MMU_IIgs::build_fast_page(iigs_fast_page_t *fp, int slot, uint32_t page) {
+    *fp = {};
+    fp->gen = fast_gen;
+    fp->read_cycle = CYCLE_TYPE_FAST;
+    if (!map_initialized || DEBUG(DEBUG_MMUGS)) return;
+
+    resolve_fast_page(fp, slot, page);
+
+    const uint8_t watch = fast_watch[(slot << 8) | page];
+    if (watch & WATCH_READ) fp->read_p = nullptr;
+    if (watch & WATCH_WRITE) fp->fast_write = false;
+}
+
+/* Resolve one page of banks $00/$01/$E0/$E1 the way bank_shadow_read/write and
+   bank_e0/e1_read/write would for the current state. Anything those handlers do
+   beyond "load/store through a pointer, maybe shadow to the Mega II, maybe set
+   the cycle type" stays on the handler path. */
+void MMU_IIgs::resolve_fast_page(iigs_fast_page_t *fp, int slot, uint32_t page) {
+    if (slot < 2) {
+        page_table_entry_t *pte = map_entry(slot);
+        if (pte->read_h.read != bank_shadow_read || pte->write_h.write != bank_shadow_write) return;
+
+        const uint32_t address = ((uint32_t)slot << 16) | (page << 8);
+        const bool iolc = is_iolc_shadowed();
+        if (iolc && page >= 0xC0 && page <= 0xCF) return; // Mega II I/O
+
+        if (iolc && page >= 0xD0 && !is_lc_read_enable()) {
+            fp->read_p = main_rom + rom_bank_ff_offset() + (address & 0xFFFF);
+            fp->read_cycle = CYCLE_TYPE_FAST_ROM;
+        } else {
+            uint32_t raddr = address;
+            if (iolc && page >= 0xD0 && page <= 0xDF && is_lc_bank1()) raddr -= 0x1000;
+            raddr += calc_aux_read(raddr);
+            if (raddr < get_memory_size()) fp->read_p = main_ram + raddr;
+        }
+
+        uint32_t waddr = address;
+        if (iolc && page >= 0xD0) {
+            if (!is_lc_write_enable()) return;
+            if (is_lc_bank1() && page <= 0xDF) waddr -= 0x1000;
+        }
+        waddr += calc_aux_write(waddr);
+        if (waddr >= get_memory_size()) return;
+
+        uint8_t *mega = nullptr;
+        if (shadow_is_enabled(waddr)) {
+            uint32_t a17 = waddr & 0x1'FFFF;
+            if ((a17 & 0x1'0000) && g_bank_latch) {
+                uint16_t a16 = (uint16_t)a17;
+                if (is_aux_linear() && a16 >= 0x2000 && a16 <= 0x9FFF) return; // byte interleave
+                mega = megaii->get_memory_base() + a17;
+            } else {
+                mega = megaii_write_page((a17 >> 8) & 0xFF);
+                if (!mega) return;
+            }
+        }
+        fp->write_p = main_ram + waddr;
+        fp->mega_p = mega;
+        fp->fast_write = true;
+        return;
+    }
+
+    // $E0/$E1: every access is a Mega II (1MHz) cycle. Only RAM below $C000.
+    if (page >= 0xC0) return;
+    page_table_entry_t *pte = map_entry(0xE0 + slot - 2);
+    if (slot == 2 && (pte->read_h.read != bank_e0_read || pte->write_h.write != bank_e0_write)) return;
+    if (slot == 3 && (pte->read_h.read != bank_e1_read || pte->write_h.write != bank_e1_write)) return;
+
+    uint8_t *rp, *wp;
+    if (slot == 3 && g_bank_latch) {
+        if (is_aux_linear() && page >= 0x20 && page <= 0x9F) return; // byte interleave
+        rp = wp = megaii->get_memory_base() + 0x1'0000 + (page << 8);
+    } else {
+        rp = megaii->get_page_base_address(page);
+        wp = megaii_write_page(page);
+    }
+    fp->read_p = rp;
+    fp->read_cycle = CYCLE_TYPE_SYNC;
+    if (wp) {
+        fp->mega_p = wp;
+        fp->fast_write = true;
+    }
+}
+
 void MMU_IIgs::init_c0xx_handlers() {
     for (uint32_t i = 0xC000; i <= 0xC009; i++) {
         megaii->set_C0XX_write_handler(i, {megaii_c0xx_write, this});
@@ -734,6 +916,8 @@ void MMU_IIgs::set_ram_shadow_banks() {
         }
     }
 
+    invalidate_fast_map();
+
     if (DEBUG(DEBUG_MMUGS)) {
         dump_page_table(0x00, 0x03);
         dump_page_table(0xE0, 0xE1);
@@ -776,6 +960,7 @@ void MMU_IIgs::init_map() {
 
     init_c0xx_handlers();
     map_initialized = true;
+    invalidate_fast_map();
 }
 
 void MMU_IIgs::reset(bool cold_start) {
@@ -804,6 +989,32 @@ void MMU_IIgs::reset(bool cold_start) {
         // don't do this here.
         //megaii->write(0xC054, 0x00);    
     }
+    invalidate_fast_map();
+}
+
+void MMU_IIgs::snapshot(SnapshotIO &io) {
+    uint8_t slot = reg_slot, speed = reg_speed;
+    io.field(slot);
+    io.field(speed);
+    io.field(reg_shadow);
+    io.field(reg_state);
+    io.field(reg_new_video);
+    io.field(g_80store);
+    io.field(g_hires);
+    io.field(g_text);
+    io.field(g_mixed);
+    ll.snapshot(io);
+    io.field(megaii->f_slotc3rom);
+    io.field(dma_bank_register);
+    if (!io.loading()) return;
+
+    set_slot_register(slot);
+    set_intcxrom(g_intcxrom);
+    set_speed_register(speed);
+    set_ram_shadow_banks();
+    megaii_compose_map();
+    bsr_map_memory();
+    invalidate_fast_map();
 }
 
 void MMU_IIgs::debug_dump(DebugFormatter *df) {
@@ -7,10 +7,24 @@
 #include "debug.hpp"
 #include "NClock.hpp"
 #include "devices/languagecard/LanguageCardLogic.hpp"
+#include "util/SharedRam.hpp"
+
+/* One 256-byte page of banks $00/$01/$E0/$E1, resolved down to host pointers for
+   the current softswitch / shadow / LC state. Pages that need the full handler
+   (I/O, LC write-protect, aux linearization, ...) keep null pointers. */
+struct iigs_fast_page_t {
+    uint8_t *read_p;        // nullptr: use the bank's read handler
+    uint8_t *write_p;       // FPI RAM store, or nullptr
+    uint8_t *mega_p;        // Mega II RAM store: the shadow copy, or the whole store in $E0/$E1
+    uint32_t gen;           // valid while equal to MMU_IIgs::fast_gen
+    uint8_t read_cycle;     // cycle type for reads; CYCLE_TYPE_FAST leaves it alone
+    bool fast_write;        // write_p / mega_p cover this page's writes
+};
 
 class MMU_IIgs : public MMU {
     protected:
         uint32_t ram_banks;
+        SharedRam ram_block;
         uint8_t *main_ram = nullptr;
         uint32_t rom_banks;
         uint8_t *main_rom = nullptr;
@@ -71,6 +85,30 @@ class MMU_IIgs : public MMU {
 
         uint8_t dma_bank_register = 0;
 
+        /* Banks $00/$01/$E0/$E1 at 256-byte granularity. Entries are rebuilt on
+           first touch after any map-affecting state change bumps fast_gen, so
+           flipping PAGE2 around every 80-column character store stays cheap. */
+        constexpr static int FAST_SLOTS = 4;
+        iigs_fast_page_t fast_map[FAST_SLOTS * 256] = {};
+        uint32_t fast_gen = 1;
+        // WATCH_* per fast page. A watched page stays off the fast path for that kind
+        // of access, so it reaches the trapped bank entry; the rest of the bank doesn't.
+        uint8_t fast_watch[FAST_SLOTS * 256] = {};
+
+        static inline int fast_slot(uint32_t bank) {
+            if (bank < 0x02) return bank;
+            if ((bank & 0xFE) == 0xE0) return 2 + (bank & 1);
+            return -1;
+        }
+        inline iigs_fast_page_t *fast_page(int slot, uint32_t address) {
+            iigs_fast_page_t *fp = &fast_map[(slot << 8) | ((address >> 8) & 0xFF)];
+            if (fp->gen != fast_gen) build_fast_page(fp, slot, (address >> 8) & 0xFF);
+            return fp;
+        }
+        void build_fast_page(iigs_fast_page_t *fp, int slot, uint32_t page);
+        void resolve_fast_page(iigs_fast_page_t *fp, int slot, uint32_t page);
+        uint8_t *megaii_write_page(uint32_t page);
+
         //cpu_state *cpu = nullptr;
         NClock *clock = nullptr;
 
@@ -80,7 +118,7 @@ class MMU_IIgs : public MMU {
 
         MMU_IIgs(size_t num_banks, int ram_size, uint32_t rom_size, uint8_t *rom, MMU_IIe *mmu_iie) : MMU(num_banks, BANK_SIZE), megaii(mmu_iie) {
             ram_banks = ram_size / BANK_SIZE;
-            main_ram = new uint8_t[ram_banks * BANK_SIZE];
+            main_ram = ram_block.allocate(ram_banks * BANK_SIZE);
             rom_banks = rom_size / BANK_SIZE;
             is_rom03 = rom_banks >= 4;
             main_rom = rom;
@@ -89,20 +127,50 @@ class MMU_IIgs : public MMU {
             reset(true); // power-on: ROM03 CYAREG bit 6 set when cold_start
         };
 
-        virtual ~MMU_IIgs() { delete[] main_ram; /* main_rom is owned by caller */ }
+        virtual ~MMU_IIgs() { /* ram_block frees main_ram; main_rom is owned by caller */ }
 
         virtual uint8_t read(uint32_t address) override {
-            if (address >= ROM_SPACE_BASE) set_next_cycle_type(CYCLE_TYPE_FAST_ROM); // rom access is fast.
+            int slot = fast_slot(address >> 16);
+            if (slot >= 0) {
+                iigs_fast_page_t *fp = fast_page(slot, address);
+                if (fp->read_p) {
+                    if (fp->read_cycle != CYCLE_TYPE_FAST) set_next_cycle_type((cycle_type_t)fp->read_cycle);
+                    return fp->read_p[address & 0xFF];
+                }
+            } else if (address >= ROM_SPACE_BASE) set_next_cycle_type(CYCLE_TYPE_FAST_ROM); // rom access is fast.
 
             return MMU::read(address);
         }
 
         virtual void write(uint32_t address, uint8_t value) override {
-            if (address >= ROM_SPACE_BASE) set_next_cycle_type(CYCLE_TYPE_FAST_ROM); // rom access is fast.
+            int slot = fast_slot(address >> 16);
+            if (slot >= 0) {
+                iigs_fast_page_t *fp = fast_page(slot, address);
+                if (fp->fast_write) {
+                    uint32_t offset = address & 0xFF;
+                    if (fp->mega_p) {
+                        megaii->video_write_sync(fp->mega_p + offset);
+                        fp->mega_p[offset] = value;
+                        set_next_cycle_type(CYCLE_TYPE_SYNC);
+                    }
+                    if (fp->write_p) fp->write_p[offset] = value;
+                    return;
+                }
+            } else if (address >= ROM_SPACE_BASE) set_next_cycle_type(CYCLE_TYPE_FAST_ROM); // rom access is fast.
 
             MMU::write(address, value);
         }
 
+        // Call after anything that changes how banks $00/$01/$E0/$E1 decode.
+        void invalidate_fast_map();
+
+        void watch_range(uint32_t start, uint32_t end, uint8_t access) override;
+        void clear_watches() override;
+
+        // Banks $00/$01/$E0/$E1 go through the fast map (shadowing included).
+        void write_block(uint32_t address, const uint8_t *src, uint32_t len) override;
+        void read_block(uint32_t address, uint8_t *dst, uint32_t len) override;
+
         inline bool shadow_is_enabled(uint32_t address) {
             uint32_t address_16 = address & 0xFFFF;
             uint32_t address_17 = address & 0x1FFFF;
@@ -149,6 +217,7 @@ class MMU_IIgs : public MMU {
                 if (is_aux_linear()) {
                     idx = 0x1'0000 | iigs_aux_linear_to_phys((uint16_t)idx);
                 }
+                megaii->video_write_sync(megaii->get_memory_base() + idx);
                 megaii->get_memory_base()[idx] = value;
             } else {
                 megaii->write(address & 0xFFFF, value);
@@ -176,7 +245,7 @@ class MMU_IIgs : public MMU {
             return 0x1'0000 | a16;
         }
 
-        inline void set_shadow_register(uint8_t value) { if (DEBUG(DEBUG_MMUGS)) printf("setting shadow register: %02X\n", value); reg_shadow = value; }
+        inline void set_shadow_register(uint8_t value) { if (DEBUG(DEBUG_MMUGS)) printf("setting shadow register: %02X\n", value); reg_shadow = value; invalidate_fast_map(); }
         inline void set_speed_register(uint8_t value) { 
             if (DEBUG(DEBUG_MMUGS)) printf("setting speed register: %02X\n", value); 
             reg_speed = value;
@@ -187,6 +256,7 @@ class MMU_IIgs : public MMU {
             reg_state = value; 
             ll.FF_READ_ENABLE = !g_rdrom; // sync LC state with state reg 
             ll.FF_BANK_1 = !g_lcbnk2; // this was missing.. 
+            invalidate_fast_map();
         }
         inline uint8_t shadow_register() { return reg_shadow; }
         inline uint8_t speed_register() { return reg_speed; }
@@ -195,23 +265,23 @@ class MMU_IIgs : public MMU {
         void set_ram_shadow_banks();
         //void shadow_register(uint16_t address, bool rw); // track accesses to softswitches the FPI also tracks.
         inline bool is_lc_bank1() { return ll.FF_BANK_1 == 1; }
-        inline void set_lc_bank1(bool value) { ll.FF_BANK_1 = value; g_lcbnk2 = !value; }
+        inline void set_lc_bank1(bool value) { ll.FF_BANK_1 = value; g_lcbnk2 = !value; invalidate_fast_map(); }
         inline bool is_lc_read_enable() { return ll.FF_READ_ENABLE == 1; }
-        inline void set_lc_read_enable(bool value) { ll.FF_READ_ENABLE = value; g_rdrom = !value; }
+        inline void set_lc_read_enable(bool value) { ll.FF_READ_ENABLE = value; g_rdrom = !value; invalidate_fast_map(); }
         inline bool is_lc_pre_write() { return ll.FF_PRE_WRITE == 1; }
         inline void set_lc_pre_write(bool value) { ll.FF_PRE_WRITE = value; }
         inline bool is_lc_write_enable() { return ll._FF_WRITE_ENABLE == 0; } // reverse sense since this is active low
-        inline void set_lc_write_enable(bool value) { ll._FF_WRITE_ENABLE = value; }
+        inline void set_lc_write_enable(bool value) { ll._FF_WRITE_ENABLE = value; invalidate_fast_map(); }
         inline bool is_page2() { return g_page2; }
-        inline void set_page2(bool value) { g_page2 = value; }
+        inline void set_page2(bool value) { g_page2 = value; invalidate_fast_map(); }
         inline bool is_hires() { return g_hires; }
-        inline void set_hires(bool value) { g_hires = value; }
+        inline void set_hires(bool value) { g_hires = value; invalidate_fast_map(); }
         inline bool is_text() { return g_text; }
         inline void set_text(bool value) { g_text = value; }
         inline bool is_mixed() { return g_mixed; }
         inline void set_mixed(bool value) { g_mixed = value; }
         inline bool is_altzp() { return g_altzp; }
-        inline void set_altzp(bool value) { g_altzp = value; }
+        inline void set_altzp(bool value) { g_altzp = value; invalidate_fast_map(); }
         
         inline bool is_80store() { return g_80store ? true : false; }
         inline bool is_slotc3rom() { return megaii->f_slotc3rom ? true : false; }
@@ -244,10 +314,14 @@ class MMU_IIgs : public MMU {
         inline uint32_t rom_bank_ff_offset() const { return (rom_banks - 1) * BANK_SIZE; }
         uint8_t *get_memory_base() override { return main_ram; }
         uint32_t get_memory_size() override { return ram_banks * BANK_SIZE; }
+        const SharedRam *get_memory_block() override { return &ram_block; }
         inline bool is_rom03_machine() const { return is_rom03; }
 
         virtual void init_map();
         virtual void reset(bool cold_start = false) override;
+        /** FPI registers and softswitches. The m_* flags describe the live Mega II map and are
+            not saved, so on load megaii_compose_map() moves exactly the pages that differ. */
+        void snapshot(SnapshotIO &io);
         void debug_dump(DebugFormatter *df);
 
         inline void set_clock(NClockII *clock) { this->clock = clock; }
@@ -20,6 +20,8 @@
 #include <errno.h>
 #include <cstdlib>
 #include <sys/stat.h>
+#include <mutex>
+#include <unordered_map>
 #include "platforms.hpp"
 #include "util/ResourceFile.hpp"
 #include "util/dialog.hpp"
@@ -191,14 +193,26 @@ int num_platforms = sizeof(platforms) / sizeof(platforms[0]);
     return nullptr;
 }
 
+/*
+ * ROM images are immutable once loaded (the MMUs map them read-only), so every machine
+ * built for a platform shares one copy. They stay loaded for the life of the process.
+ */
+static std::mutex rom_cache_mutex;
+static std::unordered_map<int, rom_data *> rom_cache;
+
 rom_data* load_platform_roms(platform_info *platform) {
     if (!platform) return nullptr;
 
+    std::lock_guard<std::mutex> lock(rom_cache_mutex);
+    auto it = rom_cache.find(platform->id);
+    if (it != rom_cache.end()) {
+        return it->second;
+    }
+
     fprintf(stderr, "Platform: %s   folder name: %s\n", platform->name, platform->rom_dir);
 
     rom_data* roms = new rom_data();
     char filepath[256];
-    struct stat st;
 
     // Load main ROM
     snprintf(filepath, sizeof(filepath), "roms/%s/main.rom", platform->rom_dir);
@@ -207,6 +221,7 @@ rom_data* load_platform_roms(platform_info *platform) {
         char *debugstr = new char[512];
         snprintf(debugstr, 512, "Failed to stat %s errno: %d\n", filepath, errno);
         system_failure(debugstr);
+        delete roms->main_rom_file;
         delete roms;
         return nullptr;
     }
@@ -219,7 +234,8 @@ rom_data* load_platform_roms(platform_info *platform) {
         char *debugstr = new char[512];
         snprintf(debugstr, 512, "Failed to stat %s errno: %d\n", filepath, errno);
         system_failure(debugstr);
-        delete[] roms->main_rom_file;
+        delete roms->main_rom_file;
+        delete roms->char_rom_file;
         delete roms;
         return nullptr;
     }
@@ -231,10 +247,11 @@ rom_data* load_platform_roms(platform_info *platform) {
     fprintf(stdout, "  Main ROM Size: %zu bytes\n", roms->main_rom_file->size());
     fprintf(stdout, "  Character ROM Size: %zu bytes\n", roms->char_rom_file->size());
 
+    rom_cache[platform->id] = roms;
     return roms;
 }
 
-// Helper function to free ROM data
+// Helper function to free ROM data. Not for the shared images load_platform_roms returns.
 void free_platform_roms(rom_data* roms) {
     if (roms) {
         delete roms->main_rom_file;
@@ -55,6 +55,7 @@ struct rom_data {
 extern  int num_platforms;
 platform_info* get_platform(int index);
 platform_info* find_platform_by_dir(const char* dir);
+/* Shared, read-only and cached per platform: callers must not modify or free the result. */
 rom_data* load_platform_roms(platform_info *platform);
 void free_platform_roms(rom_data* roms); 
 void print_platform_info(platform_info *platform);
\ No newline at end of file
@@ -10,7 +10,8 @@ int SDLCALL SerialDeviceThreadHandler(void *data) {
     return 0;
 }
 
-SerialDevice::SerialDevice(const char *name, const char *port_id) {
+SerialDevice::SerialDevice(const char *name, const char *port_id, uint32_t queue_depth)
+    : q_host(queue_depth), q_dev(queue_depth) {
     this->name = name ? name : "SerialDevice";
     this->port_id = port_id ? port_id : "UNK";
 
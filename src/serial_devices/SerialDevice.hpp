@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <SDL3/SDL.h>
 
 enum serial_message_type_t {
@@ -17,39 +19,105 @@ struct SerialMessage {
     uint64_t data;
 };
 
+/**
+ * Single-producer / single-consumer ring of SerialMessages between the emulator
+ * thread and a device thread. head is written only by the producer and tail only
+ * by the consumer; the release store of one and the acquire load of the other
+ * hand the slot across, so neither side ever takes a lock.
+ *
+ * The consumer may sleep in wait() until the producer sends something. A sleeping
+ * consumer sets 'waiting'; send() rings the doorbell only when it sees it, so a
+ * producer sending to a busy consumer pays one extra load and no system call.
+ */
 class SerialQueue {
-    constexpr static uint32_t queue_depth = 128; // must be a power of 2!!
-    constexpr static uint32_t queue_mask = queue_depth - 1;
-    
-    SerialMessage queue[queue_depth];
-    uint32_t head = 0;
-    uint32_t tail = 0;
+    public:
+        constexpr static uint32_t default_depth = 1024;
+
+    private:
+        uint32_t queue_depth;           // power of 2
+        uint32_t queue_mask;
+        std::unique_ptr<SerialMessage[]> queue;
+        SDL_Semaphore *doorbell = nullptr;
+
+        // Free-running indexes, masked on use; head - tail is the count.
+        alignas(64) std::atomic<uint32_t> head{0};
+        alignas(64) std::atomic<uint32_t> tail{0};
+        alignas(64) std::atomic<bool> waiting{false};
+
+        static uint32_t round_depth(uint32_t depth) {
+            uint32_t d = 2;
+            while (d < depth) d <<= 1;
+            return d;
+        }
 
     public:
-        SerialQueue() = default;
-        ~SerialQueue() = default;
-        
-        inline bool is_empty() { return head == tail; }
-        inline SerialMessage get() { 
-            if (is_empty()) {
+        explicit SerialQueue(uint32_t depth = default_depth)
+            : queue_depth(round_depth(depth)), queue_mask(round_depth(depth) - 1),
+              queue(new SerialMessage[round_depth(depth)]), doorbell(SDL_CreateSemaphore(0)) {}
+        ~SerialQueue() { if (doorbell) SDL_DestroySemaphore(doorbell); }
+        SerialQueue(const SerialQueue &) = delete;
+        SerialQueue &operator=(const SerialQueue &) = delete;
+
+        inline bool is_empty() const {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+        }
+
+        /* Consumer side. */
+        inline SerialMessage get() {
+            uint32_t t = tail.load(std::memory_order_relaxed);
+            if (head.load(std::memory_order_acquire) == t) {
                 return SerialMessage{MESSAGE_NONE, 0};
             }
-            SerialMessage msg = queue[tail];
-            tail = (tail + 1) & queue_mask;
+            SerialMessage msg = queue[t & queue_mask];
+            tail.store(t + 1, std::memory_order_release);
             return msg;
         }
 
-        inline bool is_full() { return ((head + 1) & queue_mask) == tail; }
+        /**
+         * Consumer side: block until the queue is non-empty or timeout_ms passes
+         * (-1 waits forever). Returns true if there is something to get().
+         */
+        bool wait(int32_t timeout_ms) {
+            if (!is_empty()) return true;
+            if (!doorbell) {
+                SDL_Delay(timeout_ms < 0 ? 10 : (uint32_t)timeout_ms);
+                return !is_empty();
+            }
+            // seq_cst on both sides: either send() sees waiting, or we see its head.
+            waiting.store(true);
+            bool signalled = false;
+            if (head.load() == tail.load(std::memory_order_relaxed)) {
+                signalled = SDL_WaitSemaphoreTimeout(doorbell, timeout_ms);
+            }
+            if (!signalled && !waiting.exchange(false)) {
+                // send() claimed the wakeup; take its signal so the count stays 0.
+                SDL_WaitSemaphore(doorbell);
+            }
+            return !is_empty();
+        }
+
+        inline bool is_full() const {
+            return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) >= queue_depth;
+        }
+
+        /* Producer side. */
         inline bool send(SerialMessage msg) {
-            if (is_full()) {
+            uint32_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) >= queue_depth) {
                 return false;
             }
-            queue[head] = msg;
-            head = (head + 1) & queue_mask;
+            queue[h & queue_mask] = msg;
+            head.store(h + 1);
+            if (waiting.load() && waiting.exchange(false)) {
+                SDL_SignalSemaphore(doorbell);
+            }
             return true;
         }
 
-        inline uint64_t get_count() { return (head - tail) & queue_mask; }
+        inline uint64_t get_count() const {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+        inline uint32_t get_depth() const { return queue_depth; }
 };
 
 class SerialDevice {
@@ -62,13 +130,15 @@ class SerialDevice {
         SerialQueue q_host; // host -> dev queue
         SerialQueue q_dev;  // dev -> host queue
 
-        SerialDevice(const char *name, const char *port_id);
+        SerialDevice(const char *name, const char *port_id, uint32_t queue_depth = SerialQueue::default_depth);
         virtual ~SerialDevice();
 
         /*
            This method only exits when it receives a SHUTDOWN message. Otherwise
            processes in a loop forever.
            Must ONLY q_host->get() and q_dev->send() to prevent race conditions.
+           Sleep in q_host.wait() rather than SDL_Delay() so a send from the
+           emulator wakes the thread at once.
         */
 
         const char *get_name() { return name; }
@@ -13,7 +13,7 @@ class EchoDevice : public SerialDevice {
 
         void device_loop() override {
             while (true) {
-                SDL_Delay(17);
+                q_host.wait(-1);
                 uint64_t bytes_received = 0;
                 uint64_t bytes_in_q = q_host.get_count();
                 
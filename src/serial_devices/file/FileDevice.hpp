@@ -153,7 +153,13 @@ class FileDevice : public SerialDevice {
 
         void device_loop() override {
             while (true) {
-                SDL_Delay(10);
+                // Sleep until the host sends something, or until an open file goes idle.
+                int32_t timeout_ms = -1;
+                if (file && last_write_ticks != 0) {
+                    uint64_t idle = SDL_GetTicks() - last_write_ticks;
+                    timeout_ms = idle >= idle_close_ms ? 0 : (int32_t)(idle_close_ms - idle);
+                }
+                q_host.wait(timeout_ms);
 
                 if (file && last_write_ticks != 0 &&
                     (SDL_GetTicks() - last_write_ticks) >= idle_close_ms) {
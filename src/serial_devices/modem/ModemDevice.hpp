@@ -61,6 +61,10 @@ class ModemDevice : public SerialDevice {
         
         // TCP receive buffer
         std::vector<uint8_t> tcp_buffer;
+        constexpr static uint32_t modem_queue_depth = 4096; // a full tcp_buffer fits in q_dev
+        // Online, the socket is polled this often. At 9600 baud that's ~10 bytes per
+        // poll, well inside tcp_buffer and q_dev; host bytes still wake us at once.
+        constexpr static int32_t socket_poll_ms = 10;
 
         void send_response(const char *response) {
             size_t len = strlen(response);
@@ -310,17 +314,15 @@ class ModemDevice : public SerialDevice {
         }
 
         void drain_tcp_buffer_to_queue() {
-            // Try to move buffered data to the serial queue
-            while (!tcp_buffer.empty() && !q_dev.is_full()) {
-                SerialMessage msg;
-                msg.type = MESSAGE_DATA;
-                msg.data = tcp_buffer[0];
-                if (q_dev.send(msg)) {
-                    tcp_buffer.erase(tcp_buffer.begin());
-                } else {
+            // Move as much buffered data as fits into the serial queue, then drop it in one go
+            size_t sent = 0;
+            while (sent < tcp_buffer.size()) {
+                if (!q_dev.send({MESSAGE_DATA, tcp_buffer[sent]})) {
                     break;  // Queue is full, stop trying
                 }
+                sent++;
             }
+            tcp_buffer.erase(tcp_buffer.begin(), tcp_buffer.begin() + sent);
         }
 
         void check_tcp_data() {
@@ -377,7 +379,7 @@ class ModemDevice : public SerialDevice {
         }
 
     public:
-        ModemDevice(const char *name, const char *port_id) : SerialDevice("ModemDevice", port_id), 
+        ModemDevice(const char *name, const char *port_id) : SerialDevice("ModemDevice", port_id, modem_queue_depth), 
                        state(STATE_COMMAND),
                        socket(nullptr),
                        remote_port(23),
@@ -411,8 +413,11 @@ class ModemDevice : public SerialDevice {
 
         void device_loop() override {
             while (true) {
-                SDL_Delay(10); // Check every 10ms for better responsiveness
-                
+                // In command mode only the host can give us work. Online, the socket
+                // has no wakeup we can share with the queue, so look at it every
+                // socket_poll_ms; the +++ guard time only needs the same resolution.
+                q_host.wait(state == STATE_COMMAND ? -1 : socket_poll_ms);
+
                 // Check for incoming TCP data if we're online
                 if (state == STATE_ONLINE) {
                     check_tcp_data();
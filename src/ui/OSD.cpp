@@ -15,6 +15,7 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <filesystem>
 #include <stdexcept>
 #include <string>
 #include <SDL3/SDL.h>
@@ -176,6 +177,37 @@ void OSD::refresh_host_fst_button() {
     }
 }
 
+namespace {
+
+void snapshot_slot_paths(computer_t *computer, std::string &base, std::string &quick) {
+    std::string id = computer->get_machine_id().empty() ? "default" : computer->get_machine_id();
+    Paths::calc_pref(base, "snapshots/" + id + ".base.gs2snap");
+    Paths::calc_pref(quick, "snapshots/" + id + ".gs2snap");
+}
+
+}  // namespace
+
+void OSD::save_state() {
+    std::string base, quick, err;
+    snapshot_slot_paths(computer, base, quick);
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(quick).parent_path(), ec);
+
+    bool ok = true;
+    if (!computer->snapshots->has_base()) {
+        ok = computer->save_snapshot(base, false, err);
+    }
+    ok = ok && computer->save_snapshot(quick, true, err);
+    set_heads_up_message(ok ? "State saved" : "Save failed: " + err, 120);
+}
+
+void OSD::load_state() {
+    std::string base, quick, err;
+    snapshot_slot_paths(computer, base, quick);
+    bool ok = computer->load_snapshot(quick, err);
+    set_heads_up_message(ok ? "State loaded" : "Load failed: " + err, 120);
+}
+
 void OSD::open_host_fst_folder_dialog() {
 #if defined(__EMSCRIPTEN__)
     set_heads_up_message("Host FST folder picker unavailable", 120);
@@ -454,6 +486,34 @@ OSD::OSD(computer_t *computer, SDL_Renderer *rendererp, SDL_Window *windowp, Slo
         host_fst_con->layout();
     }
 
+    Style_t snapBtnStyle;
+    snapBtnStyle.background_color = 0xE0E0FFFF;
+    snapBtnStyle.text_color = 0x000000FF;
+    snapBtnStyle.border_width = 1;
+    snapBtnStyle.border_color = 0x000000FF;
+    snapBtnStyle.padding = 2;
+
+    snap_con = new Container_t(&ui_ctx, SC);
+    snap_con->set_position(30, 690);
+    snap_con->size(320, 50);
+    containers.push_back(snap_con);
+
+    snap_save_btn = new Button_t(&ui_ctx, "Save State", snapBtnStyle);
+    snap_save_btn->size(145, 36);
+    snap_save_btn->on_click([this](const SDL_Event&) -> bool {
+        save_state();
+        return true;
+    });
+    snap_load_btn = new Button_t(&ui_ctx, "Load State", snapBtnStyle);
+    snap_load_btn->size(145, 36);
+    snap_load_btn->on_click([this](const SDL_Event&) -> bool {
+        load_state();
+        return true;
+    });
+    snap_con->add(snap_save_btn);
+    snap_con->add(snap_load_btn);
+    snap_con->layout();
+
     // Create text buttons for the disk save dialog
     Style_t TextButtonCfg;
     TextButtonCfg.background_color = 0xE0E0FFFF;
@@ -527,9 +587,11 @@ OSD::OSD(computer_t *computer, SDL_Renderer *rendererp, SDL_Window *windowp, Slo
         delete media;
 #endif
         // after that, find button that was under the mouse. Scan Drive Container for button that is highlighted.
+        bool on_drive = false;
         for (int i = 0; i < drive_container->count(); i++) {
             Tile_t *tile = drive_container->get_tile(i);
             if (tile && tile->is_mouse_hovering()) {
+                on_drive = true;
                 StorageButton *button = dynamic_cast<StorageButton *>(tile);
                 storage_key_t key = button->get_key();
                 disk_mount_t dm;
@@ -547,6 +609,13 @@ OSD::OSD(computer_t *computer, SDL_Renderer *rendererp, SDL_Window *windowp, Slo
                 }
             }
         }
+        // Anywhere else: a BASIC listing or a #06AAAA binary goes straight into memory.
+        std::string status;
+        if (!on_drive && event.drop.data && computer->load_program_file(event.drop.data, status)) {
+            static char msg[160];
+            snprintf(msg, sizeof(msg), "%s", status.c_str());
+            computer->event_queue->addEvent(new Event(EVENT_SHOW_MESSAGE, 0, msg));
+        }
         // Raise our window to the top. After a DD I would expect to be able to just go back to doing stuff in the app.
         SDL_RaiseWindow(window);
 #if defined(__EMSCRIPTEN__)
@@ -854,6 +923,14 @@ void OSD::render() {
 
         open_btn->render(); // this now takes care of its own fade-out.
 
+        if (computer->disk_accel.active) {
+            static const char disk_accel_str[] = "DISK ACCEL";
+            SDL_SetRenderDrawColor(renderer, 0xFF, 0xC0, 0x40, 0xFF);
+            SDL_RenderDebugText(renderer,
+                window_width - 20 - (sizeof(disk_accel_str) - 1) * SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE,
+                window_height - 30, disk_accel_str);
+        }
+
         //hover_controls_con->render();
 
         // display the MHz at the bottom of the screen.
@@ -864,8 +941,9 @@ void OSD::render() {
                 const char *tag = computer->is_ludicrous_calibrating() ? " (cal)" :
                     (computer->is_ludicrous_locked() ? "" : " (cal)");
                 snprintf(hud_str, sizeof(hud_str),
-                    "MHz: %8.4f (%ux14.3%s) / FPS %8.4f / Idle: %5.1f%%",
-                    computer->e_mhz, n, tag, computer->fps, computer->get_idle_percent());
+                    "MHz: %8.4f (%ux14.3%s) / FPS %8.4f (shown %4.1f) / Idle: %5.1f%%",
+                    computer->e_mhz, n, tag, computer->fps, computer->presented_fps,
+                    computer->get_idle_percent());
             } else {
                 snprintf(hud_str, sizeof(hud_str), "MHz: %8.4f / FPS %8.4f / Idle: %5.1f%%",
                     computer->e_mhz, computer->fps, computer->get_idle_percent());
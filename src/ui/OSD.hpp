@@ -91,6 +91,10 @@ protected:
     Container_t *host_fst_con = nullptr;
     Button_t *host_fst_btn = nullptr;
 
+    Container_t *snap_con = nullptr;
+    Button_t *snap_save_btn = nullptr;
+    Button_t *snap_load_btn = nullptr;
+
     Button_t *save_btn = nullptr;
     Button_t *save_as_btn = nullptr;
     Button_t *discard_btn = nullptr;
@@ -203,6 +207,10 @@ public:
     void open_host_fst_folder_dialog();
     void refresh_host_fst_button();
 
+    /** Quick save slot under PrefPath/snapshots: a base written once per session, then deltas. */
+    void save_state();
+    void load_state();
+
     void show_connection_picker(connection_key_t key, connection_port_kind_t kind);
     void dismiss_connection_picker();
     void refresh_serial_ports();
@@ -0,0 +1,209 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+
+#include "Applesoft.hpp"
+
+// In ROM order ($D0D0); the position is the token.
+const char *const applesoft_keywords[APPLESOFT_KEYWORD_COUNT] = {
+    "END", "FOR", "NEXT", "DATA", "INPUT", "DEL", "DIM", "READ",
+    "GR", "TEXT", "PR#", "IN#", "CALL", "PLOT", "HLIN", "VLIN",
+    "HGR2", "HGR", "HCOLOR=", "HPLOT", "DRAW", "XDRAW", "HTAB", "HOME",
+    "ROT=", "SCALE=", "SHLOAD", "TRACE", "NOTRACE", "NORMAL", "INVERSE", "FLASH",
+    "COLOR=", "POP", "VTAB", "HIMEM:", "LOMEM:", "ONERR", "RESUME", "RECALL",
+    "STORE", "SPEED=", "LET", "GOTO", "RUN", "IF", "RESTORE", "&",
+    "GOSUB", "RETURN", "REM", "STOP", "ON", "WAIT", "LOAD", "SAVE",
+    "DEF", "POKE", "PRINT", "CONT", "LIST", "CLEAR", "GET", "NEW",
+    "TAB(", "TO", "FN", "SPC(", "THEN", "AT", "NOT", "STEP",
+    "+", "-", "*", "/", "^", "AND", "OR", ">",
+    "=", "<", "SGN", "INT", "ABS", "USR", "FRE", "SCRN(",
+    "PDL", "POS", "SQR", "RND", "LOG", "EXP", "COS", "SIN",
+    "TAN", "ATN", "PEEK", "LEN", "STR$", "VAL", "ASC", "CHR$",
+    "LEFT$", "RIGHT$", "MID$",
+};
+
+namespace {
+
+constexpr uint8_t TOKEN_DATA = 0x83;
+constexpr uint8_t TOKEN_REM = 0xB2;
+constexpr uint8_t TOKEN_PRINT = 0xBA;
+constexpr uint8_t TOKEN_AT = 0xC5;
+
+inline uint8_t fold(uint8_t c) {
+    return c >= 'a' ? (c & 0x5F) : c;
+}
+
+} // namespace
+
+/*
+ * Follows PARSE step for step. 'endchr' and 'in_data' are ENDCHR ($0E) and DATAFLG
+ * ($13); the enhanced ROMs' fetch helper consults both, so they are kept exactly.
+ */
+void applesoft_tokenize_line(const std::string &text, bool fold_lowercase, std::vector<uint8_t> &out) {
+    std::vector<uint8_t> in;
+    in.reserve(text.size() + 2);
+    for (char ch : text) in.push_back((uint8_t)ch & 0x7F);     // INLIN strips bit 7
+    in.push_back(0);
+    in.push_back(0);
+
+    uint8_t endchr = 0;
+    bool in_data = false;
+
+    // The fetch at PARSE's top and in its keyword compare.
+    auto fetch = [&](size_t i) -> uint8_t {
+        uint8_t c = in[i];
+        if (fold_lowercase && endchr != 0 && endchr != '"' && !in_data) c = fold(c);
+        return c;
+    };
+    // The unconditional fold the enhanced ROMs use elsewhere.
+    auto fetch_folded = [&](size_t i) -> uint8_t {
+        return fold_lowercase ? fold(in[i]) : in[i];
+    };
+
+    size_t x = 0;
+    while (true) {
+        uint8_t c = fetch(x);
+        if (!in_data && c == ' ') {
+            x++;
+            continue;
+        }
+        endchr = c;
+
+        if (c == '"') {
+            // Copy the quoted string as-is; the closing quote is stored below.
+            out.push_back(c);
+            x++;
+            while (in[x] != 0 && in[x] != endchr) out.push_back(in[x++]);
+            c = in[x];
+        } else if (in_data) {
+            // stored as-is
+        } else if (c == '?') {
+            c = TOKEN_PRINT;
+        } else if (c >= '0' && c < '<') {
+            // digits, ':' and ';' are stored as-is
+        } else {
+            // Try each keyword in table order, skipping blanks in the input.
+            const size_t start = x;
+            bool found = false;
+            for (uint32_t t = 0; t < APPLESOFT_KEYWORD_COUNT && !found; t++) {
+                const char *kw = applesoft_keywords[t];
+                size_t xi = start;
+                size_t k = 0;
+                while (true) {
+                    uint8_t ic = fetch(xi);
+                    while (ic == ' ') ic = fetch(++xi);
+                    if (ic != (uint8_t)kw[k]) break;
+                    if (kw[k + 1] == 0) {
+                        uint8_t token = (uint8_t)(0x80 + t);
+                        if (token == TOKEN_AT) {
+                            // "ATN" and "A TO" are not AT.
+                            uint8_t next = fetch_folded(xi + 1);
+                            if (next == 'N' || next == 'O') break;
+                        }
+                        c = token;
+                        x = xi;
+                        found = true;
+                        break;
+                    }
+                    k++;
+                    xi++;
+                }
+            }
+            if (!found) c = fetch_folded(start);
+        }
+
+        // Store, then track statement boundaries.
+        x++;
+        out.push_back(c);
+        if (c == 0) break;
+        if (c == ':') in_data = false;
+        else if (c == TOKEN_DATA) in_data = true;
+        if (c == TOKEN_REM) {
+            endchr = 0;
+            while (in[x] != 0) out.push_back(in[x++]);
+            out.push_back(0);
+            break;
+        }
+    }
+}
+
+bool applesoft_tokenize_listing(const std::string &listing, uint16_t txttab, bool fold_lowercase,
+                                std::vector<uint8_t> &image, uint32_t &line_count, std::string &err) {
+    std::map<uint32_t, std::vector<uint8_t>> lines;
+    uint32_t source_line = 0;
+    size_t pos = 0;
+
+    while (pos < listing.size()) {
+        size_t eol = listing.find_first_of("\r\n", pos);
+        if (eol == std::string::npos) eol = listing.size();
+        std::string text = listing.substr(pos, eol - pos);
+        pos = eol;
+        if (pos < listing.size() && listing[pos] == '\r') pos++;
+        if (pos < listing.size() && listing[pos] == '\n') pos++;
+        source_line++;
+
+        // LINGET via CHRGET: blanks are skipped, even between digits.
+        size_t i = 0;
+        while (i < text.size() && text[i] == ' ') i++;
+        if (i == text.size()) continue;
+        if (text[i] < '0' || text[i] > '9') {
+            err = "line " + std::to_string(source_line) + ": no line number";
+            return false;
+        }
+        if (text.size() > APPLESOFT_MAX_LINE_LENGTH) {
+            err = "line " + std::to_string(source_line) + ": longer than " +
+                  std::to_string(APPLESOFT_MAX_LINE_LENGTH) + " characters";
+            return false;
+        }
+        uint32_t number = 0;
+        while (i < text.size() && ((text[i] >= '0' && text[i] <= '9') || text[i] == ' ')) {
+            if (text[i] != ' ') {
+                number = number * 10 + (uint32_t)(text[i] - '0');
+                if (number > APPLESOFT_MAX_LINE_NUMBER) {
+                    err = "line " + std::to_string(source_line) + ": line number over 63999";
+                    return false;
+                }
+            }
+            i++;
+        }
+
+        std::vector<uint8_t> tokens;
+        applesoft_tokenize_line(text.substr(i), fold_lowercase, tokens);
+        if (tokens[0] == 0) {
+            lines.erase(number);
+        } else {
+            lines[number] = std::move(tokens);
+        }
+    }
+
+    image.clear();
+    uint32_t addr = txttab;
+    for (const auto &[number, tokens] : lines) {
+        uint32_t link = addr + 4 + (uint32_t)tokens.size();
+        image.push_back((uint8_t)(link & 0xFF));
+        image.push_back((uint8_t)(link >> 8));
+        image.push_back((uint8_t)(number & 0xFF));
+        image.push_back((uint8_t)(number >> 8));
+        image.insert(image.end(), tokens.begin(), tokens.end());
+        addr = link;
+    }
+    image.push_back(0);
+    image.push_back(0);
+    line_count = (uint32_t)lines.size();
+    return true;
+}
@@ -0,0 +1,68 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Host-side Applesoft tokenizer, for loading a listing straight into guest memory
+ * instead of typing it in.
+ *
+ * applesoft_tokenize_line() is a transliteration of the ROM's PARSE routine
+ * ($D559): blanks are dropped outside quotes, REM and DATA, keywords match across
+ * blanks, '?' is PRINT, and "AT" is not a keyword when followed by N or O. The
+ * enhanced IIe and IIgs ROMs read PARSE's input through a helper that upper-cases
+ * letters outside quotes, REM and DATA; fold_lowercase selects that behavior.
+ */
+
+// Zero-page pointers a freshly entered program leaves behind.
+constexpr uint16_t APPLESOFT_TXTTAB = 0x67;
+constexpr uint16_t APPLESOFT_VARTAB = 0x69;
+constexpr uint16_t APPLESOFT_ARYTAB = 0x6B;
+constexpr uint16_t APPLESOFT_STREND = 0x6D;
+constexpr uint16_t APPLESOFT_FRETOP = 0x6F;
+constexpr uint16_t APPLESOFT_MEMSIZ = 0x73;
+constexpr uint16_t APPLESOFT_DATPTR = 0x7D;
+constexpr uint16_t APPLESOFT_PRGEND = 0xAF;
+
+// The keyword table, and the instruction in PARSE that fetches an input character.
+constexpr uint16_t APPLESOFT_KEYWORD_TABLE = 0xD0D0;
+constexpr uint16_t APPLESOFT_PARSE_FETCH = 0xD56D;
+
+constexpr uint16_t APPLESOFT_MAX_LINE_NUMBER = 63999;
+constexpr uint32_t APPLESOFT_MAX_LINE_LENGTH = 239;  // GETLN cancels a longer line
+
+/** Keyword i (0 .. 106) is token 0x80 + i. */
+extern const char *const applesoft_keywords[];
+constexpr uint32_t APPLESOFT_KEYWORD_COUNT = 107;
+
+/** Tokenize the text after a line number. Appends the tokens and the terminating 0 to out. */
+void applesoft_tokenize_line(const std::string &text, bool fold_lowercase, std::vector<uint8_t> &out);
+
+/**
+ * Tokenize a listing - numbered lines separated by CR, LF or CRLF - into the linked
+ * line image that belongs at txttab, ending with the 00 00 end-of-program link.
+ * Later lines replace earlier ones with the same number, and a number with nothing
+ * after it deletes the line, as when typed. Blank lines are skipped. Returns false,
+ * with err naming the offending line, for a line with no number, a number over 63999,
+ * or a line GETLN would not accept.
+ */
+bool applesoft_tokenize_listing(const std::string &listing, uint16_t txttab, bool fold_lowercase,
+                                std::vector<uint8_t> &image, uint32_t &line_count, std::string &err);
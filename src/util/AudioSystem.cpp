@@ -1,6 +1,7 @@
 #include <cstdio>
 #include <SDL3/SDL.h>
 
+#include "gs2.hpp"
 #include "computer.hpp"
 #include "DebugFormatter.hpp"
 #include "AudioSystem.hpp"
@@ -9,6 +10,15 @@ AudioSystem::AudioSystem(computer_t *computer) {
     // Initialize SDL audio
     SDL_Init(SDL_INIT_AUDIO);
 
+    if (gs2_app_values.headless) {
+        // Null sink: streams are created but never bound to a device, and the
+        // run loop discards whatever is queued with clear_all_streams().
+        null_sink = true;
+        device_id = 0;
+        gain = 1.0f * 6.0f / 16.0f;
+        return;
+    }
+
     // for info purposes, print out the available devices and their formats.
     int num_devices = 0;
     SDL_AudioDeviceID *devices = SDL_GetAudioPlaybackDevices(&num_devices);
@@ -72,7 +82,9 @@ AudioSystem::~AudioSystem() {
     for (auto &stream : allocated_streams) {
         SDL_DestroyAudioStream(stream.stream);
     }
-    SDL_CloseAudioDevice(device_id);
+    if (device_id) {
+        SDL_CloseAudioDevice(device_id);
+    }
 }
 
 SDL_AudioDeviceID AudioSystem::get_audio_device_id() {
@@ -99,7 +111,7 @@ SDL_AudioStream *AudioSystem::create_stream(int sample_rate, int channels, SDL_A
         SDL_Log("Couldn't create audio stream: %s", SDL_GetError());
         return nullptr;
     }
-    if (!SDL_BindAudioStream(device_id, stream)) {  /* once bound, it'll start playing when there is data available! */
+    if (!null_sink && !SDL_BindAudioStream(device_id, stream)) {  /* once bound, it'll start playing when there is data available! */
         SDL_Log("Failed to bind speaker stream to device: %s", SDL_GetError());
         return nullptr;
     }
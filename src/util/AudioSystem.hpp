@@ -24,7 +24,8 @@ class AudioSystem {
 private:
     // List to track allocated audio streams
     std::vector<audio_stream_t> allocated_streams;
-    SDL_AudioDeviceID device_id;
+    SDL_AudioDeviceID device_id = 0;
+    bool null_sink = false; // headless: no device; streams are never bound
     uint16_t volume_setting = 6;
     float gain = 1.0f;
     bool decorrelation_enabled = true;
@@ -73,7 +74,8 @@ public:
     }
 
     // Clear all streams — discards buffered audio that accumulated while the
-    // device was paused during a format/device change.
+    // device was paused during a format/device change. Headless runs call this
+    // every frame, since nothing consumes the (unbound) streams.
     void clear_all_streams() {
         for (auto &streamr : allocated_streams) {
             SDL_ClearAudioStream(streamr.stream);
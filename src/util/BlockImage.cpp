@@ -0,0 +1,145 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "BlockImage.hpp"
+
+#ifdef BLOCKIMAGE_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+BlockImage::~BlockImage() {
+    close();
+}
+
+#ifdef BLOCKIMAGE_USE_MMAP
+
+bool BlockImage::open(const std::string &filename, bool write_protected) {
+    close();
+    fd = ::open(filename.c_str(), write_protected ? O_RDONLY : O_RDWR);
+    if (fd < 0) return false;
+    read_only = write_protected;
+    opened = true;
+    if (!remap()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// (Re)map the whole file at its current size.
+bool BlockImage::remap() {
+    if (mapped) munmap(mapped, file_size);
+    mapped = nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+    file_size = (uint64_t)st.st_size;
+    if (file_size == 0) return true;
+
+    void *p = mmap(nullptr, file_size, read_only ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return false;
+    mapped = (uint8_t *)p;
+    return true;
+}
+
+void BlockImage::close() {
+    if (!opened) return;
+    flush();
+    if (mapped) munmap(mapped, file_size);
+    mapped = nullptr;
+    ::close(fd);
+    fd = -1;
+    file_size = 0;
+    opened = false;
+}
+
+bool BlockImage::read(uint64_t offset, uint8_t *dst, size_t len) {
+    if (!mapped || offset > file_size || len > file_size - offset) return false;
+    memcpy(dst, mapped + offset, len);
+    return true;
+}
+
+bool BlockImage::write(uint64_t offset, const uint8_t *src, size_t len) {
+    if (!opened || read_only) return false;
+    if (mapped && offset <= file_size && len <= file_size - offset) {
+        memcpy(mapped + offset, src, len);
+    } else {
+        // Past the end: extend the file the ordinary way, then map the new size.
+        if (pwrite(fd, src, len, (off_t)offset) != (ssize_t)len) return false;
+        if (!remap()) return false;
+    }
+    dirty = true;
+    return sync_writes ? flush() : true;
+}
+
+bool BlockImage::flush() {
+    if (!dirty) return true;
+    dirty = false;
+    if (mapped && msync(mapped, file_size, MS_SYNC) != 0) return false;
+    return fsync(fd) == 0;
+}
+
+#else
+
+bool BlockImage::open(const std::string &filename, bool write_protected) {
+    close();
+    fp = fopen(filename.c_str(), write_protected ? "rb" : "r+b");
+    if (fp == nullptr) return false;
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    file_size = len > 0 ? (uint64_t)len : 0;
+    read_only = write_protected;
+    opened = true;
+    return true;
+}
+
+void BlockImage::close() {
+    if (!opened) return;
+    flush();
+    fclose(fp);
+    fp = nullptr;
+    file_size = 0;
+    opened = false;
+}
+
+bool BlockImage::read(uint64_t offset, uint8_t *dst, size_t len) {
+    if (!opened || offset > file_size || len > file_size - offset) return false;
+    if (fseek(fp, (long)offset, SEEK_SET) < 0) return false;
+    return fread(dst, 1, len, fp) == len;
+}
+
+bool BlockImage::write(uint64_t offset, const uint8_t *src, size_t len) {
+    if (!opened || read_only) return false;
+    if (fseek(fp, (long)offset, SEEK_SET) < 0) return false;
+    if (fwrite(src, 1, len, fp) != len) return false;
+    if (offset + len > file_size) file_size = offset + len;
+    dirty = true;
+    return sync_writes ? flush() : true;
+}
+
+bool BlockImage::flush() {
+    if (!dirty) return true;
+    dirty = false;
+    return fflush(fp) == 0;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define BLOCKIMAGE_USE_MMAP
+#endif
+
+/**
+ * A block device's backing image file.
+ *
+ * Where mmap is available the whole file is mapped shared: reads are a memcpy
+ * out of the mapping and writes a memcpy into it, with the OS page cache as the
+ * write-back cache. Elsewhere it falls back to fseek + fread / fwrite.
+ *
+ * flush() pushes written data to the file and fsyncs it (unmount / writeback);
+ * with set_sync_writes(true) every write() does that before returning.
+ */
+class BlockImage {
+public:
+    BlockImage() = default;
+    ~BlockImage();
+    BlockImage(const BlockImage &) = delete;
+    BlockImage &operator=(const BlockImage &) = delete;
+
+    bool open(const std::string &filename, bool write_protected);
+    void close();
+    inline bool is_open() const { return opened; }
+
+    /** Copy len bytes at offset into dst. False if any of it lies past the end of the file. */
+    bool read(uint64_t offset, uint8_t *dst, size_t len);
+    /** Store len bytes at offset, growing the file if needed. False if read-only or on I/O error. */
+    bool write(uint64_t offset, const uint8_t *src, size_t len);
+    bool flush();
+
+    inline void set_sync_writes(bool on) { sync_writes = on; }
+    inline uint64_t size() const { return file_size; }
+
+private:
+    bool opened = false;
+    bool read_only = true;
+    bool sync_writes = false;
+    bool dirty = false;
+    uint64_t file_size = 0;
+
+#ifdef BLOCKIMAGE_USE_MMAP
+    bool remap();
+
+    int fd = -1;
+    uint8_t *mapped = nullptr;      // nullptr for an empty file
+#else
+    FILE *fp = nullptr;
+#endif
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include "NClock.hpp"
+
+/**
+ * Disk accelerator (-x): the clock runs at the accelerator speed while a floppy motor
+ * is on, then goes back to the speed it interrupted. computer_t calls update() once
+ * per frame with the motor state from Mounts::any_floppy_motor_on().
+ *
+ * Entering free-run needs a Ludicrous N. The N calibrated during an earlier spell is
+ * reused; only the first spell asks the caller to calibrate.
+ */
+struct DiskAccelerator {
+    enum action_t {
+        NONE,
+        CALIBRATE,      // entered free-run with no N to reuse: start calibrating
+        REUSE_N,        // entered free-run with the N from an earlier spell
+    };
+
+    bool active = false;
+    clock_mode_t restore = CLOCK_1_024MHZ;
+    uint32_t restore_n = 1;
+    uint32_t locked_n = 0;      // Ludicrous N calibrated during an earlier spell
+
+    // Free-run counts as the fastest mode; the rest are in ascending order.
+    static inline int rank(clock_mode_t mode) {
+        return mode == CLOCK_FREE_RUN ? NUM_CLOCK_MODES : (int)mode;
+    }
+
+    /** ludicrous_locked: the calibrator has settled on the clock's current N. */
+    action_t update(NClock *clock, bool spinning, clock_mode_t accel, bool ludicrous_locked) {
+        if (spinning == active) return NONE;
+
+        if (spinning) {
+            clock_mode_t current = clock->get_clock_mode();
+            if (rank(current) >= rank(accel)) return NONE; // already as fast
+            restore = current;
+            restore_n = clock->get_cpu_per_14m();
+            active = true;
+            clock->set_clock_mode(accel);
+            if (accel != CLOCK_FREE_RUN) return NONE;
+            if (!locked_n) return CALIBRATE;
+            clock->set_cpu_per_14m(locked_n);
+            return REUSE_N;
+        }
+
+        active = false;
+        if (clock->get_clock_mode() != accel) return NONE; // the user picked a speed meanwhile; keep it
+        if (accel == CLOCK_FREE_RUN && ludicrous_locked) {
+            locked_n = clock->get_cpu_per_14m();
+        }
+        clock->set_clock_mode(restore);
+        if (restore == CLOCK_FREE_RUN) {
+            clock->set_cpu_per_14m(restore_n);
+        }
+        return NONE;
+    }
+};
@@ -3,6 +3,7 @@
 #include <limits>
 #include <iostream>
 #include "debug.hpp"
+#include "Snapshot.hpp"
 //#include "cpu.hpp"
 
 // Constructor implementation
@@ -14,7 +15,49 @@ EventTimer::~EventTimer() = default;
 
 inline void EventTimer::updateNextEventCycle() {
     // Update next_event_cycle to the earliest event's trigger time
-    next_event_cycle = events.empty() ? std::numeric_limits<uint64_t>::max() : events.front().triggerCycles;
+    next_event_cycle = heap.empty() ? std::numeric_limits<uint64_t>::max() : heap.front().triggerCycles;
+}
+
+void EventTimer::sift_up(uint32_t pos) {
+    HeapEntry entry = heap[pos];
+    while (pos > 0) {
+        uint32_t parent = (pos - 1) / 2;
+        if (heap[parent].triggerCycles <= entry.triggerCycles) break;
+        heap[pos] = heap[parent];
+        nodes[heap[pos].node].heap_pos = pos;
+        pos = parent;
+    }
+    heap[pos] = entry;
+    nodes[entry.node].heap_pos = pos;
+}
+
+void EventTimer::sift_down(uint32_t pos) {
+    HeapEntry entry = heap[pos];
+    const uint32_t size = (uint32_t)heap.size();
+    for (;;) {
+        uint32_t child = pos * 2 + 1;
+        if (child >= size) break;
+        if (child + 1 < size && heap[child + 1].triggerCycles < heap[child].triggerCycles) child++;
+        if (entry.triggerCycles <= heap[child].triggerCycles) break;
+        heap[pos] = heap[child];
+        nodes[heap[pos].node].heap_pos = pos;
+        pos = child;
+    }
+    heap[pos] = entry;
+    nodes[entry.node].heap_pos = pos;
+}
+
+// Take the event in heap slot pos off the queue.
+void EventTimer::remove_at(uint32_t pos) {
+    nodes[heap[pos].node].heap_pos = NOT_QUEUED;
+
+    HeapEntry last = heap.back();
+    heap.pop_back();
+    if (pos < heap.size()) {
+        heap[pos] = last;
+        sift_down(pos);
+        sift_up(nodes[last.node].heap_pos);
+    }
 }
 
 // Add a new event to the queue
@@ -24,44 +67,31 @@ void EventTimer::scheduleEvent(uint64_t triggerCycles, void (*callback)(uint64_t
         std::cout << "scheduleEvent: Event in the past, skipping" << std::endl;
         return;
     }
-    // Check if an event with the same instanceID already exists
-    auto existingEvent = std::find_if(events.begin(), events.end(), 
-        [instanceID](const Event& event) { return event.instanceID == instanceID; });
-    
-    if (existingEvent != events.end()) {
-        // Replace the existing event with the new one
-        existingEvent->triggerCycles = triggerCycles;
-        existingEvent->triggerCallback = callback;
-        existingEvent->userData = userData;
-        
-        // Rebuild the heap after modifying an element
-        std::make_heap(events.begin(), events.end(), [](const Event& a, const Event& b) {
-            return a.triggerCycles > b.triggerCycles;
-        });
+    auto [it, added] = node_of.try_emplace(instanceID, (uint32_t)nodes.size());
+    if (added) nodes.emplace_back();
+    Node &node = nodes[it->second];
+    uint64_t old_trigger = node.event.triggerCycles;
+    node.event = Event{triggerCycles, callback, instanceID, userData};
+
+    if (node.heap_pos != NOT_QUEUED) {
+        // Replace the existing event with the new one and move it to its new place
+        heap[node.heap_pos].triggerCycles = triggerCycles;
+        if (triggerCycles < old_trigger) sift_up(node.heap_pos);
+        else sift_down(node.heap_pos);
     } else {
         // Add a new event to the queue
-        Event newEvent{triggerCycles, callback, instanceID, userData};
-        events.push_back(newEvent);
-        std::push_heap(events.begin(), events.end(), [](const Event& a, const Event& b) {
-            return a.triggerCycles > b.triggerCycles; // Reverse for priority queue (earliest first)
-        });
+        heap.push_back(HeapEntry{triggerCycles, it->second});
+        sift_up((uint32_t)heap.size() - 1);
     }
     updateNextEventCycle();
+    if (deadline_reset && next_event_cycle == triggerCycles) *deadline_reset = 0;
 }
 
 // Process all events that should trigger by the given cycle count
 void EventTimer::processEvents(uint64_t currentCycles) {
-    /* std::cout << "processEvents: " << currentCycles << "Front: " << events.front().triggerCycles << std::endl;
-    // Print how many events are on the queue
-    if (!events.empty()) {
-        std::cout << "Events on queue: " << events.size() << std::endl;
-    } */
-    while (!events.empty() && events.front().triggerCycles <= currentCycles) {
-        Event event = events.front();
-        std::pop_heap(events.begin(), events.end(), [](const Event& a, const Event& b) {
-            return a.triggerCycles > b.triggerCycles;
-        });
-        events.pop_back();
+    while (!heap.empty() && heap.front().triggerCycles <= currentCycles) {
+        Event event = nodes[heap.front().node].event;
+        remove_at(0);
         if (DEBUG(DEBUG_EVENT_TIMER)) std::cout << "Processing event: " << event.triggerCycles << " InstanceID: " << event.instanceID << std::endl;
         // Call the callback function
         if (event.triggerCallback) {
@@ -73,25 +103,77 @@ void EventTimer::processEvents(uint64_t currentCycles) {
 
 // Cancel all events for a specific instance
 void EventTimer::cancelEvents(uint64_t instanceID) {
-    auto newEnd = std::remove_if(events.begin(), events.end(),
-        [instanceID](const Event& event) { return event.instanceID == instanceID; });
-    
-    if (newEnd != events.end()) {
-        events.erase(newEnd, events.end());
-        // Rebuild the heap after removing elements
-        std::make_heap(events.begin(), events.end(), [](const Event& a, const Event& b) {
-            return a.triggerCycles > b.triggerCycles;
-        });
+    // scheduleEvent keeps at most one event per instance.
+    auto existing = node_of.find(instanceID);
+    if (existing != node_of.end() && nodes[existing->second].heap_pos != NOT_QUEUED) {
+        remove_at(nodes[existing->second].heap_pos);
     }
     updateNextEventCycle();
 }
 
 // Check if there are any pending events
 bool EventTimer::hasPendingEvents() const {
-    return !events.empty();
+    return !heap.empty();
 }
 
 // Get the cycle count of the next event
 uint64_t EventTimer::getNextEventCycle() const {
     return next_event_cycle;
 }
+
+// Is instanceID queued, and if so, when does it fire
+bool EventTimer::isPending(uint64_t instanceID, uint64_t &triggerCycles) const {
+    auto existing = node_of.find(instanceID);
+    if (existing == node_of.end() || nodes[existing->second].heap_pos == NOT_QUEUED) return false;
+    triggerCycles = nodes[existing->second].event.triggerCycles;
+    return true;
+}
+
+void EventTimer::snapshot(SnapshotIO &io, uint64_t now) {
+    uint32_t count = (uint32_t)heap.size();
+    io.field(count);
+    if (!io.loading()) {
+        for (const HeapEntry &entry : heap) {
+            uint64_t id = nodes[entry.node].event.instanceID;
+            uint64_t when = entry.triggerCycles;
+            io.field(id);
+            io.cycle_time(when, now);
+        }
+        return;
+    }
+
+    // Whatever the fresh machine queued at power-on is replaced by the saved queue.
+    for (const HeapEntry &entry : heap) nodes[entry.node].heap_pos = NOT_QUEUED;
+    heap.clear();
+    for (uint32_t i = 0; i < count && io.ok(); i++) {
+        uint64_t id = 0, when = 0;
+        io.field(id);
+        io.cycle_time(when, now);
+        auto existing = node_of.find(id);
+        if (existing == node_of.end() || nodes[existing->second].event.triggerCallback == nullptr) {
+            std::cout << "EventTimer: no handler for saved event " << std::hex << id << std::dec << ", dropped" << std::endl;
+            continue;
+        }
+        if (when < now) when = now;
+        Node &node = nodes[existing->second];
+        node.event.triggerCycles = when;
+        heap.push_back(HeapEntry{when, existing->second});
+        sift_up((uint32_t)heap.size() - 1);
+    }
+    updateNextEventCycle();
+    if (deadline_reset) *deadline_reset = 0;
+}
+
+void EventTimer::snapshot_event(SnapshotIO &io, uint64_t now, uint64_t instanceID, void (*callback)(uint64_t, void*), void* userData) {
+    uint64_t when = 0;
+    isPending(instanceID, when);
+    io.cycle_time(when, now);
+    if (!io.loading()) return;
+    if (when == 0) {
+        cancelEvents(instanceID);
+        return;
+    }
+    if (when < now) when = now;
+    scheduleEvent(when, callback, instanceID, userData);
+    if (deadline_reset) *deadline_reset = 0;
+}
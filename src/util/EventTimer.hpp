@@ -2,8 +2,10 @@
 
 #include <vector>
 #include <cstdint>
+#include <unordered_map>
 
 class NClockII;  // forward declare instead of include
+class SnapshotIO;
 
 class EventTimer {
 public:
@@ -25,8 +27,41 @@ public:
     uint64_t getNextEventCycle() const;
     inline bool isEventPassed(uint64_t currentCycles) { return currentCycles >= next_event_cycle; }
     void set_clock(NClockII *clock) { this->clock = clock; }
+    // Zeroed whenever an event is scheduled ahead of everything else on this
+    // timer, so a run loop caching "nothing due before X" re-checks.
+    void set_deadline_reset(uint64_t *deadline) { deadline_reset = deadline; }
+
+    /* Save / restore, with trigger times stored relative to now (this timer's
+       own clock). snapshot() carries the whole queue but can only re-arm
+       instances that already have a callback in the loading machine;
+       snapshot_event() carries one instance for a device that may not have
+       scheduled it yet. */
+    void snapshot(SnapshotIO &io, uint64_t now);
+    void snapshot_event(SnapshotIO &io, uint64_t now, uint64_t instanceID, void (*callback)(uint64_t, void*), void* userData = nullptr);
+    bool isPending(uint64_t instanceID, uint64_t &triggerCycles) const;
     
 private:
-    std::vector<Event> events;
+    /* Binary min-heap on triggerCycles, indexed by instanceID. The heap holds
+       node numbers and each node remembers its heap slot, so rescheduling or
+       cancelling an instance is one hash lookup plus an O(log n) sift. An
+       instance keeps its node once it has one (the set of timers a machine
+       uses is small and fixed), so firing and re-arming never allocate. */
+    static constexpr uint32_t NOT_QUEUED = UINT32_MAX;
+    struct HeapEntry {
+        uint64_t triggerCycles;
+        uint32_t node;
+    };
+    struct Node {
+        Event event;
+        uint32_t heap_pos = NOT_QUEUED;
+    };
+    std::vector<HeapEntry> heap;
+    std::vector<Node> nodes;
+    std::unordered_map<uint64_t, uint32_t> node_of;  // instanceID -> node
+    uint64_t *deadline_reset = nullptr;
+
+    void sift_up(uint32_t pos);
+    void sift_down(uint32_t pos);
+    void remove_at(uint32_t pos);
     void updateNextEventCycle();
 };
@@ -99,6 +99,17 @@ class InterruptController {
         }
     }
     
+    // Whole-mask access for save / restore.
+    inline uint64_t get_all_irqs() const { return irq_asserted; }
+
+    inline void set_all_irqs(uint64_t mask) {
+        uint64_t old = irq_asserted;
+        irq_asserted = mask;
+        if (old != irq_asserted) {
+            notify_irq_receiver();
+        }
+    }
+
     DebugFormatter *debug_irq() {
         DebugFormatter *f = new DebugFormatter();
         f->addLine("IRQ: %08llX", irq_asserted);
@@ -0,0 +1,130 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SharedRam.hpp"
+
+#ifdef SHAREDRAM_USE_SHM
+#include <atomic>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+SharedRam::~SharedRam() {
+    release();
+}
+
+#ifdef SHAREDRAM_USE_SHM
+
+namespace {
+
+// A read-write descriptor for a new shared memory object of size bytes. Without
+// memfd the object has a name for a moment; ro gets a read-only descriptor opened
+// before the name is removed, since it cannot be reopened afterwards.
+int create_object(size_t size, int &ro) {
+    ro = -1;
+#if defined(__linux__)
+    int rw = memfd_create("gs2-ram", MFD_CLOEXEC);
+#else
+    static std::atomic<uint32_t> serial{0};
+    char name[64];
+    snprintf(name, sizeof(name), "/gs2-%d-%u", (int)getpid(), (unsigned)serial++);
+    int rw = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (rw >= 0) {
+        ro = shm_open(name, O_RDONLY, 0);
+        shm_unlink(name);
+    }
+#endif
+    if (rw < 0) return -1;
+    if (ftruncate(rw, (off_t)size) != 0) {
+        ::close(rw);
+        if (ro >= 0) ::close(ro);
+        ro = -1;
+        return -1;
+    }
+    return rw;
+}
+
+} // namespace
+
+uint8_t *SharedRam::allocate(size_t size) {
+    release();
+    len = size;
+    if (sharing_enabled && size > 0) {
+        fd = create_object(size, ro_fd);
+        if (fd >= 0) {
+            void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                mem = (uint8_t *)p;
+                return mem;
+            }
+            ::close(fd);
+            if (ro_fd >= 0) ::close(ro_fd);
+            fd = ro_fd = -1;
+        }
+    }
+    mem = new uint8_t[size]();
+    return mem;
+}
+
+void SharedRam::release() {
+    if (fd >= 0) {
+        munmap(mem, len);
+        ::close(fd);
+        if (ro_fd >= 0) ::close(ro_fd);
+        fd = ro_fd = -1;
+    } else {
+        delete[] mem;
+    }
+    mem = nullptr;
+    len = 0;
+}
+
+int SharedRam::share_fd(bool writable) const {
+    if (fd < 0) return -1;
+    if (writable) return fcntl(fd, F_DUPFD_CLOEXEC, 0);
+#if defined(__linux__)
+    // Reopening through /proc gives a descriptor that cannot be mapped writable.
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    return ::open(path, O_RDONLY | O_CLOEXEC);
+#else
+    return ro_fd >= 0 ? fcntl(ro_fd, F_DUPFD_CLOEXEC, 0) : -1;
+#endif
+}
+
+#else
+
+uint8_t *SharedRam::allocate(size_t size) {
+    release();
+    len = size;
+    mem = new uint8_t[size]();
+    return mem;
+}
+
+void SharedRam::release() {
+    delete[] mem;
+    mem = nullptr;
+    len = 0;
+}
+
+int SharedRam::share_fd(bool) const {
+    return -1;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define SHAREDRAM_USE_SHM
+#endif
+
+/**
+ * A zeroed block of memory that can be mapped into another process: guest RAM the
+ * debug protocol hands to clients (MEMSHARE), so they read it in place instead of
+ * copying it out a request at a time.
+ *
+ * The block lives in a memfd on Linux and in an unlinked POSIX shared memory object
+ * on other POSIX hosts. It is only shareable while sharing is enabled (the debug
+ * socket is on) at allocation time; otherwise, and on hosts without shared memory,
+ * it is plain heap memory.
+ */
+class SharedRam {
+public:
+    SharedRam() = default;
+    ~SharedRam();
+    SharedRam(const SharedRam &) = delete;
+    SharedRam &operator=(const SharedRam &) = delete;
+
+    /** Allocate (or replace with) size zeroed bytes. Returns the block. */
+    uint8_t *allocate(size_t size);
+    void release();
+
+    uint8_t *data() const { return mem; }
+    size_t size() const { return len; }
+    bool shareable() const { return fd >= 0; }
+
+    /** A new descriptor for the block, read-only unless writable; -1 if not shareable. The caller closes it. */
+    int share_fd(bool writable) const;
+
+    /** Whether later allocations are shareable. Off by default. */
+    static void set_enabled(bool enabled) { sharing_enabled = enabled; }
+    static bool enabled() { return sharing_enabled; }
+
+private:
+    uint8_t *mem = nullptr;
+    size_t len = 0;
+    int fd = -1;        // read-write
+    int ro_fd = -1;     // read-only, when the host cannot reopen fd read-only later
+
+    static inline bool sharing_enabled = false;
+};
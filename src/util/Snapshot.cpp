@@ -0,0 +1,519 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define SNAPSHOT_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Snapshot.hpp"
+
+namespace {
+
+constexpr char SNAP_MAGIC[8] = { 'G', 'S', '2', 'S', 'N', 'A', 'P', 0x1A };
+constexpr size_t SNAP_HEADER_SIZE = 32;  // magic, version, platform, id, parent id
+constexpr size_t SNAP_CHUNK_HEADER_SIZE = 16; // tag, flags, length
+constexpr int SNAP_MAX_PARENT_DEPTH = 64;
+
+constexpr uint32_t fourcc(const char (&s)[5]) {
+    return (uint32_t)(uint8_t)s[0] | ((uint32_t)(uint8_t)s[1] << 8) | ((uint32_t)(uint8_t)s[2] << 16) | ((uint32_t)(uint8_t)s[3] << 24);
+}
+
+constexpr uint32_t CHUNK_PARENT = fourcc("PRNT");
+constexpr uint32_t CHUNK_STATE = fourcc("STAT");
+constexpr uint32_t CHUNK_RAM = fourcc("RAM ");
+constexpr uint32_t CHUNK_END = fourcc("END ");
+
+enum snapshot_page_kind_t : uint8_t {
+    PAGE_PARENT = 0,  // unchanged since the parent snapshot
+    PAGE_ZERO = 1,
+    PAGE_RAW = 2,
+    PAGE_PACKBITS = 3, // u32 packed length, then PackBits data
+};
+
+inline void put_le(std::vector<uint8_t> &out, uint64_t v, size_t width) {
+    for (size_t i = 0; i < width; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+inline uint64_t get_le(const uint8_t *p, size_t width) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < width; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+inline void put_name(std::vector<uint8_t> &out, const std::string &name) {
+    put_le(out, name.size(), 2);
+    out.insert(out.end(), name.begin(), name.end());
+}
+
+// Chunk length is patched once the payload is in place.
+inline size_t begin_chunk(std::vector<uint8_t> &out, uint32_t tag) {
+    put_le(out, tag, 4);
+    put_le(out, 0, 4);
+    put_le(out, 0, 8);
+    return out.size();
+}
+
+inline void end_chunk(std::vector<uint8_t> &out, size_t payload_start) {
+    uint64_t len = out.size() - payload_start;
+    for (size_t i = 0; i < 8; i++) out[payload_start - 8 + i] = (uint8_t)(len >> (8 * i));
+}
+
+struct snapshot_chunk_t {
+    uint32_t tag;
+    const uint8_t *data;
+    size_t size;
+};
+
+struct snapshot_header_t {
+    uint32_t version;
+    uint32_t platform_id;
+    uint64_t id;
+    uint64_t parent_id;
+};
+
+bool parse_snapshot(const uint8_t *data, size_t size, snapshot_header_t &hdr, std::vector<snapshot_chunk_t> &chunks, std::string &err) {
+    if (size < SNAP_HEADER_SIZE || memcmp(data, SNAP_MAGIC, sizeof(SNAP_MAGIC)) != 0) {
+        err = "not a snapshot file";
+        return false;
+    }
+    hdr.version = (uint32_t)get_le(data + 8, 4);
+    hdr.platform_id = (uint32_t)get_le(data + 12, 4);
+    hdr.id = get_le(data + 16, 8);
+    hdr.parent_id = get_le(data + 24, 8);
+    if (hdr.version != SnapshotManager::VERSION) {
+        err = "unsupported snapshot version";
+        return false;
+    }
+    size_t pos = SNAP_HEADER_SIZE;
+    while (pos + SNAP_CHUNK_HEADER_SIZE <= size) {
+        snapshot_chunk_t c;
+        c.tag = (uint32_t)get_le(data + pos, 4);
+        uint64_t len = get_le(data + pos + 8, 8);
+        pos += SNAP_CHUNK_HEADER_SIZE;
+        if (len > size - pos) break;
+        if (c.tag == CHUNK_END) return true;
+        c.data = data + pos;
+        c.size = (size_t)len;
+        chunks.push_back(c);
+        pos += (size_t)len;
+    }
+    err = "snapshot file is truncated";
+    return false;
+}
+
+bool read_name(const snapshot_chunk_t &c, std::string &name, size_t &pos) {
+    if (c.size < 2) return false;
+    size_t len = (size_t)get_le(c.data, 2);
+    if (len > c.size - 2) return false;
+    name.assign((const char *)c.data + 2, len);
+    pos = 2 + len;
+    return true;
+}
+
+/** Read-only view of a whole file: mapped where available, otherwise read into memory. */
+class MappedFile {
+public:
+    ~MappedFile() {
+#ifdef SNAPSHOT_USE_MMAP
+        if (mapped) munmap((void *)mapped, size);
+#endif
+    }
+
+    bool open(const std::string &path) {
+#ifdef SNAPSHOT_USE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        size = (size_t)st.st_size;
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        mapped = (const uint8_t *)p;
+        data = mapped;
+        return true;
+#else
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (!fp) return false;
+        fseek(fp, 0, SEEK_END);
+        long len = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        if (len <= 0) {
+            fclose(fp);
+            return false;
+        }
+        contents.resize((size_t)len);
+        size_t got = fread(contents.data(), 1, contents.size(), fp);
+        fclose(fp);
+        if (got != contents.size()) return false;
+        data = contents.data();
+        size = contents.size();
+        return true;
+#endif
+    }
+
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+
+private:
+    const uint8_t *mapped = nullptr;
+    std::vector<uint8_t> contents;
+};
+
+uint64_t new_snapshot_id() {
+    std::random_device rd;
+    uint64_t id = ((uint64_t)rd() << 32) ^ rd() ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    return id ? id : 1;
+}
+
+} // namespace
+
+void SnapshotManager::register_state_handler(const std::string &name, StateHandler handler) {
+    state_handlers.push_back({name, std::move(handler)});
+}
+
+void SnapshotManager::register_ram_region(const std::string &name, uint8_t *base, size_t size) {
+    ram_regions.push_back({name, base, size, {}});
+}
+
+size_t SnapshotManager::packbits_encode(const uint8_t *src, size_t size, uint8_t *dst) {
+    size_t i = 0, o = 0;
+    while (i < size) {
+        size_t run = 1;
+        while (i + run < size && run < 128 && src[i + run] == src[i]) run++;
+        if (run >= 3) {
+            dst[o++] = (uint8_t)(1 - (int)run);
+            dst[o++] = src[i];
+            i += run;
+            continue;
+        }
+        // literal until the next run of 3 or more
+        size_t start = i, lit = 0;
+        while (i < size && lit < 128) {
+            if (i + 2 < size && src[i] == src[i + 1] && src[i] == src[i + 2]) break;
+            i++;
+            lit++;
+        }
+        dst[o++] = (uint8_t)(lit - 1);
+        memcpy(dst + o, src + start, lit);
+        o += lit;
+    }
+    return o;
+}
+
+bool SnapshotManager::packbits_decode(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size) {
+    size_t i = 0, o = 0;
+    while (i < size) {
+        int8_t n = (int8_t)src[i++];
+        if (n >= 0) {
+            size_t len = (size_t)n + 1;
+            if (len > size - i || len > dst_size - o) return false;
+            memcpy(dst + o, src + i, len);
+            i += len;
+            o += len;
+        } else if (n != -128) {
+            size_t len = (size_t)(1 - n);
+            if (i >= size || len > dst_size - o) return false;
+            memset(dst + o, src[i++], len);
+            o += len;
+        }
+    }
+    return o == dst_size;
+}
+
+void SnapshotManager::set_base(const std::string &path, uint64_t id) {
+    for (RamRegion &r : ram_regions) {
+        r.baseline.assign(r.base, r.base + r.size);
+    }
+    base_path = path;
+    base_id = id;
+}
+
+bool SnapshotManager::save(const std::string &path, bool incremental, std::string &err) {
+    bool diff = incremental && base_id != 0 && path != base_path;
+    for (const RamRegion &r : ram_regions) {
+        if (r.baseline.size() != r.size) diff = false;
+    }
+
+    uint64_t id = new_snapshot_id();
+    std::vector<uint8_t> out;
+    out.insert(out.end(), SNAP_MAGIC, SNAP_MAGIC + sizeof(SNAP_MAGIC));
+    put_le(out, VERSION, 4);
+    put_le(out, platform_id, 4);
+    put_le(out, id, 8);
+    put_le(out, diff ? base_id : 0, 8);
+
+    if (diff) {
+        size_t c = begin_chunk(out, CHUNK_PARENT);
+        out.insert(out.end(), base_path.begin(), base_path.end());
+        end_chunk(out, c);
+    }
+
+    for (StateHandlerInfo &h : state_handlers) {
+        size_t c = begin_chunk(out, CHUNK_STATE);
+        put_name(out, h.name);
+        SnapshotIO io(out);
+        h.handler(io);
+        end_chunk(out, c);
+    }
+
+    static const uint8_t zero_page[PAGE_SIZE] = {};
+    uint8_t packed[PAGE_SIZE + PAGE_SIZE / 128 + 2];
+    for (RamRegion &r : ram_regions) {
+        size_t c = begin_chunk(out, CHUNK_RAM);
+        put_name(out, r.name);
+        put_le(out, r.size, 8);
+        for (size_t off = 0; off < r.size; off += PAGE_SIZE) {
+            size_t len = (r.size - off < PAGE_SIZE) ? r.size - off : PAGE_SIZE;
+            const uint8_t *page = r.base + off;
+            if (diff && memcmp(page, r.baseline.data() + off, len) == 0) {
+                out.push_back(PAGE_PARENT);
+            } else if (memcmp(page, zero_page, len) == 0) {
+                out.push_back(PAGE_ZERO);
+            } else {
+                size_t plen = packbits_encode(page, len, packed);
+                if (plen + 4 < len) {
+                    out.push_back(PAGE_PACKBITS);
+                    put_le(out, plen, 4);
+                    out.insert(out.end(), packed, packed + plen);
+                } else {
+                    out.push_back(PAGE_RAW);
+                    out.insert(out.end(), page, page + len);
+                }
+            }
+        }
+        end_chunk(out, c);
+    }
+    begin_chunk(out, CHUNK_END);
+
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp) {
+        err = "cannot create " + path;
+        return false;
+    }
+    size_t wrote = fwrite(out.data(), 1, out.size(), fp);
+    if (fclose(fp) != 0 || wrote != out.size()) {
+        err = "write failed: " + path;
+        return false;
+    }
+
+    if (!diff) set_base(path, id);
+    printf("Snapshot: saved %s (%zu bytes%s)\n", path.c_str(), out.size(), diff ? ", incremental" : "");
+    return true;
+}
+
+// RAM only: a parent chain is walked for its pages, not its device state. Pages are
+// decoded into img, never into the machine, so a bad file leaves the machine untouched.
+bool SnapshotManager::load_ram(const uint8_t *data, size_t size, int depth, RamImage &img, std::string &err) {
+    snapshot_header_t hdr;
+    std::vector<snapshot_chunk_t> chunks;
+    if (!parse_snapshot(data, size, hdr, chunks, err)) return false;
+
+    if (hdr.parent_id) {
+        if (depth >= SNAP_MAX_PARENT_DEPTH) {
+            err = "snapshot parent chain is too long";
+            return false;
+        }
+        const snapshot_chunk_t *pc = nullptr;
+        for (const snapshot_chunk_t &c : chunks) {
+            if (c.tag == CHUNK_PARENT) pc = &c;
+        }
+        if (!pc) {
+            err = "incremental snapshot has no parent";
+            return false;
+        }
+        std::string parent_path((const char *)pc->data, pc->size);
+        MappedFile parent;
+        if (!parent.open(parent_path)) {
+            err = "cannot open parent snapshot " + parent_path;
+            return false;
+        }
+        if (parent.size < SNAP_HEADER_SIZE || get_le(parent.data + 16, 8) != hdr.parent_id) {
+            err = "parent snapshot " + parent_path + " does not match";
+            return false;
+        }
+        if (!load_ram(parent.data, parent.size, depth + 1, img, err)) return false;
+        // the top-level file's parent is what later incremental saves diff against
+        if (depth == 0) {
+            img.parent_ram = img.ram;
+            img.parent_path = parent_path;
+            img.parent_id = hdr.parent_id;
+        }
+    }
+
+    for (const snapshot_chunk_t &c : chunks) {
+        if (c.tag != CHUNK_RAM) continue;
+        std::string name;
+        size_t pos;
+        if (!read_name(c, name, pos) || c.size - pos < 8) {
+            err = "bad RAM chunk";
+            return false;
+        }
+        uint64_t region_size = get_le(c.data + pos, 8);
+        pos += 8;
+        size_t ri = ram_regions.size();
+        for (size_t i = 0; i < ram_regions.size(); i++) {
+            if (ram_regions[i].name == name) ri = i;
+        }
+        if (ri == ram_regions.size() || ram_regions[ri].size != region_size) {
+            err = "RAM region " + name + " does not match this machine";
+            return false;
+        }
+        uint8_t *base = img.ram[ri].data();
+        const size_t region_len = ram_regions[ri].size;
+        for (size_t off = 0; off < region_len; off += PAGE_SIZE) {
+            size_t len = (region_len - off < PAGE_SIZE) ? region_len - off : PAGE_SIZE;
+            if (pos >= c.size) {
+                err = "RAM region " + name + " is truncated";
+                return false;
+            }
+            uint8_t kind = c.data[pos++];
+            bool good = true;
+            switch (kind) {
+                case PAGE_PARENT:
+                    good = hdr.parent_id != 0;
+                    break;
+                case PAGE_ZERO:
+                    memset(base + off, 0, len);
+                    break;
+                case PAGE_RAW:
+                    good = len <= c.size - pos;
+                    if (good) memcpy(base + off, c.data + pos, len);
+                    pos += len;
+                    break;
+                case PAGE_PACKBITS: {
+                    good = c.size - pos >= 4;
+                    if (!good) break;
+                    size_t plen = (size_t)get_le(c.data + pos, 4);
+                    pos += 4;
+                    good = plen <= c.size - pos && packbits_decode(c.data + pos, plen, base + off, len);
+                    pos += plen;
+                    break;
+                }
+                default:
+                    good = false;
+                    break;
+            }
+            if (!good) {
+                err = "RAM region " + name + " is corrupt";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void SnapshotManager::swap_ram(RamImage &img) {
+    for (size_t i = 0; i < ram_regions.size(); i++) {
+        std::swap_ranges(ram_regions[i].base, ram_regions[i].base + ram_regions[i].size, img.ram[i].begin());
+    }
+}
+
+/*
+ * Nothing in the machine changes until the whole file (and its parents) has been read:
+ * every RAM page is decoded into a scratch copy first. Only then is RAM swapped in and
+ * the state handlers run. A state chunk that turns out to be truncated puts back the old
+ * RAM and the state of every handler already run, from a save taken just before.
+ */
+bool SnapshotManager::load(const std::string &path, std::string &err) {
+    MappedFile file;
+    if (!file.open(path)) {
+        err = "cannot open " + path;
+        return false;
+    }
+    snapshot_header_t hdr;
+    std::vector<snapshot_chunk_t> chunks;
+    if (!parse_snapshot(file.data, file.size, hdr, chunks, err)) return false;
+    if (hdr.platform_id != platform_id) {
+        err = "snapshot is for a different machine";
+        return false;
+    }
+
+    // Regions the file doesn't mention keep what they hold now.
+    RamImage img;
+    for (const RamRegion &r : ram_regions) {
+        img.ram.emplace_back(r.base, r.base + r.size);
+    }
+    if (!load_ram(file.data, file.size, 0, img, err)) return false;
+
+    std::vector<std::pair<StateHandlerInfo *, SnapshotIO>> states;
+    for (const snapshot_chunk_t &c : chunks) {
+        if (c.tag != CHUNK_STATE) continue;
+        std::string name;
+        size_t pos;
+        if (!read_name(c, name, pos)) {
+            err = "bad state chunk";
+            return false;
+        }
+        StateHandlerInfo *h = nullptr;
+        for (StateHandlerInfo &hh : state_handlers) {
+            if (hh.name == name) h = &hh;
+        }
+        if (!h) {
+            printf("Snapshot: no handler for state '%s', skipped\n", name.c_str());
+            continue;
+        }
+        states.emplace_back(h, SnapshotIO(c.data + pos, c.size - pos));
+    }
+
+    std::vector<std::vector<uint8_t>> undo(states.size());
+    for (size_t i = 0; i < states.size(); i++) {
+        SnapshotIO io(undo[i]);
+        states[i].first->handler(io);
+    }
+
+    swap_ram(img);  // img now holds the RAM as it was
+    for (size_t i = 0; i < states.size(); i++) {
+        SnapshotIO &io = states[i].second;
+        states[i].first->handler(io);
+        if (!io.ok()) {
+            err = "state for " + states[i].first->name + " is truncated";
+            swap_ram(img);
+            for (size_t j = 0; j <= i; j++) {
+                SnapshotIO back(undo[j].data(), undo[j].size());
+                states[j].first->handler(back);
+            }
+            return false;
+        }
+    }
+
+    if (hdr.parent_id) {
+        for (size_t i = 0; i < ram_regions.size(); i++) {
+            ram_regions[i].baseline = std::move(img.parent_ram[i]);
+        }
+        base_path = img.parent_path;
+        base_id = img.parent_id;
+    } else {
+        set_base(path, hdr.id);
+    }
+    printf("Snapshot: loaded %s\n", path.c_str());
+    return true;
+}
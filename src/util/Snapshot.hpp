@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Save / restore of the whole machine. See Docs/SaveAndRestore.md for the file layout.
+ *
+ * State is written by handlers registered with computer_t::register_state_handler().
+ * A handler is one function used for both directions: it calls io.field() on each
+ * value it owns, and after a load it re-applies whatever derived state (memory maps,
+ * video mode) depends on those values.
+ */
+class SnapshotIO {
+public:
+    explicit SnapshotIO(std::vector<uint8_t> &out) : out(&out) {}
+    SnapshotIO(const uint8_t *data, size_t size) : in(data), in_size(size) {}
+
+    inline bool loading() const { return out == nullptr; }
+    /** False once a load has run off the end of the handler's chunk. */
+    inline bool ok() const { return good; }
+
+    /** Integers, enums and bools, stored little-endian at their own width. */
+    template <typename T>
+    void field(T &value) {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "SnapshotIO::field takes integers and enums");
+        if constexpr (std::is_same_v<T, bool>) {
+            uint8_t b = value ? 1 : 0;
+            raw(&b, 1);
+            if (loading()) value = b != 0;
+        } else {
+            uint8_t buf[sizeof(T)];
+            uint64_t v = (uint64_t)value;
+            if (!loading()) {
+                for (size_t i = 0; i < sizeof(T); i++) buf[i] = (uint8_t)(v >> (8 * i));
+            }
+            raw(buf, sizeof(T));
+            if (loading()) {
+                v = 0;
+                for (size_t i = 0; i < sizeof(T); i++) v |= (uint64_t)buf[i] << (8 * i);
+                value = (T)v;
+            }
+        }
+    }
+
+    /** Opaque byte block; the size must be the same on save and load. */
+    inline void bytes(void *data, size_t size) { raw((uint8_t *)data, size); }
+
+    /** A time on one of the machine clocks. The clocks aren't rewound by a load, so the
+        value is stored as an offset from now and rebased onto the loading machine's now.
+        0 means "not set" and stays 0. */
+    void cycle_time(uint64_t &t, uint64_t now) {
+        bool set = t != 0;
+        int64_t offset = set ? (int64_t)(t - now) : 0;
+        field(set);
+        field(offset);
+        if (loading()) {
+            if (!set) t = 0;
+            else if (offset < 0 && (uint64_t)-offset >= now) t = 1;
+            else t = now + offset;
+        }
+    }
+
+private:
+    // inline so the MMUs and scanners that serialize themselves don't link the file code
+    inline void raw(uint8_t *data, size_t size) {
+        if (out) {
+            out->insert(out->end(), data, data + size);
+            return;
+        }
+        if (!good || size > in_size - pos) {
+            good = false;
+            memset(data, 0, size);
+            return;
+        }
+        memcpy(data, in + pos, size);
+        pos += size;
+    }
+
+    std::vector<uint8_t> *out = nullptr;
+    const uint8_t *in = nullptr;
+    size_t in_size = 0;
+    size_t pos = 0;
+    bool good = true;
+};
+
+/**
+ * Owns the registered state handlers and RAM regions and reads / writes snapshot files.
+ *
+ * RAM is stored as 4K pages: zero, PackBits-compressed or raw, whichever is smallest.
+ * An incremental save names the last full snapshot (the base) as its parent and stores
+ * only the pages that differ from it; loading one loads the parent's RAM first. Files
+ * are memory-mapped on load where the host allows it.
+ */
+class SnapshotManager {
+public:
+    using StateHandler = std::function<void (SnapshotIO &io)>;
+
+    struct StateHandlerInfo {
+        std::string name;
+        StateHandler handler;
+    };
+
+    struct RamRegion {
+        std::string name;
+        uint8_t *base;
+        size_t size;
+        std::vector<uint8_t> baseline; // contents of the base snapshot, for incremental saves
+    };
+
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t PAGE_SIZE = 4096;
+
+    SnapshotManager(uint32_t platform_id = 0) : platform_id(platform_id) {}
+
+    inline void set_platform_id(uint32_t id) { platform_id = id; }
+    void register_state_handler(const std::string &name, StateHandler handler);
+    void register_ram_region(const std::string &name, uint8_t *base, size_t size);
+
+    /** Incremental falls back to a full save (which becomes the new base) when there is no
+        base, or when it would overwrite the base itself. */
+    bool save(const std::string &path, bool incremental, std::string &err);
+    bool load(const std::string &path, std::string &err);
+
+    inline bool has_base() const { return base_id != 0; }
+    inline const std::string &get_base_path() const { return base_path; }
+
+    static size_t packbits_encode(const uint8_t *src, size_t size, uint8_t *dst);
+    static bool packbits_decode(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size);
+
+private:
+    /** RAM decoded from a file, one buffer per ram_regions entry, before it goes into the machine. */
+    struct RamImage {
+        std::vector<std::vector<uint8_t>> ram;
+        std::vector<std::vector<uint8_t>> parent_ram; // the top file's parent alone: the new base
+        std::string parent_path;
+        uint64_t parent_id = 0;
+    };
+
+    bool load_ram(const uint8_t *data, size_t size, int depth, RamImage &img, std::string &err);
+    void swap_ram(RamImage &img);
+    void set_base(const std::string &path, uint64_t id);
+
+    uint32_t platform_id;
+    std::vector<StateHandlerInfo> state_handlers;
+    std::vector<RamRegion> ram_regions;
+
+    std::string base_path;
+    uint64_t base_id = 0;
+};
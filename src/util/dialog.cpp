@@ -17,12 +17,17 @@
 
 #include <SDL3/SDL.h>
 #include <stdio.h>
+
+#include "gs2.hpp"
+
 void system_failure(const char *message) {
     printf("Error: %s\n", message);
+    if (gs2_app_values.headless) return;
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", message, NULL);
 }
 
 void system_diag(char *message) {
     printf("Information: %s\n", message);
+    if (gs2_app_values.headless) return;
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Information", message, NULL);
 }
\ No newline at end of file
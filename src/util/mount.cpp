@@ -170,6 +170,14 @@ bool Mounts::has_drive(storage_key_t key) const {
     return storage_devices.find(key) != storage_devices.end();
 }
 
+bool Mounts::any_floppy_motor_on() {
+    for (const auto& [key, registration] : storage_devices) {
+        if (registration.drive_type == DRIVE_TYPE_PRODOS_BLOCK) continue;
+        if (registration.device->status(key).motor_on) return true;
+    }
+    return false;
+}
+
 
 void Mounts::dump() {
     for (auto it = mounted_media.begin(); it != mounted_media.end(); it++) {
@@ -83,6 +83,8 @@ public:
     drive_status_t media_status(storage_key_t key);
     /** True if a storage device is registered at this slot/drive key. */
     bool has_drive(storage_key_t key) const;
+    /** True if any Disk II / 5.25 / 3.5 drive motor is running (not block devices). */
+    bool any_floppy_motor_on();
     const std::vector<drive_info_t>& get_all_drives();
     int register_storage_device(storage_key_t key, StorageDevice *storage_device, drive_type_t drive_type);
     void dump();
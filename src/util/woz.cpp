@@ -70,8 +70,8 @@ const uint32_t Woz::crc32_tab[256] = {
     0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
-uint32_t Woz::crc32(const uint8_t* buf, size_t size) {
-    uint32_t crc = 0u ^ ~0u;
+uint32_t Woz::crc32(const uint8_t* buf, size_t size, uint32_t crc) {
+    crc = crc ^ ~0u;
     while (size--)
         crc = crc32_tab[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
     return crc ^ ~0u;
@@ -331,10 +331,9 @@ int Woz::parse_trks_v1(const uint8_t* data, uint32_t size) {
 }
 
 // WOZ 2.0: variable-length tracks via 160-entry TRK descriptor array.
-// file_buf contains the entire file; chunk_data_offset is the byte offset
-// of the TRKS chunk *data* (= byte 256 in a well-formed WOZ2 file).
-int Woz::parse_trks_v2(const std::vector<uint8_t>& file_buf,
-                        size_t chunk_data_offset, uint32_t /*chunk_size*/) {
+// trk_array is the start of the TRKS chunk data (= byte 256 in a well-formed
+// WOZ2 file). Only the descriptors are parsed; load_track() reads the bits.
+int Woz::parse_trks_v2(const uint8_t* trk_array, uint32_t size) {
     // Determine how many track entries are referenced by TMAP.
     uint8_t max_trk = 0;
     bool any = false;
@@ -352,10 +351,10 @@ int Woz::parse_trks_v2(const std::vector<uint8_t>& file_buf,
     m_image.tracks.resize(num_tracks);
 
     for (uint32_t i = 0; i < num_tracks; i++) {
-        size_t entry_off = chunk_data_offset + i * WOZ_TRK_ENTRY_SIZE;
-        if (entry_off + WOZ_TRK_ENTRY_SIZE > file_buf.size()) break;
+        size_t entry_off = i * WOZ_TRK_ENTRY_SIZE;
+        if (entry_off + WOZ_TRK_ENTRY_SIZE > size) break;
 
-        const uint8_t* e = file_buf.data() + entry_off;
+        const uint8_t* e = trk_array + entry_off;
         uint16_t starting_block = static_cast<uint16_t>(e[0]) |
                                   (static_cast<uint16_t>(e[1]) << 8);
         uint16_t block_count    = static_cast<uint16_t>(e[2]) |
@@ -366,20 +365,20 @@ int Woz::parse_trks_v2(const std::vector<uint8_t>& file_buf,
                                   (static_cast<uint32_t>(e[7]) << 24);
 
         if (starting_block == 0 && block_count == 0) continue; // empty entry
+        if (bit_count == 0) continue;
 
         size_t byte_offset = static_cast<size_t>(starting_block) * WOZ_BLOCK_SIZE;
         size_t byte_count  = (bit_count + 7) / 8;
         size_t alloc_bytes = static_cast<size_t>(block_count) * WOZ_BLOCK_SIZE;
 
-        if (byte_offset + alloc_bytes > file_buf.size()) {
+        if (byte_offset + std::max(alloc_bytes, byte_count) > m_file->size()) {
             std::cerr << "WOZ: TRK[" << i << "] data out of file bounds\n";
             continue;
         }
 
         woz_track_t& trk = m_image.tracks[i];
         trk.bit_count = bit_count;
-        trk.bits.assign(file_buf.data() + byte_offset,
-                        file_buf.data() + byte_offset + byte_count);
+        trk.file_offset = byte_offset;
     }
     return 0;
 }
@@ -406,50 +405,51 @@ int Woz::parse_meta(const uint8_t* data, uint32_t size) {
 
 int Woz::load(const std::string& filename) {
     current_image_filename = filename;
-    FILE* fp = fopen(filename.c_str(), "rb");
-    if (!fp) {
-        std::cerr << "WOZ: cannot open '" << filename << "'\n";
-        return -1;
+    // Read-write so writeback() can patch tracks in place; read-only files
+    // still load, they just can't be written back (see is_read_only()).
+    m_file = std::make_unique<BlockImage>();
+    m_read_only = false;
+    m_crc_cleared = false;
+    if (!m_file->open(filename, false)) {
+        m_read_only = true;
+        if (!m_file->open(filename, true)) {
+            std::cerr << "WOZ: cannot open '" << filename << "'\n";
+            m_file.reset();
+            return -1;
+        }
     }
-
-    // Read the entire file into memory.
-    fseek(fp, 0, SEEK_END);
-    long file_sz = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    if (file_sz < static_cast<long>(WOZ_HEADER_SIZE + 8)) {
+    const uint64_t file_size = m_file->size();
+    uint8_t header[WOZ_HEADER_SIZE];
+    if (file_size < WOZ_HEADER_SIZE + 8 || !m_file->read(0, header, WOZ_HEADER_SIZE)) {
         std::cerr << "WOZ: file too small\n";
-        fclose(fp);
-        return -1;
-    }
-    std::vector<uint8_t> buf(static_cast<size_t>(file_sz));
-    if (fread(buf.data(), 1, buf.size(), fp) != buf.size()) {
-        std::cerr << "WOZ: read error on '" << filename << "'\n";
-        fclose(fp);
+        m_file.reset();
         return -1;
     }
-    fclose(fp);
 
     // Validate magic cookie.
-    if (std::memcmp(buf.data(), WOZ1_MAGIC, 8) == 0) {
+    if (std::memcmp(header, WOZ1_MAGIC, 8) == 0) {
         m_image.file_version = 1;
-    } else if (std::memcmp(buf.data(), WOZ2_MAGIC, 8) == 0) {
+    } else if (std::memcmp(header, WOZ2_MAGIC, 8) == 0) {
         m_image.file_version = 2;
     } else {
         std::cerr << "WOZ: unrecognised magic in '" << filename << "'\n";
+        m_file.reset();
         return -1;
     }
 
-    // Validate CRC32 (skip if stored value is 0).
-    uint32_t stored_crc = static_cast<uint32_t>(buf[8])  |
-                         (static_cast<uint32_t>(buf[9])  << 8) |
-                         (static_cast<uint32_t>(buf[10]) << 16) |
-                         (static_cast<uint32_t>(buf[11]) << 24);
+    // Validate CRC32 (skip if stored value is 0). This streams the whole file
+    // through m_file once; the track bits themselves are still only copied
+    // out on first use.
+    uint32_t stored_crc = static_cast<uint32_t>(header[8])  |
+                         (static_cast<uint32_t>(header[9])  << 8) |
+                         (static_cast<uint32_t>(header[10]) << 16) |
+                         (static_cast<uint32_t>(header[11]) << 24);
     if (stored_crc != 0) {
-        uint32_t computed = crc32(buf.data() + WOZ_HEADER_SIZE,
-                                  buf.size() - WOZ_HEADER_SIZE);
-        if (computed != stored_crc) {
+        uint32_t computed = 0;
+        if (!file_crc32(computed) || computed != stored_crc) {
             std::cerr << "WOZ: CRC32 mismatch (stored 0x" << std::hex << stored_crc
                       << ", computed 0x" << computed << std::dec << ")\n";
+            m_file.reset();
             return -1;
         }
     }
@@ -460,58 +460,115 @@ int Woz::load(const std::string& filename) {
     std::fill(std::begin(m_image.tmap), std::end(m_image.tmap), 0xFF);
 
     // Walk chunks starting at byte 12.
-    size_t pos = WOZ_HEADER_SIZE;
+    uint64_t pos = WOZ_HEADER_SIZE;
     bool tmap_parsed = false;
-
-    while (pos + 8 <= buf.size()) {
-        uint32_t chunk_id   = static_cast<uint32_t>(buf[pos])   |
-                             (static_cast<uint32_t>(buf[pos+1]) << 8) |
-                             (static_cast<uint32_t>(buf[pos+2]) << 16) |
-                             (static_cast<uint32_t>(buf[pos+3]) << 24);
-        uint32_t chunk_size = static_cast<uint32_t>(buf[pos+4]) |
-                             (static_cast<uint32_t>(buf[pos+5]) << 8) |
-                             (static_cast<uint32_t>(buf[pos+6]) << 16) |
-                             (static_cast<uint32_t>(buf[pos+7]) << 24);
-
-        size_t data_off = pos + 8;
-        if (data_off + chunk_size > buf.size()) {
+    std::vector<uint8_t> data;
+
+    while (pos + 8 <= file_size) {
+        uint8_t hdr[8];
+        if (!m_file->read(pos, hdr, 8)) break;
+        uint32_t chunk_id   = static_cast<uint32_t>(hdr[0]) |
+                             (static_cast<uint32_t>(hdr[1]) << 8) |
+                             (static_cast<uint32_t>(hdr[2]) << 16) |
+                             (static_cast<uint32_t>(hdr[3]) << 24);
+        uint32_t chunk_size = static_cast<uint32_t>(hdr[4]) |
+                             (static_cast<uint32_t>(hdr[5]) << 8) |
+                             (static_cast<uint32_t>(hdr[6]) << 16) |
+                             (static_cast<uint32_t>(hdr[7]) << 24);
+
+        uint64_t data_off = pos + 8;
+        if (data_off + chunk_size > file_size) {
             std::cerr << "WOZ: chunk data extends beyond file end\n";
             break;
         }
-        const uint8_t* data = buf.data() + data_off;
+
+        // Only the chunks we parse are read; of a WOZ2 TRKS chunk, only the TRK array.
+        uint32_t read_size = 0;
+        switch (chunk_id) {
+            case WOZ_CHUNK_INFO:
+            case WOZ_CHUNK_TMAP:
+            case WOZ_CHUNK_META:
+                read_size = chunk_size;
+                break;
+            case WOZ_CHUNK_TRKS:
+                read_size = (m_image.file_version == 1) ? chunk_size
+                    : std::min<uint32_t>(chunk_size, WOZ_TRK_ARRAY_ENTRIES * WOZ_TRK_ENTRY_SIZE);
+                break;
+            default:
+                break;
+        }
+        data.resize(read_size);
+        if (read_size && !m_file->read(data_off, data.data(), read_size)) {
+            std::cerr << "WOZ: read error on '" << filename << "'\n";
+            m_file.reset();
+            return -1;
+        }
 
         int rc = 0;
         switch (chunk_id) {
             case WOZ_CHUNK_INFO:
-                rc = parse_info(data, chunk_size);
+                rc = parse_info(data.data(), chunk_size);
                 break;
             case WOZ_CHUNK_TMAP:
-                rc = parse_tmap(data, chunk_size);
+                rc = parse_tmap(data.data(), chunk_size);
                 tmap_parsed = true;
                 break;
             case WOZ_CHUNK_TRKS:
                 if (!tmap_parsed) {
                     std::cerr << "WOZ: TRKS chunk appears before TMAP – skipping\n";
                 } else if (m_image.file_version == 1) {
-                    rc = parse_trks_v1(data, chunk_size);
+                    rc = parse_trks_v1(data.data(), chunk_size);
                 } else {
-                    rc = parse_trks_v2(buf, data_off, chunk_size);
+                    rc = parse_trks_v2(data.data(), read_size);
                 }
                 break;
             case WOZ_CHUNK_META:
-                rc = parse_meta(data, chunk_size);
+                rc = parse_meta(data.data(), chunk_size);
                 break;
             default:
                 // Unknown chunk – spec says to skip it.
                 break;
         }
-        if (rc != 0) return rc;
+        if (rc != 0) {
+            m_file.reset();
+            return rc;
+        }
 
         pos = data_off + chunk_size;
     }
+
+    // WOZ1 tracks are all in memory now and are saved back as WOZ2.
+    if (m_image.file_version == 1) m_file.reset();
     return 0;
 }
 
+// ─── Lazy track data ──────────────────────────────────────────────────────────
+
+void Woz::load_track(woz_track_t& trk) {
+    trk.bits.assign((trk.bit_count + 7) / 8, 0);
+    if (!m_file || !m_file->read(trk.file_offset, trk.bits.data(), trk.bits.size())) {
+        std::cerr << "WOZ: read error on track data at offset " << trk.file_offset << "\n";
+    }
+}
+
+void Woz::load_all_tracks() {
+    for (woz_track_t& trk : m_image.tracks) {
+        if (trk.bits.empty() && trk.file_offset) load_track(trk);
+    }
+}
+
+bool Woz::file_crc32(uint32_t& crc) {
+    uint8_t buf[16 * 1024];
+    crc = 0;
+    for (uint64_t pos = WOZ_HEADER_SIZE; pos < m_file->size(); ) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(sizeof(buf), m_file->size() - pos));
+        if (!m_file->read(pos, buf, n)) return false;
+        crc = crc32(buf, n, crc);
+        pos += n;
+    }
+    return true;
+}
+
 // ─── Chunk writers ────────────────────────────────────────────────────────────
 
 void Woz::append_u16le(std::vector<uint8_t>& v, uint16_t val) {
@@ -632,6 +689,11 @@ std::vector<uint8_t> Woz::build_meta_chunk() {
 // ─── Save ─────────────────────────────────────────────────────────────────────
 
 int Woz::save(const std::string& filename) {
+    // Everything is in memory from here on: the file being written may be the
+    // one tracks were being read from.
+    load_all_tracks();
+    m_file.reset();
+
     std::vector<uint8_t> out;
     out.reserve(64 * 1024);
 
@@ -674,6 +736,62 @@ int Woz::save(const std::string& filename) {
         std::cerr << "WOZ: write error on '" << filename << "'\n";
         return -1;
     }
+    for (woz_track_t& trk : m_image.tracks) trk.dirty = false;
+    return 0;
+}
+
+// Only bits ever change under the guest (bit_count, TMAP and INFO stay put), so
+// each dirty track goes back over its old bytes and the CRC is recomputed.
+int Woz::writeback() {
+    if (m_read_only) {
+        std::cerr << "WOZ: '" << current_image_filename << "' is read-only, not written back\n";
+        return -1;
+    }
+    if (!m_file) return save(current_image_filename);
+    if (write_tracks() != 0) return -1;
+    return write_crc();
+}
+
+int Woz::write_tracks() {
+    if (m_read_only || !m_file) return -1;
+    bool any = false;
+    for (const woz_track_t& trk : m_image.tracks) any |= trk.dirty;
+    if (!any) return 0;
+
+    // CRC first: tracks patched under a stale CRC would make the file unloadable.
+    if (!m_crc_cleared) {
+        const uint8_t zero[4] = {};
+        if (!m_file->write(8, zero, 4)) {
+            std::cerr << "WOZ: write error on '" << current_image_filename << "'\n";
+            return -1;
+        }
+        m_crc_cleared = true;
+    }
+    for (woz_track_t& trk : m_image.tracks) {
+        if (!trk.dirty) continue;
+        if (!m_file->write(trk.file_offset, trk.bits.data(), trk.bits.size())) {
+            std::cerr << "WOZ: write error on '" << current_image_filename << "'\n";
+            return -1;
+        }
+        trk.dirty = false;
+    }
+    return 0;
+}
+
+int Woz::write_crc() {
+    if (!m_crc_cleared) return 0;
+    uint32_t crc = 0;
+    if (!file_crc32(crc)) {
+        std::cerr << "WOZ: read error on '" << current_image_filename << "'\n";
+        return -1;
+    }
+    uint8_t le[4] = { static_cast<uint8_t>(crc), static_cast<uint8_t>(crc >> 8),
+                      static_cast<uint8_t>(crc >> 16), static_cast<uint8_t>(crc >> 24) };
+    if (!m_file->write(8, le, 4) || !m_file->flush()) {
+        std::cerr << "WOZ: write error on '" << current_image_filename << "'\n";
+        return -1;
+    }
+    m_crc_cleared = false;
     return 0;
 }
 
@@ -995,15 +1113,15 @@ woz_track_t* Woz::get_track_ptr(int quarter_track) {
     uint8_t idx = m_image.tmap[quarter_track];
     if (idx == 0xFF) return nullptr;
     if (idx >= m_image.tracks.size()) return nullptr;
-    return &m_image.tracks[idx];
+    woz_track_t& trk = m_image.tracks[idx];
+    if (trk.bits.empty() && trk.file_offset) load_track(trk);
+    return &trk;
 }
 
+// Reading a track in from the file doesn't change the image, so const
+// callers (the block exporters) share the lazy load.
 const woz_track_t* Woz::get_track_ptr(int quarter_track) const {
-    if (quarter_track < 0 || quarter_track >= 160) return nullptr;
-    uint8_t idx = m_image.tmap[quarter_track];
-    if (idx == 0xFF) return nullptr;
-    if (idx >= m_image.tracks.size()) return nullptr;
-    return &m_image.tracks[idx];
+    return const_cast<Woz*>(this)->get_track_ptr(quarter_track);
 }
 
 // ─── Diagnostics ─────────────────────────────────────────────────────────────
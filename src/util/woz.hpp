@@ -21,9 +21,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <algorithm>
 
 #include "util/media.hpp"
+#include "util/BlockImage.hpp"
 //#include "devices/diskii/diskii_fmt.hpp"
 
 // Disk data structure (raw, unencoded)
@@ -90,9 +92,14 @@ struct woz_info_t {
 //
 // A regular data nibble is 8 bits (high bit first), since nibbles always have
 // the high bit set and contain no more than two consecutive zero bits.
+//
+// Tracks of a loaded WOZ2 file start out with only file_offset / bit_count set;
+// Woz::get_track_ptr() reads the bits in the first time the track is asked for.
 struct woz_track_t {
     std::vector<uint8_t> bits;     // bit-packed stream, MSB-first per byte
     uint32_t             bit_count = 0;
+    uint64_t             file_offset = 0;  // bit data in the WOZ2 file, 0 if built in memory
+    bool                 dirty = false;    // written since load / last writeback
 };
 
 // ─── Full in-memory WOZ image ─────────────────────────────────────────────────
@@ -113,15 +120,18 @@ public:
     // Constructs a blank WOZ2 5.25" image with creator string pre-filled.
     Woz();
 
-    // Default destructor: std::vector / std::map members handle all cleanup.
-    // Declared explicitly as a positive assertion that no manual resource
-    // management is needed (no raw pointers or open file handles are kept).
+    // A loaded WOZ2 keeps its file open (m_file) so tracks can be read in
+    // lazily and written back in place; the unique_ptr closes it.
     ~Woz() = default;
+    Woz(Woz&&) = default;
+    Woz& operator=(Woz&&) = default;
 
     // ── Primary operations ───────────────────────────────────────────────────
 
     // Load a WOZ 1.0 or 2.x file from disk into m_image.
-    // Validates magic cookie and CRC32 (if non-zero).
+    // Validates the magic cookie and the CRC32 (if non-zero). WOZ1 files are
+    // read whole; WOZ2 files only have INFO / TMAP / META and the TRK array
+    // parsed here, track bits come in on first use.
     // Returns 0 on success, -1 on error.
     int load(const std::string& filename);
     inline std::string get_current_filename() { return current_image_filename; }
@@ -129,6 +139,29 @@ public:
     // Write m_image to disk as WOZ 2.x with a freshly computed CRC32.
     // Returns 0 on success, -1 on error.
     int save(const std::string& filename);
+
+    // Write changes back to the file the image was loaded from. A WOZ2 file
+    // gets only its dirty tracks rewritten in place plus a new CRC32, synced
+    // to disk; anything else is rewritten whole with save().
+    // Returns 0 on success, -1 on error (always, for a read-only file).
+    int writeback();
+
+    // The cheap half of writeback() for a drive going idle: patch the dirty
+    // tracks into the file, with no CRC pass and no sync. The header CRC is
+    // zeroed before the first track is touched, which the WOZ spec reads as
+    // "not checked", so a file left like this by a crash still loads.
+    // Only for writes_in_place(). Returns 0 on success, -1 on error.
+    int write_tracks();
+
+    // Put back the CRC32 write_tracks() cleared, and sync the file. Returns 0
+    // at once if it didn't clear one.
+    int write_crc();
+
+    // The file could only be opened read-only: mount it write-protected.
+    inline bool is_read_only() const { return m_read_only; }
+    // Dirty tracks are patched into the open file rather than rewriting it,
+    // so write_tracks() is cheap enough to run whenever the drive idles.
+    inline bool writes_in_place() const { return m_file && !m_read_only; }
 #if 0
     // Build m_image from a block-based or nibblized disk image described by
     // media (as returned by identify_media).  Generates a proper Apple II
@@ -150,7 +183,8 @@ public:
     const woz_image_t&  image() const { return m_image; }
 
     // Returns a pointer to the bit-stream for the given quarter-track index
-    // (0–159).  Returns nullptr if the TMAP entry is 0xFF (empty track).
+    // (0–159), reading the track in from the file if it isn't yet.
+    // Returns nullptr if the TMAP entry is 0xFF (empty track).
     woz_track_t*       get_track_ptr(int quarter_track);
     const woz_track_t* get_track_ptr(int quarter_track) const;
 
@@ -162,6 +196,15 @@ public:
 private:
     woz_image_t m_image;
     std::string current_image_filename;
+    // The WOZ2 file tracks are read from / written back to; null otherwise.
+    std::unique_ptr<BlockImage> m_file;
+    bool m_read_only = false;
+    bool m_crc_cleared = false;   // write_tracks() zeroed the file's CRC32
+
+    void load_track(woz_track_t& trk);
+    void load_all_tracks();
+    // CRC32 of the file from byte 12 on, read back through m_file.
+    bool file_crc32(uint32_t& crc);
 #if 0    
     // ── Bit-stream primitives ────────────────────────────────────────────────
     // Append one bit (0 or 1) to trk, MSB-first within each byte.
@@ -205,9 +248,8 @@ private:
     // WOZ1: fixed 6656-byte tracks packed directly in the chunk data.
     int parse_trks_v1(const uint8_t* data, uint32_t size);
     // WOZ2: 160-entry TRK descriptor array + block-addressed bit data.
-    // file_buf / file_size are needed to resolve block addresses.
-    int parse_trks_v2(const std::vector<uint8_t>& file_buf,
-                      size_t chunk_data_offset, uint32_t chunk_size);
+    // Records where each track lives in m_file; the bits are read later.
+    int parse_trks_v2(const uint8_t* trk_array, uint32_t size);
     int parse_meta(const uint8_t* data, uint32_t size);
 
     // ── Chunk writers (always produce WOZ2) ──────────────────────────────────
@@ -223,6 +265,7 @@ private:
     std::vector<uint8_t> build_meta_chunk();
 
     // ── CRC32 (Gary S. Brown 1986, per WOZ spec Appendix A) ─────────────────
-    static uint32_t crc32(const uint8_t* buf, size_t size);
+    // Pass a previous result as crc to continue over the next span.
+    static uint32_t crc32(const uint8_t* buf, size_t size, uint32_t crc = 0);
     static const uint32_t crc32_tab[256];
 };
@@ -33,11 +33,13 @@ video_system_t::video_system_t(computer_t *computer) {
     window_height = (BASE_HEIGHT + border_height*2) * SCALE_Y;
     aspect_ratio = (float)window_width / (float)window_height;
 
+    // Headless runs get a hidden window (on the offscreen video driver) so the display
+    // devices still have a renderer to draw into; nothing is ever presented.
     window = SDL_CreateWindow(
         "GSSquared - Apple ][ Emulator", 
         (BASE_WIDTH + border_width*2) * SCALE_X, 
         (BASE_HEIGHT + border_height*2) * SCALE_Y, 
-        SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY
+        gs2_app_values.headless ? SDL_WINDOW_HIDDEN : (SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY)
     );
 
     if (!window) {
@@ -60,11 +62,15 @@ video_system_t::video_system_t(computer_t *computer) {
     // shaders (CRT post-processing). macOS uses Metal/MSL; Windows uses
     // D3D12/DXIL. If neither backend is available, fall back to the classic
     // renderer; gpu_device stays null and CRT shader effects are disabled.
-    renderer = SDL_CreateGPURenderer(window,
-        SDL_GPU_SHADERFORMAT_MSL | SDL_GPU_SHADERFORMAT_DXIL, &gpu_device);
-    if (!renderer) {
-        printf("GPU renderer unavailable (%s); falling back to classic renderer\n", SDL_GetError());
-        gpu_device = nullptr;
+    if (gs2_app_values.headless) {
+        renderer = SDL_CreateRenderer(window, SDL_SOFTWARE_RENDERER);
+    } else {
+        renderer = SDL_CreateGPURenderer(window,
+            SDL_GPU_SHADERFORMAT_MSL | SDL_GPU_SHADERFORMAT_DXIL, &gpu_device);
+        if (!renderer) {
+            printf("GPU renderer unavailable (%s); falling back to classic renderer\n", SDL_GetError());
+            gpu_device = nullptr;
+        }
     }
     if (!renderer) {
         renderer = SDL_CreateRenderer(window, NULL);
@@ -94,7 +100,9 @@ video_system_t::video_system_t(computer_t *computer) {
     clear();
     present();
 
-    SDL_RaiseWindow(window);
+    if (!gs2_app_values.headless) {
+        SDL_RaiseWindow(window);
+    }
 
     {
         int point_w = 0, point_h = 0;
@@ -250,9 +258,20 @@ void video_system_t::present() {
     if (screenshot_writer) {
         screenshot_writer->poll(event_queue);
     }
+    if (gs2_app_values.headless) {
+        return;
+    }
     SDL_RenderPresent(renderer);
 }
 
+uint64_t video_system_t::host_refresh_ns() {
+    const SDL_DisplayMode *mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+    if (!mode || mode->refresh_rate <= 0.0f) {
+        return 1000000000ULL / 60;
+    }
+    return (uint64_t)(1000000000.0 / mode->refresh_rate);
+}
+
 void video_system_t::set_window_title(const char *title) {
     SDL_SetWindowTitle(window, title);
 }
@@ -304,6 +323,9 @@ void video_system_t::clear() {
 }
 
 void video_system_t::raise() {
+    if (gs2_app_values.headless) {
+        return;
+    }
     SDL_RaiseWindow(window);
 }
 void video_system_t::raise(SDL_Window *windowp) {
@@ -568,6 +590,19 @@ void video_system_t::save_screenshot() {
     SDL_DestroySurface(surface);
 }
 
+bool video_system_t::save_screenshot(const std::string &path) {
+    if (!screenshot_writer || screenshot_writer->is_pending()) {
+        return false;
+    }
+    SDL_Surface *surface = capture_screen_surface();
+    if (!surface) {
+        return false;
+    }
+    bool ok = screenshot_writer->try_submit(surface, path);
+    SDL_DestroySurface(surface);
+    return ok;
+}
+
 void video_system_t::register_frame_processor(int weight, FrameHandler handler) {
     frame_handlers.insert({weight, handler});
 }
@@ -133,6 +133,8 @@ public:
         const SDL_FRect *content_inset_src = nullptr);
     void clear();
     void present();
+    /** Nanoseconds between host refreshes of the display the window is on (60Hz if unknown). */
+    uint64_t host_refresh_ns();
     bool display_capture_mouse(bool capture);
     bool display_capture_mouse_message(bool capture);
     bool is_mouse_captured();
@@ -146,6 +148,8 @@ public:
     void set_display_mono_color(display_mono_color_t mode);
     void copy_screen();
     void save_screenshot();
+    /** Write the last presented frame to path as PNG (on the screenshot worker). False if busy or nothing to capture. */
+    bool save_screenshot(const std::string &path);
     void flip_display_scale_mode();
     // True when the CRT post-process shader is available to be used.
     bool crt_shader_available() const { return crt_state != nullptr; }